@@ -9,6 +9,7 @@
 */
 
 #include <ctype.h>
+#include <setjmp.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -35,6 +36,52 @@ void *xrealloc(void *p, size_t n);
 /** strdup() replacement using xmalloc(); returns NULL if s is NULL. */
 char *xstrdup(const char *s);
 
+/** FNV-1a hash of a NUL-terminated string (stable across runs and platforms). */
+unsigned int lb_hash_str(const char *s);
+
+/** Square root by Newton's method, so no module needs libm; 0 for x <= 0. */
+double lb_sqrt(double x);
+
+/* splitmix64 stream: tiny, fast, and identical on every platform. */
+typedef struct {
+    unsigned long long s;
+} LbRng;
+
+/** Seeds `r`; different `stream` values give independent sequences for one seed. */
+void lb_rng_seed(LbRng *r, unsigned long long seed, unsigned long long stream);
+unsigned long long lb_rng_next(LbRng *r);
+/** Uniform double in [0, 1) from the top 53 bits. */
+double lb_rng_unit(LbRng *r);
+/** Fills out[0..n) with lb_rng_unit() draws (same sequence, no per-draw call). */
+void lb_rng_fill_unit(LbRng *r, double *out, int n);
+
+/*
+  Error trap for worker threads. While a trap is installed on the calling
+  thread, dief() formats its message into `msg` and longjmps to `jb` instead of
+  exiting, so a loader can report the first failure in a deterministic order.
+*/
+typedef struct {
+    jmp_buf jb;
+    char msg[512];
+} DieTrap;
+
+/** Installs (or with NULL removes) the dief() trap for the calling thread. */
+void dief_trap_set(DieTrap *trap);
+
+/* -------------------------------------------------------------------------- */
+/* Parallel helpers                                                            */
+/* -------------------------------------------------------------------------- */
+
+/** Returns the number of online CPUs (at least 1). */
+int lb_cpu_count(void);
+
+/*
+  Runs fn(ctx, i) for every i in [0, n) on up to `threads` threads (<= 0 means
+  one per CPU). Indices are handed out dynamically, so uneven jobs balance out;
+  the calling thread participates and the call returns once all jobs are done.
+*/
+void parallel_for(int n, int threads, void (*fn)(void *ctx, int i), void *ctx);
+
 /* -------------------------------------------------------------------------- */
 /* Tiny typed vectors (stretchy buffers)                                       */
 /* -------------------------------------------------------------------------- */
@@ -54,54 +101,291 @@ char *xstrdup(const char *s);
 
 #define VEC_PUSH(a, x)                                                       do {                                                                         if ((a).n == (a).cap) {                                                      (a).cap = (a).cap ? (a).cap * 2 : 8;                                       (a).v = xrealloc((a).v, (size_t)(a).cap * sizeof(*(a).v));               }                                                                          (a).v[(a).n++] = (x);                                                    } while (0)
 
+/* Replaces `dst` (which must not own storage) with an exact-size copy of `src`'s elements. */
+#define VEC_COPY(dst, src)   do {                                                         (dst).n = (dst).cap = (src).n;                                               (dst).v = (src).n ? xmalloc((size_t)(src).n * sizeof(*(src).v)) : NULL;       if ((src).n) memcpy((dst).v, (src).v, (size_t)(src).n * sizeof(*(src).v)); } while (0)
+
 /* Forward declarations needed for vector declarations below. */
 typedef struct Expr Expr;
 typedef struct Stmt Stmt;
 
 VEC_DECL(VecStr, char *);
 VEC_DECL(VecDbl, double);
+VEC_DECL(VecInt, int);
 VEC_DECL(VecExprPtr, Expr *);
 VEC_DECL(VecStmtPtr, Stmt *);
 
+/*
+  Open-addressing index from name hashes to element positions, shared by the
+  item registry, catalog and inventory. Linear probing, kept at most half
+  full; each slot holds position + 1 (0 = empty) and the hash, so a probe
+  only touches elements whose hash matches. Callers compare names:
+
+      int slot = -1, i;
+      while ((i = hidx_next(&ix, h, &slot)) >= 0) if (strcmp(v[i].name, name)==0) return i;
+*/
+typedef struct {
+    int *slots;
+    unsigned int *hashes;
+    int cap, n;
+} HashIndex;
+
+void hidx_init(HashIndex *ix);
+void hidx_free(HashIndex *ix);
+/* Replaces `dst` (which must not own storage) with a copy of `src`. */
+void hidx_copy(HashIndex *dst, const HashIndex *src);
+/* Sizes the table for `n` entries up front, so they go in without regrowing. */
+void hidx_reserve(HashIndex *ix, int n);
+void hidx_add(HashIndex *ix, unsigned int hash, int pos);
+/* Next position filed under `hash` after probe slot *slot (start at -1), or -1. */
+int hidx_next(const HashIndex *ix, unsigned int hash, int *slot);
+
 /* -------------------------------------------------------------------------- */
 /* Inventory / Catalog / World                                                 */
 /* -------------------------------------------------------------------------- */
 
+/* Item tags are interned per registry; a tag set has one bit per tag id. */
+typedef unsigned long long ItemTagSet;
+#define LB_MAX_ITEM_TAGS 64
+
+/* What an `itemdef` (or data/items.txt) says about an item kind. */
+typedef struct {
+    char *name;
+    unsigned int hash;
+    ItemTagSet tags;
+    int stackable;
+    double max_condition;
+    int shelf_life_days;  /* 0 = never spoils */
+} ItemDef;
+
+VEC_DECL(VecItemDef, ItemDef);
+
+typedef struct {
+    VecItemDef items;     /* item id == index */
+    HashIndex index;      /* name -> id */
+    char *tags[LB_MAX_ITEM_TAGS];
+    int n_tags;
+} ItemRegistry;
+
+void item_reg_init(ItemRegistry *r);
+void item_reg_free(ItemRegistry *r);
+/* Returns the item id, or -1 if no definition exists. */
+int item_reg_find(const ItemRegistry *r, const char *name);
+int item_reg_get_or_add(ItemRegistry *r, const char *name);
+/* Returns the tag id, or -1 for a tag no item carries. */
+int item_reg_tag_id(const ItemRegistry *r, const char *tag);
+/* Interns `tag` (fatal beyond LB_MAX_ITEM_TAGS) and adds it to item `id`. */
+void item_reg_add_tag(ItemRegistry *r, int id, const char *tag);
+
 typedef struct {
     char *key;        /* item kind, e.g. "water_filter" */
+    unsigned int hash; /* lb_hash_str(key), cached for the inventory index */
     double qty;       /* quantity in stock (unit depends on DSL) */
     double best_cond; /* best observed condition (0–100) */
+    int item_id;      /* registry id, or -1 when no itemdef names this key */
+    ItemTagSet tags;  /* copied from the registry when the entry is bound */
+    int shelf_ticks;  /* registry shelf life in ticks; 0 = no lots */
+    double lot_qty;   /* qty still covered by unexpired lots */
+    int instanced;    /* non-stackable: qty counts instances in Inventory.inst */
+    VecInt inst;      /* max-heap of instance ids by condition; top is the best tool */
 } ItemEntry;
 
 VEC_DECL(VecItemEntry, ItemEntry);
 
+/*
+  Index of an entry in Inventory.items. Entries are never removed, so a handle
+  stays valid for the inventory's lifetime (and in copies of it). Canonical
+  items from data/items.txt are interned first, so CANON_ITEM_* ids are handles.
+*/
+typedef int ItemHandle;
+
+/*
+  Condition of every non-stackable item instance, pooled as parallel arrays so
+  wear updates touch one double. Freed slots are chained through `pos`.
+*/
+typedef struct {
+    double *cond;
+    ItemHandle *owner;   /* -1 while the slot is free */
+    int *pos;            /* index in the owner's heap, or next free slot */
+    int n, cap;
+    int free_head;       /* -1 when no slot is free */
+} InstancePool;
+
+void inst_pool_init(InstancePool *p);
+void inst_pool_free(InstancePool *p);
+void inst_pool_copy(InstancePool *dst, const InstancePool *src);
+/* Allocates an instance of `owner` with condition `cond` and pushes it on `heap`. */
+int inst_pool_add(InstancePool *p, VecInt *heap, ItemHandle owner, double cond);
+/* Removes instance `id` from `heap` in O(log n) and frees its slot. */
+void inst_pool_remove(InstancePool *p, VecInt *heap, int id);
+/* Restores heap order after p->cond[id] changed. */
+void inst_pool_update(InstancePool *p, VecInt *heap, int id);
+
+/*
+  A perishable addition. Stock is assumed to be used oldest-first, so when a
+  lot expires whatever stock is not covered by younger lots spoils with it.
+*/
+typedef struct {
+    int expires;       /* absolute tick */
+    unsigned int seq;  /* insertion order; breaks ties so expiry is deterministic */
+    ItemHandle item;
+    double qty;
+} ItemLot;
+
+VEC_DECL(VecItemLot, ItemLot);
+
+/* One inventory mutation; the prev_* fields make rollback exact. */
+typedef struct {
+    int tick;          /* Inventory.now when recorded */
+    ItemHandle item;
+    int cause;         /* CANON_TASK_* id, -1 for world upkeep, or an interned name (inv_journal_cause) */
+    double delta;
+    double prev_qty;
+    double prev_cond;
+} InvJournalEntry;
+
+VEC_DECL(VecInvJournalEntry, InvJournalEntry);
+
+/* Compacted produced/consumed totals for one (day, item, cause). */
+typedef struct {
+    int day;           /* -1 in whole-run summaries */
+    ItemHandle item;
+    int cause;
+    double produced;
+    double consumed;
+} InvFlow;
+
+VEC_DECL(VecInvFlow, InvFlow);
+
+/* Position in the journal; stays meaningful across compaction. */
+typedef long InvMark;
+
+/* Days of per-day flows a journal keeps; older days live on only in the run totals. */
+#define INV_FLOW_WINDOW_DAYS 7
+
+typedef struct {
+    VecInvJournalEntry entries;
+    InvMark base;      /* mark of entries.v[0]; grows as compaction drops entries */
+    VecInvFlow flows;  /* compacted recent days, ordered by day */
+    VecInvFlow totals; /* days that left the window, summed (day -1) */
+    int window;        /* days kept in `flows`; INV_FLOW_WINDOW_DAYS by default */
+    int cause;         /* stamped onto new entries; the sim keeps it current */
+    VecStr names;      /* causes that are not canonical tasks; cause -2-i is names.v[i] */
+    HashIndex name_index;
+} InvJournal;
+
 typedef struct {
     VecItemEntry items;
+    HashIndex index;                       /* key -> handle */
+    const ItemRegistry *reg;               /* NULL until inv_bind_registry() */
+    double tag_stock[LB_MAX_ITEM_TAGS];    /* running qty total per registry tag */
+    InvJournal *journal;                   /* optional change log, not owned; NULL = off */
+    int now;                               /* absolute tick (day*DAY_TICKS + tick), set by the sim */
+    VecItemLot lots;                       /* min-heap on (expires, seq) */
+    unsigned int lot_seq;
+    InstancePool inst;                     /* conditions of non-stackable instances */
 } Inventory;
 
 void inv_init(Inventory *inv);
+void inv_free(Inventory *inv);
+/* Deep copy with identical handles; the journal is not copied (dst->journal is NULL). */
+void inv_copy(Inventory *dst, const Inventory *src);
+/* Resolves every entry against `reg`, rebuilds tag totals and re-lots perishable stock from `now`. */
+void inv_bind_registry(Inventory *inv, const ItemRegistry *reg);
+/* Returns the handle for key, interning a zero-stock entry if needed. */
+ItemHandle inv_handle(Inventory *inv, const char *key);
+/* Returns the handle for key, or -1 if the inventory has never seen it. */
+ItemHandle inv_lookup(const Inventory *inv, const char *key);
 ItemEntry *inv_find(Inventory *inv, const char *key);
 void inv_add(Inventory *inv, const char *key, double qty, double cond);
+void inv_add_h(Inventory *inv, ItemHandle h, double qty, double cond);
+/* Removes up to qty; returns the amount actually taken. */
+double inv_consume(Inventory *inv, const char *key, double qty);
+double inv_consume_h(Inventory *inv, ItemHandle h, double qty);
 double inv_stock(Inventory *inv, const char *key);
+double inv_stock_h(const Inventory *inv, ItemHandle h);
+/* Total stock of every item carrying `tag`; O(1) in the number of items. */
+double inv_stock_tag(const Inventory *inv, const char *tag);
 int inv_has(Inventory *inv, const char *key);
 double inv_cond(Inventory *inv, const char *key);
+double inv_cond_h(const Inventory *inv, ItemHandle h);
+/* Uses the best instance of a non-stackable item, wearing it by `wear`; returns its condition
+   before wear (0 if none). Instances worn to 0 break. Stackable items just report inv_cond_h. */
+double inv_wear_h(Inventory *inv, ItemHandle h, double wear);
+/* Pool id of the best-condition instance, or -1. */
+int inv_best_instance(const Inventory *inv, ItemHandle h);
+/* Spoils every lot expiring at or before `now`; appends what was removed to `spoiled` (may be NULL). */
+void inv_expire_lots(Inventory *inv, VecItemLot *spoiled);
+
+void inv_journal_init(InvJournal *jr);
+void inv_journal_free(InvJournal *jr);
+InvMark inv_journal_mark(const InvJournal *jr);
+/* Undoes every change after `mark` in O(changes); fatal if the mark was compacted. Lots and
+   instance wear are not journaled; restored instances come back at the previous best condition. */
+void inv_journal_rollback(Inventory *inv, InvMark mark);
+/*
+  Folds entries before `keep` into per-day flows and drops them; days more
+  than `window` before the newest folded day go into the run totals, so the
+  journal's size does not grow with the run.
+*/
+void inv_journal_compact(InvJournal *jr, InvMark keep);
+/* Appends flows for `day` (or whole-run totals for day -1), including uncompacted entries; days past the window have none. */
+void inv_journal_flows(const InvJournal *jr, int day, VecInvFlow *out);
+/* Cause id for a task name: its CANON_TASK_* id, or an id of its own for other names. */
+int inv_journal_cause(InvJournal *jr, const char *task);
+/* Label of a cause id: the task name, or "(world)" for -1. */
+const char *inv_journal_cause_name(const InvJournal *jr, int cause);
+
+/* An item a task must have on hand to start; canonical ids double as handles. */
+typedef struct {
+    ItemHandle item;
+    double qty;
+} TaskInput;
 
 /* Tasks are referenced by name from character scripts and rules. */
 typedef struct {
     char *name;
     int time_ticks; /* default duration if the script doesn't override it */
     char *station;  /* optional station label, e.g. "workshop" */
+    const TaskInput *inputs; /* required inputs (borrowed from kCanonTasks), reserved at start */
+    int n_inputs;
+    unsigned int hash; /* lb_hash_str(name), cached for the catalog index */
+    int canon_id;   /* index into kCanonTasks, or -1 for tasks only the .lbc knows */
+    int lazy_head;  /* first unparsed body span (lazy catalogs), or -1 */
+    int lazy_tail;
 } TaskDef;
 
 VEC_DECL(VecTaskDef, TaskDef);
 
+/* Byte range of a taskdef body recorded by the lazy first pass. */
+typedef struct {
+    const char *filename;
+    char *start;    /* first byte after '{' */
+    size_t len;     /* bytes up to (not including) the closing '}' */
+    int line;       /* line number at start */
+    int next;       /* next span of the same task (later definitions), or -1 */
+} CatalogSpan;
+
+VEC_DECL(VecCatalogSpan, CatalogSpan);
+
 typedef struct {
     VecTaskDef tasks;
+    HashIndex index; /* name -> task index */
+    /* Lazy mode: pending bodies and the source buffers they point into. */
+    VecCatalogSpan spans;
+    VecStr sources;
+    ItemRegistry items;   /* itemdefs (plus data/items.txt when seeded) */
 } Catalog;
 
 void cat_init(Catalog *c);
+/* Frees parsed task names, stations, lazy sources and item definitions; table defaults are borrowed. */
+void cat_free(Catalog *c);
+/* Lazy catalogs parse a task body here on first hit; not safe to race with other threads. */
 TaskDef *cat_find_task(Catalog *c, const char *name);
 TaskDef *cat_get_or_add_task(Catalog *c, const char *name);
+/* Replaces td->station (taking ownership of `station`) without freeing table strings. */
+void taskdef_set_station(TaskDef *td, char *station);
+/* Parses every pending lazy body on up to `threads` threads; returns 0 or -1 with err. */
+int cat_resolve_all(Catalog *c, int threads, char *err, size_t errn);
 
 /* The "world" is the shared state that both characters operate within. */
 typedef struct {
@@ -114,14 +398,237 @@ typedef struct {
     double contamination;
 } Shelter;
 
+/* Built-in event ids; world_init interns these names first. */
+enum { EVENT_BREACH = 0, EVENT_OVERNIGHT = 1 };
+
+/* A world-declared event rolled once per day (`daily "name" chance N% [at T];`). */
+typedef struct {
+    int id;
+    double chance;
+    int tick; /* -1 = random tick in 6..21 */
+} DailyEvent;
+
+VEC_DECL(VecDailyEvent, DailyEvent);
+
+typedef struct {
+    int day, tick;
+    unsigned int seq; /* schedule order; breaks ties within a tick */
+    int id;
+    int level; /* event payload (breach severity), 0 otherwise */
+} EventFiring;
+
+VEC_DECL(VecEventFiring, EventFiring);
+
 typedef struct {
     double breach_chance;
     double overnight_chance;
+    /* Interned event names; the index is the event id. */
+    VecStr names;
+    VecDailyEvent daily;
+    /* Pending firings, a min-heap on (day, tick, seq). */
+    VecEventFiring queue;
+    unsigned int seq;
+    /* Firings popped for the current tick by event_pop_due. */
+    VecEventFiring now;
 } WorldEvents;
 
+void events_init(WorldEvents *ev);
+void events_free(WorldEvents *ev);
+void events_copy(WorldEvents *dst, const WorldEvents *src);
+int event_intern(WorldEvents *ev, const char *name);
+/* Returns the event id or -1 if `name` was never interned. */
+int event_find(const WorldEvents *ev, const char *name);
+void event_schedule(WorldEvents *ev, int day, int tick, int id, int level);
+/*
+  Moves every firing due at or before (day, tick) into ev->now, in schedule
+  order, and returns how many there are. Costs one comparison when none is due.
+*/
+int event_pop_due(WorldEvents *ev, int day, int tick);
+
+/*
+  Quantities promised to tasks that have started but not completed, keyed by
+  item handle. Available stock is inventory stock minus what is held here.
+*/
+typedef struct {
+    VecDbl held;
+} ReserveLedger;
+
+void ledger_init(ReserveLedger *l);
+void ledger_free(ReserveLedger *l);
+void ledger_copy(ReserveLedger *dst, const ReserveLedger *src);
+double ledger_available(const ReserveLedger *l, const Inventory *inv, ItemHandle h);
+int ledger_can_reserve(const ReserveLedger *l, const Inventory *inv, const TaskInput *in, int n);
+/* All-or-nothing: returns 0 (holding nothing) if any input is short. */
+int ledger_reserve(ReserveLedger *l, const Inventory *inv, const TaskInput *in, int n);
+/* Drops a reservation, either at completion (effects then consume the stock) or on abandonment. */
+void ledger_release(ReserveLedger *l, const TaskInput *in, int n);
+
+/*
+  Per-bed hydroponics as structure-of-arrays columns, so the nightly pass is a
+  straight sweep over contiguous doubles. With n == 0 the sim keeps the single
+  garden model (hydroponic_health plus the "Plant" stock).
+*/
+typedef struct {
+    int n, cap;
+    double *health; /* 0..100 */
+    double *growth; /* plant mass; harvestable at HYDRO_RIPE */
+    double *water;  /* reservoir level 0..100 */
+    double *draw;   /* scratch: tonight's harvest draw, then the harvest flag */
+    unsigned char *crop; /* index into the caller's produce table */
+    unsigned int *yield; /* harvests to date */
+} HydroBeds;
+
+/* Shelter-wide inputs shared by every bed for one night. */
+typedef struct {
+    double water_in; /* reservoir added to each bed today */
+    double care;     /* health bonus from maintenance */
+    double climate;  /* health delta from shelter temperature */
+} BedsNight;
+
+void beds_init(HydroBeds *b);
+void beds_free(HydroBeds *b);
+void beds_copy(HydroBeds *dst, const HydroBeds *src);
+/* Appends `count` beds; crops cycle through 0..n_crops-1 by bed index. */
+void beds_add(HydroBeds *b, int count, double health, double water, int n_crops);
+/*
+  Nightly pass over all beds. Adds the number of harvested beds per crop into
+  harvests[crop]; draws come from `rng` in bed order.
+*/
+void beds_night(HydroBeds *b, const BedsNight *in, LbRng *rng, int *harvests);
+double beds_mean_health(const HydroBeds *b);
+
+/*
+  Joint station assignment for the survivors choosing in one tick. Each agent
+  offers a few (station, value) options; the solver gives every agent at most
+  one option so no exclusive station is used twice and the summed value is
+  maximal (forward auction, within agents*AUCTION_EPS of the optimum). An agent
+  may always fall back to idling, valued below all of its options. Solves
+  warm-start from the previous one: agents whose key and options are
+  unchanged keep their station unless prices moved against them.
+*/
+typedef struct {
+    int station; /* index into StationAssign.stations, or -1 if not exclusive */
+    double value;
+} AssignOption;
+
+VEC_DECL(VecAssignOption, AssignOption);
+
+typedef struct {
+    VecStr stations;      /* interned names; kept across ticks */
+    VecAssignOption opts; /* all options, grouped by agent */
+    VecInt first;         /* agent a owns opts[first[a] .. first[a+1]) */
+    VecInt key;           /* per agent: the caller's id, stable across solves */
+    VecDbl price;         /* per station; kept across solves */
+    VecInt owner;         /* per station: agent, or -1 */
+    VecInt choice;        /* per agent: index into opts, or -1 for idle */
+    VecInt queue;
+    /* The previous solve, for the warm start. */
+    VecAssignOption prev_opts;
+    VecInt prev_first, prev_key, prev_choice;
+    VecInt prev_of;       /* per key: its agent in the previous solve, or -1 */
+} StationAssign;
+
+void assign_init(StationAssign *a);
+void assign_free(StationAssign *a);
+/* A solver that warm-starts exactly as `src` would; the current agents are not copied. */
+void assign_copy(StationAssign *dst, const StationAssign *src);
+/* Drops the previous tick's agents; buffers and the station table are reused. */
+void assign_begin(StationAssign *a);
+/*
+  Starts the next agent (agents are numbered 0, 1, ... in call order) and
+  returns its index. `key` names the agent across solves, e.g. a survivor
+  index, so an unchanged agent keeps its choice. Keys are small and
+  non-negative (they index a table); a negative key never warm-starts.
+*/
+int assign_agent(StationAssign *a, int key);
+/* Adds an option for the agent most recently started; station may be NULL. */
+void assign_option(StationAssign *a, const char *station, double value);
+void assign_solve(StationAssign *a);
+/* The agent's chosen option in the order it was added, or -1 for idle. */
+int assign_choice(const StationAssign *a, int agent);
+
+/*
+  Decision log for record/replay. A recorded run keeps every decision an idle
+  survivor took, the scheduler notes printed with it, every sim draw and a
+  state hash per day; a replay feeds those back instead of evaluating rules
+  and stops at the first point where the run no longer matches the log.
+*/
+typedef struct {
+    int day, tick;
+    int agent;       /* 0 = first character, 1 = second */
+    int kind;        /* Candidate kind: 1 task, anything else idles */
+    int task;        /* DecisionLog.strings index, or -1 */
+    int station;     /* DecisionLog.strings index, or -1 */
+    int posture;     /* DecisionLog.strings index: posture after deciding */
+    int ticks;
+    double priority;
+} Decision;
+
+enum { NOTE_PLAIN=0, NOTE_YIELD=1, NOTE_SWITCH=2 };
+
+typedef struct {
+    int day, tick;
+    int agent;
+    int counter;     /* NOTE_*: which conflict counter the note bumps */
+    char *text;      /* the line as printed */
+} DecisionNote;
+
+VEC_DECL(VecDecision, Decision);
+VEC_DECL(VecDecisionNote, DecisionNote);
+VEC_DECL(VecU64, unsigned long long);
+
+typedef struct {
+    unsigned long long inputs; /* dlog_fingerprint() of the files the run loaded */
+    unsigned int seed;
+    int days;
+    LbRng rng;                 /* World.rng when the run started */
+    VecStr strings;            /* task, station and posture names */
+    VecDecision decisions;     /* in the order the sim applied them */
+    VecDecisionNote notes;
+    VecInt draws;
+    VecU64 day_hash;
+    /* Replay state. */
+    int replaying;
+    int next_decision, next_note, next_draw;
+    int diverged;
+    int div_day, div_tick;
+    char div_reason[160];
+} DecisionLog;
+
+void dlog_init(DecisionLog *l);
+void dlog_free(DecisionLog *l);
+/* Index of `s` in l->strings (added on first use); -1 for NULL. */
+int dlog_intern(DecisionLog *l, const char *s);
+int dlog_save(const DecisionLog *l, const char *path, char *err, size_t err_sz);
+/* Returns 0, or -1 with err set and nothing in `l` left to free. */
+int dlog_load(DecisionLog *l, const char *path, char *err, size_t err_sz);
+/* Switches a recorded or loaded log to replay from the start. */
+void dlog_rewind(DecisionLog *l);
+/* Records the first divergence; later calls are ignored. */
+void dlog_diverge(DecisionLog *l, int day, int tick, const char *fmt, ...);
+/* 64-bit FNV-1a over the contents of each file; NULL or unreadable paths hash as empty. */
+unsigned long long dlog_fingerprint(const char *const *paths, int n);
+
+/*
+  What a sim draw is for. In common-random-numbers mode (world_use_crn) each
+  purpose draws from its own stream keyed by (seed, day, tick, purpose), so a
+  plan that adds, drops or moves draws of one kind leaves every other draw
+  where it was.
+*/
+typedef enum {
+    RNG_BREACH = 0,   /* breach roll, tick and severity */
+    RNG_EVENTS,       /* world-declared daily events */
+    RNG_OVERNIGHT,    /* overnight threat roll */
+    RNG_HARVEST,      /* single-garden harvest attempts */
+    RNG_PRESERVE,     /* which can a preserving run yields */
+    RNG_BEDS,         /* per-bed growth and yields */
+    RNG_PURPOSES
+} RngPurpose;
+
 typedef struct {
     Shelter shelter;
     Inventory inv;
+    ReserveLedger reserve;
     WorldEvents events;
     /* Hydroponics subsystem status consumed by simulation night pass. */
     double hydroponic_health;
@@ -129,9 +636,49 @@ typedef struct {
     int hydroponics_maintained_today;
     /* Portion count used to apply cooked-food nutrition bonuses. */
     double cooked_food_portions;
+    HydroBeds beds;
+    /* Per-run PRNG (seeded from --seed); the legacy paths still use rand(). */
+    LbRng rng;
+    /* When set, every sim draw comes from rng instead of the process-wide rand(). */
+    int own_rng;
+    /* Destination of the sim's tick log (stdout unless a driver redirects it); NULL = no log. */
+    FILE *log;
+    /* Decision log being recorded or replayed; NULL when off. */
+    DecisionLog *dlog;
+    /*
+      Optional stop condition (--until), evaluated for each survivor after
+      every tick, or after the last tick of each day when until_daily is set;
+      the run ends when it holds for either. Shared by copies, not owned.
+    */
+    Expr *until;
+    int until_daily;
+    /* Day and tick after which `until` held; -1 while the run goes on. */
+    int stop_day, stop_tick;
+    /*
+      Steady-state mode (--steady): longest cycle, in days, that sim_fast_forward
+      looks for; 0 = off. The run reports the last cycle it extrapolated and the
+      days it skipped in total.
+    */
+    int steady_period;
+    int steady_day, steady_cycle, steady_skipped;
+    /* Last day a task outcome (harvest, preserving) was drawn at random; -1 = none. */
+    int steady_roll_day;
+    /* Common random numbers: per-purpose streams instead of rng/rand(); see RngPurpose. */
+    int crn;
+    unsigned long long crn_seed;
+    LbRng crn_rng[RNG_PURPOSES];
+    int crn_at[RNG_PURPOSES]; /* absolute tick crn_rng[p] was keyed for; -1 = none */
 } World;
 
 void world_init(World *w);
+void world_free(World *w);
+/*
+  Deep copy for another run from the same start: same handles, events, beds
+  and stream. The copy logs to src->log and has no journal or decision log.
+*/
+void world_copy(World *dst, const World *src);
+/* Switches the world's sim draws to common-random-numbers streams for `seed`. */
+void world_use_crn(World *w, unsigned long long seed);
 
 /* -------------------------------------------------------------------------- */
 /* Lexer                                                                       */
@@ -222,9 +769,15 @@ typedef enum {
     OP_NOT  /* unary 'not' */
 } OpKind;
 
+/* Built-in query functions, resolved once when a call is parsed. */
+typedef enum { CALL_UNKNOWN, CALL_STOCK, CALL_STOCK_TAG, CALL_HAS, CALL_COND, CALL_EVENT } CallBuiltin;
+
 typedef struct {
     char *name;
     VecExprPtr args;
+    CallBuiltin builtin;
+    int item; /* inventory handle of a literal item argument, -1 until bound */
+    unsigned int item_hash; /* key hash at bind time, to detect a foreign inventory */
 } CallExpr;
 
 struct Expr {
@@ -315,6 +868,7 @@ VEC_DECL(VecGenericRule, GenericRule);
 
 typedef struct {
     char *event_name;
+    int event_id; /* id in World.events, -1 until bound */
     double priority;
     Expr *when_cond;
     VecStmtPtr stmts;
@@ -352,9 +906,28 @@ typedef struct {
     const char *rt_station;
     int rt_remaining;
     double rt_priority;
+    const TaskInput *rt_inputs; /* held in World.reserve until the task completes */
+    int rt_n_inputs;
+    /*
+      on_events grouped by bound event id: the handlers for id e are
+      on_events.v[ev_rules[k]] for k in [ev_first[e], ev_first[e+1]).
+    */
+    int *ev_first;
+    int *ev_rules;
+    int ev_n; /* ids covered by ev_first; rebound when the world interns more */
+    const WorldEvents *ev_table;
 } Character;
 
 void character_init(Character *c);
+/*
+  Copies vitals, posture and task state for another run. The script (name,
+  skills, rules) is shared with `src`, which must outlive the copy; release
+  the copy with character_copy_free.
+*/
+void character_copy(Character *dst, const Character *src);
+void character_copy_free(Character *c);
+/* Frees a parsed character: its script, skills and traits (not a copy; see character_copy_free). */
+void character_free(Character *c);
 
 /* -------------------------------------------------------------------------- */
 /* Parser                                                                       */
@@ -366,6 +939,8 @@ typedef struct {
 } Parser;
 
 void ps_init(Parser *ps, const char *filename, char *src);
+/* Lexes only src[0..len) and numbers lines from `line` (lazy catalog bodies). */
+void ps_init_span(Parser *ps, const char *filename, char *src, size_t len, int line);
 int ps_is(Parser *ps, TokenKind k);
 int ps_is_ident(Parser *ps, const char *s);
 
@@ -376,12 +951,22 @@ double ps_expect_number(Parser *ps, const char *what);
 double ps_expect_percent(Parser *ps, const char *what);
 
 void parse_character(Parser *ps, Character *out);
+/* Parses `text` as one DSL expression (e.g. a --until condition); NULL with err on a syntax error. */
+Expr *parse_condition(const char *name, const char *text, char *err, size_t errn);
 
 /* -------------------------------------------------------------------------- */
 /* Data file parsing (.lbc catalog, .lbw world)                                 */
 /* -------------------------------------------------------------------------- */
 
 void parse_catalog(Catalog *cat, const char *filename, char *src);
+/*
+  Lazy variant: one fast scan records each taskdef's name and body range; bodies
+  are parsed on the first cat_find_task() hit or by cat_resolve_all(). The
+  catalog takes ownership of src. Errors inside a body surface when it is parsed.
+*/
+void parse_catalog_lazy(Catalog *cat, const char *filename, char *src);
+/* Parses the pending body spans of one task (used by cat_find_task). */
+void catalog_resolve_task(Catalog *cat, TaskDef *td);
 void parse_world(World *w, const char *filename, char *src);
 
 /* -------------------------------------------------------------------------- */
@@ -391,16 +976,623 @@ void parse_world(World *w, const char *filename, char *src);
 int file_exists(const char *path);
 char *read_entire_file(const char *path);
 
+/* -------------------------------------------------------------------------- */
+/* Input loading                                                                 */
+/* -------------------------------------------------------------------------- */
+
+typedef enum {
+    CATALOG_EAGER = 0,    /* parse every body while loading (default) */
+    CATALOG_LAZY,         /* index names only; parse bodies on first lookup */
+    CATALOG_LAZY_PARALLEL /* index first, then parse all bodies on the worker pool */
+} CatalogMode;
+
+/* Everything a run reads from disk before the simulation starts. */
+typedef struct {
+    const char *catalog_path;     /* optional .lbc, applied over the default catalog */
+    CatalogMode catalog_mode;
+    const char *world_path;       /* optional .lbw, applied over world_init() */
+    const char *const *char_paths;
+    int n_chars;
+    int threads;                  /* <= 0: one per CPU */
+} LoadRequest;
+
+/*
+  Reads and parses every input file concurrently. `cat` and `w` are initialized
+  here (defaults first, then the optional files); characters land in argument
+  order, so the result never depends on thread timing. Returns 0 on success; otherwise copies the error that a
+  sequential load would have hit first into err and returns -1.
+*/
+int load_inputs(const LoadRequest *rq, Catalog *cat, World *w, Character *chars, char *err, size_t errn);
+
 /* -------------------------------------------------------------------------- */
 /* Defaults                                                                       */
 /* -------------------------------------------------------------------------- */
 
+/* Per-completion stat and shelter changes of a task. */
+typedef struct {
+    double hunger;
+    double hydration;
+    double morale;
+    double injury;
+    double illness;
+    double temp_c;
+    double power;
+    double water_safe;
+    double water_raw;
+    double structure;
+    double contamination;
+    double signature;
+} TaskDelta;
+
+/*
+  Canonical tables generated from data/tasks.txt and data/items.txt at build
+  time (tools/lb_tablegen.c -> src/lb_canon_tables.c). Both are sorted by name;
+  `id` equals the row index and the CANON_* constants in src/lb_canon_ids.h.
+*/
+typedef struct {
+    const char *name;
+    unsigned int hash; /* lb_hash_str(name) */
+    int id;
+    int time_ticks;
+    const char *station;
+    TaskDelta delta;
+    const TaskInput *inputs;
+    int n_inputs;
+} CanonTask;
+
+typedef struct {
+    const char *name;
+    unsigned int hash;
+    int id;
+    ItemTagSet tags; /* bits index kCanonItemTags */
+    int shelf_life_days;
+} CanonItem;
+
+extern const CanonTask kCanonTasks[];
+extern const int kCanonTaskCount;
+extern const CanonItem kCanonItems[];
+extern const int kCanonItemCount;
+extern const char *const kCanonItemTags[];
+extern const int kCanonItemTagCount;
+
+/* Binary search by name; NULL when the name is not canonical. */
+const CanonTask *canon_task_find(const char *name);
+const CanonItem *canon_item_find(const char *name);
+
+/* Get-or-add for a canonical task, resetting it to the table's time and station. */
+TaskDef *cat_add_canon_task(Catalog *c, const CanonTask *ct);
+/* Adds the canonical tasks and items; task names and stations point into kCanonTasks. */
 void seed_default_catalog(Catalog *cat);
 
+/* -------------------------------------------------------------------------- */
+/* Synthetic scenario generation (lastbreach-gen)                                 */
+/* -------------------------------------------------------------------------- */
+
+/* Size knobs for generated inputs; every count may be zero. */
+typedef struct {
+    unsigned long long seed;
+    int taskdefs;   /* catalog: number of taskdef blocks */
+    int itemdefs;   /* catalog: number of itemdef blocks */
+    int stations;   /* catalog: distinct station labels */
+    int inventory;  /* world: number of inventory lines */
+    int thresholds; /* character: threshold rules */
+    int blocks;     /* character: plan blocks */
+    int rules;      /* character: generic plan rules */
+    int on_events;  /* character: on "breach" handlers */
+    int stmts;      /* statements per block/rule/handler body */
+    int if_depth;   /* nesting depth of the if-chain in each body */
+    int lets;       /* let bindings per body */
+} GenParams;
+
+void gen_params_default(GenParams *p);
+void gen_catalog(FILE *out, const GenParams *p);
+void gen_world(FILE *out, const GenParams *p);
+void gen_character(FILE *out, const GenParams *p, const char *name, int index);
+
 /* -------------------------------------------------------------------------- */
 /* Simulation                                                                     */
 /* -------------------------------------------------------------------------- */
 
+/*
+  Day-at-a-time form of run_sim: sim_begin binds the cast to the world,
+  sim_step_day plays one full day, sim_end prints the completion report and
+  frees the run. Once w->until has held, the day stops at that tick and
+  later sim_step_day calls do nothing. The world, catalog and cast must
+  outlive the run.
+*/
+typedef struct SimRun SimRun;
+
+SimRun *sim_begin(World *w, Catalog *cat, Character *A, Character *B);
+/*
+  Continues `src` between days on copies made by the caller: `w` from
+  world_copy of src's world, `A` and `B` from character_copy of its cast.
+  The clone carries the day and counters and plays on independently.
+*/
+SimRun *sim_clone(const SimRun *src, World *w, Character *A, Character *B);
+void sim_step_day(SimRun *r);
+/* Index of the next day sim_step_day will play. */
+int sim_day(const SimRun *r);
+/* Counters of survivor `agent` (0 = A) so far: idle ticks and completions per distinct task. */
+int sim_idle_ticks(const SimRun *r, int agent);
+int sim_completed_kinds(const SimRun *r, int agent);
+const char *sim_completed_task(const SimRun *r, int agent, int i, int *count);
+void sim_end(SimRun *r);
+/*
+  With w->steady_period set, checks whether the days played so far end in a
+  cycle (see SteadyTrack) and, if so, extrapolates whole laps toward `days`:
+  vitals, shelter and task state stay at the cycle's phase, stocks and
+  counters move by their per-lap drift. It stops short of scheduled events,
+  stock running out and perishable or instanced stock that drifts, and never
+  runs with a decision log. Returns the days skipped (0 when off or no cycle).
+*/
+int sim_fast_forward(SimRun *r, int days);
+/* Plays days until day `days`, --until or a replay divergence, fast-forwarding steady cycles. */
+void sim_play(SimRun *r, int days);
+
 void run_sim(World *w, Catalog *cat, Character *A, Character *B, int days);
 
+/*
+  Record/replay: a run whose world has a DecisionLog attached at sim_begin
+  records into it. If the log is replaying (dlog_rewind), decisions and draws
+  come from the log, choose_action is never called, and run_sim stops after
+  the day where the log first diverged.
+*/
+unsigned long long dlog_state_hash(const World *w, const Character *a, const Character *b);
+
+/* -------------------------------------------------------------------------- */
+/* Region (many shelters, day-boundary exchange)                               */
+/* -------------------------------------------------------------------------- */
+
+/* One shelter of a region: its own world, catalog and two-person cast. */
+typedef struct {
+    char *name;
+    World world;
+    Catalog cat;
+    Character cast[2];
+    SimRun *run;
+    /* Exchange totals to date, in units moved. */
+    double traded_in, traded_out;
+    double raided_in, raided_out;
+} RegionSite;
+
+VEC_DECL(VecRegionSitePtr, RegionSite *);
+
+/* What the exchange phase did at the end of one region day. */
+typedef struct {
+    int trades;
+    double traded_units;
+    int raids;
+    double raided_units;
+} RegionExchange;
+
+typedef struct {
+    /* Sites are heap-allocated so worlds keep their address while runs hold them. */
+    VecRegionSitePtr sites;
+    unsigned long long seed;
+    int threads; /* <= 0: one per CPU */
+    int day;
+    FILE *sink;  /* shared destination for the sites' tick logs */
+    int owns_sink;
+} Region;
+
+/* `sink` may be NULL to discard site logs. */
+void region_init(Region *r, unsigned long long seed, int threads, FILE *sink);
+void region_free(Region *r);
+/*
+  Appends a site for the caller to fill. Its world, catalog and cast start
+  initialized and belong to the region, which frees them in region_free; a
+  caller loading over them (load_inputs) frees them first. The world is
+  switched to a private RNG stream of the region seed when the region starts.
+*/
+RegionSite *region_add_site(Region *r, const char *name);
+/*
+  Plays one day in every shelter on the worker pool, then runs the exchange
+  phase serially in site order. The outcome does not depend on `threads`.
+*/
+void region_step_day(Region *r, RegionExchange *ex);
+
+/* -------------------------------------------------------------------------- */
+/* Result cache                                                                 */
+/* -------------------------------------------------------------------------- */
+
+/*
+  Results of single batch and sweep runs on disk (lb_cache.c), keyed by the
+  inputs, engine, flags and days (cache_inputs_key) plus a per-run string
+  naming the seed and any overrides. Safe to use from worker threads.
+*/
+typedef struct ResultCache ResultCache;
+
+/*
+  Hash of the input files' token streams (not their layout or comments), the
+  engine, `options` and `days`. The engine is LB_ENGINE_HASH, a checksum of
+  the sources and data files the Makefile passes in; a build without it
+  uses its build time, so it never reads runs another build cached.
+*/
+unsigned long long cache_inputs_key(const char *const *paths, int n, const char *options, int days);
+/* Loads `path` if it exists; returns NULL with err if it cannot be written. */
+ResultCache *cache_open(const char *path, long long max_bytes, unsigned long long base, char *err, size_t errn);
+/* Payload stored for run `what`, malloc'd, or NULL. */
+char *cache_get(ResultCache *c, const char *what);
+/* Stores and flushes at once, so finished runs survive an interruption. */
+void cache_put(ResultCache *c, const char *what, const char *payload);
+/*
+  Rewrites the file if anything changed, evicting the least recently used
+  entries down to max_bytes; reports reuse to `report` (may be NULL) and
+  frees the cache. A NULL cache is ignored.
+*/
+void cache_close(ResultCache *c, FILE *report);
+
+/* -------------------------------------------------------------------------- */
+/* Parameter sweeps (grid over world settings, seeds in parallel)              */
+/* -------------------------------------------------------------------------- */
+
+/*
+  One `--sweep key=start:stop:step` axis: n values start, start+step, ... up
+  to stop. Keys are events.breach_chance, events.overnight_chance,
+  shelter.<field> and inventory.<item name> (starting quantity).
+*/
+typedef struct {
+    char *key;
+    double start, step;
+    int n;
+} SweepAxis;
+
+VEC_DECL(VecSweepAxis, SweepAxis);
+
+typedef struct {
+    VecSweepAxis axes; /* the first axis varies slowest */
+    int seeds;         /* runs per point, seeded seed, seed+1, ... */
+    unsigned int seed;
+    int days;
+    int threads;       /* <= 0: one per CPU */
+    ResultCache *cache; /* NULL: every run is played */
+} Sweep;
+
+/* End-of-run state averaged over a point's seeds. */
+typedef struct {
+    double structure, structure_min;
+    double food;
+    double water_safe;
+    double hunger, morale; /* mean over both survivors */
+    double lost;           /* share of runs that ended with structure 0 */
+} SweepRow;
+
+void sweep_init(Sweep *s);
+void sweep_free(Sweep *s);
+/* Parses and appends one axis; returns 0 or -1 with err. */
+int sweep_add_axis(Sweep *s, const char *spec, char *err, size_t errn);
+/* Number of grid points (product of the axis sizes). */
+int sweep_points(const Sweep *s);
+double sweep_value(const Sweep *s, int point, int axis);
+/* Sets one sweep key on `w`; returns 0 or -1 with err for an unknown key or item. */
+int sweep_apply(World *w, const char *key, double v, char *err, size_t errn);
+/*
+  Runs every point and seed from copies of the parsed base world and cast, on
+  the worker pool, and fills rows[sweep_points(s)]. Runs draw from their own
+  streams, so the rows do not depend on the thread count. Returns 0 or -1 with
+  err when an axis does not apply to the base world.
+*/
+int sweep_run(const Sweep *s, World *base, Catalog *cat, Character *cast, SweepRow *rows, char *err, size_t errn);
+/* CSV: one column per axis, then the SweepRow fields; one row per point. */
+void sweep_write_csv(FILE *out, const Sweep *s, const SweepRow *rows);
+
+/* -------------------------------------------------------------------------- */
+/* Plan tuning                                                                  */
+/* -------------------------------------------------------------------------- */
+
+/*
+  One tuned literal: the priority of the `task` statement on `line` of cast
+  member `script`'s plan, searched within [lo, hi]. Parameters come from
+  `# tune lo..hi` comments on the task line or from a side file.
+*/
+typedef struct {
+    int script; /* 0 or 1, argument order */
+    int line;
+    double lo, hi;
+    double start; /* value written in the plan, filled by tune_run */
+} TuneParam;
+
+VEC_DECL(VecTuneParam, TuneParam);
+
+typedef struct {
+    VecTuneParam params;
+    int population;  /* candidates per generation */
+    int generations;
+    int seeds;       /* runs per candidate, seeded seed, seed+1, ... for every candidate */
+    unsigned int seed;
+    int days;
+    int threads;     /* <= 0: one per CPU */
+    FILE *log;       /* one line per generation; NULL for none */
+} Tune;
+
+void tune_init(Tune *t);
+void tune_free(Tune *t);
+/* Adds a parameter for every `# tune lo..hi` (or `// tune`) comment in plan source `src`. */
+int tune_scan_annotations(Tune *t, int script, const char *path, const char *src, char *err, size_t errn);
+/*
+  Reads a side file of `<plan file>:<line> lo..hi` lines (# comments allowed);
+  the plan file is matched against the base names of script_paths[0..1].
+*/
+int tune_load_file(Tune *t, const char *path, const char *const *script_paths, char *err, size_t errn);
+/*
+  Searches the parameters with a real-coded genetic algorithm. `casts` holds
+  2*population separately parsed characters (pairs in argument order), one
+  pair per candidate, so a generation evaluates every candidate and seed on
+  the worker pool at once. Candidates are scored by survival_score averaged
+  over the seeds; the result depends only on the seed, never on the thread
+  count. Fills best[params.n] and *best_score; returns 0 or -1 with err when
+  a parameter line has no task priority literal.
+*/
+int tune_run(Tune *t, World *base, Catalog *cat, Character *casts, double *best, double *best_score, char *err, size_t errn);
+/* End-of-run objective: structure and survivor condition, 0..100, less 100 when the shelter fell. */
+double survival_score(const World *w, const Character *a, const Character *b);
+/* Writes plan source `src` of cast member `script` with the tuned priorities substituted. */
+void tune_write_plan(FILE *out, const Tune *t, int script, const char *src, const double *x);
+
+/* -------------------------------------------------------------------------- */
+/* Streaming statistics                                                         */
+/* -------------------------------------------------------------------------- */
+
+#define STAT_CENTROIDS 100
+#define STAT_BUFFER 50
+
+/* `weight` samples with mean `mean`, all within [lo, hi]; lo == hi marks a point mass. */
+typedef struct {
+    double mean, weight;
+    double lo, hi;
+} StatCentroid;
+
+/*
+  O(1)-memory summary of a stream: Welford mean/M2, min/max and a merging
+  t-digest for quantiles. Fixed size, so it can be copied and merged freely.
+*/
+typedef struct {
+    long long n;
+    double mean, m2;
+    double min, max;
+    StatCentroid c[STAT_CENTROIDS]; /* sorted by mean after a compression */
+    int nc;
+    StatCentroid buf[STAT_BUFFER];  /* unsorted additions since the last compression */
+    int nb;
+} StreamStat;
+
+void stat_init(StreamStat *s);
+void stat_add(StreamStat *s, double x);
+/* Adds `k` copies of x at the cost of one. */
+void stat_add_n(StreamStat *s, double x, long long k);
+/* Folds src into dst; the moments and extremes are exact, quantiles stay within the digest's error. */
+void stat_merge(StreamStat *dst, const StreamStat *src);
+/* Sample variance (n-1); 0 below two samples. */
+double stat_var(const StreamStat *s);
+/* Estimated q-quantile, q in [0, 1]; compresses pending additions first. */
+double stat_quantile(StreamStat *s, double q);
+
+typedef struct {
+    char *name;
+    StreamStat s;
+} StatRow;
+
+VEC_DECL(VecStatRow, StatRow);
+
+/* Named metrics over a batch of runs; every row holds one sample per run. */
+typedef struct {
+    long long runs;
+    VecStatRow rows;
+} BatchStats;
+
+void bstats_init(BatchStats *b);
+void bstats_free(BatchStats *b);
+/* Index of the row `name`, added if new and padded with a 0 for each run so far. */
+int bstats_row(BatchStats *b, const char *name);
+/* Adds src's runs to dst, padding rows either side lacks with zeros. */
+void bstats_merge(BatchStats *dst, const BatchStats *src);
+/* One line per row: mean, sd, min, p05, p50, p95, max. */
+void bstats_print(FILE *out, BatchStats *b);
+/*
+  Final tidy-up of a merged batch (lb_sweep.c): drops stock rows no run ever
+  held and sorts the rows after the first `fixed` (task completions) by name.
+*/
+void bstats_finish(BatchStats *b, int fixed);
+
+/*
+  Runs seeds seed .. seed+runs-1 from copies of the parsed base world and cast
+  (lb_sweep.c) and streams the end state of each run into `out`: survivor
+  vitals and idle ticks, shelter structure, safe water and power, whether
+  the shelter stood (structure > 0), the stock of every item the base inventory knows, completions per task and, with
+  base->until set, whether and when the run stopped; with --steady, the
+  days extrapolated. Runs are
+  split into a fixed number of chunks whose stats merge in chunk order, so
+  the table does not depend on the thread count. Runs found in `cache` (may
+  be NULL) are read instead of played. Returns 0 or -1 with err.
+*/
+int batch_run(World *base, Catalog *cat, Character *cast, unsigned int seed, long long runs, int days, int threads,
+              ResultCache *cache, BatchStats *out, char *err, size_t errn);
+
+/* Width of the 95% interval on a metric's mean that a batch should reach. */
+typedef struct {
+    char *metric;    /* "survival", "structure", "morale" or a batch row name */
+    double width;    /* target: full width, hi - lo */
+    double achieved; /* after the last round */
+    int met;
+} CiTarget;
+
+VEC_DECL(VecCiTarget, CiTarget);
+
+void ci_targets_init(VecCiTarget *t);
+void ci_targets_free(VecCiTarget *t);
+/* Parses "metric=width"; returns 0 or -1 with err. */
+int ci_target_add(VecCiTarget *t, const char *spec, char *err, size_t errn);
+/*
+  Full width of the 95% interval on the mean: Wilson's score interval for a
+  row of 0s and 1s, the Student t interval otherwise; huge below two samples.
+*/
+double stat_ci_width(const StreamStat *s);
+/*
+  batch_run that picks its own size (lb_sweep.c): seeds go out in rounds,
+  each sized from the current widths, until every target is met or
+  max_runs have been played. The stopping rule only sees whole rounds, so
+  the table does not depend on the thread count. Each target's achieved
+  width is left in `targets`.
+*/
+int batch_run_ci(World *base, Catalog *cat, Character *cast, unsigned int seed, long long max_runs, int days, int threads,
+                 ResultCache *cache, VecCiTarget *targets, BatchStats *out, char *err, size_t errn);
+/* One line per target: achieved width, target and run count. */
+void ci_targets_print(FILE *out, const VecCiTarget *targets, long long runs);
+
+/* -------------------------------------------------------------------------- */
+/* Paired A/B comparison                                                        */
+/* -------------------------------------------------------------------------- */
+
+#define AB_METRICS 9
+
+/*
+  End-of-run metrics of two plan variants over the same seeds: each variant's
+  distribution and the paired differences B - A.
+*/
+typedef struct {
+    long long runs;
+    StreamStat a[AB_METRICS], b[AB_METRICS], diff[AB_METRICS];
+} AbStats;
+
+/* "score", "structure", "fell", then survivor means and total idle ticks. */
+const char *ab_metric_name(int m);
+/*
+  Plays seeds seed .. seed+runs-1 once with cast_a and once with cast_b
+  (lb_sweep.c), both in common-random-numbers mode, so the two runs of a
+  seed see the same breaches, nights and harvest luck and their difference
+  is down to the plans. Chunked like batch_run, so the result does not
+  depend on the thread count. Returns 0 or -1 with err.
+*/
+int ab_run(World *base, Catalog *cat, Character *cast_a, Character *cast_b, unsigned int seed, long long runs, int days, int threads,
+           AbStats *out, char *err, size_t errn);
+/* Two-sided 95% Student t quantile for `df` degrees of freedom. */
+double stat_t975(long long df);
+/* Means, B - A with its 95% interval, the variance gain from pairing, and a verdict per metric. */
+void ab_print(FILE *out, const AbStats *s);
+
+/* -------------------------------------------------------------------------- */
+/* Rare-event splitting                                                         */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+    VecDbl levels;   /* decreasing structure thresholds; collapse (<= 0) is the last level */
+    int effort;      /* runs per stage */
+    int reps;        /* independent replications, for the variance */
+    unsigned int seed;
+    int days;        /* horizon */
+    int threads;     /* <= 0: one per CPU */
+} Split;
+
+typedef struct {
+    double p;        /* mean estimate over the replications */
+    double var;      /* variance of p: sample variance of the replications / reps */
+    int stages;      /* levels.n + 1 */
+    double *stage_p; /* mean hit fraction per stage */
+    int *stage_runs; /* replications that reached each stage */
+    long long days_simulated;
+} SplitResult;
+
+void split_init(Split *s);
+void split_free(Split *s);
+/* Parses "50,30,15" into s->levels; returns 0 or -1 with err. */
+int split_parse_levels(Split *s, const char *spec, char *err, size_t errn);
+/*
+  Estimates the probability that structure reaches 0 at the end of some day
+  within s->days (lb_split.c): fixed-effort multilevel splitting, cloning
+  runs between days with sim_clone. Returns 0 or -1 with err; free the
+  result with split_result_free.
+*/
+int split_run(const Split *s, World *base, Catalog *cat, Character *cast, SplitResult *res, char *err, size_t errn);
+void split_result_free(SplitResult *res);
+/* Stage table, the estimate with its 95% interval, and the cost next to plain Monte Carlo. */
+void split_print(FILE *out, const Split *s, const SplitResult *res);
+
+/* -------------------------------------------------------------------------- */
+/* Sharding across processes                                                    */
+/* -------------------------------------------------------------------------- */
+
+typedef enum {
+    PARTIAL_BATCH,
+    PARTIAL_SWEEP
+} PartialKind;
+
+/*
+  One shard's share of a batch or sweep, as written by --shard and read by
+  lastbreach-merge. A batch shard keeps its chunks' accumulators unmerged
+  and a sweep shard its points' rows, so the merge can repeat exactly what
+  one process would have done.
+*/
+typedef struct {
+    PartialKind kind;
+    unsigned long long inputs; /* dlog_fingerprint of the input files */
+    char *options;             /* flags that change results (--until, --steady); shards must agree */
+    unsigned int seed;
+    int days;
+    int shard, shards;         /* shard `shard` of `shards`, from 1 */
+    int total;                 /* chunks (batch) or points (sweep) over all shards */
+    int first, n;              /* this shard's: first .. first+n-1 */
+    /* batch */
+    long long runs;
+    int fixed;                 /* rows registered before any run, see bstats_finish */
+    BatchStats *chunks;        /* n, unmerged */
+    /* sweep */
+    Sweep sweep;               /* axes, seeds and seed of the whole sweep */
+    SweepRow *rows;            /* n */
+} Partial;
+
+/* Parses "i/n" with 1 <= i <= n; returns 0 or -1 with err. */
+int shard_parse(const char *spec, int *shard, int *shards, char *err, size_t errn);
+/* Shard `shard`'s contiguous slice [first, end) of `total` units. */
+void shard_range(long long total, int shard, int shards, long long *first, long long *end);
+void partial_init(Partial *p);
+void partial_free(Partial *p);
+/* Self-describing text file; doubles are written in hex so they read back bit for bit. */
+int partial_save(const Partial *p, const char *path, char *err, size_t errn);
+int partial_load(Partial *p, const char *path, char *err, size_t errn);
+/*
+  Checks that parts[0..n-1] are every shard of one run, then writes what
+  that run would have printed in one process: the batch table or the sweep
+  CSV. Returns 0 or -1 with err.
+*/
+int partial_merge(Partial *parts, int n, FILE *out, char *err, size_t errn);
+/*
+  Batch and sweep slices (lb_sweep.c). The caller fills the identity fields
+  of `out` (inputs, options, seed, days, shard, shards) and saves it.
+*/
+int batch_run_shard(World *base, Catalog *cat, Character *cast, unsigned int seed, long long runs, int days, int threads,
+                    ResultCache *cache, int shard, int shards, Partial *out, char *err, size_t errn);
+int sweep_run_shard(const Sweep *s, World *base, Catalog *cat, Character *cast, int shard, int shards, Partial *out,
+                    char *err, size_t errn);
+
+/* -------------------------------------------------------------------------- */
+/* Steady-state detection                                                       */
+/* -------------------------------------------------------------------------- */
+
+/* Laps that must agree before a cycle is trusted. */
+#define STEADY_REPEATS 3
+
+/*
+  Ring of recent end-of-day snapshots: a hash of the state that must repeat
+  exactly and n_level values that may drift by a constant amount per lap.
+*/
+typedef struct {
+    int max_period;
+    int cap, len, head;
+    unsigned long long *hash;
+    int n_level;
+    double *level; /* cap rows of n_level */
+} SteadyTrack;
+
+void steady_init(SteadyTrack *t, int max_period);
+void steady_free(SteadyTrack *t);
+/* Forgets the snapshots, e.g. after an extrapolation moved the levels. */
+void steady_reset(SteadyTrack *t);
+/*
+  Adds the newest day. Returns the shortest period p <= max_period for which
+  the last STEADY_REPEATS laps of p days have equal hashes and equal level
+  changes, writing that change per lap to drift[n_level]; 0 when none does.
+  A change of n_level restarts the ring.
+*/
+int steady_observe(SteadyTrack *t, unsigned long long hash, const double *level, int n_level, double *drift);
+
 #endif /* LASTBREACH_H */
@@ -0,0 +1,241 @@
+#include "lastbreach.h"
+/**
+ * lb_assign.c
+ *
+ * Module: Joint station assignment (forward auction).
+ *
+ * Agents bid for exclusive stations in index order. An agent bids its best net
+ * value (option value minus station price) over the runner-up, plus a small
+ * epsilon, and outbids the current holder, who re-enters the queue. Options
+ * without a station and the idle fallback are private to the agent and never
+ * contested. Ties go to the agent added first.
+ *
+ * Solves are incremental. Prices and owners carry over from the last solve,
+ * and an agent (matched by its key) whose options have not changed keeps its
+ * choice as long as that choice is still within epsilon of its best net
+ * value; only the other agents bid. Stations nobody holds drop back to price
+ * zero, so every price left standing belongs to a held station, and the
+ * result stays within agents*AUCTION_EPS of the best total value.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+
+#define AUCTION_EPS 1e-3
+
+void assign_init(StationAssign *a) {
+    VEC_INIT(a->stations);
+    VEC_INIT(a->opts);
+    VEC_INIT(a->first);
+    VEC_INIT(a->key);
+    VEC_INIT(a->price);
+    VEC_INIT(a->owner);
+    VEC_INIT(a->choice);
+    VEC_INIT(a->queue);
+    VEC_INIT(a->prev_opts);
+    VEC_INIT(a->prev_first);
+    VEC_INIT(a->prev_key);
+    VEC_INIT(a->prev_choice);
+    VEC_INIT(a->prev_of);
+}
+
+void assign_free(StationAssign *a) {
+    for (int i = 0; i<a->stations.n; i++) free(a->stations.v[i]);
+    VEC_FREE(a->stations);
+    VEC_FREE(a->opts);
+    VEC_FREE(a->first);
+    VEC_FREE(a->key);
+    VEC_FREE(a->price);
+    VEC_FREE(a->owner);
+    VEC_FREE(a->choice);
+    VEC_FREE(a->queue);
+    VEC_FREE(a->prev_opts);
+    VEC_FREE(a->prev_first);
+    VEC_FREE(a->prev_key);
+    VEC_FREE(a->prev_choice);
+    VEC_FREE(a->prev_of);
+}
+
+void assign_copy(StationAssign *dst, const StationAssign *src) {
+    /* Everything the next solve reads: stations, prices and the previous solve. */
+    assign_init(dst);
+    for (int i = 0; i<src->stations.n; i++) VEC_PUSH(dst->stations, xstrdup(src->stations.v[i]));
+    VEC_COPY(dst->price, src->price);
+    VEC_COPY(dst->owner, src->owner);
+    VEC_COPY(dst->prev_opts, src->prev_opts);
+    VEC_COPY(dst->prev_first, src->prev_first);
+    VEC_COPY(dst->prev_key, src->prev_key);
+    VEC_COPY(dst->prev_choice, src->prev_choice);
+    VEC_COPY(dst->prev_of, src->prev_of);
+}
+
+void assign_begin(StationAssign *a) {
+    a->opts.n = 0;
+    a->first.n = 0;
+    a->key.n = 0;
+    VEC_PUSH(a->first, 0);
+}
+
+int assign_agent(StationAssign *a, int key) {
+    /* first[] always ends with the open agent's end offset. */
+    VEC_PUSH(a->first, a->opts.n);
+    VEC_PUSH(a->key, key);
+    return a->first.n-2;
+}
+
+static int station_id(StationAssign *a, const char *name) {
+    /* A shelter has tens of stations at most; a scan is cheaper than hashing. */
+    for (int i = 0; i<a->stations.n; i++) {
+        if (strcmp(a->stations.v[i], name)==0) return i;
+    }
+    VEC_PUSH(a->stations, xstrdup(name));
+    return a->stations.n-1;
+}
+
+void assign_option(StationAssign *a, const char *station, double value) {
+    AssignOption o;
+    o.station = station ? station_id(a, station) : -1;
+    o.value = value;
+    VEC_PUSH(a->opts, o);
+    a->first.v[a->first.n-1] = a->opts.n;
+}
+
+/* Net value of agent i's option j at current prices; j < 0 is idling. */
+static double net_value(const StationAssign *a, int j, double idle) {
+    if (j < 0) return idle;
+    const AssignOption *o = &a->opts.v[j];
+    return o->value - (o->station >= 0 ? a->price.v[o->station] : 0.0);
+}
+
+static double best_net(const StationAssign *a, int i, double idle) {
+    double best = idle;
+    for (int j = a->first.v[i]; j<a->first.v[i+1]; j++) {
+        double net = net_value(a, j, idle);
+        if (net > best) best = net;
+    }
+    return best;
+}
+
+/* Last solve's choice for agent i (relative to its options) if its key and options are unchanged, else -2. */
+static int previous_choice(const StationAssign *a, int i) {
+    int key = a->key.v[i];
+    int p = key >= 0 && key < a->prev_of.n ? a->prev_of.v[key] : -1;
+    if (p < 0) return -2;
+    int n = a->first.v[i+1] - a->first.v[i];
+    if (a->prev_first.v[p+1] - a->prev_first.v[p]!=n) return -2;
+    for (int k = 0; k<n; k++) {
+        const AssignOption *o = &a->opts.v[a->first.v[i]+k], *q = &a->prev_opts.v[a->prev_first.v[p]+k];
+        if (o->station!=q->station || o->value!=q->value) return -2;
+    }
+    return a->prev_choice.v[p];
+}
+
+/*
+  Keeps the choices of unchanged agents that still satisfy epsilon
+  complementary slackness; every other agent is left unassigned (-2).
+  Freeing a station drops its price, which can break another agent's
+  slackness, so the check repeats until nothing changes.
+*/
+static void warm_start(StationAssign *a, int agents, double idle) {
+    for (int s = 0; s<a->stations.n; s++) a->owner.v[s] = -1;
+    for (int i = 0; i<agents; i++) {
+        int rel = previous_choice(a, i);
+        int j = rel >= 0 ? a->first.v[i] + rel : rel;
+        int st = j >= 0 ? a->opts.v[j].station : -1;
+        if (st >= 0 && a->owner.v[st] >= 0) j = -2; /* duplicate key */
+        if (st >= 0 && j >= 0) a->owner.v[st] = i;
+        a->choice.v[i] = j;
+    }
+    for (int changed = 1; changed;) {
+        changed = 0;
+        for (int s = 0; s<a->stations.n; s++) {
+            if (a->owner.v[s] < 0) a->price.v[s] = 0.0;
+        }
+        for (int i = 0; i<agents; i++) {
+            int j = a->choice.v[i];
+            if (j==-2 || net_value(a, j, idle) >= best_net(a, i, idle) - AUCTION_EPS - 1e-9) continue;
+            if (j >= 0 && a->opts.v[j].station >= 0) a->owner.v[a->opts.v[j].station] = -1;
+            a->choice.v[i] = -2;
+            changed = 1;
+        }
+    }
+}
+
+static void remember(StationAssign *a, int agents) {
+    a->prev_opts.n = 0;
+    for (int j = 0; j<a->opts.n; j++) VEC_PUSH(a->prev_opts, a->opts.v[j]);
+    a->prev_first.n = 0;
+    for (int i = 0; i<=agents; i++) VEC_PUSH(a->prev_first, a->first.v[i]);
+    /* Only the slots of the last solve's keys are set, so clearing them is enough. */
+    for (int p = 0; p<a->prev_key.n; p++) {
+        if (a->prev_key.v[p] >= 0) a->prev_of.v[a->prev_key.v[p]] = -1;
+    }
+    a->prev_key.n = 0;
+    a->prev_choice.n = 0;
+    for (int i = 0; i<agents; i++) {
+        int key = a->key.v[i];
+        VEC_PUSH(a->prev_key, key);
+        VEC_PUSH(a->prev_choice, a->choice.v[i] < 0 ? -1 : a->choice.v[i] - a->first.v[i]);
+        if (key < 0) continue;
+        while (a->prev_of.n <= key) VEC_PUSH(a->prev_of, -1);
+        /* With duplicate keys the first agent is the one remembered. */
+        if (a->prev_of.v[key] < 0) a->prev_of.v[key] = i;
+    }
+}
+
+void assign_solve(StationAssign *a) {
+    int agents = a->first.n-1;
+    while (a->price.n < a->stations.n) VEC_PUSH(a->price, 0.0);
+    while (a->owner.n < a->stations.n) VEC_PUSH(a->owner, -1);
+    while (a->choice.n < agents) VEC_PUSH(a->choice, -1);
+    if (agents <= 0) return;
+
+    /* Idling is worth less than any option, so an agent only idles when outbid everywhere. */
+    double idle = 0.0;
+    for (int j = 0; j<a->opts.n; j++) {
+        if (a->opts.v[j].value < idle) idle = a->opts.v[j].value;
+    }
+    idle -= 1.0;
+
+    warm_start(a, agents, idle);
+    a->queue.n = 0;
+    for (int i = 0; i<agents; i++) {
+        if (a->choice.v[i]!=-2) continue;
+        a->choice.v[i] = -1;
+        VEC_PUSH(a->queue, i);
+    }
+    for (int head = 0; head<a->queue.n; head++) {
+        int i = a->queue.v[head];
+        int bj = -1;
+        double best = idle, second = idle;
+        for (int j = a->first.v[i]; j<a->first.v[i+1]; j++) {
+            double net = net_value(a, j, idle);
+            if (net > best) {
+                second = best;
+                best = net;
+                bj = j;
+            } else if (net > second) {
+                second = net;
+            }
+        }
+        a->choice.v[i] = bj;
+        if (bj < 0 || a->opts.v[bj].station < 0) continue;
+
+        int st = a->opts.v[bj].station;
+        a->price.v[st] += best - second + AUCTION_EPS;
+        int prev = a->owner.v[st];
+        a->owner.v[st] = i;
+        if (prev >= 0) {
+            a->choice.v[prev] = -1;
+            VEC_PUSH(a->queue, prev);
+        }
+    }
+    remember(a, agents);
+}
+
+int assign_choice(const StationAssign *a, int agent) {
+    int j = a->choice.v[agent];
+    return j < 0 ? -1 : j - a->first.v[agent];
+}
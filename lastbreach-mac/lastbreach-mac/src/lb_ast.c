@@ -33,4 +33,122 @@ void character_init(Character *c) {
     c->rt_station = NULL;
     c->rt_remaining = 0;
     c->rt_priority = 0;
+    c->rt_inputs = NULL;
+    c->rt_n_inputs = 0;
+    c->ev_first = NULL;
+    c->ev_rules = NULL;
+    c->ev_n = 0;
+    c->ev_table = NULL;
+}
+
+void character_copy(Character *dst, const Character *src) {
+    *dst = *src;
+    dst->defense_posture = xstrdup(src->defense_posture);
+    /* Handler groups are rebuilt against the copy's world on first use. */
+    dst->ev_first = NULL;
+    dst->ev_rules = NULL;
+    dst->ev_n = 0;
+    dst->ev_table = NULL;
+}
+
+void character_copy_free(Character *c) {
+    free(c->defense_posture);
+    free(c->ev_first);
+    free(c->ev_rules);
+    c->defense_posture = NULL;
+    c->ev_first = NULL;
+    c->ev_rules = NULL;
+}
+
+static void expr_free(Expr *e) {
+    if (!e) return;
+    switch (e->kind) {
+    case EX_STRING:
+        free(e->u.str);
+        break;
+    case EX_VAR:
+        free(e->u.var);
+        break;
+    case EX_CALL:
+        free(e->u.call.name);
+        for (int i = 0; i<e->u.call.args.n; i++) expr_free(e->u.call.args.v[i]);
+        VEC_FREE(e->u.call.args);
+        break;
+    case EX_UNARY:
+        expr_free(e->u.un.a);
+        break;
+    case EX_BINARY:
+        expr_free(e->u.bin.a);
+        expr_free(e->u.bin.b);
+        break;
+    default:
+        break;
+    }
+    free(e);
+}
+
+static void stmts_free(VecStmtPtr *v);
+
+static void stmt_free(Stmt *st) {
+    if (!st) return;
+    switch (st->kind) {
+    case ST_LET:
+        free(st->u.let_.name);
+        expr_free(st->u.let_.value);
+        break;
+    case ST_IF:
+        expr_free(st->u.if_.cond);
+        stmts_free(&st->u.if_.then_stmts);
+        stmts_free(&st->u.if_.else_stmts);
+        break;
+    case ST_TASK:
+        free(st->u.task.task_name);
+        expr_free(st->u.task.for_ticks);
+        expr_free(st->u.task.priority);
+        break;
+    case ST_SET:
+        free(st->u.set_.lhs);
+        expr_free(st->u.set_.rhs);
+        break;
+    default:
+        break;
+    }
+    free(st);
+}
+
+static void stmts_free(VecStmtPtr *v) {
+    for (int i = 0; i<v->n; i++) stmt_free(v->v[i]);
+    VEC_FREE(*v);
+}
+
+void character_free(Character *c) {
+    free(c->name);
+    for (int i = 0; i<c->skill_keys.n; i++) free(c->skill_keys.v[i]);
+    for (int i = 0; i<c->traits.n; i++) free(c->traits.v[i]);
+    VEC_FREE(c->skill_keys);
+    VEC_FREE(c->skill_vals);
+    VEC_FREE(c->traits);
+    for (int i = 0; i<c->thresholds.n; i++) {
+        expr_free(c->thresholds.v[i].cond);
+        stmt_free(c->thresholds.v[i].action);
+    }
+    VEC_FREE(c->thresholds);
+    for (int i = 0; i<c->blocks.n; i++) {
+        free(c->blocks.v[i].name);
+        stmts_free(&c->blocks.v[i].stmts);
+    }
+    VEC_FREE(c->blocks);
+    for (int i = 0; i<c->rules.n; i++) {
+        free(c->rules.v[i].label);
+        stmts_free(&c->rules.v[i].stmts);
+    }
+    VEC_FREE(c->rules);
+    for (int i = 0; i<c->on_events.n; i++) {
+        free(c->on_events.v[i].event_name);
+        expr_free(c->on_events.v[i].when_cond);
+        stmts_free(&c->on_events.v[i].stmts);
+    }
+    VEC_FREE(c->on_events);
+    character_copy_free(c);
+    c->name = NULL;
 }
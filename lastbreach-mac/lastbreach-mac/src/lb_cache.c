@@ -0,0 +1,326 @@
+#include "lastbreach.h"
+
+#include <pthread.h>
+/**
+ * lb_cache.c
+ *
+ * Module: On-disk cache of single-run results for batches and sweeps.
+ *
+ * A run is a pure function of the parsed inputs, the engine, the flags that
+ * change results, the seed, the day count and, in a sweep, the point's
+ * overrides. The cache keys each run by a hash of exactly those. The inputs
+ * are hashed as the lexer sees them, so comments, layout and the spelling
+ * of numbers ("5" or "5.0") do not count.
+ *
+ * Entries live in one text file, one line each. New results are appended
+ * and flushed as runs finish, so a batch or sweep that is interrupted keeps
+ * everything it finished. When the cache is closed, the file is rewritten
+ * once: duplicates are dropped, entries used this session are marked, and
+ * the least recently used entries are evicted until the file fits the
+ * size limit. If appends push the file past the limit during a run, it is
+ * rewritten then as well, down to half the limit so that a long run does
+ * not rewrite it for every new entry.
+ *
+ * Workers call cache_get and cache_put concurrently; one mutex covers the
+ * table and the file.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+#define FNV64_OFFSET 1469598103934665603ULL
+#define FNV64_PRIME 1099511628211ULL
+
+typedef struct {
+    unsigned long long key;
+    long long stamp;   /* session that last used the entry */
+    char *payload;
+} CacheEntry;
+
+VEC_DECL(VecCacheEntry, CacheEntry);
+
+struct ResultCache {
+    pthread_mutex_t mu;
+    char *path;
+    long long max_bytes;
+    unsigned long long base;  /* inputs, engine, flags and days */
+    long long session;
+    VecCacheEntry entries;
+    int *slots;               /* open addressing: entry index + 1, 0 = empty */
+    int n_slots;
+    FILE *append;
+    long long file_bytes;     /* size of the file, appends included */
+    long long hits, stored, evicted;
+    int dirty;
+    int compact_failed;       /* stop retrying mid-run compaction after an error */
+};
+
+static unsigned long long fnv64(unsigned long long h, const void *p, size_t n) {
+    const unsigned char *b = (const unsigned char*)p;
+    for (size_t i = 0; i<n; i++) {
+        h ^= b[i];
+        h *= FNV64_PRIME;
+    }
+    return h;
+}
+
+static unsigned long long fnv64_dbl(unsigned long long h, double v) {
+    if (v==0.0) v = 0.0; /* -0.0 reads the same as 0.0 */
+    return fnv64(h, &v, sizeof(v));
+}
+
+/* One file as its token stream: kinds, names and literal values. */
+static unsigned long long hash_tokens(unsigned long long h, char *text) {
+    Lexer lx;
+    lx.src = text;
+    lx.len = strlen(text);
+    lx.pos = 0;
+    lx.line = 1;
+    for (lx_next_token(&lx); lx.cur.kind!=TK_EOF; lx_next_token(&lx)) {
+        int kind = (int)lx.cur.kind;
+        h = fnv64(h, &kind, sizeof(kind));
+        if (lx.cur.kind==TK_NUMBER || lx.cur.kind==TK_PERCENT) h = fnv64_dbl(h, lx.cur.num);
+        else if (lx.cur.kind==TK_DURATION) h = fnv64(h, &lx.cur.iticks, sizeof(lx.cur.iticks));
+        else h = fnv64(h, lx.cur.start, (size_t)lx.cur.len);
+    }
+    return h;
+}
+
+unsigned long long cache_inputs_key(const char *const *paths, int n, const char *options, int days) {
+    unsigned long long h = FNV64_OFFSET;
+#ifdef LB_ENGINE_HASH
+    unsigned long long engine = LB_ENGINE_HASH;
+    h = fnv64(h, &engine, sizeof(engine));
+#else
+    h = fnv64(h, __DATE__ " " __TIME__, sizeof(__DATE__ " " __TIME__));
+#endif
+    for (int i = 0; i<n; i++) {
+        char *text = paths[i] ? read_entire_file(paths[i]) : NULL;
+        /* An absent file means the built-in defaults, which the engine version covers. */
+        if (text) h = hash_tokens(h, text);
+        h = fnv64(h, "\n\x1e", 2);
+        free(text);
+    }
+    h = fnv64(h, options, strlen(options));
+    return fnv64(h, &days, sizeof(days));
+}
+
+/* ---- table --------------------------------------------------------------- */
+
+static int slot_of(const ResultCache *c, unsigned long long key) {
+    int i = (int)(key % (unsigned long long)c->n_slots);
+    while (c->slots[i] && c->entries.v[c->slots[i]-1].key!=key) i = (i+1) % c->n_slots;
+    return i;
+}
+
+static void rehash(ResultCache *c, int n_slots) {
+    free(c->slots);
+    c->n_slots = n_slots;
+    c->slots = (int*)xmalloc(sizeof(int)*(size_t)n_slots);
+    for (int i = 0; i<n_slots; i++) c->slots[i] = 0;
+    for (int e = 0; e<c->entries.n; e++) c->slots[slot_of(c, c->entries.v[e].key)] = e+1;
+}
+
+/* Adds or replaces; a later line for a key wins, as in the file. */
+static CacheEntry *table_put(ResultCache *c, unsigned long long key, long long stamp, char *payload) {
+    if (2*(c->entries.n+1) > c->n_slots) rehash(c, c->n_slots*2);
+    int s = slot_of(c, key);
+    if (c->slots[s]) {
+        CacheEntry *e = &c->entries.v[c->slots[s]-1];
+        free(e->payload);
+        e->payload = payload;
+        e->stamp = stamp;
+        return e;
+    }
+    CacheEntry e;
+    e.key = key;
+    e.stamp = stamp;
+    e.payload = payload;
+    VEC_PUSH(c->entries, e);
+    c->slots[s] = c->entries.n;
+    return &c->entries.v[c->entries.n-1];
+}
+
+static CacheEntry *table_get(ResultCache *c, unsigned long long key) {
+    int s = slot_of(c, key);
+    return c->slots[s] ? &c->entries.v[c->slots[s]-1] : NULL;
+}
+
+/* ---- file ---------------------------------------------------------------- */
+
+static void load_lines(ResultCache *c, char *text) {
+    char *line = text;
+    while (*line) {
+        char *nl = strchr(line, '\n');
+        /* A line without its newline was cut off mid-write; it is not an entry. */
+        if (!nl) break;
+        *nl = 0;
+        unsigned long long key;
+        long long stamp;
+        int off = 0;
+        if (sscanf(line, "%16llx %lld %n", &key, &stamp, &off)==2 && off > 0 && line[off]) {
+            table_put(c, key, stamp, xstrdup(line+off));
+            if (stamp >= c->session) c->session = stamp+1;
+        }
+        line = nl+1;
+    }
+}
+
+ResultCache *cache_open(const char *path, long long max_bytes, unsigned long long base, char *err, size_t errn) {
+    ResultCache *c = (ResultCache*)xmalloc(sizeof(ResultCache));
+    memset(c, 0, sizeof(*c));
+    pthread_mutex_init(&c->mu, NULL);
+    c->path = xstrdup(path);
+    c->max_bytes = max_bytes;
+    c->base = base;
+    c->session = 1;
+    VEC_INIT(c->entries);
+    rehash(c, 1024);
+    char *text = read_entire_file(path);
+    if (text) {
+        c->file_bytes = (long long)strlen(text);
+        load_lines(c, text);
+        free(text);
+    }
+    c->append = fopen(path, "a");
+    if (!c->append) {
+        snprintf(err, errn, "cannot write result cache %s", path);
+        cache_close(c, NULL);
+        return NULL;
+    }
+    return c;
+}
+
+static unsigned long long run_key(const ResultCache *c, const char *what) {
+    return fnv64(c->base, what, strlen(what));
+}
+
+char *cache_get(ResultCache *c, const char *what) {
+    unsigned long long key = run_key(c, what);
+    char *out = NULL;
+    pthread_mutex_lock(&c->mu);
+    CacheEntry *e = table_get(c, key);
+    if (e) {
+        out = xstrdup(e->payload);
+        if (e->stamp!=c->session) c->dirty = 1;
+        e->stamp = c->session;
+        c->hits++;
+    }
+    pthread_mutex_unlock(&c->mu);
+    return out;
+}
+
+static int newest_first(const void *pa, const void *pb) {
+    const CacheEntry *a = *(const CacheEntry *const *)pa, *b = *(const CacheEntry *const *)pb;
+    if (a->stamp!=b->stamp) return a->stamp > b->stamp ? -1 : 1;
+    if (a->key!=b->key) return a->key < b->key ? -1 : 1;
+    return 0;
+}
+
+/* Drops the evicted entries order[kept..n) from the table. */
+static void drop_evicted(ResultCache *c, CacheEntry **order, int kept, int n) {
+    for (int i = kept; i<n; i++) {
+        free(order[i]->payload);
+        order[i]->payload = NULL;
+    }
+    int m = 0;
+    for (int i = 0; i<c->entries.n; i++) {
+        if (c->entries.v[i].payload) c->entries.v[m++] = c->entries.v[i];
+    }
+    c->entries.n = m;
+    rehash(c, c->n_slots);
+}
+
+/*
+  Rewrites the file with the most recently used entries that fit in `limit`
+  bytes and forgets the rest; returns how many were dropped, or -1.
+*/
+static int compact(ResultCache *c, long long limit, char *err, size_t errn) {
+    int n = c->entries.n, kept = 0;
+    CacheEntry **order = (CacheEntry**)xmalloc(sizeof(CacheEntry*)*(size_t)(n > 0 ? n : 1));
+    for (int i = 0; i<n; i++) order[i] = &c->entries.v[i];
+    qsort(order, (size_t)n, sizeof(order[0]), newest_first);
+
+    size_t tmp_len = strlen(c->path) + 5;
+    char *tmp = (char*)xmalloc(tmp_len);
+    snprintf(tmp, tmp_len, "%s.tmp", c->path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        snprintf(err, errn, "cannot write result cache %s", tmp);
+        free(tmp);
+        free(order);
+        return -1;
+    }
+    long long bytes = 0;
+    for (int i = 0; i<n; i++) {
+        /* key, space, stamp, space, payload, newline */
+        long long size = 16 + 1 + 20 + 1 + (long long)strlen(order[i]->payload) + 1;
+        if (bytes + size > limit) break;
+        fprintf(f, "%016llx %lld %s\n", order[i]->key, order[i]->stamp, order[i]->payload);
+        bytes += size;
+        kept++;
+    }
+    int failed = ferror(f);
+    int rc = n - kept;
+    if (fclose(f)!=0 || failed || rename(tmp, c->path)!=0) {
+        snprintf(err, errn, "cannot replace result cache %s", c->path);
+        remove(tmp);
+        rc = -1;
+    } else {
+        c->file_bytes = bytes;
+        c->evicted += rc;
+        if (rc > 0) drop_evicted(c, order, kept, n);
+    }
+    free(tmp);
+    free(order);
+    return rc;
+}
+
+void cache_put(ResultCache *c, const char *what, const char *payload) {
+    unsigned long long key = run_key(c, what);
+    pthread_mutex_lock(&c->mu);
+    table_put(c, key, c->session, xstrdup(payload));
+    /* Flushed per run: an interrupted sweep resumes from everything that finished. */
+    if (c->append) {
+        int len = fprintf(c->append, "%016llx %lld %s\n", key, c->session, payload);
+        fflush(c->append);
+        if (len > 0) c->file_bytes += len;
+    }
+    c->stored++;
+    c->dirty = 1;
+    if (c->append && c->file_bytes > c->max_bytes && !c->compact_failed) {
+        /* Over the limit mid-run: rewrite now, leaving room for more runs before the next rewrite. */
+        char err[512];
+        fclose(c->append);
+        if (compact(c, c->max_bytes/2, err, sizeof(err)) < 0) {
+            fprintf(stderr, "%s\n", err);
+            c->compact_failed = 1;
+        }
+        /* Without the file, later runs stay in the table for the rewrite at close. */
+        c->append = fopen(c->path, "a");
+        if (!c->append) fprintf(stderr, "cannot write result cache %s\n", c->path);
+    }
+    pthread_mutex_unlock(&c->mu);
+}
+
+void cache_close(ResultCache *c, FILE *report) {
+    if (!c) return;
+    if (c->append) fclose(c->append);
+    if (c->dirty) {
+        char err[512];
+        if (compact(c, c->max_bytes, err, sizeof(err)) < 0) fprintf(stderr, "%s\n", err);
+        if (report) {
+            fprintf(report, "cache %s: %lld runs reused, %lld stored, %lld evicted\n", c->path, c->hits, c->stored,
+                    c->evicted);
+        }
+    } else if (report) {
+        fprintf(report, "cache %s: %lld runs reused, 0 stored\n", c->path, c->hits);
+    }
+    for (int i = 0; i<c->entries.n; i++) free(c->entries.v[i].payload);
+    VEC_FREE(c->entries);
+    free(c->slots);
+    free(c->path);
+    pthread_mutex_destroy(&c->mu);
+    free(c);
+}
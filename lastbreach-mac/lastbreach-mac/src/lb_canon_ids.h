@@ -0,0 +1,189 @@
+/* Generated by tools/lb_tablegen.c from data/tasks.txt and data/items.txt. Do not edit. */
+#ifndef LB_CANON_IDS_H
+#define LB_CANON_IDS_H
+
+/* Ids index kCanonTasks / kCanonItems, which are sorted by name. */
+enum {
+    CANON_TASK_AQUARIUM_MAINTENANCE = 0,
+    CANON_TASK_CLEANING = 1,
+    CANON_TASK_COMPUTER_WORK = 2,
+    CANON_TASK_COOKING = 3,
+    CANON_TASK_CRAFTING = 4,
+    CANON_TASK_CROCHETING = 5,
+    CANON_TASK_DEFENSIVE_COMBAT = 6,
+    CANON_TASK_DEFENSIVE_SHOOTING = 7,
+    CANON_TASK_DRAWING = 8,
+    CANON_TASK_EATING = 9,
+    CANON_TASK_ELECTRICAL_DIAGNOSTICS = 10,
+    CANON_TASK_ELECTRONICS_REPAIR = 11,
+    CANON_TASK_FIRST_AID = 12,
+    CANON_TASK_FISH_CLEANING = 13,
+    CANON_TASK_FISHING = 14,
+    CANON_TASK_FOOD_PRESERVATION = 15,
+    CANON_TASK_GARDENING = 16,
+    CANON_TASK_GENERAL_SHELTER_CHORES = 17,
+    CANON_TASK_GUN_SMITHING = 18,
+    CANON_TASK_HEATING = 19,
+    CANON_TASK_HYDROPONICS_MAINTENANCE = 20,
+    CANON_TASK_KNITTING = 21,
+    CANON_TASK_MAINTENANCE_CHORES = 22,
+    CANON_TASK_MEAL_PREP = 23,
+    CANON_TASK_MEDICAL_TREATMENT = 24,
+    CANON_TASK_PAINTING = 25,
+    CANON_TASK_PLAYING_GUITAR = 26,
+    CANON_TASK_PLAYING_VIDEO_GAMES = 27,
+    CANON_TASK_POWER_MANAGEMENT = 28,
+    CANON_TASK_RADIO_COMMUNICATION = 29,
+    CANON_TASK_READING = 30,
+    CANON_TASK_RESTING = 31,
+    CANON_TASK_SCOUTING_OUTSIDE = 32,
+    CANON_TASK_SEWING = 33,
+    CANON_TASK_SLEEPING = 34,
+    CANON_TASK_SOCIALIZING = 35,
+    CANON_TASK_SOLDERING = 36,
+    CANON_TASK_SWIMMING = 37,
+    CANON_TASK_TALKING = 38,
+    CANON_TASK_TELESCOPE_USE = 39,
+    CANON_TASK_TENDING_A_FIRE = 40,
+    CANON_TASK_WATCHING = 41,
+    CANON_TASK_WATER_COLLECTION = 42,
+    CANON_TASK_WATER_FILTRATION = 43,
+    CANON_TASK_WATERING_PLANTS = 44,
+    CANON_TASK_COUNT = 45
+};
+
+enum {
+    CANON_ITEM_AMMUNITION = 0,
+    CANON_ITEM_AMPLIFIER = 1,
+    CANON_ITEM_ANTENNA = 2,
+    CANON_ITEM_AQUARIUM = 3,
+    CANON_ITEM_BAIT = 4,
+    CANON_ITEM_BARREL_HEATER = 5,
+    CANON_ITEM_BASEBALL_BAT = 6,
+    CANON_ITEM_BATTERY = 7,
+    CANON_ITEM_BED = 8,
+    CANON_ITEM_BENCH_VISE = 9,
+    CANON_ITEM_BLANKET = 10,
+    CANON_ITEM_BOOKS = 11,
+    CANON_ITEM_BOOKSHELVES = 12,
+    CANON_ITEM_BOWLS = 13,
+    CANON_ITEM_BUCKET = 14,
+    CANON_ITEM_BUNK_BEDS = 15,
+    CANON_ITEM_CAMP_STOVE = 16,
+    CANON_ITEM_CAMPFIRE = 17,
+    CANON_ITEM_CANNED_BEANS = 18,
+    CANON_ITEM_CANNED_CORN = 19,
+    CANON_ITEM_CANNED_SPAM = 20,
+    CANON_ITEM_CANNED_TOMATO = 21,
+    CANON_ITEM_CANNED_TUNA = 22,
+    CANON_ITEM_CANVAS = 23,
+    CANON_ITEM_CHARGE_CONTROLLER = 24,
+    CANON_ITEM_CHILI = 25,
+    CANON_ITEM_COMPUTER = 26,
+    CANON_ITEM_CONSOLE = 27,
+    CANON_ITEM_COOKWARE = 28,
+    CANON_ITEM_CRIMPING_TOOL = 29,
+    CANON_ITEM_CROCHET_HOOKS = 30,
+    CANON_ITEM_CUPS = 31,
+    CANON_ITEM_CUTLERY = 32,
+    CANON_ITEM_CUTTING_BOARD = 33,
+    CANON_ITEM_DESOLDERING_PUMP = 34,
+    CANON_ITEM_DINING_CHAIR = 35,
+    CANON_ITEM_DINING_TABLE = 36,
+    CANON_ITEM_DRAWING_PAPER = 37,
+    CANON_ITEM_DRUMS = 38,
+    CANON_ITEM_ELECTRICAL_GEAR = 39,
+    CANON_ITEM_FABRIC = 40,
+    CANON_ITEM_FERTILIZER = 41,
+    CANON_ITEM_FIRE_PIT = 42,
+    CANON_ITEM_FIREWOOD = 43,
+    CANON_ITEM_FIRST_AID_BOX = 44,
+    CANON_ITEM_FISH = 45,
+    CANON_ITEM_FISH_NET = 46,
+    CANON_ITEM_FISH_TANK = 47,
+    CANON_ITEM_FISHING_HOOKS = 48,
+    CANON_ITEM_FISHING_LINE = 49,
+    CANON_ITEM_FISHING_LURES = 50,
+    CANON_ITEM_FISHING_ROD = 51,
+    CANON_ITEM_FLOAT = 52,
+    CANON_ITEM_FOOD = 53,
+    CANON_ITEM_FOOD_STORAGE_CONTAINERS = 54,
+    CANON_ITEM_FRIDGE = 55,
+    CANON_ITEM_FUEL_CAN = 56,
+    CANON_ITEM_GAME_CONTROLLER = 57,
+    CANON_ITEM_GARLIC = 58,
+    CANON_ITEM_GENERATOR = 59,
+    CANON_ITEM_GREEN_BEAN = 60,
+    CANON_ITEM_GUITAR = 61,
+    CANON_ITEM_GUITAR_PICKS = 62,
+    CANON_ITEM_GUITAR_STRINGS = 63,
+    CANON_ITEM_GUN_CLEANING_KIT = 64,
+    CANON_ITEM_GUNSMITH_TOOLKIT = 65,
+    CANON_ITEM_HYDROPONIC_PLANTER = 66,
+    CANON_ITEM_INVERTER = 67,
+    CANON_ITEM_JAR_OF_CHEESE_POWDER = 68,
+    CANON_ITEM_JAR_OF_OLIVES = 69,
+    CANON_ITEM_KETTLE = 70,
+    CANON_ITEM_KEYBOARD = 71,
+    CANON_ITEM_KITCHEN_KNIFE = 72,
+    CANON_ITEM_KNITTING_SUPPLIES = 73,
+    CANON_ITEM_LED_LIGHT_BANK = 74,
+    CANON_ITEM_LADDER = 75,
+    CANON_ITEM_LAPTOP = 76,
+    CANON_ITEM_LIFE_RING = 77,
+    CANON_ITEM_LIGHTER = 78,
+    CANON_ITEM_MEDICAL_BOX = 79,
+    CANON_ITEM_MICROWAVE = 80,
+    CANON_ITEM_MONITOR = 81,
+    CANON_ITEM_MOUSE = 82,
+    CANON_ITEM_MULTIMETER = 83,
+    CANON_ITEM_OSCILLOSCOPE_CRO = 84,
+    CANON_ITEM_PAINT = 85,
+    CANON_ITEM_PAINT_BRUSHES = 86,
+    CANON_ITEM_PENCILS = 87,
+    CANON_ITEM_PILLOW = 88,
+    CANON_ITEM_PISTOL = 89,
+    CANON_ITEM_PLANT = 90,
+    CANON_ITEM_PLATES = 91,
+    CANON_ITEM_PROJECTOR = 92,
+    CANON_ITEM_PROJECTOR_SCREEN = 93,
+    CANON_ITEM_PUNCH_SET = 94,
+    CANON_ITEM_RADIO = 95,
+    CANON_ITEM_RAILING = 96,
+    CANON_ITEM_RAMEN = 97,
+    CANON_ITEM_REVOLVER = 98,
+    CANON_ITEM_RIFLE = 99,
+    CANON_ITEM_ROPE = 100,
+    CANON_ITEM_SATELLITE_DISH = 101,
+    CANON_ITEM_SCISSORS = 102,
+    CANON_ITEM_SCREWDRIVER_SET = 103,
+    CANON_ITEM_SEEDS = 104,
+    CANON_ITEM_SEWING_KIT = 105,
+    CANON_ITEM_SINKERS = 106,
+    CANON_ITEM_SOIL = 107,
+    CANON_ITEM_SOLAR_PANEL = 108,
+    CANON_ITEM_SOLDER_WIRE = 109,
+    CANON_ITEM_SOLDERING_IRON = 110,
+    CANON_ITEM_STAIR = 111,
+    CANON_ITEM_STUFFED_TOY = 112,
+    CANON_ITEM_TELESCOPE = 113,
+    CANON_ITEM_TINY_SHELTER_STRUCTURE = 114,
+    CANON_ITEM_TOMATO = 115,
+    CANON_ITEM_TOOLS = 116,
+    CANON_ITEM_TORQUE_DRIVER = 117,
+    CANON_ITEM_TRAIN_CAR_LIVING_COMPARTMENT = 118,
+    CANON_ITEM_TREEHOUSE_STRUCTURE = 119,
+    CANON_ITEM_TURNTABLE = 120,
+    CANON_ITEM_UTILITY_GEAR = 121,
+    CANON_ITEM_VINYL_RECORD = 122,
+    CANON_ITEM_WATER = 123,
+    CANON_ITEM_WATER_BARREL = 124,
+    CANON_ITEM_WATER_FILTER = 125,
+    CANON_ITEM_WATER_TANK = 126,
+    CANON_ITEM_WATERING_CAN = 127,
+    CANON_ITEM_WIRE_STRIPPER = 128,
+    CANON_ITEM_YARN = 129,
+    CANON_ITEM_COUNT = 130
+};
+
+#endif /* LB_CANON_IDS_H */
@@ -0,0 +1,199 @@
+/* Generated by tools/lb_tablegen.c from data/tasks.txt and data/items.txt. Do not edit. */
+#include "lastbreach.h"
+#include "lb_canon_ids.h"
+
+/* Required task inputs; tasks point at their run of entries. */
+static const TaskInput kCanonTaskInputs[] = {
+    {CANON_ITEM_AMMUNITION, 2},
+    {CANON_ITEM_SOLDER_WIRE, 0.2},
+    {CANON_ITEM_FISH, 1},
+    {CANON_ITEM_SOLDER_WIRE, 0.2},
+};
+
+/* {name, hash, id, time_ticks, station, {hunger, hydration, morale, injury, illness, temp_c, power, water_safe, water_raw, structure, contamination, signature}, inputs, n_inputs} */
+const CanonTask kCanonTasks[] = {
+    {"Aquarium maintenance", 0x29149ba1u, CANON_TASK_AQUARIUM_MAINTENANCE, 2, "aquarium", {0, 0, 1, 0, 0, 0, -0.2, 0, 0, 0, -0.8, 0}, NULL, 0},
+    {"Cleaning", 0xcbe1ceb2u, CANON_TASK_CLEANING, 2, "wash", {0, 0, 0.5, 0, 0, 0, 0, 0, 0, 0, -2.0, 0}, NULL, 0},
+    {"Computer work", 0x54a5d3b5u, CANON_TASK_COMPUTER_WORK, 2, "comms", {0, 0, 1, 0, 0, 0, -1.5, 0, 0, 0, 0, 0.2}, NULL, 0},
+    {"Cooking", 0x450b1697u, CANON_TASK_COOKING, 2, "kitchen", {0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Crafting", 0x07f1a03fu, CANON_TASK_CRAFTING, 2, "workshop", {0, 0, 2, 0, 0, 0, -0.5, 0, 0, 0.4, 0, 0.2}, NULL, 0},
+    {"Crocheting", 0x7cebb5f1u, CANON_TASK_CROCHETING, 2, "craft", {0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Defensive combat", 0x6bb7f44au, CANON_TASK_DEFENSIVE_COMBAT, 3, "defense", {0, 0, -1, 2, 0, 0, 0, 0, 0, -0.5, 0, 1.0}, NULL, 0},
+    {"Defensive shooting", 0x1062feabu, CANON_TASK_DEFENSIVE_SHOOTING, 3, "defense", {0, 0, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0.8}, kCanonTaskInputs+0, 1},
+    {"Drawing", 0x75394665u, CANON_TASK_DRAWING, 1, "craft", {0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Eating", 0xdf5b6dfbu, CANON_TASK_EATING, 1, "kitchen", {12, 5, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Electrical diagnostics", 0xa663736bu, CANON_TASK_ELECTRICAL_DIAGNOSTICS, 2, "power", {0, 0, 0, 0, 0, 0, 0.2, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Electronics repair", 0x58a403b1u, CANON_TASK_ELECTRONICS_REPAIR, 2, "workshop", {0, 0, 1, 0, 0, 0, 0.4, 0, 0, 0, 0, 0}, kCanonTaskInputs+1, 1},
+    {"First aid", 0x3b0d73cbu, CANON_TASK_FIRST_AID, 1, "med", {0, 0, 1, -12, 0, 0, 0, 0, 0, 0, -0.5, 0}, NULL, 0},
+    {"Fish cleaning", 0x8bcc05aeu, CANON_TASK_FISH_CLEANING, 1, "kitchen", {0, 0, 0.5, 0, 0, 0, 0, 0, 0, 0, 0.3, 0}, kCanonTaskInputs+2, 1},
+    {"Fishing", 0xc42eecd5u, CANON_TASK_FISHING, 3, "outside", {0, 0, 1, 0, 0, 0, -0.4, 0, 0, 0, 0, 0.8}, NULL, 0},
+    {"Food preservation", 0x7d7e749du, CANON_TASK_FOOD_PRESERVATION, 2, "kitchen", {0, 0, 1, 0, 0, 0, 0, 0, 0, 0, -0.5, 0}, NULL, 0},
+    {"Gardening", 0x0e55d604u, CANON_TASK_GARDENING, 2, "hydroponics", {0, 0, 2, 0, 0, 0, 0, 0, 0, 0.2, -0.5, 0}, NULL, 0},
+    {"General shelter chores", 0x9c42effcu, CANON_TASK_GENERAL_SHELTER_CHORES, 2, "chores", {0, 0, 0.5, 0, 0, 0, 0, 0, 0, 0.5, -0.8, 0}, NULL, 0},
+    {"Gun smithing", 0xf64d7166u, CANON_TASK_GUN_SMITHING, 2, "workshop", {0, 0, 1, 0, 0, 0, 0, 0, 0, 0.4, 0, 0.2}, NULL, 0},
+    {"Heating", 0xacc61ce5u, CANON_TASK_HEATING, 2, "heat", {0, 0, 0, 0, 0, 2.0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Hydroponics maintenance", 0x561627a0u, CANON_TASK_HYDROPONICS_MAINTENANCE, 2, "hydroponics", {0, 0, 1, 0, 0, 0, -0.3, 0, 0, 0.5, -1, 0}, NULL, 0},
+    {"Knitting", 0x500c7b99u, CANON_TASK_KNITTING, 2, "craft", {0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Maintenance chores", 0xeccee4c2u, CANON_TASK_MAINTENANCE_CHORES, 2, "workshop", {0, 0, 0.5, 0, 0, 0, 0.2, 0, 0, 1.0, -0.2, 0}, NULL, 0},
+    {"Meal prep", 0x670c8fb5u, CANON_TASK_MEAL_PREP, 2, "kitchen", {0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Medical treatment", 0xff76b608u, CANON_TASK_MEDICAL_TREATMENT, 2, "med", {0, 0, 1, 0, -12, 0, -0.2, 0, 0, 0, -1.0, 0}, NULL, 0},
+    {"Painting", 0x8dc1c285u, CANON_TASK_PAINTING, 2, "craft", {0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Playing guitar", 0xedf9e859u, CANON_TASK_PLAYING_GUITAR, 1, "lounge", {0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0.3}, NULL, 0},
+    {"Playing video games", 0xcae9bf9du, CANON_TASK_PLAYING_VIDEO_GAMES, 1, "lounge", {0, 0, 4, 0, 0, 0, -1, 0, 0, 0, 0, 0.2}, NULL, 0},
+    {"Power management", 0x9f744469u, CANON_TASK_POWER_MANAGEMENT, 2, "power", {0, 0, 0.5, 0, 0, 0, 1.5, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Radio communication", 0x711ee340u, CANON_TASK_RADIO_COMMUNICATION, 1, "comms", {0, 0, 0, 0, 0, 0, -0.4, 0, 0, 0, 0, 1.5}, NULL, 0},
+    {"Reading", 0x5ee7339bu, CANON_TASK_READING, 1, "lounge", {0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Resting", 0xb9483f81u, CANON_TASK_RESTING, 2, "cot", {0, 0, 1, -0.5, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Scouting outside", 0x8c8957c0u, CANON_TASK_SCOUTING_OUTSIDE, 3, "outside", {0, 0, -1, 1, 0, 0, -0.8, 0, 0, 0, 0, 1.2}, NULL, 0},
+    {"Sewing", 0x2b5b5d9au, CANON_TASK_SEWING, 2, "craft", {0, 0, 2, 0, 0, 0, 0, 0, 0, 0.3, 0, 0}, NULL, 0},
+    {"Sleeping", 0x2f2a16a0u, CANON_TASK_SLEEPING, 4, "cot", {0, 0, 2, -1, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Socializing", 0xd99d1b7fu, CANON_TASK_SOCIALIZING, 1, "lounge", {0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Soldering", 0xc14f7a44u, CANON_TASK_SOLDERING, 2, "workshop", {0, 0, 0, 0, 0, 0, 0.2, 0, 0, 0, 0, 0}, kCanonTaskInputs+3, 1},
+    {"Swimming", 0x7e406f48u, CANON_TASK_SWIMMING, 2, "outside", {0, -2, 2, -1, 0, 0, 0, 0, 0, 0, 0, 0.5}, NULL, 0},
+    {"Talking", 0xad8c7d09u, CANON_TASK_TALKING, 1, "lounge", {0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Telescope use", 0xd83af4c0u, CANON_TASK_TELESCOPE_USE, 1, "outside", {0, 0, 1, 0, 0, 0, -0.2, 0, 0, 0, 0, 0.6}, NULL, 0},
+    {"Tending a fire", 0xc2739f75u, CANON_TASK_TENDING_A_FIRE, 2, "heat", {0, 0, 0.5, 0, 0, 1.2, 0, 0, 0, 0, 0, 0.4}, NULL, 0},
+    {"Watching", 0xc56e0440u, CANON_TASK_WATCHING, 1, "lounge", {0, 0, 2, 0, 0, 0, -0.5, 0, 0, 0, 0, 0}, NULL, 0},
+    {"Water collection", 0x2d58636cu, CANON_TASK_WATER_COLLECTION, 2, "outside", {0, 0, 0, 0, 0, 0, 0, 0, 2.5, 0, -0.4, 0.4}, NULL, 0},
+    {"Water filtration", 0x5432552au, CANON_TASK_WATER_FILTRATION, 2, "wash", {0, 0, 0, 0, 0, 0, -0.2, 2.0, -2.0, 0, -1.0, 0}, NULL, 0},
+    {"Watering plants", 0x69f5e84au, CANON_TASK_WATERING_PLANTS, 1, "hydroponics", {0, 0, 1, 0, 0, 0, 0, 0, 0, 0, -0.5, 0}, NULL, 0}
+};
+const int kCanonTaskCount = CANON_TASK_COUNT;
+
+const char *const kCanonItemTags[] = {"edible"};
+const int kCanonItemTagCount = 1;
+
+/* {name, hash, id, tags, shelf_life_days} */
+const CanonItem kCanonItems[] = {
+    {"Ammunition", 0xda36dfcau, CANON_ITEM_AMMUNITION, 0x0ull, 0},
+    {"Amplifier", 0x1e069324u, CANON_ITEM_AMPLIFIER, 0x0ull, 0},
+    {"Antenna", 0x13849eb0u, CANON_ITEM_ANTENNA, 0x0ull, 0},
+    {"Aquarium", 0xec68f5cau, CANON_ITEM_AQUARIUM, 0x0ull, 0},
+    {"Bait", 0xb97ba5b1u, CANON_ITEM_BAIT, 0x0ull, 5},
+    {"Barrel heater", 0x4a1d0fe2u, CANON_ITEM_BARREL_HEATER, 0x0ull, 0},
+    {"Baseball bat", 0x84bb8acau, CANON_ITEM_BASEBALL_BAT, 0x0ull, 0},
+    {"Battery", 0x840ae12eu, CANON_ITEM_BATTERY, 0x0ull, 0},
+    {"Bed", 0xb5b3478cu, CANON_ITEM_BED, 0x0ull, 0},
+    {"Bench vise", 0xcb29928au, CANON_ITEM_BENCH_VISE, 0x0ull, 0},
+    {"Blanket", 0xb1db7b28u, CANON_ITEM_BLANKET, 0x0ull, 0},
+    {"Books", 0xd9d036b1u, CANON_ITEM_BOOKS, 0x0ull, 0},
+    {"Bookshelves", 0xfd973498u, CANON_ITEM_BOOKSHELVES, 0x0ull, 0},
+    {"Bowls", 0x6b237ce2u, CANON_ITEM_BOWLS, 0x0ull, 0},
+    {"Bucket", 0xe34e3557u, CANON_ITEM_BUCKET, 0x0ull, 0},
+    {"Bunk beds", 0x5c482cf1u, CANON_ITEM_BUNK_BEDS, 0x0ull, 0},
+    {"Camp stove", 0xb93ad751u, CANON_ITEM_CAMP_STOVE, 0x0ull, 0},
+    {"Campfire", 0xacb06d38u, CANON_ITEM_CAMPFIRE, 0x0ull, 0},
+    {"Canned beans", 0x34bb3d4bu, CANON_ITEM_CANNED_BEANS, 0x1ull, 0},
+    {"Canned corn", 0xb78ded52u, CANON_ITEM_CANNED_CORN, 0x1ull, 0},
+    {"Canned spam", 0x561a2f21u, CANON_ITEM_CANNED_SPAM, 0x1ull, 0},
+    {"Canned tomato", 0x87a98e8au, CANON_ITEM_CANNED_TOMATO, 0x1ull, 0},
+    {"Canned tuna", 0x2975be42u, CANON_ITEM_CANNED_TUNA, 0x1ull, 0},
+    {"Canvas", 0xb2585091u, CANON_ITEM_CANVAS, 0x0ull, 0},
+    {"Charge controller", 0x1ab646efu, CANON_ITEM_CHARGE_CONTROLLER, 0x0ull, 0},
+    {"Chili", 0x80d5e686u, CANON_ITEM_CHILI, 0x1ull, 12},
+    {"Computer", 0xd76345b8u, CANON_ITEM_COMPUTER, 0x0ull, 0},
+    {"Console", 0x5edb76cau, CANON_ITEM_CONSOLE, 0x0ull, 0},
+    {"Cookware", 0x847a1a24u, CANON_ITEM_COOKWARE, 0x0ull, 0},
+    {"Crimping tool", 0x9b562218u, CANON_ITEM_CRIMPING_TOOL, 0x0ull, 0},
+    {"Crochet hooks", 0xb30b3f7bu, CANON_ITEM_CROCHET_HOOKS, 0x0ull, 0},
+    {"Cups", 0x145b5454u, CANON_ITEM_CUPS, 0x0ull, 0},
+    {"Cutlery", 0xdd8770b5u, CANON_ITEM_CUTLERY, 0x0ull, 0},
+    {"Cutting board", 0x5eb106bfu, CANON_ITEM_CUTTING_BOARD, 0x0ull, 0},
+    {"Desoldering pump", 0x2984b61du, CANON_ITEM_DESOLDERING_PUMP, 0x0ull, 0},
+    {"Dining chair", 0xc623a285u, CANON_ITEM_DINING_CHAIR, 0x0ull, 0},
+    {"Dining table", 0xb066511cu, CANON_ITEM_DINING_TABLE, 0x0ull, 0},
+    {"Drawing paper", 0x8312badbu, CANON_ITEM_DRAWING_PAPER, 0x0ull, 0},
+    {"Drums", 0x85ac7c5au, CANON_ITEM_DRUMS, 0x0ull, 0},
+    {"Electrical gear", 0xdaed26f2u, CANON_ITEM_ELECTRICAL_GEAR, 0x0ull, 0},
+    {"Fabric", 0xda37335cu, CANON_ITEM_FABRIC, 0x0ull, 0},
+    {"Fertilizer", 0xff3a73b7u, CANON_ITEM_FERTILIZER, 0x0ull, 0},
+    {"Fire pit", 0x30285d74u, CANON_ITEM_FIRE_PIT, 0x0ull, 0},
+    {"Firewood", 0x52e55e3cu, CANON_ITEM_FIREWOOD, 0x0ull, 0},
+    {"First-aid box", 0x4eb41fc3u, CANON_ITEM_FIRST_AID_BOX, 0x0ull, 0},
+    {"Fish", 0x2fd9d583u, CANON_ITEM_FISH, 0x1ull, 3},
+    {"Fish net", 0x5f68f56cu, CANON_ITEM_FISH_NET, 0x0ull, 0},
+    {"Fish tank", 0x196d847du, CANON_ITEM_FISH_TANK, 0x0ull, 0},
+    {"Fishing hooks", 0x518d1171u, CANON_ITEM_FISHING_HOOKS, 0x0ull, 0},
+    {"Fishing line", 0xf59044cdu, CANON_ITEM_FISHING_LINE, 0x0ull, 0},
+    {"Fishing lures", 0x98e99702u, CANON_ITEM_FISHING_LURES, 0x0ull, 0},
+    {"Fishing rod", 0x74136f34u, CANON_ITEM_FISHING_ROD, 0x0ull, 0},
+    {"Float", 0x4c816225u, CANON_ITEM_FLOAT, 0x0ull, 0},
+    {"Food", 0xbd7cbfe9u, CANON_ITEM_FOOD, 0x1ull, 4},
+    {"Food storage containers", 0xd0ad7a04u, CANON_ITEM_FOOD_STORAGE_CONTAINERS, 0x0ull, 0},
+    {"Fridge", 0xcc056b54u, CANON_ITEM_FRIDGE, 0x0ull, 0},
+    {"Fuel can", 0x2a1dddebu, CANON_ITEM_FUEL_CAN, 0x0ull, 120},
+    {"Game controller", 0xf66f32c1u, CANON_ITEM_GAME_CONTROLLER, 0x0ull, 0},
+    {"Garlic", 0x08360eefu, CANON_ITEM_GARLIC, 0x1ull, 30},
+    {"Generator", 0x93798b62u, CANON_ITEM_GENERATOR, 0x0ull, 0},
+    {"Green bean", 0x3bd1c226u, CANON_ITEM_GREEN_BEAN, 0x1ull, 6},
+    {"Guitar", 0xf53c5c2fu, CANON_ITEM_GUITAR, 0x0ull, 0},
+    {"Guitar picks", 0x050d12b9u, CANON_ITEM_GUITAR_PICKS, 0x0ull, 0},
+    {"Guitar strings", 0x377dd379u, CANON_ITEM_GUITAR_STRINGS, 0x0ull, 0},
+    {"Gun cleaning kit", 0xa4710c60u, CANON_ITEM_GUN_CLEANING_KIT, 0x0ull, 0},
+    {"Gunsmith toolkit", 0xb436ef2eu, CANON_ITEM_GUNSMITH_TOOLKIT, 0x0ull, 0},
+    {"Hydroponic planter", 0xc23702f4u, CANON_ITEM_HYDROPONIC_PLANTER, 0x0ull, 0},
+    {"Inverter", 0xf94a0bfau, CANON_ITEM_INVERTER, 0x0ull, 0},
+    {"Jar of cheese powder", 0x49d62991u, CANON_ITEM_JAR_OF_CHEESE_POWDER, 0x0ull, 0},
+    {"Jar of olives", 0x05fc022du, CANON_ITEM_JAR_OF_OLIVES, 0x0ull, 0},
+    {"Kettle", 0x5926af22u, CANON_ITEM_KETTLE, 0x0ull, 0},
+    {"Keyboard", 0x27d1a714u, CANON_ITEM_KEYBOARD, 0x0ull, 0},
+    {"Kitchen knife", 0x084d44d2u, CANON_ITEM_KITCHEN_KNIFE, 0x0ull, 0},
+    {"Knitting supplies", 0xf46f0854u, CANON_ITEM_KNITTING_SUPPLIES, 0x0ull, 0},
+    {"LED light bank", 0x3aab4d30u, CANON_ITEM_LED_LIGHT_BANK, 0x0ull, 0},
+    {"Ladder", 0x467435c9u, CANON_ITEM_LADDER, 0x0ull, 0},
+    {"Laptop", 0x8864914du, CANON_ITEM_LAPTOP, 0x0ull, 0},
+    {"Life ring", 0x4443abb3u, CANON_ITEM_LIFE_RING, 0x0ull, 0},
+    {"Lighter", 0xf65d7c84u, CANON_ITEM_LIGHTER, 0x0ull, 0},
+    {"Medical box", 0x6fb4e7bdu, CANON_ITEM_MEDICAL_BOX, 0x0ull, 0},
+    {"Microwave", 0x90f2ec0au, CANON_ITEM_MICROWAVE, 0x0ull, 0},
+    {"Monitor", 0xe60c8ab9u, CANON_ITEM_MONITOR, 0x0ull, 0},
+    {"Mouse", 0x2b1d9b64u, CANON_ITEM_MOUSE, 0x0ull, 0},
+    {"Multimeter", 0xa8f8b613u, CANON_ITEM_MULTIMETER, 0x0ull, 0},
+    {"Oscilloscope (CRO)", 0xf18ba18du, CANON_ITEM_OSCILLOSCOPE_CRO, 0x0ull, 0},
+    {"Paint", 0x36b37bd3u, CANON_ITEM_PAINT, 0x0ull, 0},
+    {"Paint brushes", 0xcb21de0fu, CANON_ITEM_PAINT_BRUSHES, 0x0ull, 0},
+    {"Pencils", 0x9399f9f5u, CANON_ITEM_PENCILS, 0x0ull, 0},
+    {"Pillow", 0x58756da0u, CANON_ITEM_PILLOW, 0x0ull, 0},
+    {"Pistol", 0x2b9d7f76u, CANON_ITEM_PISTOL, 0x0ull, 0},
+    {"Plant", 0x8dc56832u, CANON_ITEM_PLANT, 0x0ull, 0},
+    {"Plates", 0xca0e6970u, CANON_ITEM_PLATES, 0x0ull, 0},
+    {"Projector", 0x9854b083u, CANON_ITEM_PROJECTOR, 0x0ull, 0},
+    {"Projector screen", 0x18a9523du, CANON_ITEM_PROJECTOR_SCREEN, 0x0ull, 0},
+    {"Punch set", 0x9e2b60cfu, CANON_ITEM_PUNCH_SET, 0x0ull, 0},
+    {"Radio", 0x5675f954u, CANON_ITEM_RADIO, 0x0ull, 0},
+    {"Railing", 0xa332e847u, CANON_ITEM_RAILING, 0x0ull, 0},
+    {"Ramen", 0x5b4040b4u, CANON_ITEM_RAMEN, 0x1ull, 0},
+    {"Revolver", 0xc43b93b6u, CANON_ITEM_REVOLVER, 0x0ull, 0},
+    {"Rifle", 0xb1751b11u, CANON_ITEM_RIFLE, 0x0ull, 0},
+    {"Rope", 0xc070ee4du, CANON_ITEM_ROPE, 0x0ull, 0},
+    {"Satellite dish", 0x6e7c313eu, CANON_ITEM_SATELLITE_DISH, 0x0ull, 0},
+    {"Scissors", 0x192eda16u, CANON_ITEM_SCISSORS, 0x0ull, 0},
+    {"Screwdriver set", 0xba26c765u, CANON_ITEM_SCREWDRIVER_SET, 0x0ull, 0},
+    {"Seeds", 0xe283c4adu, CANON_ITEM_SEEDS, 0x0ull, 0},
+    {"Sewing kit", 0xa45fd022u, CANON_ITEM_SEWING_KIT, 0x0ull, 0},
+    {"Sinkers", 0x6f815f02u, CANON_ITEM_SINKERS, 0x0ull, 0},
+    {"Soil", 0x8a968722u, CANON_ITEM_SOIL, 0x0ull, 0},
+    {"Solar panel", 0x7ae84d00u, CANON_ITEM_SOLAR_PANEL, 0x0ull, 0},
+    {"Solder wire", 0xf9a5c2b1u, CANON_ITEM_SOLDER_WIRE, 0x0ull, 0},
+    {"Soldering iron", 0x728eee32u, CANON_ITEM_SOLDERING_IRON, 0x0ull, 0},
+    {"Stair", 0x06f33c26u, CANON_ITEM_STAIR, 0x0ull, 0},
+    {"Stuffed toy", 0x53c6b9f4u, CANON_ITEM_STUFFED_TOY, 0x0ull, 0},
+    {"Telescope", 0xed0dc1b3u, CANON_ITEM_TELESCOPE, 0x0ull, 0},
+    {"Tiny shelter structure", 0x49fda41bu, CANON_ITEM_TINY_SHELTER_STRUCTURE, 0x0ull, 0},
+    {"Tomato", 0x626b3de3u, CANON_ITEM_TOMATO, 0x1ull, 8},
+    {"Tools", 0x950196fcu, CANON_ITEM_TOOLS, 0x0ull, 0},
+    {"Torque driver", 0x1d1633fbu, CANON_ITEM_TORQUE_DRIVER, 0x0ull, 0},
+    {"Train-car living compartment", 0x2cf6648bu, CANON_ITEM_TRAIN_CAR_LIVING_COMPARTMENT, 0x0ull, 0},
+    {"Treehouse structure", 0xc3a472e2u, CANON_ITEM_TREEHOUSE_STRUCTURE, 0x0ull, 0},
+    {"Turntable", 0xe39aaeeeu, CANON_ITEM_TURNTABLE, 0x0ull, 0},
+    {"Utility gear", 0xf36d7376u, CANON_ITEM_UTILITY_GEAR, 0x0ull, 0},
+    {"Vinyl record", 0x7aeb06c4u, CANON_ITEM_VINYL_RECORD, 0x0ull, 0},
+    {"Water", 0xd63556b0u, CANON_ITEM_WATER, 0x0ull, 0},
+    {"Water barrel", 0x94092e14u, CANON_ITEM_WATER_BARREL, 0x0ull, 0},
+    {"Water filter", 0x0bf5cb42u, CANON_ITEM_WATER_FILTER, 0x0ull, 0},
+    {"Water tank", 0x0863f030u, CANON_ITEM_WATER_TANK, 0x0ull, 0},
+    {"Watering can", 0x6b85f7dau, CANON_ITEM_WATERING_CAN, 0x0ull, 0},
+    {"Wire stripper", 0xb6cf93edu, CANON_ITEM_WIRE_STRIPPER, 0x0ull, 0},
+    {"Yarn", 0xc05b35abu, CANON_ITEM_YARN, 0x0ull, 0}
+};
+const int kCanonItemCount = CANON_ITEM_COUNT;
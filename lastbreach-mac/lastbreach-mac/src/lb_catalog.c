@@ -13,20 +13,148 @@
 /** Initializes a catalog (empty task list). */
 void cat_init(Catalog *c) {
     VEC_INIT(c->tasks);
+    hidx_init(&c->index);
+    VEC_INIT(c->spans);
+    VEC_INIT(c->sources);
+    item_reg_init(&c->items);
 }
-TaskDef *cat_find_task(Catalog *c, const char *name) {
-    /* Catalog sizes are modest; linear lookup keeps code simple and transparent. */
-    for (int i = 0; i<c->tasks.n; i++) if (strcmp(c->tasks.v[i].name, name)==0) return &c->tasks.v[i];
+
+void cat_free(Catalog *c) {
+    for (int i = 0; i<c->tasks.n; i++) {
+        TaskDef *t = &c->tasks.v[i];
+        const CanonTask *ct = t->canon_id >= 0 ? &kCanonTasks[t->canon_id] : NULL;
+        if (!ct || t->name != ct->name) free(t->name);
+        if (!ct || t->station != ct->station) free(t->station);
+    }
+    VEC_FREE(c->tasks);
+    hidx_free(&c->index);
+    VEC_FREE(c->spans);
+    for (int i = 0; i<c->sources.n; i++) free(c->sources.v[i]);
+    VEC_FREE(c->sources);
+    item_reg_free(&c->items);
+}
+
+static TaskDef *cat_lookup_hashed(Catalog *c, const char *name, unsigned int h) {
+    int slot = -1, i;
+    while ((i = hidx_next(&c->index, h, &slot)) >= 0) {
+        if (strcmp(c->tasks.v[i].name, name)==0) return &c->tasks.v[i];
+    }
     return NULL;
 }
+
+static TaskDef *cat_lookup(Catalog *c, const char *name) {
+    return cat_lookup_hashed(c, name, lb_hash_str(name));
+}
+
+static TaskDef *cat_push_task(Catalog *c, TaskDef *nt) {
+    VEC_PUSH(c->tasks, *nt);
+    hidx_add(&c->index, nt->hash, c->tasks.n-1);
+    return &c->tasks.v[c->tasks.n-1];
+}
+
+TaskDef *cat_find_task(Catalog *c, const char *name) {
+    /* Hashed lookup keeps very large (generated) catalogs as cheap as small ones. */
+    TaskDef *t = cat_lookup(c, name);
+    if (t && t->lazy_head >= 0) catalog_resolve_task(c, t);
+    return t;
+}
 TaskDef *cat_get_or_add_task(Catalog *c, const char *name) {
-    TaskDef *t = cat_find_task(c, name);
+    TaskDef *t = cat_lookup(c, name);
     if (t) return t;
+    const CanonTask *ct = canon_task_find(name);
     TaskDef nt;
-    nt.name = xstrdup(name);
+    /* Canonical names are borrowed from the generated table, never copied. */
+    nt.name = ct ? (char*)ct->name : xstrdup(name);
     /* Sensible defaults when DSL omits details. */
     nt.time_ticks = 1;
     nt.station = NULL;
-    VEC_PUSH(c->tasks, nt);
-    return &c->tasks.v[c->tasks.n-1];
+    nt.hash = ct ? ct->hash : lb_hash_str(name);
+    nt.canon_id = ct ? ct->id : -1;
+    nt.inputs = ct ? ct->inputs : NULL;
+    nt.n_inputs = ct ? ct->n_inputs : 0;
+    nt.lazy_head = -1;
+    nt.lazy_tail = -1;
+    return cat_push_task(c, &nt);
+}
+
+/** Adds a canonical task with its table defaults; no hashing or copying. */
+TaskDef *cat_add_canon_task(Catalog *c, const CanonTask *ct) {
+    TaskDef *t = cat_lookup_hashed(c, ct->name, ct->hash);
+    if (!t) {
+        TaskDef nt;
+        nt.name = (char*)ct->name;
+        nt.time_ticks = 1;
+        nt.station = NULL;
+        nt.hash = ct->hash;
+        nt.canon_id = ct->id;
+        nt.inputs = NULL;
+        nt.n_inputs = 0;
+        nt.lazy_head = -1;
+        nt.lazy_tail = -1;
+        t = cat_push_task(c, &nt);
+    }
+    t->canon_id = ct->id;
+    t->time_ticks = ct->time_ticks;
+    t->inputs = ct->inputs;
+    t->n_inputs = ct->n_inputs;
+    if (ct->station) taskdef_set_station(t, (char*)ct->station);
+    return t;
+}
+
+void taskdef_set_station(TaskDef *td, char *station) {
+    /* The table default is static; anything else came from the parser or xstrdup. */
+    int borrowed = td->canon_id >= 0 && td->station==kCanonTasks[td->canon_id].station;
+    if (td->station && !borrowed && td->station != station) free(td->station);
+    td->station = station;
+}
+
+typedef struct {
+    Catalog *cat;
+    int *pending; /* task indices with unparsed bodies */
+    int *failed;
+    char (*errs)[512];
+} ResolveJobs;
+
+static void resolve_worker(void *ctx, int i) {
+    ResolveJobs *rj = (ResolveJobs*)ctx;
+    DieTrap trap;
+    /* Each job owns one TaskDef, so workers never touch shared state. */
+    if (setjmp(trap.jb)==0) {
+        dief_trap_set(&trap);
+        catalog_resolve_task(rj->cat, &rj->cat->tasks.v[rj->pending[i]]);
+    } else {
+        rj->failed[i] = 1;
+        memcpy(rj->errs[i], trap.msg, sizeof(rj->errs[i]));
+    }
+    dief_trap_set(NULL);
+}
+
+/** Parses every pending lazy body in parallel; reports the first error in catalog order. */
+int cat_resolve_all(Catalog *c, int threads, char *err, size_t errn) {
+    int n = 0;
+    for (int i = 0; i<c->tasks.n; i++) if (c->tasks.v[i].lazy_head >= 0) n++;
+    if (n==0) return 0;
+
+    ResolveJobs rj;
+    rj.cat = c;
+    rj.pending = (int*)xmalloc((size_t)n*sizeof(*rj.pending));
+    rj.failed = (int*)xmalloc((size_t)n*sizeof(*rj.failed));
+    rj.errs = xmalloc((size_t)n*sizeof(*rj.errs));
+    memset(rj.failed, 0, (size_t)n*sizeof(*rj.failed));
+    n = 0;
+    for (int i = 0; i<c->tasks.n; i++) if (c->tasks.v[i].lazy_head >= 0) rj.pending[n++] = i;
+
+    parallel_for(n, threads, resolve_worker, &rj);
+
+    int rc = 0;
+    for (int i = 0; i<n; i++) {
+        if (!rj.failed[i]) continue;
+        if (err && errn) snprintf(err, errn, "%s", rj.errs[i]);
+        rc = -1;
+        break;
+    }
+    free(rj.pending);
+    free(rj.failed);
+    free(rj.errs);
+    return rc;
 }
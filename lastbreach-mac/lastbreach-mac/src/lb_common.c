@@ -1,4 +1,8 @@
+#define _POSIX_C_SOURCE 200809L
 #include "lastbreach.h"
+
+#include <float.h>
+#include <pthread.h>
 /**
  * lb_common.c
  *
@@ -10,9 +14,31 @@
  */
 
 
+static pthread_key_t g_trap_key;
+static pthread_once_t g_trap_once = PTHREAD_ONCE_INIT;
+
+static void trap_key_init(void) {
+    (void)pthread_key_create(&g_trap_key, NULL);
+}
+
+/** Installs (or with NULL removes) the dief() trap for the calling thread. */
+void dief_trap_set(DieTrap *trap) {
+    pthread_once(&g_trap_once, trap_key_init);
+    (void)pthread_setspecific(g_trap_key, trap);
+}
+
 /** Prints a formatted fatal error message to stderr and terminates the program. */
 void dief(const char *fmt, ...) {
     va_list ap;
+    pthread_once(&g_trap_once, trap_key_init);
+    DieTrap *trap = (DieTrap*)pthread_getspecific(g_trap_key);
+    if (trap) {
+        /* Worker threads hand the message back instead of killing the process. */
+        va_start(ap, fmt);
+        vsnprintf(trap->msg, sizeof(trap->msg), fmt, ap);
+        va_end(ap);
+        longjmp(trap->jb, 1);
+    }
     va_start(ap, fmt);
     vfprintf(stderr, fmt, ap);
     fprintf(stderr, "\n");
@@ -37,3 +63,120 @@ char *xstrdup(const char *s) {
     memcpy(p, s, n+1);
     return p;
 }
+
+/** FNV-1a hash of a NUL-terminated string. */
+unsigned int lb_hash_str(const char *s) {
+    unsigned int h = 2166136261u;
+    for (; *s; s++) {
+        h ^= (unsigned char)*s;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void hidx_init(HashIndex *ix) {
+    ix->slots = NULL;
+    ix->hashes = NULL;
+    ix->cap = 0;
+    ix->n = 0;
+}
+
+void hidx_free(HashIndex *ix) {
+    free(ix->slots);
+    free(ix->hashes);
+    hidx_init(ix);
+}
+
+void hidx_copy(HashIndex *dst, const HashIndex *src) {
+    *dst = *src;
+    if (!src->cap) return;
+    dst->slots = (int*)xmalloc((size_t)src->cap*sizeof(*dst->slots));
+    dst->hashes = (unsigned int*)xmalloc((size_t)src->cap*sizeof(*dst->hashes));
+    memcpy(dst->slots, src->slots, (size_t)src->cap*sizeof(*dst->slots));
+    memcpy(dst->hashes, src->hashes, (size_t)src->cap*sizeof(*dst->hashes));
+}
+
+static void hidx_place(HashIndex *ix, unsigned int hash, int pos) {
+    unsigned int mask = (unsigned int)ix->cap-1;
+    unsigned int slot = hash & mask;
+    while (ix->slots[slot]) slot = (slot+1) & mask;
+    ix->slots[slot] = pos+1;
+    ix->hashes[slot] = hash;
+}
+
+static void hidx_resize(HashIndex *ix, int cap) {
+    /* The old table carries the hashes, so the elements need not be revisited. */
+    HashIndex old = *ix;
+    ix->cap = cap;
+    ix->slots = (int*)xmalloc((size_t)cap*sizeof(*ix->slots));
+    ix->hashes = (unsigned int*)xmalloc((size_t)cap*sizeof(*ix->hashes));
+    memset(ix->slots, 0, (size_t)cap*sizeof(*ix->slots));
+    for (int s = 0; s<old.cap; s++) if (old.slots[s]) hidx_place(ix, old.hashes[s], old.slots[s]-1);
+    free(old.slots);
+    free(old.hashes);
+}
+
+void hidx_reserve(HashIndex *ix, int n) {
+    int cap = ix->cap ? ix->cap : 64;
+    while (2*n > cap) cap *= 2;
+    if (cap!=ix->cap) hidx_resize(ix, cap);
+}
+
+void hidx_add(HashIndex *ix, unsigned int hash, int pos) {
+    hidx_reserve(ix, ix->n+1);
+    hidx_place(ix, hash, pos);
+    ix->n++;
+}
+
+int hidx_next(const HashIndex *ix, unsigned int hash, int *slot) {
+    if (!ix->cap) return -1;
+    unsigned int mask = (unsigned int)ix->cap-1;
+    unsigned int s = *slot < 0 ? hash & mask : ((unsigned int)*slot+1) & mask;
+    for (; ix->slots[s]; s = (s+1) & mask) {
+        if (ix->hashes[s]==hash) {
+            *slot = (int)s;
+            return ix->slots[s]-1;
+        }
+    }
+    *slot = (int)s;
+    return -1;
+}
+
+double lb_sqrt(double x) {
+    if (x <= 0.0) return 0.0;
+    if (x != x || x > DBL_MAX) return x;
+    /* Scale by powers of 4 into [0.25, 1), where one starting guess is close for every exponent. */
+    double scale = 1.0;
+    while (x >= 0x1p64) { x *= 0x1p-64; scale *= 0x1p32; }
+    while (x < 0x1p-64) { x *= 0x1p64; scale *= 0x1p-32; }
+    while (x >= 1.0) { x *= 0.25; scale *= 2.0; }
+    while (x < 0.25) { x *= 4.0; scale *= 0.5; }
+    /* (1 + x)/2 is never below sqrt(x), so the steps fall until rounding stops them. */
+    double r = 0.5*(1.0 + x);
+    for (;;) {
+        double next = 0.5*(r + x/r);
+        if (next >= r) break;
+        r = next;
+    }
+    return r * scale;
+}
+
+unsigned long long lb_rng_next(LbRng *r) {
+    unsigned long long z = (r->s += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void lb_rng_seed(LbRng *r, unsigned long long seed, unsigned long long stream) {
+    r->s = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+    (void)lb_rng_next(r);
+}
+
+double lb_rng_unit(LbRng *r) {
+    return (double)(lb_rng_next(r) >> 11) * (1.0/9007199254740992.0);
+}
+
+void lb_rng_fill_unit(LbRng *r, double *out, int n) {
+    for (int i = 0; i<n; i++) out[i] = lb_rng_unit(r);
+}
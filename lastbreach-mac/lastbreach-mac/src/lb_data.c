@@ -100,6 +100,26 @@ void parse_world(World *w, const char *filename, char *src) {
             ps_expect(&ps, TK_RBRACE, "}");
             continue;
         }
+        if (ps_is_ident(&ps, "hydroponics")) {
+            lx_next_token(&ps.lx);
+            ps_expect(&ps, TK_LBRACE, "{");
+            double beds = 0, health = w->hydroponic_health, water = 50.0;
+            while (!ps_is(&ps, TK_RBRACE)) {
+                char *k = ps_expect_ident(&ps, "hydroponics key");
+                ps_expect(&ps, TK_COLON, ":");
+                double v = ps_expect_number(&ps, "number");
+                ps_expect(&ps, TK_SEMI, ";");
+                if (strcmp(k, "beds")==0) beds = v;
+                else if (strcmp(k, "health")==0) health = v;
+                else if (strcmp(k, "water")==0) water = v;
+                free(k);
+            }
+            ps_expect(&ps, TK_RBRACE, "}");
+            if (beds < 0 || beds > 1000000) dief("%s:%d: hydroponics beds out of range", filename, ps.lx.cur.line);
+            /* Crops cycle Tomato/Green bean/Chili/Garlic, matching the sim's produce table. */
+            beds_add(&w->beds, (int)beds, health, water, 4);
+            continue;
+        }
         if (ps_is_ident(&ps, "events")) {
             lx_next_token(&ps.lx);
             ps_expect(&ps, TK_LBRACE, "{");
@@ -110,16 +130,46 @@ void parse_world(World *w, const char *filename, char *src) {
                     if (!ps_is_ident(&ps, "chance")) dief("%s:%d: expected chance", filename, ps.lx.cur.line);
                     lx_next_token(&ps.lx);
                     double ch = ps_expect_percent(&ps, "percent");
+                    int at = -1;
+                    if (ps_is_ident(&ps, "at")) {
+                        lx_next_token(&ps.lx);
+                        at = (int)ps_expect_number(&ps, "tick");
+                        if (at<0 || at>=DAY_TICKS) dief("%s:%d: event tick must be 0..%d", filename, ps.lx.cur.line, DAY_TICKS-1);
+                    }
                     if (ps_is_ident(&ps, "when")) {
                         lx_next_token(&ps.lx);
                         skip_until_semi(&ps);
                     }
                     ps_expect(&ps, TK_SEMI, ";");
                     /*
-                     * Only events consumed by the simulator are persisted.
-                     * Unknown daily events are parsed/ignored for compatibility.
+                     * Breach keeps its dedicated roll (severity depends on shelter
+                     * state); every other name becomes a queued world event that
+                     * fires handlers and event() for that name.
                      */
-                    if (strcmp(ename, "breach")==0) w->events.breach_chance = ch;
+                    if (strcmp(ename, "breach")==0) {
+                        w->events.breach_chance = ch;
+                    } else {
+                        DailyEvent de;
+                        de.id = event_intern(&w->events, ename);
+                        de.chance = ch;
+                        de.tick = at;
+                        VEC_PUSH(w->events.daily, de);
+                    }
+                    free(ename);
+                    continue;
+                }
+                if (ps_is_ident(&ps, "once")) {
+                    lx_next_token(&ps.lx);
+                    char *ename = ps_expect_string(&ps, "event name");
+                    if (!ps_is_ident(&ps, "day")) dief("%s:%d: expected day", filename, ps.lx.cur.line);
+                    lx_next_token(&ps.lx);
+                    int day = (int)ps_expect_number(&ps, "day");
+                    if (!ps_is_ident(&ps, "tick")) dief("%s:%d: expected tick", filename, ps.lx.cur.line);
+                    lx_next_token(&ps.lx);
+                    int tick = (int)ps_expect_number(&ps, "tick");
+                    if (day<0 || tick<0 || tick>=DAY_TICKS) dief("%s:%d: bad once event time", filename, ps.lx.cur.line);
+                    ps_expect(&ps, TK_SEMI, ";");
+                    event_schedule(&w->events, day, tick, event_intern(&w->events, ename), 0);
                     free(ename);
                     continue;
                 }
@@ -158,6 +208,115 @@ void parse_world(World *w, const char *filename, char *src) {
     if (ps_is(&ps, TK_RBRACE)) ps_expect(&ps, TK_RBRACE, "}");
 }
 
+static void skip_catalog_field(Parser *ps) {
+    /* Unknown `key: value;`, `key { ... }` or bare `key;` fields are consumed whole. */
+    char *k = ps_expect_ident(ps, "field");
+    if (ps_is(ps, TK_COLON)) {
+        ps_expect(ps, TK_COLON, ":");
+        while (!ps_is(ps, TK_SEMI) && !ps_is(ps, TK_EOF)) {
+            if (ps_is(ps, TK_LBRACE)) {
+                skip_block(ps);
+                break;
+            }
+            lx_next_token(&ps->lx);
+        }
+        if (ps_is(ps, TK_SEMI)) ps_expect(ps, TK_SEMI, ";");
+    }
+
+    /* Nested object payload for unsupported fields. */
+    else if (ps_is(ps, TK_LBRACE)) {
+        skip_block(ps);
+    }
+
+    /* Bare marker field terminated with semicolon. */
+    else if (ps_is(ps, TK_SEMI)) {
+        ps_expect(ps, TK_SEMI, ";");
+    } else {
+        while (!ps_is(ps, TK_SEMI) && !ps_is(ps, TK_EOF)) lx_next_token(&ps->lx);
+        if (ps_is(ps, TK_SEMI)) ps_expect(ps, TK_SEMI, ";");
+    }
+    free(k);
+}
+
+static void parse_taskdef_body(Parser *ps, TaskDef *td) {
+    while (!ps_is(ps, TK_RBRACE) && !ps_is(ps, TK_EOF)) {
+        /* Keep taskdef parsing permissive: consume known fields, tolerate extras. */
+        if (ps_is_ident(ps, "time")) {
+            lx_next_token(&ps->lx);
+            ps_expect(ps, TK_COLON, ":");
+            int ticks = (int)(ps_expect_number(ps, "ticks")+0.5);
+            ps_expect(ps, TK_SEMI, ";");
+            td->time_ticks = (ticks<=0)?1:ticks;
+            continue;
+        }
+        if (ps_is_ident(ps, "station")) {
+            lx_next_token(&ps->lx);
+            ps_expect(ps, TK_COLON, ":");
+            char *st = ps_expect_ident(ps, "station");
+            ps_expect(ps, TK_SEMI, ";");
+            taskdef_set_station(td, st);
+            continue;
+        }
+        if (ps_is(ps, TK_IDENT)) {
+            skip_catalog_field(ps);
+            continue;
+        }
+        lx_next_token(&ps->lx);
+    }
+}
+
+static void parse_itemdef_body(Parser *ps, ItemRegistry *reg, int id) {
+    while (!ps_is(ps, TK_RBRACE) && !ps_is(ps, TK_EOF)) {
+        if (ps_is_ident(ps, "max_condition")) {
+            lx_next_token(&ps->lx);
+            ps_expect(ps, TK_COLON, ":");
+            reg->items.v[id].max_condition = ps_expect_number(ps, "max_condition");
+            ps_expect(ps, TK_SEMI, ";");
+            continue;
+        }
+        if (ps_is_ident(ps, "shelf_life")) {
+            lx_next_token(&ps->lx);
+            ps_expect(ps, TK_COLON, ":");
+            int line = ps->lx.cur.line;
+            double days = ps_expect_number(ps, "shelf_life");
+            if (days < 0) dief("%s:%d: shelf_life must be >= 0 days", ps->filename, line);
+            reg->items.v[id].shelf_life_days = (int)days;
+            ps_expect(ps, TK_SEMI, ";");
+            continue;
+        }
+        if (ps_is_ident(ps, "stackable")) {
+            lx_next_token(&ps->lx);
+            ps_expect(ps, TK_COLON, ":");
+            char *v = ps_expect_ident(ps, "true or false");
+            reg->items.v[id].stackable = strcmp(v, "false")!=0;
+            free(v);
+            ps_expect(ps, TK_SEMI, ";");
+            continue;
+        }
+        if (ps_is_ident(ps, "tags")) {
+            /* Tags accumulate across definitions, so a catalog extends data/items.txt. */
+            lx_next_token(&ps->lx);
+            ps_expect(ps, TK_COLON, ":");
+            ps_expect(ps, TK_LBRACK, "[");
+            while (!ps_is(ps, TK_RBRACK)) {
+                char *tag = ps_expect_string(ps, "tag");
+                item_reg_add_tag(reg, id, tag);
+                free(tag);
+                if (!ps_is(ps, TK_COMMA)) break;
+                ps_expect(ps, TK_COMMA, ",");
+            }
+            ps_expect(ps, TK_RBRACK, "]");
+            ps_expect(ps, TK_SEMI, ";");
+            continue;
+        }
+        if (ps_is(ps, TK_IDENT)) {
+            skip_catalog_field(ps);
+            continue;
+        }
+        lx_next_token(&ps->lx);
+    }
+}
+
 /** parse_catalog function. */
 void parse_catalog(Catalog *cat, const char *filename, char *src) {
     Parser ps;
@@ -169,66 +328,213 @@ void parse_catalog(Catalog *cat, const char *filename, char *src) {
             TaskDef *td = cat_get_or_add_task(cat, tname);
             free(tname);
             ps_expect(&ps, TK_LBRACE, "{");
-            while (!ps_is(&ps, TK_RBRACE)) {
-                /* Keep taskdef parsing permissive: consume known fields, tolerate extras. */
-                if (ps_is_ident(&ps, "time")) {
-                    lx_next_token(&ps.lx);
-                    ps_expect(&ps, TK_COLON, ":");
-                    int ticks = (int)(ps_expect_number(&ps, "ticks")+0.5);
-                    ps_expect(&ps, TK_SEMI, ";");
-                    td->time_ticks = (ticks<=0)?1:ticks;
-                    continue;
-                }
-                if (ps_is_ident(&ps, "station")) {
-                    lx_next_token(&ps.lx);
-                    ps_expect(&ps, TK_COLON, ":");
-                    char *st = ps_expect_ident(&ps, "station");
-                    ps_expect(&ps, TK_SEMI, ";");
-                    if (td->station) free(td->station);
-                    td->station = st;
-                    continue;
-                }
-                if (ps_is(&ps, TK_IDENT)) {
-                    char *k = ps_expect_ident(&ps, "field");
-                    if (ps_is(&ps, TK_COLON)) {
-                        ps_expect(&ps, TK_COLON, ":");
-                        while (!ps_is(&ps, TK_SEMI) && !ps_is(&ps, TK_EOF)) {
-                            if (ps_is(&ps, TK_LBRACE)) {
-                                skip_block(&ps);
-                                break;
-                            }
-                            lx_next_token(&ps.lx);
-                        }
-                        if (ps_is(&ps, TK_SEMI)) ps_expect(&ps, TK_SEMI, ";");
-                    }
-
-                    /* Nested object payload for unsupported fields. */
-                    else if (ps_is(&ps, TK_LBRACE)) {
-                        skip_block(&ps);
-                    }
-
-                    /* Bare marker field terminated with semicolon. */
-                    else if (ps_is(&ps, TK_SEMI)) {
-                        ps_expect(&ps, TK_SEMI, ";");
-                    } else {
-                        while (!ps_is(&ps, TK_SEMI) && !ps_is(&ps, TK_EOF)) lx_next_token(&ps.lx);
-                        if (ps_is(&ps, TK_SEMI)) ps_expect(&ps, TK_SEMI, ";");
-                    }
-                    free(k);
-                    continue;
-                }
-                lx_next_token(&ps.lx);
-            }
+            parse_taskdef_body(&ps, td);
             ps_expect(&ps, TK_RBRACE, "}");
             continue;
         }
         if (ps_is_ident(&ps, "itemdef")) {
             lx_next_token(&ps.lx);
             char *nm = ps_expect_string(&ps, "item name");
+            int id = item_reg_get_or_add(&cat->items, nm);
             free(nm);
-            if (ps_is(&ps, TK_LBRACE)) skip_block(&ps);
+            if (ps_is(&ps, TK_LBRACE)) {
+                ps_expect(&ps, TK_LBRACE, "{");
+                parse_itemdef_body(&ps, &cat->items, id);
+                ps_expect(&ps, TK_RBRACE, "}");
+            }
             continue;
         }
         lx_next_token(&ps.lx);
     }
 }
+
+/* ---- Lazy catalog: byte-level first pass ---- */
+
+typedef struct {
+    const char *filename;
+    char *src;
+    size_t len;
+    size_t pos;
+    int line;
+} CatScan;
+
+static int scan_skip_trivia(CatScan *sc) {
+    /* Same comment forms as the lexer; returns the next significant byte or 0. */
+    while (sc->pos < sc->len) {
+        char c = sc->src[sc->pos];
+        if (c=='\n') {
+            sc->line++;
+            sc->pos++;
+        } else if (isspace((unsigned char)c)) {
+            sc->pos++;
+        } else if (c=='#' || (c=='/' && sc->pos+1<sc->len && sc->src[sc->pos+1]=='/')) {
+            while (sc->pos < sc->len && sc->src[sc->pos]!='\n') sc->pos++;
+        } else if (c=='/' && sc->pos+1<sc->len && sc->src[sc->pos+1]=='*') {
+            int line0 = sc->line;
+            sc->pos += 2;
+            while (sc->pos+1 < sc->len && !(sc->src[sc->pos]=='*' && sc->src[sc->pos+1]=='/')) {
+                if (sc->src[sc->pos]=='\n') sc->line++;
+                sc->pos++;
+            }
+            if (sc->pos+1 >= sc->len) dief("%s:%d: unterminated block comment", sc->filename, line0);
+            sc->pos += 2;
+        } else {
+            return (unsigned char)c;
+        }
+    }
+    return 0;
+}
+
+static void scan_string(CatScan *sc) {
+    /* Called on the opening quote; leaves pos after the closing quote. */
+    int line0 = sc->line;
+    sc->pos++;
+    while (sc->pos < sc->len && sc->src[sc->pos]!='"') {
+        if (sc->src[sc->pos]=='\\') sc->pos++;
+        else if (sc->src[sc->pos]=='\n') sc->line++;
+        sc->pos++;
+    }
+    if (sc->pos >= sc->len) dief("%s:%d: unterminated string", sc->filename, line0);
+    sc->pos++;
+}
+
+static size_t scan_block_end(CatScan *sc) {
+    /*
+     * Called just after '{'; returns the offset of the matching '}'.
+     * This is the hot loop of the lazy pass, so it only stops on bytes that
+     * can change brace depth or line count instead of lexing tokens.
+     */
+    const char *s = sc->src;
+    size_t n = sc->len;
+    int depth = 1;
+    int line0 = sc->line;
+    while (sc->pos < n) {
+        switch (s[sc->pos]) {
+        case '\n':
+            sc->line++;
+            sc->pos++;
+            break;
+        case '"':
+            scan_string(sc);
+            break;
+        case '#':
+        case '/': {
+            /* A lone '/' is not trivia; step over it so the loop progresses. */
+            size_t before = sc->pos;
+            (void)scan_skip_trivia(sc);
+            if (sc->pos==before) sc->pos++;
+            break;
+        }
+        case '{':
+            depth++;
+            sc->pos++;
+            break;
+        case '}':
+            if (--depth==0) return sc->pos++;
+            sc->pos++;
+            break;
+        default:
+            sc->pos++;
+            break;
+        }
+    }
+    dief("%s:%d: expected }", sc->filename, line0);
+    return 0;
+}
+
+static int scan_keyword(CatScan *sc, const char *kw) {
+    size_t n = strlen(kw);
+    if (sc->pos+n > sc->len || strncmp(&sc->src[sc->pos], kw, n)!=0) return 0;
+    if (sc->pos+n < sc->len && (isalnum((unsigned char)sc->src[sc->pos+n]) || sc->src[sc->pos+n]=='_')) return 0;
+    sc->pos += n;
+    return 1;
+}
+
+/** parse_catalog_lazy function. */
+void parse_catalog_lazy(Catalog *cat, const char *filename, char *src) {
+    CatScan sc;
+    char *fname = xstrdup(filename);
+    /* Spans point into src, so the catalog keeps both buffers alive. */
+    VEC_PUSH(cat->sources, src);
+    VEC_PUSH(cat->sources, fname);
+    sc.filename = fname;
+    sc.src = src;
+    sc.len = strlen(src);
+    sc.pos = 0;
+    sc.line = 1;
+
+    for (;;) {
+        int c = scan_skip_trivia(&sc);
+        if (c==0) break;
+        if (c=='"') {
+            scan_string(&sc);
+            continue;
+        }
+        if (!isalpha(c) && c!='_') {
+            sc.pos++;
+            continue;
+        }
+        int is_task = scan_keyword(&sc, "taskdef");
+        if (!is_task && !scan_keyword(&sc, "itemdef")) {
+            while (sc.pos < sc.len && (isalnum((unsigned char)sc.src[sc.pos]) || sc.src[sc.pos]=='_')) sc.pos++;
+            continue;
+        }
+        if (scan_skip_trivia(&sc)!='"') dief("%s:%d: expected %s", fname, sc.line, is_task ? "task name" : "item name");
+        size_t name0 = sc.pos+1;
+        scan_string(&sc);
+        size_t name1 = sc.pos-1;
+        char saved = src[name1];
+        if (!is_task) {
+            src[name1] = 0;
+            int id = item_reg_get_or_add(&cat->items, &src[name0]);
+            src[name1] = saved;
+            if (scan_skip_trivia(&sc)!='{') continue;
+            sc.pos++;
+            int body_line = sc.line;
+            size_t body0 = sc.pos;
+            size_t body1 = scan_block_end(&sc);
+            /* Item bodies are a few fields each; parse them now so tags exist at bind time. */
+            Parser ps;
+            ps_init_span(&ps, fname, &src[body0], body1-body0, body_line);
+            parse_itemdef_body(&ps, &cat->items, id);
+            if (!ps_is(&ps, TK_EOF)) dief("%s:%d: unexpected } in itemdef", fname, ps.lx.cur.line);
+            continue;
+        }
+        if (scan_skip_trivia(&sc)!='{') dief("%s:%d: expected {", fname, sc.line);
+        sc.pos++;
+        int body_line = sc.line;
+        size_t body0 = sc.pos;
+        size_t body1 = scan_block_end(&sc);
+
+        src[name1] = 0;
+        TaskDef *td = cat_get_or_add_task(cat, &src[name0]);
+        src[name1] = saved;
+
+        CatalogSpan sp;
+        sp.filename = fname;
+        sp.start = &src[body0];
+        sp.len = body1-body0;
+        sp.line = body_line;
+        sp.next = -1;
+        VEC_PUSH(cat->spans, sp);
+        /* Later definitions of the same task override earlier ones, as in eager mode. */
+        if (td->lazy_tail >= 0) cat->spans.v[td->lazy_tail].next = cat->spans.n-1;
+        else td->lazy_head = cat->spans.n-1;
+        td->lazy_tail = cat->spans.n-1;
+    }
+}
+
+/** Parses the pending body spans of one task, in definition order. */
+void catalog_resolve_task(Catalog *cat, TaskDef *td) {
+    int s = td->lazy_head;
+    /* Clear first so a body that fails is not re-parsed on every lookup. */
+    td->lazy_head = -1;
+    td->lazy_tail = -1;
+    for (; s >= 0; s = cat->spans.v[s].next) {
+        CatalogSpan *sp = &cat->spans.v[s];
+        Parser ps;
+        ps_init_span(&ps, sp->filename, sp->start, sp->len, sp->line);
+        parse_taskdef_body(&ps, td);
+        if (!ps_is(&ps, TK_EOF)) dief("%s:%d: unexpected } in taskdef", sp->filename, ps.lx.cur.line);
+    }
+}
@@ -4,75 +4,47 @@
  *
  * Module: Built-in default catalog entries used when no .lbc catalog file is supplied.
  *
+ * The entries themselves live in the generated lb_canon_tables.c (see
+ * tools/lb_tablegen.c); edit data/tasks.txt rather than this file.
+ *
  * This file is part of the modularized LastBreach DSL runner (C99, no third-party
  * libraries). The goal here is readability: small functions, clear names, and
  * comments that explain *why* a piece of logic exists.
  */
 
 
-/** Populates a catalog with a reasonable default task list. */
-void seed_default_catalog(Catalog *cat) {
-    struct {
-        const char *name;
-        int t;
-        const char *station;
-    }
-    defs[] = {
-        {"Reading", 1, "lounge"},
-        {"Eating", 1, "kitchen"},
-        {"Cooking", 2, "kitchen"},
-        {"Meal prep", 2, "kitchen"},
-        {"Food preservation", 2, "kitchen"},
-        {"Sleeping", 4, "cot"},
-        {"Resting", 2, "cot"},
-        {"Socializing", 1, "lounge"},
-        {"Talking", 1, "lounge"},
-        {"Watching", 1, "lounge"},
-        {"Computer work", 2, "comms"},
-        {"Playing video games", 1, "lounge"},
-        {"Playing guitar", 1, "lounge"},
-        {"Knitting", 2, "craft"},
-        {"Crocheting", 2, "craft"},
-        {"Sewing", 2, "craft"},
-        {"Crafting", 2, "workshop"},
-        {"Painting", 2, "craft"},
-        {"Drawing", 1, "craft"},
-        {"Gardening", 2, "hydroponics"},
-        {"Watering plants", 1, "hydroponics"},
-        {"Hydroponics maintenance", 2, "hydroponics"},
-        {"Aquarium maintenance", 2, "aquarium"},
-        {"Fishing", 3, "outside"},
-        {"Fish cleaning", 1, "kitchen"},
-        {"Swimming", 2, "outside"},
-        {"Scouting outside", 3, "outside"},
-        {"Telescope use", 1, "outside"},
-        {"Defensive shooting", 3, "defense"},
-        {"Defensive combat", 3, "defense"},
-        {"Gun smithing", 2, "workshop"},
-        {"Electronics repair", 2, "workshop"},
-        {"Electrical diagnostics", 2, "power"},
-        {"Soldering", 2, "workshop"},
-        {"Power management", 2, "power"},
-        {"Radio communication", 1, "comms"},
-        {"Tending a fire", 2, "heat"},
-        {"Heating", 2, "heat"},
-        {"General shelter chores", 2, "chores"},
-        {"Maintenance chores", 2, "workshop"},
-        {"Cleaning", 2, "wash"},
-        {"First aid", 1, "med"},
-        {"Medical treatment", 2, "med"},
-        {"Water collection", 2, "outside"},
-        {"Water filtration", 2, "wash"},
-    }
-    ;
-    /* Keep this list aligned with data/tasks.txt and test expectations. */
-    int n = (int)(sizeof(defs)/sizeof(defs[0]));
-    for (int i = 0; i<n; i++) {
-        TaskDef *t = cat_get_or_add_task(cat, defs[i].name);
-        t->time_ticks = defs[i].t;
-        if (defs[i].station) {
-            if (t->station) free(t->station);
-            t->station = xstrdup(defs[i].station);
+static int cmp_canon_task(const void *key, const void *row) {
+    return strcmp((const char*)key, ((const CanonTask*)row)->name);
+}
+
+static int cmp_canon_item(const void *key, const void *row) {
+    return strcmp((const char*)key, ((const CanonItem*)row)->name);
+}
+
+/** Looks up a canonical task; the generated table is sorted by name. */
+const CanonTask *canon_task_find(const char *name) {
+    return (const CanonTask*)bsearch(name, kCanonTasks, (size_t)kCanonTaskCount, sizeof(kCanonTasks[0]), cmp_canon_task);
+}
+
+/** Looks up a canonical item by name. */
+const CanonItem *canon_item_find(const char *name) {
+    return (const CanonItem*)bsearch(name, kCanonItems, (size_t)kCanonItemCount, sizeof(kCanonItems[0]), cmp_canon_item);
+}
+
+static void seed_default_items(ItemRegistry *reg) {
+    for (int i = 0; i<kCanonItemCount; i++) {
+        int id = item_reg_get_or_add(reg, kCanonItems[i].name);
+        reg->items.v[id].shelf_life_days = kCanonItems[i].shelf_life_days;
+        /* Canonical tag bits are re-interned, since the registry may already hold tags. */
+        for (int t = 0; t<kCanonItemTagCount; t++) {
+            if (kCanonItems[i].tags & ((ItemTagSet)1 << t)) item_reg_add_tag(reg, id, kCanonItemTags[t]);
         }
     }
 }
+
+/** Populates a catalog with the canonical task and item lists from data/. */
+void seed_default_catalog(Catalog *cat) {
+    /* Names, hashes and stations are precomputed, so this only fills the index. */
+    for (int i = 0; i<kCanonTaskCount; i++) cat_add_canon_task(cat, &kCanonTasks[i]);
+    seed_default_items(&cat->items);
+}
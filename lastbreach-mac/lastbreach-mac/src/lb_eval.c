@@ -40,26 +40,41 @@ int truthy(double v) {
 }
 double eval_expr(EvalCtx *ctx, Expr *e);
 static double eval_call(EvalCtx *ctx, CallExpr *c) {
-    const char *name = c->name;
     /*
      * Built-in functions are intentionally tiny and side-effect free.
      * Unknown calls resolve to 0.0 so scripts remain robust under partial support.
      */
-    if ((strcmp(name, "stock")==0)||(strcmp(name, "has")==0)||(strcmp(name, "cond")==0)||(strcmp(name, "event")==0)) {
-        if (c->args.n<1) return 0.0;
-        Expr *a0 = c->args.v[0];
-        if (a0->kind!=EX_STRING) return 0.0;
-        const char *s = a0->u.str;
-        if (strcmp(name, "stock")==0) return inv_stock(&ctx->w->inv, s);
-        if (strcmp(name, "has")==0) return inv_has(&ctx->w->inv, s)?1.0:0.0;
-        if (strcmp(name, "cond")==0) return inv_cond(&ctx->w->inv, s);
-        if (strcmp(name, "event")==0) {
-            if (strcmp(s, "breach")==0) return ctx->ev_breach?1.0:0.0;
-            if (strcmp(s, "overnight_threat_check")==0) return ctx->ev_overnight?1.0:0.0;
-            return 0.0;
+    if (c->builtin==CALL_UNKNOWN || c->args.n<1) return 0.0;
+    Expr *a0 = c->args.v[0];
+    if (a0->kind!=EX_STRING) return 0.0;
+    const char *s = a0->u.str;
+    Inventory *inv = &ctx->w->inv;
+    ItemHandle h = -1;
+    if (c->builtin==CALL_STOCK || c->builtin==CALL_HAS || c->builtin==CALL_COND) {
+        /* Bound calls skip hashing; the hash check catches a handle from another inventory. */
+        h = c->item;
+        if (h < 0 || h >= inv->items.n || inv->items.v[h].hash!=c->item_hash) h = inv_lookup(inv, s);
+    }
+    switch (c->builtin) {
+    case CALL_STOCK:
+        return inv_stock_h(inv, h);
+    case CALL_STOCK_TAG:
+        return inv_stock_tag(inv, s);
+    case CALL_HAS:
+        return inv_stock_h(inv, h) > 0.0 ? 1.0 : 0.0;
+    case CALL_COND:
+        return inv_cond_h(inv, h);
+    case CALL_EVENT:
+        if (strcmp(s, "breach")==0) return ctx->ev_breach?1.0:0.0;
+        if (strcmp(s, "overnight_threat_check")==0) return ctx->ev_overnight?1.0:0.0;
+        for (int i = 0; i<ctx->w->events.now.n; i++) {
+            const EventFiring *f = &ctx->w->events.now.v[i];
+            if (f->id!=EVENT_BREACH && f->id!=EVENT_OVERNIGHT && strcmp(ctx->w->events.names.v[f->id], s)==0) return 1.0;
         }
+        return 0.0;
+    default:
+        return 0.0;
     }
-    return 0.0;
 }
 static double eval_var(EvalCtx *ctx, const char *v) {
     /*
@@ -143,3 +158,151 @@ double eval_expr(EvalCtx *ctx, Expr *e) {
         return 0.0;
     }
 }
+
+static void bind_expr_items(Expr *e, Inventory *inv) {
+    if (!e) return;
+    switch (e->kind) {
+    case EX_CALL: {
+        CallExpr *c = &e->u.call;
+        int item_call = c->builtin==CALL_STOCK || c->builtin==CALL_HAS || c->builtin==CALL_COND;
+        if (item_call && c->args.n>=1 && c->args.v[0]->kind==EX_STRING) {
+            /* Copies of one world share the script; rebinding them must not write. */
+            ItemHandle h = inv_handle(inv, c->args.v[0]->u.str);
+            if (c->item != h) {
+                c->item = h;
+                c->item_hash = inv->items.v[h].hash;
+            }
+        }
+        for (int i = 0; i<c->args.n; i++) bind_expr_items(c->args.v[i], inv);
+        break;
+    }
+    case EX_UNARY:
+        bind_expr_items(e->u.un.a, inv);
+        break;
+    case EX_BINARY:
+        bind_expr_items(e->u.bin.a, inv);
+        bind_expr_items(e->u.bin.b, inv);
+        break;
+    default:
+        break;
+    }
+}
+
+static void bind_stmt_items(Stmt *st, Inventory *inv);
+
+static void bind_stmts_items(VecStmtPtr *v, Inventory *inv) {
+    for (int i = 0; i<v->n; i++) bind_stmt_items(v->v[i], inv);
+}
+
+static void bind_stmt_items(Stmt *st, Inventory *inv) {
+    if (!st) return;
+    switch (st->kind) {
+    case ST_LET:
+        bind_expr_items(st->u.let_.value, inv);
+        break;
+    case ST_IF:
+        bind_expr_items(st->u.if_.cond, inv);
+        bind_stmts_items(&st->u.if_.then_stmts, inv);
+        bind_stmts_items(&st->u.if_.else_stmts, inv);
+        break;
+    case ST_TASK:
+        bind_expr_items(st->u.task.for_ticks, inv);
+        bind_expr_items(st->u.task.priority, inv);
+        break;
+    case ST_SET:
+        bind_expr_items(st->u.set_.rhs, inv);
+        break;
+    default:
+        break;
+    }
+}
+
+void expr_bind_items(Expr *e, Inventory *inv) {
+    bind_expr_items(e, inv);
+}
+
+/** Binds every literal item name in a character's script to a handle in `inv`. */
+void character_bind_items(Character *ch, Inventory *inv) {
+    for (int i = 0; i<ch->thresholds.n; i++) {
+        bind_expr_items(ch->thresholds.v[i].cond, inv);
+        bind_stmt_items(ch->thresholds.v[i].action, inv);
+    }
+    for (int i = 0; i<ch->blocks.n; i++) bind_stmts_items(&ch->blocks.v[i].stmts, inv);
+    for (int i = 0; i<ch->rules.n; i++) bind_stmts_items(&ch->rules.v[i].stmts, inv);
+    for (int i = 0; i<ch->on_events.n; i++) {
+        bind_expr_items(ch->on_events.v[i].when_cond, inv);
+        bind_stmts_items(&ch->on_events.v[i].stmts, inv);
+    }
+}
+
+static void reads_expr(const Expr *e, const Inventory *inv, VecInt *items, ItemTagSet *tags) {
+    if (!e) return;
+    switch (e->kind) {
+    case EX_CALL: {
+        const CallExpr *c = &e->u.call;
+        if (c->args.n>=1 && c->args.v[0]->kind==EX_STRING) {
+            const char *s = c->args.v[0]->u.str;
+            if (c->builtin==CALL_STOCK || c->builtin==CALL_HAS || c->builtin==CALL_COND) {
+                ItemHandle h = inv_lookup(inv, s);
+                if (h >= 0) VEC_PUSH(*items, h);
+            } else if (c->builtin==CALL_STOCK_TAG && inv->reg) {
+                int t = item_reg_tag_id(inv->reg, s);
+                if (t >= 0) *tags |= 1ULL << t;
+            }
+        }
+        for (int i = 0; i<c->args.n; i++) reads_expr(c->args.v[i], inv, items, tags);
+        break;
+    }
+    case EX_UNARY:
+        reads_expr(e->u.un.a, inv, items, tags);
+        break;
+    case EX_BINARY:
+        reads_expr(e->u.bin.a, inv, items, tags);
+        reads_expr(e->u.bin.b, inv, items, tags);
+        break;
+    default:
+        break;
+    }
+}
+
+static void reads_stmt(const Stmt *st, const Inventory *inv, VecInt *items, ItemTagSet *tags);
+
+static void reads_stmts(const VecStmtPtr *v, const Inventory *inv, VecInt *items, ItemTagSet *tags) {
+    for (int i = 0; i<v->n; i++) reads_stmt(v->v[i], inv, items, tags);
+}
+
+static void reads_stmt(const Stmt *st, const Inventory *inv, VecInt *items, ItemTagSet *tags) {
+    if (!st) return;
+    switch (st->kind) {
+    case ST_LET:
+        reads_expr(st->u.let_.value, inv, items, tags);
+        break;
+    case ST_IF:
+        reads_expr(st->u.if_.cond, inv, items, tags);
+        reads_stmts(&st->u.if_.then_stmts, inv, items, tags);
+        reads_stmts(&st->u.if_.else_stmts, inv, items, tags);
+        break;
+    case ST_TASK:
+        reads_expr(st->u.task.for_ticks, inv, items, tags);
+        reads_expr(st->u.task.priority, inv, items, tags);
+        break;
+    case ST_SET:
+        reads_expr(st->u.set_.rhs, inv, items, tags);
+        break;
+    default:
+        break;
+    }
+}
+
+void character_stock_reads(const Character *ch, const Inventory *inv, VecInt *items, ItemTagSet *tags) {
+    for (int i = 0; i<ch->thresholds.n; i++) {
+        reads_expr(ch->thresholds.v[i].cond, inv, items, tags);
+        reads_stmt(ch->thresholds.v[i].action, inv, items, tags);
+    }
+    for (int i = 0; i<ch->blocks.n; i++) reads_stmts(&ch->blocks.v[i].stmts, inv, items, tags);
+    for (int i = 0; i<ch->rules.n; i++) reads_stmts(&ch->rules.v[i].stmts, inv, items, tags);
+    for (int i = 0; i<ch->on_events.n; i++) {
+        reads_expr(ch->on_events.v[i].when_cond, inv, items, tags);
+        reads_stmts(&ch->on_events.v[i].stmts, inv, items, tags);
+    }
+}
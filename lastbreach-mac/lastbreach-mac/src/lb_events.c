@@ -0,0 +1,114 @@
+#include "lastbreach.h"
+/**
+ * lb_events.c
+ *
+ * Module: Timed world events (interned names + a firing queue).
+ *
+ * Event names are interned once so handlers and event() queries compare small
+ * integer ids. Firings wait in a binary min-heap keyed by (day, tick, seq);
+ * a tick with nothing due costs a single comparison against the heap top, no
+ * matter how many event types the world declares.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+
+void events_init(WorldEvents *ev) {
+    VEC_INIT(ev->names);
+    VEC_INIT(ev->daily);
+    VEC_INIT(ev->queue);
+    VEC_INIT(ev->now);
+    ev->seq = 0;
+}
+
+void events_free(WorldEvents *ev) {
+    for (int i = 0; i<ev->names.n; i++) free(ev->names.v[i]);
+    VEC_FREE(ev->names);
+    VEC_FREE(ev->daily);
+    VEC_FREE(ev->queue);
+    VEC_FREE(ev->now);
+}
+
+void events_copy(WorldEvents *dst, const WorldEvents *src) {
+    *dst = *src;
+    VEC_COPY(dst->names, src->names);
+    for (int i = 0; i<src->names.n; i++) dst->names.v[i] = xstrdup(src->names.v[i]);
+    VEC_COPY(dst->daily, src->daily);
+    VEC_COPY(dst->queue, src->queue);
+    VEC_COPY(dst->now, src->now);
+}
+
+int event_find(const WorldEvents *ev, const char *name) {
+    /* Worlds declare a handful to a few dozen events; a scan beats a hash here. */
+    for (int i = 0; i<ev->names.n; i++) {
+        if (strcmp(ev->names.v[i], name)==0) return i;
+    }
+    return -1;
+}
+
+int event_intern(WorldEvents *ev, const char *name) {
+    int id = event_find(ev, name);
+    if (id >= 0) return id;
+    VEC_PUSH(ev->names, xstrdup(name));
+    return ev->names.n-1;
+}
+
+static int firing_before(const EventFiring *a, const EventFiring *b) {
+    if (a->day!=b->day) return a->day < b->day;
+    if (a->tick!=b->tick) return a->tick < b->tick;
+    return a->seq < b->seq;
+}
+
+static int firing_due(const EventFiring *f, int day, int tick) {
+    return f->day < day || (f->day==day && f->tick <= tick);
+}
+
+void event_schedule(WorldEvents *ev, int day, int tick, int id, int level) {
+    EventFiring f;
+    f.day = day;
+    f.tick = tick;
+    f.seq = ev->seq++;
+    f.id = id;
+    f.level = level;
+    VEC_PUSH(ev->queue, f);
+    /* Sift up. */
+    EventFiring *q = ev->queue.v;
+    int i = ev->queue.n-1;
+    while (i>0) {
+        int parent = (i-1)/2;
+        if (!firing_before(&q[i], &q[parent])) break;
+        EventFiring t = q[i];
+        q[i] = q[parent];
+        q[parent] = t;
+        i = parent;
+    }
+}
+
+static EventFiring event_pop(WorldEvents *ev) {
+    EventFiring *q = ev->queue.v;
+    EventFiring top = q[0];
+    q[0] = q[--ev->queue.n];
+    /* Sift down. */
+    int n = ev->queue.n, i = 0;
+    for (;;) {
+        int l = 2*i+1, r = l+1, m = i;
+        if (l<n && firing_before(&q[l], &q[m])) m = l;
+        if (r<n && firing_before(&q[r], &q[m])) m = r;
+        if (m==i) break;
+        EventFiring t = q[i];
+        q[i] = q[m];
+        q[m] = t;
+        i = m;
+    }
+    return top;
+}
+
+int event_pop_due(WorldEvents *ev, int day, int tick) {
+    ev->now.n = 0;
+    while (ev->queue.n>0 && firing_due(&ev->queue.v[0], day, tick)) {
+        VEC_PUSH(ev->now, event_pop(ev));
+    }
+    return ev->now.n;
+}
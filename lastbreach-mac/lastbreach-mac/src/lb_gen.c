@@ -0,0 +1,291 @@
+#include "lastbreach.h"
+/**
+ * lb_gen.c
+ *
+ * Module: Deterministic synthetic scenario generator (catalog, world and
+ * character scripts) used for lexer/parser/scheduler/simulation scaling runs.
+ *
+ * Only constructs accepted by the parsers in this tree are emitted. Each output
+ * kind draws from its own seeded stream, so e.g. growing the catalog does not
+ * change the generated characters.
+ */
+
+/* Canonical items the simulation reacts to; mixed into generated worlds and scripts. */
+static const char *kGenStaples[] = {
+    "Food", "Water", "Seeds", "Soil", "Plant", "Fertilizer", "Hydroponic planter",
+    "Ammunition", "Rifle", "Firewood", "Fuel can", "Water filter", "Bucket",
+    "Fishing rod", "Fishing hooks", "Bait", "First-aid box", "Medical box", "Solder wire"
+};
+
+static const char *kGenTasks[] = {
+    "Eating", "Resting", "Sleeping", "Cooking", "Meal prep", "Water filtration",
+    "Water collection", "Watering plants", "Hydroponics maintenance", "Maintenance chores",
+    "General shelter chores", "Cleaning", "Reading", "Talking", "Socializing",
+    "Defensive combat", "Defensive shooting", "Fishing", "Fish cleaning", "Tending a fire",
+    "Power management", "First aid", "Medical treatment"
+};
+
+static const char *kGenVitals[] = {
+    "char.hunger", "char.hydration", "char.fatigue", "char.morale", "char.injury", "char.illness"
+};
+
+static const char *kGenShelter[] = {
+    "shelter.temp_c", "shelter.power", "shelter.water_safe", "shelter.water_raw",
+    "shelter.structure", "shelter.contamination", "shelter.signature"
+};
+
+#define GEN_COUNT(a) ((int)(sizeof(a)/sizeof((a)[0])))
+
+typedef LbRng GenRng;
+
+static unsigned long long gen_next(GenRng *r) {
+    return lb_rng_next(r);
+}
+
+static int gen_int(GenRng *r, int lo, int hi) {
+    /* Inclusive range [lo, hi]. */
+    if (hi <= lo) return lo;
+    return lo + (int)(gen_next(r) % (unsigned long long)(hi-lo+1));
+}
+
+static void gen_seed(GenRng *r, unsigned long long seed, unsigned long long stream) {
+    lb_rng_seed(r, seed, stream);
+}
+
+/** Fills in the default sizes (roughly the hand-written sample scenario). */
+void gen_params_default(GenParams *p) {
+    memset(p, 0, sizeof(*p));
+    p->seed = 1;
+    p->taskdefs = 20;
+    p->itemdefs = 20;
+    p->stations = 12;
+    p->inventory = 25;
+    p->thresholds = 4;
+    p->blocks = 4;
+    p->rules = 2;
+    p->on_events = 1;
+    p->stmts = 3;
+    p->if_depth = 2;
+    p->lets = 1;
+}
+
+static void gen_indent(FILE *out, int depth) {
+    for (int i = 0; i<depth; i++) fputs("  ", out);
+}
+
+static void gen_task_name(GenRng *r, const GenParams *p, char *buf, size_t n) {
+    /* Favor canonical tasks so scripts exercise real task effects. */
+    if (p->taskdefs > 0 && gen_int(r, 0, 3)==0) snprintf(buf, n, "Gen task %05d", gen_int(r, 0, p->taskdefs-1));
+    else snprintf(buf, n, "%s", kGenTasks[gen_int(r, 0, GEN_COUNT(kGenTasks)-1)]);
+}
+
+static void gen_item_name(GenRng *r, const GenParams *p, char *buf, size_t n) {
+    if (p->itemdefs > 0 && gen_int(r, 0, 2)==0) snprintf(buf, n, "Gen item %05d", gen_int(r, 0, p->itemdefs-1));
+    else snprintf(buf, n, "%s", kGenStaples[gen_int(r, 0, GEN_COUNT(kGenStaples)-1)]);
+}
+
+static void gen_atom(FILE *out, GenRng *r, const GenParams *p, int visible_lets) {
+    static const char *kCmp[] = {"<", "<=", ">", ">=", "==", "!="};
+    char item[64];
+    switch (gen_int(r, 0, visible_lets > 0 ? 5 : 4)) {
+    case 0:
+        fprintf(out, "%s %s %d", kGenVitals[gen_int(r, 0, GEN_COUNT(kGenVitals)-1)], kCmp[gen_int(r, 0, 3)], gen_int(r, 5, 95));
+        break;
+    case 1:
+        fprintf(out, "%s %s %d", kGenShelter[gen_int(r, 0, GEN_COUNT(kGenShelter)-1)], kCmp[gen_int(r, 0, 3)], gen_int(r, 0, 80));
+        break;
+    case 2:
+        gen_item_name(r, p, item, sizeof(item));
+        fprintf(out, "stock(\"%s\") %s %d", item, kCmp[gen_int(r, 0, 3)], gen_int(r, 0, 8));
+        break;
+    case 3:
+        gen_item_name(r, p, item, sizeof(item));
+        fprintf(out, "%shas(\"%s\")", gen_int(r, 0, 3)==0 ? "not " : "", item);
+        break;
+    case 4:
+        fprintf(out, "tick %s %d", kCmp[gen_int(r, 0, 5)], gen_int(r, 0, DAY_TICKS-1));
+        break;
+    default:
+        fprintf(out, "g%d %s %d", gen_int(r, 0, visible_lets-1), kCmp[gen_int(r, 0, 3)], gen_int(r, 0, 100));
+        break;
+    }
+}
+
+static void gen_cond(FILE *out, GenRng *r, const GenParams *p, int visible_lets) {
+    int atoms = gen_int(r, 1, 3);
+    for (int i = 0; i<atoms; i++) {
+        if (i > 0) fputs(gen_int(r, 0, 1) ? " and " : " or ", out);
+        int paren = atoms > 1 && gen_int(r, 0, 3)==0;
+        if (paren) fputc('(', out);
+        gen_atom(out, r, p, visible_lets);
+        if (paren) fputc(')', out);
+    }
+}
+
+static void gen_task_stmt(FILE *out, GenRng *r, const GenParams *p) {
+    char task[64];
+    gen_task_name(r, p, task, sizeof(task));
+    fprintf(out, "task \"%s\" for %dt priority %d;\n", task, gen_int(r, 1, 4), gen_int(r, 10, 99));
+}
+
+static void gen_body(FILE *out, GenRng *r, const GenParams *p, int indent, int depth, int *lets) {
+    /*
+     * One body = `lets` bindings, `stmts` statements, and a chain of nested
+     * ifs `depth` levels deep. The chain keeps output size linear in depth.
+     */
+    for (int i = 0; i<p->lets; i++) {
+        gen_indent(out, indent);
+        fprintf(out, "let g%d = %s * %d + %d;\n", *lets, kGenVitals[gen_int(r, 0, GEN_COUNT(kGenVitals)-1)], gen_int(r, 1, 3), gen_int(r, 0, 20));
+        (*lets)++;
+    }
+    int nested_at = (depth > 0) ? gen_int(r, 0, p->stmts > 0 ? p->stmts-1 : 0) : -1;
+    for (int i = 0; i<p->stmts || i==nested_at; i++) {
+        gen_indent(out, indent);
+        if (i==nested_at) {
+            fputs("if ", out);
+            gen_cond(out, r, p, *lets);
+            fputs(" {\n", out);
+            gen_body(out, r, p, indent+1, depth-1, lets);
+            gen_indent(out, indent);
+            fputs("} else {\n", out);
+            gen_indent(out, indent+1);
+            gen_task_stmt(out, r, p);
+            gen_indent(out, indent);
+            fputs("}\n", out);
+            continue;
+        }
+        switch (gen_int(r, 0, 5)) {
+        case 0:
+            fputs("if ", out);
+            gen_cond(out, r, p, *lets);
+            fputs(" {\n", out);
+            gen_indent(out, indent+1);
+            gen_task_stmt(out, r, p);
+            gen_indent(out, indent);
+            fputs("}\n", out);
+            break;
+        case 1:
+            fprintf(out, "set defaults.defense_posture = \"%s\";\n", gen_int(r, 0, 1) ? "quiet" : "loud");
+            break;
+        default:
+            gen_task_stmt(out, r, p);
+            break;
+        }
+    }
+}
+
+/** Emits `taskdefs` taskdef blocks followed by `itemdefs` itemdef blocks. */
+void gen_catalog(FILE *out, const GenParams *p) {
+    static const char *kLocations[] = {"inside", "near", "outside"};
+    static const char *kRisks[] = {"none", "low", "med", "high"};
+    static const char *kTags[] = {"consumable", "tool", "fuel", "garden", "material", "weapon", "ammo", "medical"};
+    GenRng r;
+    gen_seed(&r, p->seed, 1);
+    int stations = p->stations > 0 ? p->stations : 1;
+
+    fprintf(out, "# generated catalog: taskdefs=%d itemdefs=%d seed=%llu\n\n", p->taskdefs, p->itemdefs, p->seed);
+    for (int i = 0; i<p->itemdefs; i++) {
+        int tool = gen_int(&r, 0, 2)==0;
+        const char *t0 = kTags[gen_int(&r, 0, GEN_COUNT(kTags)-1)];
+        if (tool) fprintf(out, "itemdef \"Gen item %05d\" { max_condition: 100; stackable: false; tags: [\"tool\", \"%s\"]; }\n", i, t0);
+        else fprintf(out, "itemdef \"Gen item %05d\" { stackable: true; tags: [\"%s\"]; }\n", i, t0);
+    }
+    fputc('\n', out);
+    for (int i = 0; i<p->taskdefs; i++) {
+        fprintf(out, "taskdef \"Gen task %05d\" {\n", i);
+        fprintf(out, "  time: %dt;\n", gen_int(&r, 1, 4));
+        fprintf(out, "  location: %s;\n", kLocations[gen_int(&r, 0, GEN_COUNT(kLocations)-1)]);
+        fprintf(out, "  risk: %s;\n", kRisks[gen_int(&r, 0, GEN_COUNT(kRisks)-1)]);
+        fprintf(out, "  station: st_%02d;\n", gen_int(&r, 0, stations-1));
+        fprintf(out, "  base_success: %d%%;\n", gen_int(&r, 50, 100));
+        if (p->itemdefs > 0 && gen_int(&r, 0, 1)) {
+            fprintf(out, "  consumes: { \"Gen item %05d\": %d; };\n", gen_int(&r, 0, p->itemdefs-1), gen_int(&r, 1, 3));
+        }
+        fprintf(out, "  effects: { morale: +%d; fatigue: +%d; };\n", gen_int(&r, 0, 3), gen_int(&r, 0, 3));
+        fputs("}\n\n", out);
+    }
+}
+
+/** Emits one world block with `inventory` inventory lines. */
+void gen_world(FILE *out, const GenParams *p) {
+    GenRng r;
+    gen_seed(&r, p->seed, 2);
+
+    fputs("version 0.1;\n\n", out);
+    fprintf(out, "world \"Generated %llu\" {\n", p->seed);
+    fputs("  constants {\n    DAY_TICKS: 24;\n  }\n\n", out);
+    fputs("  shelter {\n", out);
+    fprintf(out, "    temp_c: %d.0;\n", gen_int(&r, 0, 15));
+    fprintf(out, "    signature: %d.0;\n", gen_int(&r, 5, 20));
+    fprintf(out, "    power: %d.0;\n", gen_int(&r, 15, 60));
+    fprintf(out, "    water_safe: %d.0;\n", gen_int(&r, 2, 12));
+    fprintf(out, "    water_raw: %d.0;\n", gen_int(&r, 5, 20));
+    fprintf(out, "    structure: %d.0;\n", gen_int(&r, 55, 95));
+    fprintf(out, "    contamination: %d.0;\n", gen_int(&r, 5, 25));
+    fputs("  }\n\n  inventory {\n", out);
+    for (int i = 0; i<p->inventory; i++) {
+        /* Staples first so small worlds stay playable; then distinct synthetic items. */
+        if (i < GEN_COUNT(kGenStaples)) fprintf(out, "    \"%s\": qty %d", kGenStaples[i], gen_int(&r, 1, 12));
+        else fprintf(out, "    \"Gen item %05d\": qty %d", i-GEN_COUNT(kGenStaples), gen_int(&r, 1, 12));
+        if (gen_int(&r, 0, 2)==0) fprintf(out, ", cond %d", gen_int(&r, 30, 100));
+        fputs(";\n", out);
+    }
+    fputs("  }\n\n", out);
+    fputs("  weather {\n    storminess: 0.15;\n    outside_temp_c: 5.0;\n  }\n\n", out);
+    fputs("  events {\n", out);
+    fprintf(out, "    daily \"breach\" chance %d%%;\n", gen_int(&r, 5, 30));
+    fprintf(out, "    overnight_threat_check chance %d%%;\n", gen_int(&r, 10, 40));
+    fputs("  }\n}\n", out);
+}
+
+/** Emits one character block; `index` selects the per-character stream. */
+void gen_character(FILE *out, const GenParams *p, const char *name, int index) {
+    static const char *kSkills[] = {"cooking", "gardening", "medical", "repair", "guns", "scouting", "power"};
+    GenRng r;
+    gen_seed(&r, p->seed, 1000ULL + (unsigned long long)index);
+    int lets = 0;
+
+    fputs("version 0.1;\n\n", out);
+    fprintf(out, "character \"%s\" {\n", name);
+    fputs("  skills {\n", out);
+    for (int i = 0; i<GEN_COUNT(kSkills); i++) fprintf(out, "    %s: %d;\n", kSkills[i], gen_int(&r, 0, 3));
+    fputs("  }\n\n", out);
+    fputs("  traits: [\"generated\"];\n\n", out);
+    fprintf(out, "  defaults {\n    defense_posture: \"%s\";\n  }\n\n", gen_int(&r, 0, 1) ? "quiet" : "loud");
+
+    fputs("  thresholds {\n", out);
+    for (int i = 0; i<p->thresholds; i++) {
+        fputs("    when ", out);
+        gen_atom(out, &r, p, 0);
+        fputs(" do ", out);
+        gen_task_stmt(out, &r, p);
+    }
+    fputs("  }\n\n  plan {\n", out);
+    for (int i = 0; i<p->blocks; i++) {
+        /* Blocks tile the day when few, and overlap freely when there are many. */
+        int start, end;
+        if (p->blocks <= DAY_TICKS) {
+            start = (i*DAY_TICKS)/p->blocks;
+            end = ((i+1)*DAY_TICKS)/p->blocks;
+        } else {
+            start = gen_int(&r, 0, DAY_TICKS-1);
+            end = start + gen_int(&r, 1, 6);
+            if (end > DAY_TICKS) end = DAY_TICKS;
+        }
+        fprintf(out, "    block b%d %d..%d {\n", i, start, end);
+        gen_body(out, &r, p, 3, p->if_depth, &lets);
+        fputs("    }\n\n", out);
+    }
+    for (int i = 0; i<p->rules; i++) {
+        fprintf(out, "    rule \"r%d\" priority %d {\n", i, gen_int(&r, 10, 95));
+        gen_body(out, &r, p, 3, p->if_depth, &lets);
+        fputs("    }\n\n", out);
+    }
+    fputs("  }\n", out);
+    for (int i = 0; i<p->on_events; i++) {
+        fprintf(out, "\n  on \"breach\" when breach.level >= %d priority %d {\n", gen_int(&r, 1, 3), gen_int(&r, 80, 100));
+        gen_body(out, &r, p, 2, p->if_depth, &lets);
+        fputs("  }\n", out);
+    }
+    fputs("}\n", out);
+}
@@ -0,0 +1,115 @@
+#include "lastbreach.h"
+/**
+ * lb_instances.c
+ *
+ * Module: Pooled per-instance condition storage for non-stackable items.
+ *
+ * Each inventory entry keeps a binary max-heap of its instance ids keyed by
+ * condition, and the pool remembers every instance's heap position, so the best
+ * tool is the heap top (O(1)) and wearing or removing any instance is O(log n).
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+
+void inst_pool_init(InstancePool *p) {
+    memset(p, 0, sizeof(*p));
+    p->free_head = -1;
+}
+
+void inst_pool_free(InstancePool *p) {
+    free(p->cond);
+    free(p->owner);
+    free(p->pos);
+    inst_pool_init(p);
+}
+
+void inst_pool_copy(InstancePool *dst, const InstancePool *src) {
+    inst_pool_init(dst);
+    if (src->n==0) return;
+    dst->cond = (double*)xmalloc(sizeof(double)*(size_t)src->n);
+    dst->owner = (ItemHandle*)xmalloc(sizeof(ItemHandle)*(size_t)src->n);
+    dst->pos = (int*)xmalloc(sizeof(int)*(size_t)src->n);
+    memcpy(dst->cond, src->cond, sizeof(double)*(size_t)src->n);
+    memcpy(dst->owner, src->owner, sizeof(ItemHandle)*(size_t)src->n);
+    memcpy(dst->pos, src->pos, sizeof(int)*(size_t)src->n);
+    dst->n = dst->cap = src->n;
+    dst->free_head = src->free_head;
+}
+
+/* Ties go to the older (lower) id so the choice of tool is deterministic. */
+static int inst_better(const InstancePool *p, int a, int b) {
+    return p->cond[a] > p->cond[b] || (p->cond[a]==p->cond[b] && a < b);
+}
+
+static void heap_place(InstancePool *p, VecInt *heap, int i, int id) {
+    heap->v[i] = id;
+    p->pos[id] = i;
+}
+
+static void heap_sift_up(InstancePool *p, VecInt *heap, int i) {
+    int id = heap->v[i];
+    while (i > 0 && inst_better(p, id, heap->v[(i-1)/2])) {
+        heap_place(p, heap, i, heap->v[(i-1)/2]);
+        i = (i-1)/2;
+    }
+    heap_place(p, heap, i, id);
+}
+
+static void heap_sift_down(InstancePool *p, VecInt *heap, int i) {
+    int id = heap->v[i];
+    for (;;) {
+        int m = 2*i+1;
+        if (m >= heap->n) break;
+        if (m+1 < heap->n && inst_better(p, heap->v[m+1], heap->v[m])) m++;
+        if (!inst_better(p, heap->v[m], id)) break;
+        heap_place(p, heap, i, heap->v[m]);
+        i = m;
+    }
+    heap_place(p, heap, i, id);
+}
+
+static int inst_alloc(InstancePool *p) {
+    if (p->free_head >= 0) {
+        int id = p->free_head;
+        p->free_head = p->pos[id];
+        return id;
+    }
+    if (p->n == p->cap) {
+        /* All three columns grow together so an id indexes each of them. */
+        p->cap = p->cap ? p->cap*2 : 64;
+        p->cond = xrealloc(p->cond, (size_t)p->cap*sizeof(*p->cond));
+        p->owner = xrealloc(p->owner, (size_t)p->cap*sizeof(*p->owner));
+        p->pos = xrealloc(p->pos, (size_t)p->cap*sizeof(*p->pos));
+    }
+    return p->n++;
+}
+
+int inst_pool_add(InstancePool *p, VecInt *heap, ItemHandle owner, double cond) {
+    int id = inst_alloc(p);
+    p->cond[id] = cond;
+    p->owner[id] = owner;
+    VEC_PUSH(*heap, id);
+    heap_sift_up(p, heap, heap->n-1);
+    return id;
+}
+
+void inst_pool_remove(InstancePool *p, VecInt *heap, int id) {
+    int i = p->pos[id];
+    int last = heap->v[--heap->n];
+    if (last != id) {
+        heap_place(p, heap, i, last);
+        inst_pool_update(p, heap, last);
+    }
+    p->owner[id] = -1;
+    p->pos[id] = p->free_head;
+    p->free_head = id;
+}
+
+void inst_pool_update(InstancePool *p, VecInt *heap, int id) {
+    int i = p->pos[id];
+    if (i > 0 && inst_better(p, id, heap->v[(i-1)/2])) heap_sift_up(p, heap, i);
+    else heap_sift_down(p, heap, i);
+}
@@ -2,7 +2,8 @@
 /**
  * lb_inventory.c
  *
- * Module: Inventory container used by the simulation; supports quantity tracking and best condition.
+ * Module: Inventory container used by the simulation; supports quantity tracking, best condition,
+ *         per-tag running totals, perishable lots and per-instance tool condition.
  *
  * This file is part of the modularized LastBreach DSL runner (C99, no third-party
  * libraries). The goal here is readability: small functions, clear names, and
@@ -10,36 +11,273 @@
  */
 
 
-/** Initializes an inventory (empty item list). */
+static void inv_resolve_entry(const Inventory *inv, ItemEntry *e) {
+    e->item_id = inv->reg ? item_reg_find(inv->reg, e->key) : -1;
+    e->tags = (e->item_id >= 0) ? inv->reg->items.v[e->item_id].tags : 0;
+    e->shelf_ticks = (e->item_id >= 0) ? inv->reg->items.v[e->item_id].shelf_life_days*DAY_TICKS : 0;
+    e->instanced = (e->item_id >= 0) ? !inv->reg->items.v[e->item_id].stackable : 0;
+}
+
+static ItemHandle inv_push_entry(Inventory *inv, char *key, unsigned int hash) {
+    ItemEntry ne;
+    ne.key = key;
+    ne.hash = hash;
+    ne.qty = 0.0;
+    ne.best_cond = 0.0;
+    ne.lot_qty = 0.0;
+    VEC_INIT(ne.inst);
+    inv_resolve_entry(inv, &ne);
+    VEC_PUSH(inv->items, ne);
+    hidx_add(&inv->index, hash, inv->items.n-1);
+    return inv->items.n-1;
+}
+
+/** Initializes an inventory holding every canonical item at zero stock. */
 void inv_init(Inventory *inv) {
     VEC_INIT(inv->items);
+    hidx_init(&inv->index);
+    inv->reg = NULL;
+    inv->journal = NULL;
+    inv->now = 0;
+    VEC_INIT(inv->lots);
+    inv->lot_seq = 0;
+    inst_pool_init(&inv->inst);
+    memset(inv->tag_stock, 0, sizeof(inv->tag_stock));
+    hidx_reserve(&inv->index, kCanonItemCount+1);
+    /* Canonical keys are borrowed and pre-hashed; their handles equal CANON_ITEM_* ids. */
+    for (int i = 0; i<kCanonItemCount; i++) inv_push_entry(inv, (char*)kCanonItems[i].name, kCanonItems[i].hash);
+}
+
+void inv_free(Inventory *inv) {
+    for (int i = 0; i<inv->items.n; i++) {
+        /* Canonical keys are borrowed from the generated table. */
+        if (i >= kCanonItemCount) free(inv->items.v[i].key);
+        VEC_FREE(inv->items.v[i].inst);
+    }
+    VEC_FREE(inv->items);
+    hidx_free(&inv->index);
+    VEC_FREE(inv->lots);
+    inst_pool_free(&inv->inst);
+}
+
+void inv_copy(Inventory *dst, const Inventory *src) {
+    /* Scalars, tag totals and the registry binding carry over as-is. */
+    *dst = *src;
+    dst->journal = NULL;
+    VEC_COPY(dst->items, src->items);
+    for (int i = 0; i<src->items.n; i++) {
+        if (i >= kCanonItemCount) dst->items.v[i].key = xstrdup(src->items.v[i].key);
+        VEC_COPY(dst->items.v[i].inst, src->items.v[i].inst);
+    }
+    hidx_copy(&dst->index, &src->index);
+    VEC_COPY(dst->lots, src->lots);
+    inst_pool_copy(&dst->inst, &src->inst);
+}
+
+/* Every quantity change funnels through here so tag totals stay current. */
+static void inv_adjust(Inventory *inv, ItemEntry *e, double delta) {
+    e->qty += delta;
+    int bit = 0;
+    for (ItemTagSet t = e->tags; t; t >>= 1, bit++) {
+        if (t & 1) inv->tag_stock[bit] += delta;
+    }
+}
+
+static void inv_journal_record(Inventory *inv, ItemHandle h, double prev_qty, double prev_cond) {
+    InvJournal *jr = inv->journal;
+    const ItemEntry *e = &inv->items.v[h];
+    if (!jr || (e->qty==prev_qty && e->best_cond==prev_cond)) return;
+    InvJournalEntry je;
+    je.tick = inv->now;
+    je.item = h;
+    je.cause = jr->cause;
+    je.delta = e->qty-prev_qty;
+    je.prev_qty = prev_qty;
+    je.prev_cond = prev_cond;
+    VEC_PUSH(jr->entries, je);
+}
+
+/* Instanced entries report their current best instance, not the best ever seen. */
+static void inst_sync_best(Inventory *inv, ItemEntry *e) {
+    e->best_cond = e->inst.n ? inv->inst.cond[e->inst.v[0]] : 0.0;
+}
+
+static double inst_clamp_cond(const Inventory *inv, const ItemEntry *e, double cond) {
+    double max = inv->reg->items.v[e->item_id].max_condition;
+    if (cond > max) cond = max;
+    return cond > 0.0 ? cond : 0.0;
+}
+
+static void inst_add_n(Inventory *inv, ItemHandle h, int k, double cond) {
+    ItemEntry *e = &inv->items.v[h];
+    for (int i = 0; i<k; i++) inst_pool_add(&inv->inst, &e->inst, h, cond);
+    inst_sync_best(inv, e);
+}
+
+/* Takes the best instances first: whoever uses up a tool grabs the good one. */
+static void inst_take_n(Inventory *inv, ItemEntry *e, int k) {
+    for (; k>0 && e->inst.n; k--) inst_pool_remove(&inv->inst, &e->inst, e->inst.v[0]);
+    inst_sync_best(inv, e);
+}
+
+static int lot_before(const ItemLot *a, const ItemLot *b) {
+    return a->expires < b->expires || (a->expires==b->expires && a->seq < b->seq);
+}
+
+static void lot_push(Inventory *inv, ItemHandle h, double qty) {
+    ItemEntry *e = &inv->items.v[h];
+    ItemLot lot;
+    lot.expires = inv->now + e->shelf_ticks;
+    lot.seq = inv->lot_seq++;
+    lot.item = h;
+    lot.qty = qty;
+    e->lot_qty += qty;
+    VEC_PUSH(inv->lots, lot);
+    ItemLot *v = inv->lots.v;
+    for (int i = inv->lots.n-1; i>0 && lot_before(&v[i], &v[(i-1)/2]); i = (i-1)/2) {
+        ItemLot t = v[i];
+        v[i] = v[(i-1)/2];
+        v[(i-1)/2] = t;
+    }
+}
+
+static ItemLot lot_pop(Inventory *inv) {
+    ItemLot *v = inv->lots.v;
+    ItemLot top = v[0];
+    int n = --inv->lots.n;
+    v[0] = v[n];
+    for (int i = 0;;) {
+        int m = i, l = 2*i+1, r = 2*i+2;
+        if (l<n && lot_before(&v[l], &v[m])) m = l;
+        if (r<n && lot_before(&v[r], &v[m])) m = r;
+        if (m==i) break;
+        ItemLot t = v[i];
+        v[i] = v[m];
+        v[m] = t;
+        i = m;
+    }
+    return top;
+}
+
+/** Binds the inventory to an item registry and recomputes per-tag totals. */
+void inv_bind_registry(Inventory *inv, const ItemRegistry *reg) {
+    inv->reg = reg;
+    memset(inv->tag_stock, 0, sizeof(inv->tag_stock));
+    inv->lots.n = 0;
+    for (int i = 0; i<inv->items.n; i++) {
+        ItemEntry *e = &inv->items.v[i];
+        double qty = e->qty;
+        double cond = e->best_cond;
+        inv_resolve_entry(inv, e);
+        if (e->instanced) {
+            int want = (int)(qty+0.5);
+            if (e->inst.n != want) {
+                /* Stock from before binding (world files) only has a best condition to go on. */
+                inst_take_n(inv, e, e->inst.n);
+                inst_add_n(inv, i, want, inst_clamp_cond(inv, e, cond));
+            }
+            qty = want;
+        } else if (e->inst.n) {
+            inst_take_n(inv, e, e->inst.n);
+            e->best_cond = cond;
+        }
+        e->qty = 0.0;
+        e->lot_qty = 0.0;
+        inv_adjust(inv, e, qty);
+        /* Stock that predates the binding (world files) starts its shelf life now. */
+        if (e->shelf_ticks > 0 && qty > 0.0) lot_push(inv, i, qty);
+    }
+}
+
+ItemHandle inv_lookup(const Inventory *inv, const char *key) {
+    int slot = -1, h;
+    unsigned int hash = lb_hash_str(key);
+    while ((h = hidx_next(&inv->index, hash, &slot)) >= 0) {
+        if (strcmp(inv->items.v[h].key, key)==0) return h;
+    }
+    return -1;
+}
+
+ItemHandle inv_handle(Inventory *inv, const char *key) {
+    ItemHandle h = inv_lookup(inv, key);
+    /* A zero-stock entry reads exactly like a missing one, so interning is invisible. */
+    return (h >= 0) ? h : inv_push_entry(inv, xstrdup(key), lb_hash_str(key));
 }
+
 ItemEntry *inv_find(Inventory *inv, const char *key) {
-    /* Inventory is small enough that linear scan remains straightforward. */
-    for (int i = 0; i<inv->items.n; i++) if (strcmp(inv->items.v[i].key, key)==0) return &inv->items.v[i];
-    return NULL;
+    ItemHandle h = inv_lookup(inv, key);
+    return (h >= 0) ? &inv->items.v[h] : NULL;
 }
 
-/** Adds quantity for an item key; tracks best (max) condition seen. */
-void inv_add(Inventory *inv, const char *key, double qty, double cond) {
-    ItemEntry *e = inv_find(inv, key);
-    if (!e) {
-        ItemEntry ne;
-        ne.key = xstrdup(key);
-        ne.qty = qty;
-        ne.best_cond = cond;
-        VEC_PUSH(inv->items, ne);
+/** Adds quantity for an item handle; tracks best (max) condition seen. */
+void inv_add_h(Inventory *inv, ItemHandle h, double qty, double cond) {
+    ItemEntry *e = &inv->items.v[h];
+    double prev_qty = e->qty, prev_cond = e->best_cond;
+    if (e->instanced) {
+        /* Non-stackable stock arrives as whole instances, each at `cond`. */
+        int k = (int)(qty+0.5);
+        if (k <= 0) return;
+        qty = k;
+        inst_add_n(inv, h, k, inst_clamp_cond(inv, e, cond));
+        inv_adjust(inv, e, qty);
     } else {
         /* Condition tracks "best seen quality", not weighted average quality. */
-        e->qty += qty;
+        inv_adjust(inv, e, qty);
         if (cond > e->best_cond) e->best_cond = cond;
     }
+    if (e->shelf_ticks > 0 && qty > 0.0) lot_push(inv, h, qty);
+    inv_journal_record(inv, h, prev_qty, prev_cond);
+}
+
+/** Adds quantity for an item key; tracks best (max) condition seen. */
+void inv_add(Inventory *inv, const char *key, double qty, double cond) {
+    inv_add_h(inv, inv_handle(inv, key), qty, cond);
+}
+
+/** Removes up to qty of an item and returns the amount actually removed. */
+double inv_consume_h(Inventory *inv, ItemHandle h, double qty) {
+    if (qty <= 0 || h < 0) return 0.0;
+    ItemEntry *e = &inv->items.v[h];
+    if (e->qty <= 0) return 0.0;
+    if (e->instanced) {
+        int k = (int)(qty+0.5);
+        if (k > e->inst.n) k = e->inst.n;
+        if (k <= 0) return 0.0;
+        double prev_qty = e->qty, prev_cond = e->best_cond;
+        inst_take_n(inv, e, k);
+        inv_adjust(inv, e, -(double)k);
+        inv_journal_record(inv, h, prev_qty, prev_cond);
+        return k;
+    }
+    if (qty > e->qty) qty = e->qty;
+    double prev_qty = e->qty;
+    /* Return actual consumed amount so callers can scale downstream effects. */
+    inv_adjust(inv, e, -qty);
+    if (e->qty < 0) inv_adjust(inv, e, -e->qty);
+    inv_journal_record(inv, h, prev_qty, e->best_cond);
+    return qty;
+}
+
+double inv_consume(Inventory *inv, const char *key, double qty) {
+    return inv_consume_h(inv, inv_lookup(inv, key), qty);
+}
+
+/** Returns quantity in stock for a handle (0 for -1). */
+double inv_stock_h(const Inventory *inv, ItemHandle h) {
+    return (h >= 0) ? inv->items.v[h].qty : 0.0;
 }
 
 /** Returns quantity in stock for a key. */
 double inv_stock(Inventory *inv, const char *key) {
-    ItemEntry *e = inv_find(inv, key);
-    return e?e->qty:0.0;
+    return inv_stock_h(inv, inv_lookup(inv, key));
+}
+
+/** Returns the running total for every item carrying `tag` (0 if unbound or unknown). */
+double inv_stock_tag(const Inventory *inv, const char *tag) {
+    int t = inv->reg ? item_reg_tag_id(inv->reg, tag) : -1;
+    if (t < 0) return 0.0;
+    /* Adds and removes in a different order than a fresh sum; hide a negative residue. */
+    return inv->tag_stock[t] > 0.0 ? inv->tag_stock[t] : 0.0;
 }
 
 /** Returns non-zero if any quantity exists for a key. */
@@ -47,8 +285,190 @@ int inv_has(Inventory *inv, const char *key) {
     return inv_stock(inv, key) > 0.0;
 }
 
+/** Returns the best condition observed for a handle (0 for -1). */
+double inv_cond_h(const Inventory *inv, ItemHandle h) {
+    return (h >= 0) ? inv->items.v[h].best_cond : 0.0;
+}
+
 /** Returns the best condition observed for a key (0 if missing). */
 double inv_cond(Inventory *inv, const char *key) {
-    ItemEntry *e = inv_find(inv, key);
-    return e?e->best_cond:0.0;
+    return inv_cond_h(inv, inv_lookup(inv, key));
+}
+
+double inv_wear_h(Inventory *inv, ItemHandle h, double wear) {
+    if (h < 0) return 0.0;
+    ItemEntry *e = &inv->items.v[h];
+    if (!e->instanced) return inv_cond_h(inv, h);
+    if (!e->inst.n) return 0.0;
+    int id = e->inst.v[0];
+    double before = inv->inst.cond[id];
+    inv->inst.cond[id] = before - wear;
+    if (inv->inst.cond[id] <= 0.0) {
+        double prev_qty = e->qty, prev_cond = e->best_cond;
+        inst_pool_remove(&inv->inst, &e->inst, id);
+        inst_sync_best(inv, e);
+        inv_adjust(inv, e, -1.0);
+        inv_journal_record(inv, h, prev_qty, prev_cond);
+    } else {
+        /* Wear alone is not journaled; only a break changes the stock. */
+        inst_pool_update(&inv->inst, &e->inst, id);
+        inst_sync_best(inv, e);
+    }
+    return before;
+}
+
+int inv_best_instance(const Inventory *inv, ItemHandle h) {
+    return (h >= 0 && inv->items.v[h].inst.n) ? inv->items.v[h].inst.v[0] : -1;
+}
+
+/** Removes stock whose lots have expired; cost is O(log n) per expiring lot only. */
+void inv_expire_lots(Inventory *inv, VecItemLot *spoiled) {
+    while (inv->lots.n > 0 && inv->lots.v[0].expires <= inv->now) {
+        ItemLot lot = lot_pop(inv);
+        ItemEntry *e = &inv->items.v[lot.item];
+        /* Lots of one item expire oldest-first, so younger lots are what remains in lot_qty. */
+        e->lot_qty -= lot.qty;
+        if (e->lot_qty < 0.0) e->lot_qty = 0.0;
+        double gone = inv_consume_h(inv, lot.item, e->qty - e->lot_qty);
+        if (gone > 0.0 && spoiled) {
+            lot.qty = gone;
+            VEC_PUSH(*spoiled, lot);
+        }
+    }
+}
+
+/* ---- Change journal ---- */
+
+void inv_journal_init(InvJournal *jr) {
+    VEC_INIT(jr->entries);
+    VEC_INIT(jr->flows);
+    VEC_INIT(jr->totals);
+    jr->window = INV_FLOW_WINDOW_DAYS;
+    jr->base = 0;
+    jr->cause = -1;
+    VEC_INIT(jr->names);
+    hidx_init(&jr->name_index);
+}
+
+void inv_journal_free(InvJournal *jr) {
+    VEC_FREE(jr->entries);
+    VEC_FREE(jr->flows);
+    VEC_FREE(jr->totals);
+    for (int i = 0; i<jr->names.n; i++) free(jr->names.v[i]);
+    VEC_FREE(jr->names);
+    hidx_free(&jr->name_index);
+}
+
+int inv_journal_cause(InvJournal *jr, const char *task) {
+    const CanonTask *ct = canon_task_find(task);
+    if (ct) return ct->id;
+    /* Plan-defined tasks get ids below -1, so their flows keep their own label. */
+    unsigned int h = lb_hash_str(task);
+    int slot = -1, i;
+    while ((i = hidx_next(&jr->name_index, h, &slot)) >= 0) {
+        if (strcmp(jr->names.v[i], task)==0) return -2-i;
+    }
+    VEC_PUSH(jr->names, xstrdup(task));
+    hidx_add(&jr->name_index, h, jr->names.n-1);
+    return -2-(jr->names.n-1);
+}
+
+const char *inv_journal_cause_name(const InvJournal *jr, int cause) {
+    if (cause >= 0) return kCanonTasks[cause].name;
+    if (cause <= -2 && -2-cause < jr->names.n) return jr->names.v[-2-cause];
+    return "(world)";
+}
+
+InvMark inv_journal_mark(const InvJournal *jr) {
+    return jr->base + jr->entries.n;
+}
+
+void inv_journal_rollback(Inventory *inv, InvMark mark) {
+    InvJournal *jr = inv->journal;
+    if (mark < jr->base) dief("inventory journal: mark %ld was compacted (oldest is %ld)", mark, jr->base);
+    while (inv_journal_mark(jr) > mark) {
+        const InvJournalEntry *je = &jr->entries.v[--jr->entries.n];
+        ItemEntry *e = &inv->items.v[je->item];
+        if (e->instanced) {
+            int diff = (int)(je->prev_qty - e->qty);
+            if (diff > 0) inst_add_n(inv, je->item, diff, je->prev_cond);
+            else inst_take_n(inv, e, -diff);
+        }
+        /* Restore the recorded value rather than subtracting delta, so qty round-trips bit-exactly. */
+        inv_adjust(inv, e, je->prev_qty-e->qty);
+        e->qty = je->prev_qty;
+        if (!e->instanced) e->best_cond = je->prev_cond;
+    }
+}
+
+/*
+  Flow vectors are short (a day touches a handful of item/cause pairs, and
+  the totals one row per pair), so a backwards scan over the trailing rows
+  beats maintaining another index.
+*/
+static InvFlow *flow_slot(VecInvFlow *v, int from, int day, ItemHandle item, int cause) {
+    for (int i = v->n-1; i >= from && v->v[i].day==day; i--) {
+        if (v->v[i].item==item && v->v[i].cause==cause) return &v->v[i];
+    }
+    InvFlow f;
+    f.day = day;
+    f.item = item;
+    f.cause = cause;
+    f.produced = 0.0;
+    f.consumed = 0.0;
+    VEC_PUSH(*v, f);
+    return &v->v[v->n-1];
+}
+
+static void flow_add(InvFlow *f, double delta) {
+    if (delta > 0) f->produced += delta;
+    else f->consumed -= delta;
+}
+
+void inv_journal_compact(InvJournal *jr, InvMark keep) {
+    int n = (int)(keep - jr->base);
+    if (n <= 0) return;
+    if (n > jr->entries.n) n = jr->entries.n;
+    for (int i = 0; i<n; i++) {
+        const InvJournalEntry *je = &jr->entries.v[i];
+        flow_add(flow_slot(&jr->flows, 0, je->tick/DAY_TICKS, je->item, je->cause), je->delta);
+    }
+    memmove(jr->entries.v, jr->entries.v+n, (size_t)(jr->entries.n-n)*sizeof(*jr->entries.v));
+    jr->entries.n -= n;
+    jr->base += n;
+
+    /* Flows are ordered by day, so the days that left the window are a prefix. */
+    if (jr->flows.n==0) return;
+    int oldest = jr->flows.v[jr->flows.n-1].day - jr->window + 1, old = 0;
+    while (old < jr->flows.n && jr->flows.v[old].day < oldest) {
+        const InvFlow *f = &jr->flows.v[old++];
+        InvFlow *t = flow_slot(&jr->totals, 0, -1, f->item, f->cause);
+        t->produced += f->produced;
+        t->consumed += f->consumed;
+    }
+    memmove(jr->flows.v, jr->flows.v+old, (size_t)(jr->flows.n-old)*sizeof(*jr->flows.v));
+    jr->flows.n -= old;
+}
+
+void inv_journal_flows(const InvJournal *jr, int day, VecInvFlow *out) {
+    int from = out->n;
+    /* Totals hold the oldest days, so rows still come out in order of first appearance. */
+    for (int i = 0; day < 0 && i<jr->totals.n; i++) {
+        const InvFlow *f = &jr->totals.v[i];
+        InvFlow *dst = flow_slot(out, from, day, f->item, f->cause);
+        dst->produced += f->produced;
+        dst->consumed += f->consumed;
+    }
+    for (int i = 0; i<jr->flows.n; i++) {
+        const InvFlow *f = &jr->flows.v[i];
+        if (day >= 0 && f->day != day) continue;
+        InvFlow *dst = flow_slot(out, from, day, f->item, f->cause);
+        dst->produced += f->produced;
+        dst->consumed += f->consumed;
+    }
+    for (int i = 0; i<jr->entries.n; i++) {
+        const InvJournalEntry *je = &jr->entries.v[i];
+        if (day >= 0 && je->tick/DAY_TICKS != day) continue;
+        flow_add(flow_slot(out, from, day, je->item, je->cause), je->delta);
+    }
 }
@@ -0,0 +1,67 @@
+#include "lastbreach.h"
+/**
+ * lb_items.c
+ *
+ * Module: Item registry; interns item names and tags declared by itemdefs.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+
+/** Initializes an empty registry. */
+void item_reg_init(ItemRegistry *r) {
+    VEC_INIT(r->items);
+    hidx_init(&r->index);
+    r->n_tags = 0;
+}
+
+void item_reg_free(ItemRegistry *r) {
+    for (int i = 0; i<r->items.n; i++) free(r->items.v[i].name);
+    for (int i = 0; i<r->n_tags; i++) free(r->tags[i]);
+    VEC_FREE(r->items);
+    hidx_free(&r->index);
+    r->n_tags = 0;
+}
+
+int item_reg_find(const ItemRegistry *r, const char *name) {
+    int slot = -1, id;
+    unsigned int h = lb_hash_str(name);
+    while ((id = hidx_next(&r->index, h, &slot)) >= 0) {
+        if (strcmp(r->items.v[id].name, name)==0) return id;
+    }
+    return -1;
+}
+
+int item_reg_get_or_add(ItemRegistry *r, const char *name) {
+    int id = item_reg_find(r, name);
+    if (id >= 0) return id;
+    ItemDef d;
+    d.name = xstrdup(name);
+    d.hash = lb_hash_str(name);
+    d.tags = 0;
+    /* Defaults match the DSL: stackable consumables at full condition. */
+    d.stackable = 1;
+    d.max_condition = 100.0;
+    d.shelf_life_days = 0;
+    VEC_PUSH(r->items, d);
+    hidx_add(&r->index, d.hash, r->items.n-1);
+    return r->items.n-1;
+}
+
+int item_reg_tag_id(const ItemRegistry *r, const char *tag) {
+    /* At most LB_MAX_ITEM_TAGS entries, so a scan is constant-bounded. */
+    for (int i = 0; i<r->n_tags; i++) if (strcmp(r->tags[i], tag)==0) return i;
+    return -1;
+}
+
+void item_reg_add_tag(ItemRegistry *r, int id, const char *tag) {
+    int t = item_reg_tag_id(r, tag);
+    if (t < 0) {
+        if (r->n_tags==LB_MAX_ITEM_TAGS) dief("too many distinct item tags (max %d): %s", LB_MAX_ITEM_TAGS, tag);
+        t = r->n_tags++;
+        r->tags[t] = xstrdup(tag);
+    }
+    r->items.v[id].tags |= (ItemTagSet)1 << t;
+}
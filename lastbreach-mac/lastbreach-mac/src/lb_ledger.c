@@ -0,0 +1,61 @@
+#include "lastbreach.h"
+/**
+ * lb_ledger.c
+ *
+ * Module: Reservation ledger for scarce task inputs.
+ *
+ * A task reserves its inputs when it starts and releases them when it
+ * completes, so two survivors can no longer both start on the last unit of
+ * stock. Every operation is O(inputs): the ledger is a flat array indexed by
+ * item handle, grown on first reservation of a handle.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+
+void ledger_init(ReserveLedger *l) {
+    VEC_INIT(l->held);
+}
+
+void ledger_free(ReserveLedger *l) {
+    VEC_FREE(l->held);
+}
+
+void ledger_copy(ReserveLedger *dst, const ReserveLedger *src) {
+    VEC_COPY(dst->held, src->held);
+}
+
+static double ledger_held(const ReserveLedger *l, ItemHandle h) {
+    return (h >= 0 && h < l->held.n) ? l->held.v[h] : 0.0;
+}
+
+double ledger_available(const ReserveLedger *l, const Inventory *inv, ItemHandle h) {
+    return inv_stock_h(inv, h) - ledger_held(l, h);
+}
+
+int ledger_can_reserve(const ReserveLedger *l, const Inventory *inv, const TaskInput *in, int n) {
+    for (int i = 0; i<n; i++) {
+        /* Tolerate float residue from fractional consumption (e.g. 0.2 solder per job). */
+        if (ledger_available(l, inv, in[i].item) < in[i].qty - 1e-9) return 0;
+    }
+    return 1;
+}
+
+int ledger_reserve(ReserveLedger *l, const Inventory *inv, const TaskInput *in, int n) {
+    if (!ledger_can_reserve(l, inv, in, n)) return 0;
+    for (int i = 0; i<n; i++) {
+        while (l->held.n <= in[i].item) VEC_PUSH(l->held, 0.0);
+        l->held.v[in[i].item] += in[i].qty;
+    }
+    return 1;
+}
+
+void ledger_release(ReserveLedger *l, const TaskInput *in, int n) {
+    for (int i = 0; i<n; i++) {
+        double *h = &l->held.v[in[i].item];
+        *h -= in[i].qty;
+        if (*h < 1e-9) *h = 0.0;
+    }
+}
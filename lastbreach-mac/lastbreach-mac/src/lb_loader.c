@@ -0,0 +1,124 @@
+#include "lastbreach.h"
+/**
+ * lb_loader.c
+ *
+ * Module: Concurrent loading of catalog, world and character files.
+ *
+ * Every input file is independent until the simulation starts, so each one is
+ * read and parsed as its own job. Jobs write into private slots and the results
+ * are published in a fixed order afterwards, which keeps error reporting and
+ * the final state identical to a sequential load.
+ */
+
+typedef enum { LOAD_CATALOG, LOAD_WORLD, LOAD_CHARACTER } LoadKind;
+
+typedef struct {
+    LoadKind kind;
+    CatalogMode catalog_mode;
+    const char *path;
+    void *out; /* Catalog*, World* or Character* */
+    int failed;
+    char err[1024]; /* room for "path: " plus a full DieTrap message */
+} LoadJob;
+
+static void load_character_src(const char *path, char *src, Character *out) {
+    Parser ps;
+    ps_init(&ps, path, src);
+    /* Skip any DSL preamble until the first `character` block. */
+    while (!ps_is_ident(&ps, "character") && !ps_is(&ps, TK_EOF)) lx_next_token(&ps.lx);
+    if (ps_is(&ps, TK_EOF)) dief("%s: no character block found", path);
+    parse_character(&ps, out);
+}
+
+static void run_load_job(LoadJob *job) {
+    char *src = read_entire_file(job->path);
+    if (!src) {
+        job->failed = 1;
+        if (job->kind==LOAD_CATALOG) snprintf(job->err, sizeof(job->err), "failed to read catalog file: %s", job->path);
+        else if (job->kind==LOAD_WORLD) snprintf(job->err, sizeof(job->err), "failed to read world file: %s", job->path);
+        else snprintf(job->err, sizeof(job->err), "failed to read %s", job->path);
+        return;
+    }
+    switch (job->kind) {
+    case LOAD_CATALOG:
+        if (job->catalog_mode!=CATALOG_EAGER) {
+            /* The lazy index points into src, so the catalog keeps it. */
+            parse_catalog_lazy((Catalog*)job->out, job->path, src);
+            return;
+        }
+        parse_catalog((Catalog*)job->out, job->path, src);
+        break;
+    case LOAD_WORLD:
+        parse_world((World*)job->out, job->path, src);
+        break;
+    case LOAD_CHARACTER:
+        load_character_src(job->path, src, (Character*)job->out);
+        break;
+    }
+    free(src);
+}
+
+static void load_job_worker(void *ctx, int i) {
+    LoadJob *job = &((LoadJob*)ctx)[i];
+    DieTrap trap;
+    /* Parser errors dief(); the trap turns them into a per-job failure. */
+    if (setjmp(trap.jb)==0) {
+        dief_trap_set(&trap);
+        run_load_job(job);
+    } else {
+        job->failed = 1;
+        /* Lexer errors only carry a line number; name the file they came from. */
+        if (strncmp(trap.msg, job->path, strlen(job->path))==0) snprintf(job->err, sizeof(job->err), "%s", trap.msg);
+        else snprintf(job->err, sizeof(job->err), "%s: %s", job->path, trap.msg);
+    }
+    dief_trap_set(NULL);
+}
+
+/** Reads and parses all inputs concurrently; see lastbreach.h for the contract. */
+int load_inputs(const LoadRequest *rq, Catalog *cat, World *w, Character *chars, char *err, size_t errn) {
+    int n = 0;
+    LoadJob *jobs = (LoadJob*)xmalloc((size_t)(rq->n_chars+2)*sizeof(*jobs));
+    memset(jobs, 0, (size_t)(rq->n_chars+2)*sizeof(*jobs));
+
+    /* Defaults are applied before the jobs run so files override them as before. */
+    cat_init(cat);
+    seed_default_catalog(cat);
+    world_init(w);
+
+    /* Job order is the sequential load order; it decides which error wins. */
+    if (rq->catalog_path) {
+        jobs[n].kind = LOAD_CATALOG;
+        jobs[n].catalog_mode = rq->catalog_mode;
+        jobs[n].path = rq->catalog_path;
+        jobs[n].out = cat;
+        n++;
+    }
+    if (rq->world_path) {
+        jobs[n].kind = LOAD_WORLD;
+        jobs[n].path = rq->world_path;
+        jobs[n].out = w;
+        n++;
+    }
+    for (int i = 0; i<rq->n_chars; i++) {
+        jobs[n].kind = LOAD_CHARACTER;
+        jobs[n].path = rq->char_paths[i];
+        jobs[n].out = &chars[i];
+        n++;
+    }
+
+    parallel_for(n, rq->threads, load_job_worker, jobs);
+
+    int rc = 0;
+    for (int i = 0; i<n; i++) {
+        if (!jobs[i].failed) continue;
+        if (err && errn) snprintf(err, errn, "%s", jobs[i].err);
+        rc = -1;
+        break;
+    }
+    free(jobs);
+    /* Bodies are independent of each other, so the second pass fans out too. */
+    if (rc==0 && rq->catalog_mode==CATALOG_LAZY_PARALLEL) rc = cat_resolve_all(cat, rq->threads, err, errn);
+    /* The world may have parsed before the catalog's itemdefs; bind once both exist. */
+    if (rc==0) inv_bind_registry(&w->inv, &cat->items);
+    return rc;
+}
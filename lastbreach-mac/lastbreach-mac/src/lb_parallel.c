@@ -0,0 +1,75 @@
+#define _POSIX_C_SOURCE 200809L
+#include "lastbreach.h"
+
+#include <pthread.h>
+#include <unistd.h>
+/**
+ * lb_parallel.c
+ *
+ * Module: Minimal parallel-for over POSIX threads (loader, batch and sweep drivers).
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+typedef struct {
+    pthread_mutex_t mu;
+    int next;
+    int n;
+    void (*fn)(void *ctx, int i);
+    void *ctx;
+} ParallelFor;
+
+static int pf_claim(ParallelFor *pf) {
+    /* One shared cursor: a slow job never holds up indices behind it. */
+    pthread_mutex_lock(&pf->mu);
+    int i = (pf->next < pf->n) ? pf->next++ : -1;
+    pthread_mutex_unlock(&pf->mu);
+    return i;
+}
+
+static void *pf_worker(void *arg) {
+    ParallelFor *pf = (ParallelFor*)arg;
+    for (int i = pf_claim(pf); i >= 0; i = pf_claim(pf)) pf->fn(pf->ctx, i);
+    return NULL;
+}
+
+/** Returns the number of online CPUs (at least 1). */
+int lb_cpu_count(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n >= 1) return (int)n;
+#endif
+    return 1;
+}
+
+/** Runs fn(ctx, i) for i in [0, n) on a transient set of worker threads. */
+void parallel_for(int n, int threads, void (*fn)(void *ctx, int i), void *ctx) {
+    if (n <= 0) return;
+    if (threads <= 0) threads = lb_cpu_count();
+    if (threads > n) threads = n;
+    if (threads <= 1) {
+        for (int i = 0; i<n; i++) fn(ctx, i);
+        return;
+    }
+
+    ParallelFor pf;
+    pthread_mutex_init(&pf.mu, NULL);
+    pf.next = 0;
+    pf.n = n;
+    pf.fn = fn;
+    pf.ctx = ctx;
+
+    pthread_t *tids = (pthread_t*)xmalloc((size_t)(threads-1)*sizeof(*tids));
+    int started = 0;
+    for (int t = 0; t<threads-1; t++) {
+        if (pthread_create(&tids[t], NULL, pf_worker, &pf)!=0) break;
+        started++;
+    }
+    /* The caller works too; if thread creation failed it simply does more. */
+    pf_worker(&pf);
+    for (int t = 0; t<started; t++) pthread_join(tids[t], NULL);
+    free(tids);
+    pthread_mutex_destroy(&pf.mu);
+}
@@ -18,6 +18,15 @@ void ps_init(Parser *ps, const char *filename, char *src) {
     ps->lx.line = 1;
     lx_next_token(&ps->lx);
 }
+void ps_init_span(Parser *ps, const char *filename, char *src, size_t len, int line) {
+    /* The lexer never reads past len, so the span needs no terminator. */
+    ps->filename = filename;
+    ps->lx.src = src;
+    ps->lx.len = len;
+    ps->lx.pos = 0;
+    ps->lx.line = line;
+    lx_next_token(&ps->lx);
+}
 int ps_is(Parser *ps, TokenKind k) {
     return ps->lx.cur.kind==k;
 }
@@ -49,10 +49,21 @@ static Expr *ex_bin(OpKind op, Expr*a, Expr*b, int line) {
     e->u.bin.b = b;
     return e;
 }
+static CallBuiltin call_builtin(const char *name) {
+    if (strcmp(name, "stock")==0) return CALL_STOCK;
+    if (strcmp(name, "stock_tag")==0) return CALL_STOCK_TAG;
+    if (strcmp(name, "has")==0) return CALL_HAS;
+    if (strcmp(name, "cond")==0) return CALL_COND;
+    if (strcmp(name, "event")==0) return CALL_EVENT;
+    return CALL_UNKNOWN;
+}
 static Expr *ex_call(char *name, VecExprPtr args, int line) {
     Expr*e = ex_new(EX_CALL, line);
     e->u.call.name = name;
     e->u.call.args = args;
+    /* Resolve the builtin here so evaluation never compares names. */
+    e->u.call.builtin = call_builtin(name);
+    e->u.call.item = -1;
     return e;
 }
 static Expr *parse_primary(Parser *ps) {
@@ -246,3 +257,23 @@ Expr *parse_expr(Parser *ps) {
     /* Entry point intentionally returns the lowest-precedence parser level. */
     return parse_or(ps);
 }
+
+Expr *parse_condition(const char *name, const char *text, char *err, size_t errn) {
+    char *src = xstrdup(text);
+    DieTrap trap;
+    /* Parser errors dief(); the trap turns them into an error return for the CLI. */
+    if (setjmp(trap.jb)==0) {
+        Parser ps;
+        dief_trap_set(&trap);
+        ps_init(&ps, name, src);
+        Expr *e = parse_expr(&ps);
+        if (!ps_is(&ps, TK_EOF)) dief("%s:%d: unexpected text after the expression", name, ps.lx.cur.line);
+        dief_trap_set(NULL);
+        free(src);
+        return e;
+    }
+    dief_trap_set(NULL);
+    snprintf(err, errn, "%s", trap.msg);
+    free(src);
+    return NULL;
+}
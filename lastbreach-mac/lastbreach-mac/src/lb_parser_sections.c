@@ -177,6 +177,7 @@ static void parse_on(Parser *ps, Character *ch) {
     ps_expect(ps, TK_RBRACE, "}");
     OnEventRule r;
     r.event_name = ename;
+    r.event_id = -1;
     r.priority = pr;
     r.when_cond = when_cond;
     r.stmts = stmts;
@@ -0,0 +1,197 @@
+#include "lastbreach.h"
+#include "lb_canon_ids.h"
+/**
+ * lb_region.c
+ *
+ * Module: Region driver (many shelters stepped in parallel, exchange at day ends).
+ *
+ * Shelters never touch each other during a day: each has its own world,
+ * catalog, cast and RNG stream, so a day of every shelter is an independent
+ * job for the worker pool. They interact only in the exchange phase, which
+ * runs on the calling thread in site order. That split is what makes the
+ * region's result independent of thread count and scheduling.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+
+/* Goods the exchange moves, in processing order (staples first). */
+static const ItemHandle kTradeGoods[] = {
+    CANON_ITEM_FOOD,
+    CANON_ITEM_AMMUNITION,
+    CANON_ITEM_SEEDS,
+    CANON_ITEM_FIREWOOD,
+    CANON_ITEM_FUEL_CAN
+};
+
+#define REGION_TRADE_GOODS ((int)(sizeof(kTradeGoods)/sizeof(kTradeGoods[0])))
+
+/* A starving shelter takes this share of the richest larder, at a structure cost to the victim. */
+#define RAID_SHARE 0.25
+#define RAID_STRUCTURE_DAMAGE 2.0
+
+void region_init(Region *r, unsigned long long seed, int threads, FILE *sink) {
+    VEC_INIT(r->sites);
+    r->seed = seed;
+    r->threads = threads;
+    r->day = 0;
+    r->sink = sink;
+    r->owns_sink = 0;
+    if (!sink) {
+        r->sink = fopen("/dev/null", "w");
+        if (!r->sink) dief("region: cannot open /dev/null for site logs");
+        r->owns_sink = 1;
+    }
+}
+
+void region_free(Region *r) {
+    for (int i = 0; i<r->sites.n; i++) {
+        RegionSite *s = r->sites.v[i];
+        if (s->run) sim_end(s->run);
+        /* region_add_site initialised them, so the region owns them. */
+        world_free(&s->world);
+        cat_free(&s->cat);
+        character_free(&s->cast[0]);
+        character_free(&s->cast[1]);
+        free(s->name);
+        free(s);
+    }
+    VEC_FREE(r->sites);
+    if (r->owns_sink) fclose(r->sink);
+}
+
+RegionSite *region_add_site(Region *r, const char *name) {
+    RegionSite *s = (RegionSite*)xmalloc(sizeof(*s));
+    memset(s, 0, sizeof(*s));
+    s->name = xstrdup(name);
+    world_init(&s->world);
+    cat_init(&s->cat);
+    character_init(&s->cast[0]);
+    character_init(&s->cast[1]);
+    VEC_PUSH(r->sites, s);
+    return s;
+}
+
+static void region_start(Region *r) {
+    /* Done once, serially: loaders reset the world, so streams are assigned here. */
+    for (int i = 0; i<r->sites.n; i++) {
+        RegionSite *s = r->sites.v[i];
+        if (s->run) continue;
+        s->world.own_rng = 1;
+        lb_rng_seed(&s->world.rng, r->seed, (unsigned long long)i+1);
+        s->world.log = r->sink;
+        s->run = sim_begin(&s->world, &s->cat, &s->cast[0], &s->cast[1]);
+    }
+}
+
+static void site_day_worker(void *ctx, int i) {
+    Region *r = (Region*)ctx;
+    sim_step_day(r->sites.v[i]->run);
+}
+
+static double site_available(const RegionSite *s, ItemHandle h) {
+    /* Stock held for tasks still running across midnight is not for trade. */
+    double a = ledger_available(&s->world.reserve, &s->world.inv, h);
+    return a > 0.0 ? a : 0.0;
+}
+
+static double site_move(RegionSite *from, RegionSite *to, ItemHandle h, double qty) {
+    double cond = inv_cond_h(&from->world.inv, h);
+    double got = inv_consume_h(&from->world.inv, h, qty);
+    if (got > 0.0) inv_add_h(&to->world.inv, h, got, cond);
+    return got;
+}
+
+typedef struct {
+    int site;
+    double units;
+} ExchangeSlot;
+
+static int slot_cmp(const void *pa, const void *pb) {
+    /* Largest first; site order breaks ties so the match never depends on sort stability. */
+    const ExchangeSlot *a = (const ExchangeSlot*)pa, *b = (const ExchangeSlot*)pb;
+    if (a->units!=b->units) return a->units > b->units ? -1 : 1;
+    return a->site - b->site;
+}
+
+static void exchange_trade(Region *r, ItemHandle h, RegionExchange *ex, ExchangeSlot *need, ExchangeSlot *offer) {
+    int n = r->sites.n, n_need = 0, n_offer = 0;
+    double total = 0.0;
+    for (int i = 0; i<n; i++) total += site_available(r->sites.v[i], h);
+    double mean = total/n;
+
+    /* Whole units only: shelters level toward the regional mean without trading crumbs. */
+    for (int i = 0; i<n; i++) {
+        double a = site_available(r->sites.v[i], h);
+        if (mean - a >= 1.0) {
+            need[n_need].site = i;
+            need[n_need++].units = (double)(long)(mean - a);
+        } else if (a - mean >= 1.0) {
+            offer[n_offer].site = i;
+            offer[n_offer++].units = (double)(long)(a - mean);
+        }
+    }
+    qsort(need, (size_t)n_need, sizeof(*need), slot_cmp);
+    qsort(offer, (size_t)n_offer, sizeof(*offer), slot_cmp);
+
+    int j = 0;
+    for (int i = 0; i<n_need && j<n_offer; i++) {
+        while (need[i].units > 0.0 && j<n_offer) {
+            double q = need[i].units < offer[j].units ? need[i].units : offer[j].units;
+            RegionSite *from = r->sites.v[offer[j].site], *to = r->sites.v[need[i].site];
+            double got = site_move(from, to, h, q);
+            from->traded_out += got;
+            to->traded_in += got;
+            ex->trades++;
+            ex->traded_units += got;
+            need[i].units -= q;
+            offer[j].units -= q;
+            if (offer[j].units <= 0.0) j++;
+        }
+    }
+}
+
+static void exchange_raids(Region *r, RegionExchange *ex) {
+    int n = r->sites.n;
+    for (int i = 0; i<n; i++) {
+        RegionSite *s = r->sites.v[i];
+        if (site_available(s, CANON_ITEM_FOOD) >= 1.0) continue;
+        int victim = -1;
+        double best = 0.0;
+        for (int k = 0; k<n; k++) {
+            double a = site_available(r->sites.v[k], CANON_ITEM_FOOD);
+            if (k!=i && a > best) {
+                best = a;
+                victim = k;
+            }
+        }
+        double take = (double)(long)(best*RAID_SHARE);
+        if (victim < 0 || take < 1.0) continue;
+        RegionSite *v = r->sites.v[victim];
+        double got = site_move(v, s, CANON_ITEM_FOOD, take);
+        v->world.shelter.structure -= RAID_STRUCTURE_DAMAGE;
+        if (v->world.shelter.structure < 0.0) v->world.shelter.structure = 0.0;
+        s->raided_in += got;
+        v->raided_out += got;
+        ex->raids++;
+        ex->raided_units += got;
+    }
+}
+
+void region_step_day(Region *r, RegionExchange *ex) {
+    memset(ex, 0, sizeof(*ex));
+    if (r->sites.n==0) return;
+    region_start(r);
+    parallel_for(r->sites.n, r->threads, site_day_worker, r);
+
+    /* Exchange: trade levels stock first, then whoever is still hungry raids. */
+    ExchangeSlot *need = (ExchangeSlot*)xmalloc(sizeof(*need)*(size_t)r->sites.n);
+    ExchangeSlot *offer = (ExchangeSlot*)xmalloc(sizeof(*offer)*(size_t)r->sites.n);
+    for (int g = 0; g<REGION_TRADE_GOODS; g++) exchange_trade(r, kTradeGoods[g], ex, need, offer);
+    free(need);
+    free(offer);
+    exchange_raids(r, ex);
+    r->day++;
+}
@@ -0,0 +1,332 @@
+#include "lastbreach.h"
+/**
+ * lb_replay.c
+ *
+ * Module: Decision log (record/replay storage, fingerprints, state hashes).
+ *
+ * The sim owns the record and replay logic; this file keeps the log itself:
+ * interning, a small binary file format, and the hashes a replay uses to tell
+ * whether it still follows the recorded run. Everything in the file is written
+ * byte by byte in little-endian order so logs move between machines.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+
+#define DLOG_MAGIC "LBDL"
+#define DLOG_VERSION 1u
+
+#define FNV64_OFFSET 1469598103934665603ULL
+#define FNV64_PRIME 1099511628211ULL
+
+void dlog_init(DecisionLog *l) {
+    memset(l, 0, sizeof(*l));
+    VEC_INIT(l->strings);
+    VEC_INIT(l->decisions);
+    VEC_INIT(l->notes);
+    VEC_INIT(l->draws);
+    VEC_INIT(l->day_hash);
+}
+
+void dlog_free(DecisionLog *l) {
+    for (int i = 0; i<l->strings.n; i++) free(l->strings.v[i]);
+    for (int i = 0; i<l->notes.n; i++) free(l->notes.v[i].text);
+    VEC_FREE(l->strings);
+    VEC_FREE(l->decisions);
+    VEC_FREE(l->notes);
+    VEC_FREE(l->draws);
+    VEC_FREE(l->day_hash);
+}
+
+int dlog_intern(DecisionLog *l, const char *s) {
+    if (!s) return -1;
+    /* Task, station and posture names: a few dozen at most, so a scan is enough. */
+    for (int i = 0; i<l->strings.n; i++) {
+        if (strcmp(l->strings.v[i], s)==0) return i;
+    }
+    VEC_PUSH(l->strings, xstrdup(s));
+    return l->strings.n-1;
+}
+
+void dlog_rewind(DecisionLog *l) {
+    l->replaying = 1;
+    l->next_decision = 0;
+    l->next_note = 0;
+    l->next_draw = 0;
+    l->diverged = 0;
+    l->div_day = 0;
+    l->div_tick = 0;
+    l->div_reason[0] = 0;
+}
+
+void dlog_diverge(DecisionLog *l, int day, int tick, const char *fmt, ...) {
+    if (l->diverged) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(l->div_reason, sizeof(l->div_reason), fmt, ap);
+    va_end(ap);
+    l->diverged = 1;
+    l->div_day = day;
+    l->div_tick = tick;
+}
+
+static unsigned long long fnv_bytes(unsigned long long h, const void *p, size_t n) {
+    const unsigned char *b = (const unsigned char*)p;
+    for (size_t i = 0; i<n; i++) {
+        h ^= b[i];
+        h *= FNV64_PRIME;
+    }
+    return h;
+}
+
+static unsigned long long fnv_dbl(unsigned long long h, double v) {
+    /* -0.0 and 0.0 print the same, so they must hash the same. */
+    if (v==0.0) v = 0.0;
+    return fnv_bytes(h, &v, sizeof(v));
+}
+
+unsigned long long dlog_fingerprint(const char *const *paths, int n) {
+    unsigned long long h = FNV64_OFFSET;
+    for (int i = 0; i<n; i++) {
+        char *text = paths[i] ? read_entire_file(paths[i]) : NULL;
+        if (text) h = fnv_bytes(h, text, strlen(text));
+        /* Separator, so moving bytes between files changes the fingerprint. */
+        h = fnv_bytes(h, "\n\x1e", 2);
+        free(text);
+    }
+    return h;
+}
+
+static unsigned long long hash_character(unsigned long long h, const Character *c) {
+    h = fnv_dbl(h, c->hunger);
+    h = fnv_dbl(h, c->hydration);
+    h = fnv_dbl(h, c->fatigue);
+    h = fnv_dbl(h, c->morale);
+    h = fnv_dbl(h, c->injury);
+    h = fnv_dbl(h, c->illness);
+    h = fnv_bytes(h, &c->rt_remaining, sizeof(c->rt_remaining));
+    if (c->defense_posture) h = fnv_bytes(h, c->defense_posture, strlen(c->defense_posture));
+    return h;
+}
+
+unsigned long long dlog_state_hash(const World *w, const Character *a, const Character *b) {
+    unsigned long long h = FNV64_OFFSET;
+    const Shelter *s = &w->shelter;
+    h = fnv_dbl(h, s->temp_c);
+    h = fnv_dbl(h, s->signature);
+    h = fnv_dbl(h, s->power);
+    h = fnv_dbl(h, s->water_safe);
+    h = fnv_dbl(h, s->water_raw);
+    h = fnv_dbl(h, s->structure);
+    h = fnv_dbl(h, s->contamination);
+    h = fnv_dbl(h, w->hydroponic_health);
+    h = fnv_dbl(h, w->cooked_food_portions);
+    for (int i = 0; i<w->inv.items.n; i++) {
+        const ItemEntry *e = &w->inv.items.v[i];
+        h = fnv_bytes(h, e->key, strlen(e->key));
+        h = fnv_dbl(h, e->qty);
+    }
+    h = hash_character(h, a);
+    return hash_character(h, b);
+}
+
+/* ---- file format ---------------------------------------------------------- */
+
+static void put_u32(FILE *f, unsigned int v) {
+    for (int i = 0; i<4; i++) fputc((int)((v >> (8*i)) & 0xffu), f);
+}
+
+static void put_u64(FILE *f, unsigned long long v) {
+    for (int i = 0; i<8; i++) fputc((int)((v >> (8*i)) & 0xffu), f);
+}
+
+static void put_dbl(FILE *f, double v) {
+    unsigned long long bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u64(f, bits);
+}
+
+static void put_str(FILE *f, const char *s) {
+    size_t n = strlen(s);
+    put_u32(f, (unsigned int)n);
+    fwrite(s, 1, n, f);
+}
+
+typedef struct {
+    const unsigned char *p, *end;
+    int bad;
+} Reader;
+
+static unsigned long long get_bytes(Reader *r, int n) {
+    unsigned long long v = 0;
+    if (r->end - r->p < n) {
+        r->bad = 1;
+        return 0;
+    }
+    for (int i = 0; i<n; i++) v |= (unsigned long long)r->p[i] << (8*i);
+    r->p += n;
+    return v;
+}
+
+static unsigned int get_u32(Reader *r) {
+    return (unsigned int)get_bytes(r, 4);
+}
+
+static int get_i32(Reader *r) {
+    /* Ids are written as (unsigned)id, so -1 round-trips through 0xffffffff. */
+    unsigned int u = get_u32(r);
+    return u==0xffffffffu ? -1 : (int)u;
+}
+
+static double get_dbl(Reader *r) {
+    unsigned long long bits = get_bytes(r, 8);
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static char *get_str(Reader *r) {
+    unsigned int n = get_u32(r);
+    if (r->bad || (size_t)(r->end - r->p) < n) {
+        r->bad = 1;
+        return xstrdup("");
+    }
+    char *s = (char*)xmalloc((size_t)n+1);
+    memcpy(s, r->p, n);
+    s[n] = 0;
+    r->p += n;
+    return s;
+}
+
+int dlog_save(const DecisionLog *l, const char *path, char *err, size_t err_sz) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        snprintf(err, err_sz, "cannot write decision log %s", path);
+        return -1;
+    }
+    fwrite(DLOG_MAGIC, 1, 4, f);
+    put_u32(f, DLOG_VERSION);
+    put_u64(f, l->inputs);
+    put_u32(f, l->seed);
+    put_u32(f, (unsigned int)l->days);
+    put_u64(f, l->rng.s);
+
+    put_u32(f, (unsigned int)l->strings.n);
+    for (int i = 0; i<l->strings.n; i++) put_str(f, l->strings.v[i]);
+
+    /* Day, tick, agent and kind share one word: days < 2^22 and ticks < 2^5. */
+    put_u32(f, (unsigned int)l->decisions.n);
+    for (int i = 0; i<l->decisions.n; i++) {
+        const Decision *d = &l->decisions.v[i];
+        put_u32(f, ((unsigned int)d->day << 10) | ((unsigned int)d->tick << 5) | ((unsigned int)d->agent << 4) | (unsigned int)(d->kind & 0xf));
+        put_u32(f, (unsigned int)d->task);
+        put_u32(f, (unsigned int)d->station);
+        put_u32(f, (unsigned int)d->posture);
+        put_u32(f, (unsigned int)d->ticks);
+        put_dbl(f, d->priority);
+    }
+
+    put_u32(f, (unsigned int)l->notes.n);
+    for (int i = 0; i<l->notes.n; i++) {
+        const DecisionNote *nt = &l->notes.v[i];
+        put_u32(f, ((unsigned int)nt->day << 10) | ((unsigned int)nt->tick << 5) | ((unsigned int)nt->agent << 4) | (unsigned int)nt->counter);
+        put_str(f, nt->text);
+    }
+
+    put_u32(f, (unsigned int)l->draws.n);
+    for (int i = 0; i<l->draws.n; i++) put_u32(f, (unsigned int)l->draws.v[i]);
+
+    put_u32(f, (unsigned int)l->day_hash.n);
+    for (int i = 0; i<l->day_hash.n; i++) put_u64(f, l->day_hash.v[i]);
+
+    int failed = ferror(f);
+    if (fclose(f)!=0 || failed) {
+        snprintf(err, err_sz, "cannot write decision log %s", path);
+        return -1;
+    }
+    return 0;
+}
+
+static void unpack_when(unsigned int w, int *day, int *tick, int *agent, int *low) {
+    *day = (int)(w >> 10);
+    *tick = (int)((w >> 5) & 0x1fu);
+    *agent = (int)((w >> 4) & 0x1u);
+    *low = (int)(w & 0xfu);
+}
+
+int dlog_load(DecisionLog *l, const char *path, char *err, size_t err_sz) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        snprintf(err, err_sz, "cannot open decision log %s", path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char *buf = (unsigned char*)xmalloc(size > 0 ? (size_t)size : 1);
+    size_t got = size > 0 ? fread(buf, 1, (size_t)size, f) : 0;
+    fclose(f);
+
+    Reader r;
+    r.p = buf;
+    r.end = buf + got;
+    r.bad = 0;
+    if (got < 8 || memcmp(buf, DLOG_MAGIC, 4)!=0) {
+        free(buf);
+        snprintf(err, err_sz, "%s is not a decision log", path);
+        return -1;
+    }
+    r.p += 4;
+    if (get_u32(&r)!=DLOG_VERSION) {
+        free(buf);
+        snprintf(err, err_sz, "%s: unsupported decision log version", path);
+        return -1;
+    }
+
+    dlog_init(l);
+    l->inputs = get_bytes(&r, 8);
+    l->seed = get_u32(&r);
+    l->days = (int)get_u32(&r);
+    l->rng.s = get_bytes(&r, 8);
+
+    unsigned int n = get_u32(&r);
+    for (unsigned int i = 0; i<n && !r.bad; i++) VEC_PUSH(l->strings, get_str(&r));
+
+    n = get_u32(&r);
+    for (unsigned int i = 0; i<n && !r.bad; i++) {
+        Decision d;
+        unpack_when(get_u32(&r), &d.day, &d.tick, &d.agent, &d.kind);
+        d.task = get_i32(&r);
+        d.station = get_i32(&r);
+        d.posture = get_i32(&r);
+        d.ticks = (int)get_u32(&r);
+        d.priority = get_dbl(&r);
+        /* A string id past the table would be read later as a name; reject it here. */
+        if (d.task >= l->strings.n || d.station >= l->strings.n || d.posture >= l->strings.n) r.bad = 1;
+        VEC_PUSH(l->decisions, d);
+    }
+
+    n = get_u32(&r);
+    for (unsigned int i = 0; i<n && !r.bad; i++) {
+        DecisionNote nt;
+        unpack_when(get_u32(&r), &nt.day, &nt.tick, &nt.agent, &nt.counter);
+        nt.text = get_str(&r);
+        VEC_PUSH(l->notes, nt);
+    }
+
+    n = get_u32(&r);
+    for (unsigned int i = 0; i<n && !r.bad; i++) VEC_PUSH(l->draws, (int)get_u32(&r));
+
+    n = get_u32(&r);
+    for (unsigned int i = 0; i<n && !r.bad; i++) VEC_PUSH(l->day_hash, get_bytes(&r, 8));
+
+    free(buf);
+    if (r.bad) {
+        dlog_free(l);
+        snprintf(err, err_sz, "%s: truncated or corrupt decision log", path);
+        return -1;
+    }
+    return 0;
+}
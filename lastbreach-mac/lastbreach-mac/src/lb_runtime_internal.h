@@ -15,6 +15,8 @@
  * in include/lastbreach.h.
  */
 
+typedef struct CandidateSet CandidateSet;
+
 typedef struct {
     Character *ch;
     World *w;
@@ -24,6 +26,8 @@ typedef struct {
     /* Rule-local variable bindings set via `let`. */
     VecStr keys;
     VecDbl vals;
+    /* When set, every task candidate seen is also offered here (top-K alternatives). */
+    CandidateSet *alts;
 } EvalCtx;
 
 typedef struct {
@@ -33,18 +37,50 @@ typedef struct {
     int ticks;
     double priority;
     const char *station;
+    const TaskInput *inputs; /* from the TaskDef; reserved when the task starts */
+    int n_inputs;
     int stop_block;
 } Candidate;
 
+/* Alternatives kept per survivor for station assignment. */
+#define CAND_TOPK 4
+
+/*
+  Best task candidates of the rule phase that decided, highest priority first
+  and at most one per station, so v[0] is what choose_action returns.
+*/
+struct CandidateSet {
+    Candidate v[CAND_TOPK];
+    int n;
+};
+
 void ectx_init(EvalCtx *c);
 void ectx_clear(EvalCtx *c);
 void ectx_set(EvalCtx *c, const char *k, double v);
 int ectx_get(EvalCtx *c, const char *k, double *out);
 int truthy(double v);
 double eval_expr(EvalCtx *ctx, Expr *e);
+/* Interns literal stock()/has()/cond() item names in `inv` and caches their handles. */
+void character_bind_items(Character *ch, Inventory *inv);
+/* Same for one free-standing expression (a --until condition). */
+void expr_bind_items(Expr *e, Inventory *inv);
+/*
+  Collects what a character's script reads from `inv`: handles named by
+  stock()/has()/cond() go to `items`, tags named by stock_tag() into `tags`.
+*/
+void character_stock_reads(const Character *ch, const Inventory *inv, VecInt *items, ItemTagSet *tags);
+
+/* Groups on-event handlers by event id; choose_action rebinds when the world's table grows. */
+void character_bind_events(Character *ch, const WorldEvents *ev);
 
 void cand_reset(Candidate *c);
-/* Core scheduler entry: returns a concrete task or an explicit yield candidate. */
+/*
+  Core scheduler entry: returns a concrete task or an explicit yield candidate.
+  Tasks whose inputs cannot be reserved from w->reserve are skipped (preflight).
+*/
 Candidate choose_action(Character *ch, World *w, Catalog *cat, int day, int tick, int breach_level, int ev_breach, int ev_overnight);
+/* Same choice, also filling `alts` with the runner-up tasks at other stations. */
+Candidate choose_action_topk(Character *ch, World *w, Catalog *cat, int day, int tick, int breach_level, int ev_breach, int ev_overnight,
+                             CandidateSet *alts);
 
 #endif
@@ -10,16 +10,40 @@ void cand_reset(Candidate *c) {
     c->kind = 0;
     c->priority = -1e9;
 }
-static void cand_consider_task(Candidate *best, const char *name, int ticks, double pr, const char *station) {
+static void cand_consider(Candidate *best, const Candidate *c) {
     /* Keep only the highest-priority candidate found so far. */
-    if (pr > best->priority) {
+    if (c->priority > best->priority) {
         best->kind = 1;
-        best->priority = pr;
-        best->task_name = name;
-        best->ticks = ticks;
-        best->station = station;
+        best->priority = c->priority;
+        best->task_name = c->task_name;
+        best->ticks = c->ticks;
+        best->station = c->station;
+        best->inputs = c->inputs;
+        best->n_inputs = c->n_inputs;
     }
 }
+static int same_station(const char *a, const char *b) {
+    return a==b || (a && b && strcmp(a, b)==0);
+}
+static void cand_offer(CandidateSet *set, const Candidate *c) {
+    /* One entry per station: a lower-priority task at a taken station is no alternative. */
+    for (int i = 0; i<set->n; i++) {
+        if (!same_station(set->v[i].station, c->station)) continue;
+        if (c->priority <= set->v[i].priority) return;
+        memmove(&set->v[i], &set->v[i+1], sizeof(*set->v)*(size_t)(set->n-i-1));
+        set->n--;
+        break;
+    }
+    /* Equal priorities keep discovery order, matching cand_consider's strict '>'. */
+    int pos = 0;
+    while (pos<set->n && set->v[pos].priority >= c->priority) pos++;
+    if (pos >= CAND_TOPK) return;
+    if (set->n==CAND_TOPK) set->n--;
+    memmove(&set->v[pos+1], &set->v[pos], sizeof(*set->v)*(size_t)(set->n-pos));
+    set->v[pos] = *c;
+    set->v[pos].kind = 1;
+    set->n++;
+}
 static int exec_stmt_list_select(EvalCtx *ctx, Catalog *cat, const VecStmtPtr *list, double base_priority, Candidate *best) {
     /*
      * Execute scheduler statements in order and mutate `best` as directives are
@@ -61,7 +85,18 @@ static int exec_stmt_list_select(EvalCtx *ctx, Catalog *cat, const VecStmtPtr *l
             if (!s->u.task.for_ticks && td) ticks = td->time_ticks;
             if (s->u.task.priority) pr = eval_expr(ctx, s->u.task.priority);
             if (ticks<=0) ticks = 1;
-            cand_consider_task(best, s->u.task.task_name, ticks, pr, station);
+            /* Preflight (spec 8.1): a task short of its inputs is skipped, not started as a no-op. */
+            if (td && !ledger_can_reserve(&ctx->w->reserve, &ctx->w->inv, td->inputs, td->n_inputs)) break;
+            Candidate c;
+            cand_reset(&c);
+            c.task_name = s->u.task.task_name;
+            c.ticks = ticks;
+            c.priority = pr;
+            c.station = station;
+            c.inputs = td ? td->inputs : NULL;
+            c.n_inputs = td ? td->n_inputs : 0;
+            cand_consider(best, &c);
+            if (ctx->alts) cand_offer(ctx->alts, &c);
             break;
         }
         case ST_IF: {
@@ -93,9 +128,60 @@ static int exec_stmt_list_select(EvalCtx *ctx, Catalog *cat, const VecStmtPtr *l
     }
     return 0;
 }
+void character_bind_events(Character *ch, const WorldEvents *ev) {
+    int n = ev->names.n;
+    free(ch->ev_first);
+    free(ch->ev_rules);
+    ch->ev_first = (int*)xmalloc(sizeof(int)*(size_t)(n+1));
+    ch->ev_rules = (int*)xmalloc(sizeof(int)*(size_t)(ch->on_events.n+1));
+    for (int e = 0; e<=n; e++) ch->ev_first[e] = 0;
+    /* Counting sort by id keeps handlers of one event in declaration order. */
+    for (int i = 0; i<ch->on_events.n; i++) {
+        OnEventRule *r = &ch->on_events.v[i];
+        /* The id lives in the shared script; copies of one world find the same id, so skip the store. */
+        int id = event_find(ev, r->event_name);
+        if (r->event_id != id) r->event_id = id;
+        if (r->event_id >= 0) ch->ev_first[r->event_id+1]++;
+    }
+    for (int e = 0; e<n; e++) ch->ev_first[e+1] += ch->ev_first[e];
+    int *fill = (int*)xmalloc(sizeof(int)*(size_t)(n+1));
+    memcpy(fill, ch->ev_first, sizeof(int)*(size_t)(n+1));
+    for (int i = 0; i<ch->on_events.n; i++) {
+        int id = ch->on_events.v[i].event_id;
+        if (id >= 0) ch->ev_rules[fill[id]++] = i;
+    }
+    free(fill);
+    ch->ev_n = n;
+    ch->ev_table = ev;
+}
+static void consider_event_handlers(EvalCtx *ctx, Catalog *cat, int id, Candidate *best) {
+    Character *ch = ctx->ch;
+    if (id < 0 || id >= ch->ev_n) return;
+    for (int k = ch->ev_first[id]; k<ch->ev_first[id+1]; k++) {
+        OnEventRule *r = &ch->on_events.v[ch->ev_rules[k]];
+        if (r->when_cond) {
+            double ok = eval_expr(ctx, r->when_cond);
+            if (!truthy(ok)) continue;
+        }
+        Candidate tmp;
+        cand_reset(&tmp);
+        (void)exec_stmt_list_select(ctx, cat, &r->stmts, r->priority, &tmp);
+        if (tmp.kind==1) cand_consider(best, &tmp);
+    }
+}
 Candidate choose_action(Character *ch, World *w, Catalog *cat, int day, int tick, int breach_level, int ev_breach, int ev_overnight) {
+    return choose_action_topk(ch, w, cat, day, tick, breach_level, ev_breach, ev_overnight, NULL);
+}
+Candidate choose_action_topk(Character *ch, World *w, Catalog *cat, int day, int tick, int breach_level, int ev_breach, int ev_overnight,
+                             CandidateSet *alts) {
     EvalCtx ctx;
     memset(&ctx, 0, sizeof(ctx));
+    /*
+     * Phases return as soon as one yields a task, so the set only ever holds
+     * candidates of the deciding phase.
+     */
+    if (alts) alts->n = 0;
+    ctx.alts = alts;
     ctx.ch = ch;
     ctx.w = w;
     ctx.day = day;
@@ -113,24 +199,21 @@ Candidate choose_action(Character *ch, World *w, Catalog *cat, int day, int tick
      * 3) plan blocks
      * 4) generic fallback rules
      */
-    /* 1) on breach */
-    if (ev_breach) {
-        for (int i = 0; i<ch->on_events.n; i++) {
-            OnEventRule *r = &ch->on_events.v[i];
-            if (strcmp(r->event_name, "breach")!=0) continue;
-            if (r->when_cond) {
-                double ok = eval_expr(&ctx, r->when_cond);
-                if (!truthy(ok)) continue;
-            }
-            Candidate tmp;
-            cand_reset(&tmp);
-            (void)exec_stmt_list_select(&ctx, cat, &r->stmts, r->priority, &tmp);
-            if (tmp.kind==1) cand_consider_task(&best, tmp.task_name, tmp.ticks, tmp.priority, tmp.station);
-        }
-        if (best.kind==1) {
-            ectx_clear(&ctx);
-            return best;
-        }
+    /*
+     * 1) on-event handlers, dispatched by id to the events firing this tick.
+     * Breach/overnight come from the caller's flags; world-declared events
+     * from w->events.now. Quiet ticks never touch the handler list.
+     */
+    if (ch->ev_table!=&w->events || ch->ev_n!=w->events.names.n) character_bind_events(ch, &w->events);
+    if (ev_breach) consider_event_handlers(&ctx, cat, EVENT_BREACH, &best);
+    if (ev_overnight) consider_event_handlers(&ctx, cat, EVENT_OVERNIGHT, &best);
+    for (int i = 0; i<w->events.now.n; i++) {
+        int id = w->events.now.v[i].id;
+        if (id!=EVENT_BREACH && id!=EVENT_OVERNIGHT) consider_event_handlers(&ctx, cat, id, &best);
+    }
+    if (best.kind==1) {
+        ectx_clear(&ctx);
+        return best;
     }
     /* 2) thresholds */
     for (int i = 0; i<ch->thresholds.n; i++) {
@@ -144,7 +227,7 @@ Candidate choose_action(Character *ch, World *w, Catalog *cat, int day, int tick
         cand_reset(&tmp);
         (void)exec_stmt_list_select(&ctx, cat, &one, 0.0, &tmp);
         VEC_FREE(one);
-        if (tmp.kind==1) cand_consider_task(&best, tmp.task_name, tmp.ticks, tmp.priority, tmp.station);
+        if (tmp.kind==1) cand_consider(&best, &tmp);
     }
     if (best.kind==1) {
         ectx_clear(&ctx);
@@ -157,7 +240,7 @@ Candidate choose_action(Character *ch, World *w, Catalog *cat, int day, int tick
         Candidate tmp;
         cand_reset(&tmp);
         (void)exec_stmt_list_select(&ctx, cat, &b->stmts, 0.0, &tmp);
-        if (tmp.kind==1) cand_consider_task(&best, tmp.task_name, tmp.ticks, tmp.priority, tmp.station);
+        if (tmp.kind==1) cand_consider(&best, &tmp);
         if (tmp.stop_block) break;
     }
     /* 4) rules */
@@ -166,7 +249,7 @@ Candidate choose_action(Character *ch, World *w, Catalog *cat, int day, int tick
         Candidate tmp;
         cand_reset(&tmp);
         (void)exec_stmt_list_select(&ctx, cat, &r->stmts, r->priority, &tmp);
-        if (tmp.kind==1) cand_consider_task(&best, tmp.task_name, tmp.ticks, tmp.priority, tmp.station);
+        if (tmp.kind==1) cand_consider(&best, &tmp);
     }
     if (best.kind==0) {
         /* Scheduler always returns an explicit action; idle is encoded as yield. */
@@ -0,0 +1,358 @@
+#include "lastbreach.h"
+/**
+ * lb_shard.c
+ *
+ * Module: Partial result files for runs sharded over processes.
+ *
+ * A batch is always cut into the same fixed chunks and merged in chunk
+ * order; a sweep's points never depend on one another. So a shard takes a
+ * contiguous slice of chunks or points, and as long as it hands them over
+ * unmerged and bit-exact, merging the slices of all shards repeats the
+ * single-process merge step for step, down to the quantile sketches.
+ *
+ * The file is line-oriented text that says what it is: which inputs and
+ * flags produced it, which shard of how many it is, and then one block per
+ * chunk or point. Doubles are written with %a, which reads back exactly.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+#define PARTIAL_MAGIC "lastbreach-partial"
+#define PARTIAL_VERSION 1
+
+int shard_parse(const char *spec, int *shard, int *shards, char *err, size_t errn) {
+    int i, n;
+    char tail;
+    if (sscanf(spec, "%d/%d%c", &i, &n, &tail)!=2 || n < 1 || i < 1 || i > n) {
+        snprintf(err, errn, "--shard expects i/n with 1 <= i <= n, got '%s'", spec);
+        return -1;
+    }
+    *shard = i;
+    *shards = n;
+    return 0;
+}
+
+void shard_range(long long total, int shard, int shards, long long *first, long long *end) {
+    *first = total * (shard-1) / shards;
+    *end = total * shard / shards;
+}
+
+void partial_init(Partial *p) {
+    memset(p, 0, sizeof(*p));
+    p->options = xstrdup("");
+    sweep_init(&p->sweep);
+}
+
+void partial_free(Partial *p) {
+    if (p->chunks) {
+        for (int k = 0; k<p->n; k++) bstats_free(&p->chunks[k]);
+        free(p->chunks);
+    }
+    free(p->rows);
+    free(p->options);
+    sweep_free(&p->sweep);
+    memset(p, 0, sizeof(*p));
+}
+
+/* ---- writing ------------------------------------------------------------- */
+
+static void put_stat(FILE *f, const StatRow *row) {
+    const StreamStat *s = &row->s;
+    /* The name may hold spaces ("done.Defensive combat"), so it ends the line. */
+    fprintf(f, "row %lld %a %a %a %a %d %d %s\n", s->n, s->mean, s->m2, s->min, s->max, s->nc, s->nb, row->name);
+    for (int i = 0; i<s->nc; i++) fprintf(f, "c %a %a %a %a\n", s->c[i].mean, s->c[i].weight, s->c[i].lo, s->c[i].hi);
+    for (int i = 0; i<s->nb; i++) fprintf(f, "b %a %a %a %a\n", s->buf[i].mean, s->buf[i].weight, s->buf[i].lo, s->buf[i].hi);
+}
+
+int partial_save(const Partial *p, const char *path, char *err, size_t errn) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        snprintf(err, errn, "cannot write partial result %s", path);
+        return -1;
+    }
+    fprintf(f, "%s %d\n", PARTIAL_MAGIC, PARTIAL_VERSION);
+    fprintf(f, "kind %s\n", p->kind==PARTIAL_BATCH ? "batch" : "sweep");
+    fprintf(f, "inputs %016llx\n", p->inputs);
+    fprintf(f, "options %s\n", p->options);
+    fprintf(f, "seed %u\n", p->seed);
+    fprintf(f, "days %d\n", p->days);
+    fprintf(f, "shard %d %d\n", p->shard, p->shards);
+    fprintf(f, "units %d\n", p->total);
+    fprintf(f, "first %d\n", p->first);
+    fprintf(f, "count %d\n", p->n);
+    if (p->kind==PARTIAL_BATCH) {
+        fprintf(f, "runs %lld\n", p->runs);
+        fprintf(f, "fixed %d\n", p->fixed);
+        for (int k = 0; k<p->n; k++) {
+            const BatchStats *b = &p->chunks[k];
+            fprintf(f, "chunk %d %lld %d\n", p->first + k, b->runs, b->rows.n);
+            for (int i = 0; i<b->rows.n; i++) put_stat(f, &b->rows.v[i]);
+        }
+    } else {
+        fprintf(f, "seeds %d\n", p->sweep.seeds);
+        for (int ax = 0; ax<p->sweep.axes.n; ax++) {
+            const SweepAxis *a = &p->sweep.axes.v[ax];
+            fprintf(f, "axis %a %a %d %s\n", a->start, a->step, a->n, a->key);
+        }
+        for (int k = 0; k<p->n; k++) {
+            const SweepRow *r = &p->rows[k];
+            fprintf(f, "point %d %a %a %a %a %a %a %a\n", p->first + k, r->structure, r->structure_min, r->food,
+                    r->water_safe, r->hunger, r->morale, r->lost);
+        }
+    }
+    fprintf(f, "end\n");
+    int failed = ferror(f);
+    if (fclose(f)!=0 || failed) {
+        snprintf(err, errn, "cannot write partial result %s", path);
+        return -1;
+    }
+    return 0;
+}
+
+/* ---- reading ------------------------------------------------------------- */
+
+/* Next line of a NUL-terminated buffer, terminated in place; NULL at the end. */
+static char *next_line(char **cur) {
+    char *line = *cur;
+    if (!*line) return NULL;
+    char *nl = strchr(line, '\n');
+    if (nl) {
+        *nl = 0;
+        *cur = nl+1;
+    } else {
+        *cur = line + strlen(line);
+    }
+    return line;
+}
+
+static int read_centroid(const char *rest, StatCentroid *c) {
+    return sscanf(rest, "%lf %lf %lf %lf", &c->mean, &c->weight, &c->lo, &c->hi)==4 ? 0 : -1;
+}
+
+/* A row's centroid lines must match the counts on its row line. */
+static int row_complete(const StreamStat *s, int got_c, int got_b) {
+    return !s || (got_c==s->nc && got_b==s->nb);
+}
+
+int partial_load(Partial *p, const char *path, char *err, size_t errn) {
+    char *text = read_entire_file(path);
+    if (!text) {
+        snprintf(err, errn, "cannot open partial result %s", path);
+        return -1;
+    }
+    partial_init(p);
+    char *cur = text, *line;
+    char key[32];
+    int version = 0, bad = 0, ended = 0, count = -1, points = 0;
+    BatchStats *chunk = NULL;
+    StreamStat *stat = NULL;
+    int got_c = 0, got_b = 0;
+
+    line = next_line(&cur);
+    if (!line || sscanf(line, PARTIAL_MAGIC " %d", &version)!=1 || strncmp(line, PARTIAL_MAGIC " ", strlen(PARTIAL_MAGIC)+1)!=0) {
+        free(text);
+        partial_free(p);
+        snprintf(err, errn, "%s is not a partial result file", path);
+        return -1;
+    }
+    if (version!=PARTIAL_VERSION) {
+        free(text);
+        partial_free(p);
+        snprintf(err, errn, "%s: unsupported partial result version %d", path, version);
+        return -1;
+    }
+    while (!bad && !ended && (line = next_line(&cur))) {
+        int off = 0;
+        if (sscanf(line, "%31s%n", key, &off)!=1) continue;
+        const char *rest = line + off;
+        if (*rest==' ') rest++;
+        if (strcmp(key, "c")==0 || strcmp(key, "b")==0) {
+            int is_c = key[0]=='c';
+            if (!stat || (is_c ? got_c >= stat->nc : got_b >= stat->nb)) bad = 1;
+            else bad = read_centroid(rest, is_c ? &stat->c[got_c++] : &stat->buf[got_b++])!=0;
+            continue;
+        }
+        if (!row_complete(stat, got_c, got_b)) {
+            bad = 1;
+            break;
+        }
+        stat = NULL;
+        if (strcmp(key, "kind")==0) {
+            if (strcmp(rest, "batch")==0) p->kind = PARTIAL_BATCH;
+            else if (strcmp(rest, "sweep")==0) p->kind = PARTIAL_SWEEP;
+            else bad = 1;
+        } else if (strcmp(key, "inputs")==0) {
+            bad = sscanf(rest, "%llx", &p->inputs)!=1;
+        } else if (strcmp(key, "options")==0) {
+            free(p->options);
+            p->options = xstrdup(rest);
+        } else if (strcmp(key, "seed")==0) {
+            bad = sscanf(rest, "%u", &p->seed)!=1;
+        } else if (strcmp(key, "days")==0) {
+            bad = sscanf(rest, "%d", &p->days)!=1;
+        } else if (strcmp(key, "shard")==0) {
+            bad = sscanf(rest, "%d %d", &p->shard, &p->shards)!=2 || p->shards < 1 || p->shard < 1 || p->shard > p->shards;
+        } else if (strcmp(key, "units")==0) {
+            bad = sscanf(rest, "%d", &p->total)!=1;
+        } else if (strcmp(key, "first")==0) {
+            bad = sscanf(rest, "%d", &p->first)!=1;
+        } else if (strcmp(key, "count")==0) {
+            bad = sscanf(rest, "%d", &count)!=1 || count < 0 || count > 100000000;
+            if (!bad) {
+                /* Both kinds get their slots now; the kind line came first. */
+                if (p->kind==PARTIAL_BATCH) p->chunks = (BatchStats*)xmalloc(sizeof(BatchStats)*(size_t)(count > 0 ? count : 1));
+                else p->rows = (SweepRow*)xmalloc(sizeof(SweepRow)*(size_t)(count > 0 ? count : 1));
+            }
+        } else if (strcmp(key, "runs")==0) {
+            bad = sscanf(rest, "%lld", &p->runs)!=1;
+        } else if (strcmp(key, "fixed")==0) {
+            bad = sscanf(rest, "%d", &p->fixed)!=1;
+        } else if (strcmp(key, "seeds")==0) {
+            bad = sscanf(rest, "%d", &p->sweep.seeds)!=1;
+        } else if (strcmp(key, "axis")==0) {
+            SweepAxis a;
+            int name = 0;
+            bad = sscanf(rest, "%lf %lf %d %n", &a.start, &a.step, &a.n, &name)!=3 || name==0 || !rest[name];
+            if (!bad) {
+                a.key = xstrdup(rest + name);
+                VEC_PUSH(p->sweep.axes, a);
+            }
+        } else if (strcmp(key, "chunk")==0) {
+            int index, rows;
+            long long runs;
+            bad = !p->chunks || p->n >= count || sscanf(rest, "%d %lld %d", &index, &runs, &rows)!=3 || index!=p->first + p->n;
+            if (!bad) {
+                chunk = &p->chunks[p->n++];
+                bstats_init(chunk);
+                chunk->runs = runs;
+            }
+        } else if (strcmp(key, "row")==0) {
+            StatRow row;
+            int name = 0;
+            memset(&row, 0, sizeof(row));
+            bad = !chunk || sscanf(rest, "%lld %lf %lf %lf %lf %d %d %n", &row.s.n, &row.s.mean, &row.s.m2, &row.s.min, &row.s.max,
+                                   &row.s.nc, &row.s.nb, &name)!=7 || name==0
+                  || row.s.nc < 0 || row.s.nc > STAT_CENTROIDS || row.s.nb < 0 || row.s.nb > STAT_BUFFER;
+            if (!bad) {
+                row.name = xstrdup(rest + name);
+                VEC_PUSH(chunk->rows, row);
+                stat = &chunk->rows.v[chunk->rows.n-1].s;
+                got_c = got_b = 0;
+            }
+        } else if (strcmp(key, "point")==0) {
+            int index;
+            SweepRow r;
+            bad = !p->rows || points >= count
+                  || sscanf(rest, "%d %lf %lf %lf %lf %lf %lf %lf", &index, &r.structure, &r.structure_min, &r.food,
+                            &r.water_safe, &r.hunger, &r.morale, &r.lost)!=8
+                  || index!=p->first + points;
+            if (!bad) p->rows[points++] = r;
+        } else if (strcmp(key, "end")==0) {
+            ended = 1;
+        } else {
+            bad = 1;
+        }
+    }
+    if (p->kind==PARTIAL_SWEEP) p->n = points;
+    free(text);
+    /* A shard that died mid-write has no end line, or fewer blocks than it announced. */
+    if (bad || !ended || p->n!=count) {
+        partial_free(p);
+        snprintf(err, errn, "%s: truncated or corrupt partial result", path);
+        return -1;
+    }
+    return 0;
+}
+
+/* ---- merging ------------------------------------------------------------- */
+
+static int same_sweep(const Sweep *a, const Sweep *b) {
+    if (a->seeds!=b->seeds || a->axes.n!=b->axes.n) return 0;
+    for (int ax = 0; ax<a->axes.n; ax++) {
+        const SweepAxis *x = &a->axes.v[ax], *y = &b->axes.v[ax];
+        if (strcmp(x->key, y->key)!=0 || x->start!=y->start || x->step!=y->step || x->n!=y->n) return 0;
+    }
+    return 1;
+}
+
+/* Every part must come from the same run: only the shard number may differ. */
+static int check_parts(Partial *parts, int n, char *err, size_t errn) {
+    const Partial *a = &parts[0];
+    if (n!=a->shards) {
+        snprintf(err, errn, "got %d partial files for a run split into %d shards", n, a->shards);
+        return -1;
+    }
+    int *seen = (int*)xmalloc(sizeof(int)*(size_t)n);
+    for (int i = 0; i<n; i++) seen[i] = 0;
+    int rc = 0;
+    for (int i = 0; i<n && rc==0; i++) {
+        const Partial *b = &parts[i];
+        const char *what = NULL;
+        if (b->kind!=a->kind) what = "mode (batch or sweep)";
+        else if (b->inputs!=a->inputs) what = "input files";
+        else if (strcmp(b->options, a->options)!=0) what = "options";
+        else if (b->seed!=a->seed || b->days!=a->days) what = "seed or days";
+        else if (b->shards!=a->shards || b->total!=a->total) what = "shard count";
+        else if (b->kind==PARTIAL_BATCH && (b->runs!=a->runs || b->fixed!=a->fixed)) what = "run count";
+        else if (b->kind==PARTIAL_SWEEP && !same_sweep(&b->sweep, &a->sweep)) what = "sweep axes or seeds";
+        if (what) {
+            snprintf(err, errn, "shard %d/%d and shard %d/%d differ in %s", a->shard, a->shards, b->shard, b->shards, what);
+            rc = -1;
+            break;
+        }
+        long long first, end;
+        shard_range(b->total, b->shard, b->shards, &first, &end);
+        if (seen[b->shard-1]++) {
+            snprintf(err, errn, "shard %d/%d given twice", b->shard, b->shards);
+            rc = -1;
+        } else if (b->first!=first || b->n!=end-first) {
+            snprintf(err, errn, "shard %d/%d does not hold its slice", b->shard, b->shards);
+            rc = -1;
+        }
+    }
+    free(seen);
+    return rc;
+}
+
+/* Part holding unit `u`; parts are checked to tile the units. */
+static const Partial *part_of(const Partial *parts, int n, int u) {
+    for (int i = 0; i<n; i++) {
+        if (u >= parts[i].first && u < parts[i].first + parts[i].n) return &parts[i];
+    }
+    return NULL;
+}
+
+int partial_merge(Partial *parts, int n, FILE *out, char *err, size_t errn) {
+    if (n < 1) {
+        snprintf(err, errn, "no partial files to merge");
+        return -1;
+    }
+    if (check_parts(parts, n, err, errn)!=0) return -1;
+    const Partial *a = &parts[0];
+    if (a->kind==PARTIAL_SWEEP) {
+        SweepRow *rows = (SweepRow*)xmalloc(sizeof(SweepRow)*(size_t)(a->total > 0 ? a->total : 1));
+        for (int u = 0; u<a->total; u++) {
+            const Partial *p = part_of(parts, n, u);
+            rows[u] = p->rows[u - p->first];
+        }
+        sweep_write_csv(out, &a->sweep, rows);
+        free(rows);
+        return 0;
+    }
+    /* As batch_run: the fixed rows first, then every chunk in chunk order. */
+    BatchStats merged;
+    bstats_init(&merged);
+    const BatchStats *c0 = &part_of(parts, n, 0)->chunks[0];
+    for (int i = 0; i<a->fixed && i<c0->rows.n; i++) (void)bstats_row(&merged, c0->rows.v[i].name);
+    for (int u = 0; u<a->total; u++) {
+        const Partial *p = part_of(parts, n, u);
+        bstats_merge(&merged, &p->chunks[u - p->first]);
+    }
+    bstats_finish(&merged, a->fixed);
+    fprintf(out, "Batch: %lld runs, seeds %u.., days=%d\n", merged.runs, a->seed, a->days);
+    bstats_print(out, &merged);
+    bstats_free(&merged);
+    return 0;
+}
@@ -1,19 +1,62 @@
 #include "lb_runtime_internal.h"
+#include "lb_canon_ids.h"
 /**
  * lb_sim.c
  *
  * Module: Tick/day simulation loop, world events, and task progression/output.
  */
 
-static int rand_percent(void) {
-    return rand()%100;
+static int replay_draw(World *w, DecisionLog *l) {
+    /* An own stream still advances, so the beds' draws line up with the recording. */
+    if (w->own_rng) (void)lb_rng_next(&w->rng);
+    if (l->next_draw >= l->draws.n) {
+        dlog_diverge(l, w->inv.now/DAY_TICKS, w->inv.now%DAY_TICKS, "the run needs more random draws than were recorded");
+        return 0;
+    }
+    return l->draws.v[l->next_draw++];
 }
 
-typedef struct {
-    /* -1 means no breach that day. */
-    int breach_tick;
-    int breach_level;
-} DayEvents;
+/*
+  CRN stream of `purpose` at absolute tick `at`. Each (tick, purpose) pair
+  restarts from its own key, so how many draws one purpose made earlier, or
+  another purpose makes now, never shifts these.
+*/
+static LbRng *crn_stream(World *w, int purpose, int at) {
+    if (w->crn_at[purpose]!=at) {
+        w->crn_at[purpose] = at;
+        lb_rng_seed(&w->crn_rng[purpose], w->crn_seed, (unsigned long long)at*RNG_PURPOSES + (unsigned long long)purpose + 1);
+    }
+    return &w->crn_rng[purpose];
+}
+
+static int sim_rand_at(World *w, int purpose, int at) {
+    DecisionLog *l = w->dlog;
+    if (l && l->replaying) return replay_draw(w, l);
+    if (purpose==RNG_HARVEST || purpose==RNG_PRESERVE) w->steady_roll_day = at / DAY_TICKS;
+    int v;
+    if (w->crn) v = (int)(lb_rng_next(crn_stream(w, purpose, at)) >> 33);
+    /* Region shelters draw from their own stream so threads never share rand() state. */
+    else v = w->own_rng ? (int)(lb_rng_next(&w->rng) >> 33) : rand();
+    if (l) VEC_PUSH(l->draws, v);
+    return v;
+}
+
+static int sim_rand(World *w, int purpose) {
+    return sim_rand_at(w, purpose, w->inv.now);
+}
+
+static int rand_percent(World *w, int purpose) {
+    return sim_rand(w, purpose)%100;
+}
+
+static void sim_log(World *w, const char *fmt, ...) {
+    /* Batch drivers run without a log; skipping the formatting is most of their saving. */
+    if (!w->log) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(w->log, fmt, ap);
+    va_end(ap);
+}
 
 typedef struct {
     /* Per-task completion counter used for end-of-run diagnostics. */
@@ -28,78 +71,9 @@ typedef struct {
     /* These counters make idle/conflict behavior visible in output summaries. */
     int idle_ticks;
     int conflict_yields;
+    int conflict_switches; /* lost a station but took the next-best task elsewhere */
 } AgentDiagnostics;
 
-typedef struct {
-    /* Canonical task name in catalog/scripts. */
-    const char *name;
-    double hunger;
-    double hydration;
-    double morale;
-    double injury;
-    double illness;
-    double temp_c;
-    double power;
-    double water_safe;
-    double water_raw;
-    double structure;
-    double contamination;
-    double signature;
-} TaskDelta;
-
-/*
- * Baseline per-completion impact table.
- * Task-specific logic in apply_task_effects() can further modify outcomes
- * (inventory usage, conversions, conditional bonuses/penalties, etc.).
- */
-static const TaskDelta kTaskDeltas[] = {
-    {"Reading", 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Eating", 12, 5, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Cooking", 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Meal prep", 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Food preservation", 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, -0.5, 0},
-    {"Sleeping", 0, 0, 2, -1, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Resting", 0, 0, 1, -0.5, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Socializing", 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Talking", 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Watching", 0, 0, 2, 0, 0, 0, -0.5, 0, 0, 0, 0, 0},
-    {"Computer work", 0, 0, 1, 0, 0, 0, -1.5, 0, 0, 0, 0, 0.2},
-    {"Playing video games", 0, 0, 4, 0, 0, 0, -1, 0, 0, 0, 0, 0.2},
-    {"Playing guitar", 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0.3},
-    {"Knitting", 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Crocheting", 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Sewing", 0, 0, 2, 0, 0, 0, 0, 0, 0, 0.3, 0, 0},
-    {"Crafting", 0, 0, 2, 0, 0, 0, -0.5, 0, 0, 0.4, 0, 0.2},
-    {"Painting", 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Drawing", 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-    {"Gardening", 0, 0, 2, 0, 0, 0, 0, 0, 0, 0.2, -0.5, 0},
-    {"Watering plants", 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, -0.5, 0},
-    {"Hydroponics maintenance", 0, 0, 1, 0, 0, 0, -0.3, 0, 0, 0.5, -1, 0},
-    {"Aquarium maintenance", 0, 0, 1, 0, 0, 0, -0.2, 0, 0, 0, -0.8, 0},
-    {"Fishing", 0, 0, 1, 0, 0, 0, -0.4, 0, 0, 0, 0, 0.8},
-    {"Fish cleaning", 0, 0, 0.5, 0, 0, 0, 0, 0, 0, 0, 0.3, 0},
-    {"Swimming", 0, -2, 2, -1, 0, 0, 0, 0, 0, 0, 0, 0.5},
-    {"Scouting outside", 0, 0, -1, 1, 0, 0, -0.8, 0, 0, 0, 0, 1.2},
-    {"Telescope use", 0, 0, 1, 0, 0, 0, -0.2, 0, 0, 0, 0, 0.6},
-    {"Defensive shooting", 0, 0, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0.8},
-    {"Defensive combat", 0, 0, -1, 2, 0, 0, 0, 0, 0, -0.5, 0, 1.0},
-    {"Gun smithing", 0, 0, 1, 0, 0, 0, 0, 0, 0, 0.4, 0, 0.2},
-    {"Electronics repair", 0, 0, 1, 0, 0, 0, 0.4, 0, 0, 0, 0, 0},
-    {"Electrical diagnostics", 0, 0, 0, 0, 0, 0, 0.2, 0, 0, 0, 0, 0},
-    {"Soldering", 0, 0, 0, 0, 0, 0, 0.2, 0, 0, 0, 0, 0},
-    {"Power management", 0, 0, 0.5, 0, 0, 0, 1.5, 0, 0, 0, 0, 0},
-    {"Radio communication", 0, 0, 0, 0, 0, 0, -0.4, 0, 0, 0, 0, 1.5},
-    {"Tending a fire", 0, 0, 0.5, 0, 0, 1.2, 0, 0, 0, 0, 0, 0.4},
-    {"Heating", 0, 0, 0, 0, 0, 2.0, 0, 0, 0, 0, 0, 0},
-    {"General shelter chores", 0, 0, 0.5, 0, 0, 0, 0, 0, 0, 0.5, -0.8, 0},
-    {"Maintenance chores", 0, 0, 0.5, 0, 0, 0, 0.2, 0, 0, 1.0, -0.2, 0},
-    {"Cleaning", 0, 0, 0.5, 0, 0, 0, 0, 0, 0, 0, -2.0, 0},
-    {"First aid", 0, 0, 1, -12, 0, 0, 0, 0, 0, 0, -0.5, 0},
-    {"Medical treatment", 0, 0, 1, 0, -12, 0, -0.2, 0, 0, 0, -1.0, 0},
-    {"Water collection", 0, 0, 0, 0, 0, 0, 0, 0, 2.5, 0, -0.4, 0.4},
-    {"Water filtration", 0, 0, 0, 0, 0, 0, -0.2, 2.0, -2.0, 0, -1.0, 0}
-};
-
 static const char *kPlantProduce[] = {
     "Tomato",
     "Green bean",
@@ -107,6 +81,14 @@ static const char *kPlantProduce[] = {
     "Garlic"
 };
 
+/* Same order as kPlantProduce; canonical items need no lookup. */
+static const ItemHandle kPlantProduceItems[] = {
+    CANON_ITEM_TOMATO,
+    CANON_ITEM_GREEN_BEAN,
+    CANON_ITEM_CHILI,
+    CANON_ITEM_GARLIC
+};
+
 static void diag_init(AgentDiagnostics *d) {
     memset(d, 0, sizeof(*d));
 }
@@ -207,6 +189,7 @@ static int group_in_plan(const VecStr *planned, const char *const *tasks, int nt
 }
 
 static void print_need_line(
+    FILE *out,
     const char *name,
     const char *state,
     double metric,
@@ -215,7 +198,8 @@ static void print_need_line(
     int in_plan,
     int in_progress
 ) {
-    printf("      %s: %s (%s=%.0f) support_tasks_completed=%d support_task_in_progress=%s support_tasks_in_plan=%s\n",
+    if (!out) return;
+    fprintf(out, "      %s: %s (%s=%.0f) support_tasks_completed=%d support_task_in_progress=%s support_tasks_in_plan=%s\n",
            name, state, metric_name, metric, completed_support, in_progress?"yes":"no", in_plan?"yes":"no");
 }
 
@@ -232,23 +216,12 @@ static const char *high_is_bad_state(double v, double low, double critical) {
 }
 
 static double edible_stock(World *w) {
-    return inv_stock(&w->inv, "Food")
-           + inv_stock(&w->inv, "Fish")
-           + inv_stock(&w->inv, "Tomato")
-           + inv_stock(&w->inv, "Green bean")
-           + inv_stock(&w->inv, "Chili")
-           + inv_stock(&w->inv, "Garlic")
-           + inv_stock(&w->inv, "Ramen")
-           + inv_stock(&w->inv, "Canned spam")
-           + inv_stock(&w->inv, "Canned tomato")
-           + inv_stock(&w->inv, "Canned beans")
-           + inv_stock(&w->inv, "Canned corn")
-           + inv_stock(&w->inv, "Canned tuna")
-           + w->cooked_food_portions;
+    /* "edible" is tagged in data/items.txt; the inventory keeps the total current. */
+    return inv_stock_tag(&w->inv, "edible") + w->cooked_food_portions;
 }
 
 static double total_water_stock(World *w) {
-    return w->shelter.water_safe + w->shelter.water_raw + inv_stock(&w->inv, "Water");
+    return w->shelter.water_safe + w->shelter.water_raw + inv_stock_h(&w->inv, CANON_ITEM_WATER);
 }
 
 static int group_in_progress(Character *ch, const char *const *tasks, int ntasks) {
@@ -292,54 +265,54 @@ static void print_need_diagnostics(Character *ch, World *w, const AgentDiagnosti
     int injury_in_progress = group_in_progress(ch, kInjuryTasks, (int)(sizeof(kInjuryTasks)/sizeof(kInjuryTasks[0])));
     int illness_in_progress = group_in_progress(ch, kIllnessTasks, (int)(sizeof(kIllnessTasks)/sizeof(kIllnessTasks[0])));
 
-    printf("    life-gaps:\n");
-    print_need_line("nourishment", low_is_bad_state(ch->hunger, 20.0, 45.0), ch->hunger, "hunger", nourish_done, nourish_in_plan, nourish_in_progress);
-    if (ch->hunger <= 45.0 && nourish_done == 0) printf("        gap: recovery tasks for food were never completed.\n");
-    if (ch->hunger <= 45.0 && !nourish_in_plan) printf("        gap: no food-recovery task is present in this character's policy.\n");
-    if (ch->hunger <= 45.0 && edible_stock(w) < 1.0) printf("        gap: edible stock is near zero (edible_total=%.1f).\n", edible_stock(w));
-
-    print_need_line("hydration", low_is_bad_state(ch->hydration, 20.0, 45.0), ch->hydration, "hydration", hydration_done, hydration_in_plan, hydration_in_progress);
-    if (ch->hydration <= 45.0 && hydration_done == 0) printf("        gap: water-related tasks were never completed.\n");
-    if (ch->hydration <= 45.0 && !hydration_in_plan) printf("        gap: no water-supply task is present in this character's policy.\n");
-    if (ch->hydration <= 45.0 && total_water_stock(w) < 1.0) printf("        gap: available water is near zero (water_total=%.1f).\n", total_water_stock(w));
-
-    print_need_line("rest", high_is_bad_state(ch->fatigue, 65.0, 85.0), ch->fatigue, "fatigue", rest_done, rest_in_plan, rest_in_progress);
-    if (ch->fatigue >= 65.0 && rest_done == 0) printf("        gap: no Sleeping/Resting tasks were completed.\n");
-    if (ch->fatigue >= 65.0 && !rest_in_plan) printf("        gap: no Sleeping/Resting task exists in this character's policy.\n");
-
-    print_need_line("social/emotional", low_is_bad_state(ch->morale, 25.0, 45.0), ch->morale, "morale", morale_done, morale_in_plan, morale_in_progress);
-    if (ch->morale <= 45.0 && morale_done == 0) printf("        gap: morale-support tasks were never completed.\n");
-    if (ch->morale <= 45.0 && !morale_in_plan) printf("        gap: no morale-support task exists in this character's policy.\n");
-
-    print_need_line("injury-care", high_is_bad_state(ch->injury, 25.0, 50.0), ch->injury, "injury", injury_done, injury_in_plan, injury_in_progress);
-    if (ch->injury >= 25.0 && injury_done == 0) printf("        gap: injury-mitigation tasks were never completed.\n");
-    if (ch->injury >= 25.0 && !injury_in_plan) printf("        gap: no injury-mitigation task exists in this character's policy.\n");
-    if (ch->injury >= 25.0 && inv_stock(&w->inv, "First-aid box") <= 0.0) printf("        gap: no First-aid box remains in inventory.\n");
-
-    print_need_line("illness-care", high_is_bad_state(ch->illness, 25.0, 50.0), ch->illness, "illness", illness_done, illness_in_plan, illness_in_progress);
-    if (ch->illness >= 25.0 && illness_done == 0) printf("        gap: illness-mitigation tasks were never completed.\n");
-    if (ch->illness >= 25.0 && !illness_in_plan) printf("        gap: no illness-mitigation task exists in this character's policy.\n");
-    if (ch->illness >= 25.0 && inv_stock(&w->inv, "Medical box") <= 0.0) printf("        gap: no Medical box remains in inventory.\n");
+    sim_log(w, "    life-gaps:\n");
+    print_need_line(w->log, "nourishment", low_is_bad_state(ch->hunger, 20.0, 45.0), ch->hunger, "hunger", nourish_done, nourish_in_plan, nourish_in_progress);
+    if (ch->hunger <= 45.0 && nourish_done == 0) sim_log(w, "        gap: recovery tasks for food were never completed.\n");
+    if (ch->hunger <= 45.0 && !nourish_in_plan) sim_log(w, "        gap: no food-recovery task is present in this character's policy.\n");
+    if (ch->hunger <= 45.0 && edible_stock(w) < 1.0) sim_log(w, "        gap: edible stock is near zero (edible_total=%.1f).\n", edible_stock(w));
+
+    print_need_line(w->log, "hydration", low_is_bad_state(ch->hydration, 20.0, 45.0), ch->hydration, "hydration", hydration_done, hydration_in_plan, hydration_in_progress);
+    if (ch->hydration <= 45.0 && hydration_done == 0) sim_log(w, "        gap: water-related tasks were never completed.\n");
+    if (ch->hydration <= 45.0 && !hydration_in_plan) sim_log(w, "        gap: no water-supply task is present in this character's policy.\n");
+    if (ch->hydration <= 45.0 && total_water_stock(w) < 1.0) sim_log(w, "        gap: available water is near zero (water_total=%.1f).\n", total_water_stock(w));
+
+    print_need_line(w->log, "rest", high_is_bad_state(ch->fatigue, 65.0, 85.0), ch->fatigue, "fatigue", rest_done, rest_in_plan, rest_in_progress);
+    if (ch->fatigue >= 65.0 && rest_done == 0) sim_log(w, "        gap: no Sleeping/Resting tasks were completed.\n");
+    if (ch->fatigue >= 65.0 && !rest_in_plan) sim_log(w, "        gap: no Sleeping/Resting task exists in this character's policy.\n");
+
+    print_need_line(w->log, "social/emotional", low_is_bad_state(ch->morale, 25.0, 45.0), ch->morale, "morale", morale_done, morale_in_plan, morale_in_progress);
+    if (ch->morale <= 45.0 && morale_done == 0) sim_log(w, "        gap: morale-support tasks were never completed.\n");
+    if (ch->morale <= 45.0 && !morale_in_plan) sim_log(w, "        gap: no morale-support task exists in this character's policy.\n");
+
+    print_need_line(w->log, "injury-care", high_is_bad_state(ch->injury, 25.0, 50.0), ch->injury, "injury", injury_done, injury_in_plan, injury_in_progress);
+    if (ch->injury >= 25.0 && injury_done == 0) sim_log(w, "        gap: injury-mitigation tasks were never completed.\n");
+    if (ch->injury >= 25.0 && !injury_in_plan) sim_log(w, "        gap: no injury-mitigation task exists in this character's policy.\n");
+    if (ch->injury >= 25.0 && inv_stock_h(&w->inv, CANON_ITEM_FIRST_AID_BOX) <= 0.0) sim_log(w, "        gap: no First-aid box remains in inventory.\n");
+
+    print_need_line(w->log, "illness-care", high_is_bad_state(ch->illness, 25.0, 50.0), ch->illness, "illness", illness_done, illness_in_plan, illness_in_progress);
+    if (ch->illness >= 25.0 && illness_done == 0) sim_log(w, "        gap: illness-mitigation tasks were never completed.\n");
+    if (ch->illness >= 25.0 && !illness_in_plan) sim_log(w, "        gap: no illness-mitigation task exists in this character's policy.\n");
+    if (ch->illness >= 25.0 && inv_stock_h(&w->inv, CANON_ITEM_MEDICAL_BOX) <= 0.0) sim_log(w, "        gap: no Medical box remains in inventory.\n");
 }
 
 static void print_agent_diagnostics(Character *ch, Catalog *cat, World *w, const AgentDiagnostics *d) {
     VecStr planned;
     collect_character_tasks(ch, &planned);
 
-    printf("\n  agent: %s\n", ch->name);
-    printf("    snapshot: hunger=%.0f hyd=%.0f fatigue=%.0f morale=%.0f injury=%.0f illness=%.0f posture=%s\n",
+    sim_log(w, "\n  agent: %s\n", ch->name);
+    sim_log(w, "    snapshot: hunger=%.0f hyd=%.0f fatigue=%.0f morale=%.0f injury=%.0f illness=%.0f posture=%s\n",
            ch->hunger, ch->hydration, ch->fatigue, ch->morale, ch->injury, ch->illness, ch->defense_posture);
-    printf("    runtime: active_task=%s remaining=%d\n",
+    sim_log(w, "    runtime: active_task=%s remaining=%d\n",
            ch->rt_task ? ch->rt_task : "(none)", ch->rt_remaining);
-    printf("    activity: total_completed=%d unique_completed=%d idle_ticks=%d conflict_yields=%d\n",
-           diag_total_completions(d), d->n, d->idle_ticks, d->conflict_yields);
+    sim_log(w, "    activity: total_completed=%d unique_completed=%d idle_ticks=%d conflict_yields=%d conflict_switches=%d\n",
+           diag_total_completions(d), d->n, d->idle_ticks, d->conflict_yields, d->conflict_switches);
 
     if (d->n == 0) {
-        printf("    completed_tasks: (none)\n");
+        sim_log(w, "    completed_tasks: (none)\n");
     } else {
-        printf("    completed_tasks:\n");
+        sim_log(w, "    completed_tasks:\n");
         for (int i = 0; i<d->n; i++) {
-            printf("      - %s x%d\n", d->tasks[i].task_name, d->tasks[i].count);
+            sim_log(w, "      - %s x%d\n", d->tasks[i].task_name, d->tasks[i].count);
         }
     }
 
@@ -349,14 +322,14 @@ static void print_agent_diagnostics(Character *ch, Catalog *cat, World *w, const
         if (diag_task_count(d, planned.v[i]) == 0) planned_not_done++;
     }
     if (planned_not_done == 0) {
-        printf("    planned_but_not_completed: (none)\n");
+        sim_log(w, "    planned_but_not_completed: (none)\n");
     } else {
-        printf("    planned_but_not_completed (%d):\n", planned_not_done);
+        sim_log(w, "    planned_but_not_completed (%d):\n", planned_not_done);
         for (int i = 0; i<planned.n; i++) {
             if (diag_task_count(d, planned.v[i]) == 0) {
                 TaskDef *td = cat_find_task(cat, planned.v[i]);
                 int in_progress = (ch->rt_task && ch->rt_remaining > 0 && strcmp(ch->rt_task, planned.v[i])==0);
-                printf("      - %s (catalog=%s in_progress=%s)\n", planned.v[i], td?"yes":"no", in_progress?"yes":"no");
+                sim_log(w, "      - %s (catalog=%s in_progress=%s)\n", planned.v[i], td?"yes":"no", in_progress?"yes":"no");
             }
         }
     }
@@ -368,7 +341,7 @@ static void print_agent_diagnostics(Character *ch, Catalog *cat, World *w, const
 }
 
 static void print_world_diagnostics(World *w) {
-    printf("  world snapshot: structure=%.0f temp=%.1f power=%.0f sig=%.0f contamination=%.0f water_safe=%.0f water_raw=%.0f hydro=%.0f\n",
+    sim_log(w, "  world snapshot: structure=%.0f temp=%.1f power=%.0f sig=%.0f contamination=%.0f water_safe=%.0f water_raw=%.0f hydro=%.0f\n",
            w->shelter.structure,
            w->shelter.temp_c,
            w->shelter.power,
@@ -377,24 +350,27 @@ static void print_world_diagnostics(World *w) {
            w->shelter.water_safe,
            w->shelter.water_raw,
            w->hydroponic_health);
-    printf("  world stock: edible_total=%.1f cooked=%.1f water_total=%.1f first_aid=%.1f medical=%.1f plants=%.1f seeds=%.1f soil=%.1f\n",
+    sim_log(w, "  world stock: edible_total=%.1f cooked=%.1f water_total=%.1f first_aid=%.1f medical=%.1f plants=%.1f seeds=%.1f soil=%.1f\n",
            edible_stock(w),
            w->cooked_food_portions,
            total_water_stock(w),
-           inv_stock(&w->inv, "First-aid box"),
-           inv_stock(&w->inv, "Medical box"),
-           inv_stock(&w->inv, "Plant"),
-           inv_stock(&w->inv, "Seeds"),
-           inv_stock(&w->inv, "Soil"));
-}
-
-static void plan_day_events(World *w, DayEvents *ev) {
-    ev->breach_tick = -1;
-    ev->breach_level = 0;
-    if (rand_percent() < (int)(w->events.breach_chance+0.5)) {
-        int t = 6 + (rand()%16);
+           inv_stock_h(&w->inv, CANON_ITEM_FIRST_AID_BOX),
+           inv_stock_h(&w->inv, CANON_ITEM_MEDICAL_BOX),
+           inv_stock_h(&w->inv, CANON_ITEM_PLANT),
+           inv_stock_h(&w->inv, CANON_ITEM_SEEDS),
+           inv_stock_h(&w->inv, CANON_ITEM_SOIL));
+    if (w->steady_skipped > 0) {
+        sim_log(w, "  steady state: %d days extrapolated (last cycle %d day(s), from day %d)\n",
+               w->steady_skipped, w->steady_cycle, w->steady_day);
+    }
+}
+
+static void plan_day_events(World *w, int day) {
+    /* Drawn before the day's first tick has set inv.now, so CRN keys use the day explicitly. */
+    int at = day*DAY_TICKS;
+    if (sim_rand_at(w, RNG_BREACH, at)%100 < (int)(w->events.breach_chance+0.5)) {
+        int t = 6 + (sim_rand_at(w, RNG_BREACH, at)%16);
         /* 6..21 */
-        ev->breach_tick = t;
         double s = w->shelter.signature, st = w->shelter.structure;
         /*
          * Breach severity increases when the shelter is weak or the signature
@@ -403,9 +379,17 @@ static void plan_day_events(World *w, DayEvents *ev) {
         int lvl = 1;
         if (st<70 || s>15) lvl = 2;
         if (st<55 || s>25) lvl = 3;
-        if ((rand()%100)<25 && lvl<3) lvl++;
-        ev->breach_level = lvl;
+        if ((sim_rand_at(w, RNG_BREACH, at)%100)<25 && lvl<3) lvl++;
+        event_schedule(&w->events, day, t, EVENT_BREACH, lvl);
+    }
+    /* World-declared dailies roll after breach so breach-only worlds keep their RNG sequence. */
+    for (int i = 0; i<w->events.daily.n; i++) {
+        const DailyEvent *de = &w->events.daily.v[i];
+        if (sim_rand_at(w, RNG_EVENTS, at)%100 >= (int)(de->chance+0.5)) continue;
+        int t = de->tick>=0 ? de->tick : 6 + (sim_rand_at(w, RNG_EVENTS, at)%16);
+        event_schedule(&w->events, day, t, de->id, 0);
     }
+    event_schedule(&w->events, day, DAY_TICKS-1, EVENT_OVERNIGHT, 0);
 }
 
 static void clamp01_100(double *v) {
@@ -433,25 +417,6 @@ static void clamp_world(World *w) {
     if (w->cooked_food_portions < 0) w->cooked_food_portions = 0;
 }
 
-static const TaskDelta *find_task_delta(const char *task) {
-    int n = (int)(sizeof(kTaskDeltas)/sizeof(kTaskDeltas[0]));
-    for (int i = 0; i<n; i++) {
-        if (strcmp(kTaskDeltas[i].name, task)==0) return &kTaskDeltas[i];
-    }
-    return NULL;
-}
-
-static double inv_consume(Inventory *inv, const char *key, double qty) {
-    if (qty <= 0) return 0.0;
-    ItemEntry *e = inv_find(inv, key);
-    if (!e || e->qty <= 0) return 0.0;
-    if (qty > e->qty) qty = e->qty;
-    /* Return actual consumed amount so callers can scale downstream effects. */
-    e->qty -= qty;
-    if (e->qty < 0) e->qty = 0;
-    return qty;
-}
-
 static double consume_world_water(World *w, double amount) {
     double used = 0.0;
     if (amount <= 0) return 0.0;
@@ -470,7 +435,7 @@ static double consume_world_water(World *w, double amount) {
         used += take;
     }
     if (amount > 0) {
-        double take = inv_consume(&w->inv, "Water", amount);
+        double take = inv_consume_h(&w->inv, CANON_ITEM_WATER, amount);
         amount -= take;
         used += take;
     }
@@ -486,28 +451,28 @@ static double consume_world_water(World *w, double amount) {
 
 static int consume_meal(World *w, double *hunger_gain, double *hydration_gain) {
     struct {
-        const char *name;
+        ItemHandle item;
         double qty;
         double hunger;
         double hydration;
     } foods[] = {
-        {"Food", 1.0, 12.0, 5.0},
-        {"Fish", 1.0, 10.0, 2.0},
-        {"Tomato", 1.0, 5.0, 2.0},
-        {"Green bean", 1.0, 4.0, 1.0},
-        {"Chili", 0.5, 2.0, 0.0},
-        {"Garlic", 0.5, 1.5, 0.0},
-        {"Ramen", 1.0, 8.0, -1.0},
-        {"Canned spam", 1.0, 9.0, -0.5},
-        {"Canned tomato", 1.0, 6.0, 1.0},
-        {"Canned beans", 1.0, 7.0, 0.5},
-        {"Canned corn", 1.0, 6.0, 0.5},
-        {"Canned tuna", 1.0, 8.0, 0.0}
+        {CANON_ITEM_FOOD, 1.0, 12.0, 5.0},
+        {CANON_ITEM_FISH, 1.0, 10.0, 2.0},
+        {CANON_ITEM_TOMATO, 1.0, 5.0, 2.0},
+        {CANON_ITEM_GREEN_BEAN, 1.0, 4.0, 1.0},
+        {CANON_ITEM_CHILI, 0.5, 2.0, 0.0},
+        {CANON_ITEM_GARLIC, 0.5, 1.5, 0.0},
+        {CANON_ITEM_RAMEN, 1.0, 8.0, -1.0},
+        {CANON_ITEM_CANNED_SPAM, 1.0, 9.0, -0.5},
+        {CANON_ITEM_CANNED_TOMATO, 1.0, 6.0, 1.0},
+        {CANON_ITEM_CANNED_BEANS, 1.0, 7.0, 0.5},
+        {CANON_ITEM_CANNED_CORN, 1.0, 6.0, 0.5},
+        {CANON_ITEM_CANNED_TUNA, 1.0, 8.0, 0.0}
     };
     /* First available food entry wins; table order encodes preference. */
     int n = (int)(sizeof(foods)/sizeof(foods[0]));
     for (int i = 0; i<n; i++) {
-        double eaten = inv_consume(&w->inv, foods[i].name, foods[i].qty);
+        double eaten = inv_consume_h(&w->inv, foods[i].item, foods[i].qty);
         if (eaten > 0.0) {
             double scale = eaten/foods[i].qty;
             *hunger_gain = foods[i].hunger * scale;
@@ -517,7 +482,7 @@ static int consume_meal(World *w, double *hunger_gain, double *hydration_gain) {
               Food produced by Cooking/Meal prep is tracked as "cooked portions".
               Eating those portions gives a higher nutritional payoff than raw produce.
             */
-            if (strcmp(foods[i].name, "Food")==0 && w->cooked_food_portions > 0.0) {
+            if (foods[i].item==CANON_ITEM_FOOD && w->cooked_food_portions > 0.0) {
                 double cooked_used = eaten;
                 if (cooked_used > w->cooked_food_portions) cooked_used = w->cooked_food_portions;
                 *hunger_gain += 6.0 * cooked_used;
@@ -549,7 +514,44 @@ static void apply_task_delta(World *w, Character *ch, const TaskDelta *d) {
     w->shelter.signature += d->signature;
 }
 
+static void overnight_beds_tick(World *w) {
+    /*
+     * Settlement-scale hydroponics: one watering/maintenance run serves every
+     * bed through the shared irrigation loop; each bed then grows and yields
+     * on its own. hydroponic_health tracks the mean for reports and scripts.
+     */
+    BedsNight in;
+    in.water_in = w->plants_watered_today ? 45.0 : 0.0;
+    in.care = w->hydroponics_maintained_today ? 3.0 : 0.0;
+    in.climate = (w->shelter.temp_c < 2.0 || w->shelter.temp_c > 34.0) ? -5.0 : 1.0;
+
+    int produce_counts[4] = {0, 0, 0, 0};
+    beds_night(&w->beds, &in, w->crn ? crn_stream(w, RNG_BEDS, w->inv.now) : &w->rng, produce_counts);
+    w->hydroponic_health = beds_mean_health(&w->beds);
+
+    int harvests = 0;
+    for (int i = 0; i<4; i++) {
+        if (produce_counts[i] > 0) inv_add_h(&w->inv, kPlantProduceItems[i], produce_counts[i], 95.0);
+        harvests += produce_counts[i];
+    }
+    if (harvests > 0) {
+        sim_log(w, "    hydroponics harvest (%d beds):", w->beds.n);
+        for (int i = 0; i<4; i++) {
+            if (produce_counts[i] > 0) sim_log(w, " %s x%d", kPlantProduce[i], produce_counts[i]);
+        }
+        sim_log(w, "\n");
+    }
+
+    w->plants_watered_today = 0;
+    w->hydroponics_maintained_today = 0;
+    clamp_world(w);
+}
+
 static void overnight_plant_tick(World *w) {
+    if (w->beds.n > 0) {
+        overnight_beds_tick(w);
+        return;
+    }
     /*
      * Nightly hydroponics pass:
      * 1) update hydroponic health from actions/environment
@@ -557,9 +559,9 @@ static void overnight_plant_tick(World *w) {
      * 3) grow or decay plants
      * 4) probabilistically harvest produce
      */
-    double plants = inv_stock(&w->inv, "Plant");
+    double plants = inv_stock_h(&w->inv, CANON_ITEM_PLANT);
 
-    if (inv_stock(&w->inv, "Hydroponic planter") > 0.0) w->hydroponic_health += 1.0;
+    if (inv_stock_h(&w->inv, CANON_ITEM_HYDROPONIC_PLANTER) > 0.0) w->hydroponic_health += 1.0;
     else w->hydroponic_health -= 6.0;
 
     if (w->plants_watered_today) w->hydroponic_health += 4.0;
@@ -572,11 +574,11 @@ static void overnight_plant_tick(World *w) {
 
     clamp01_100(&w->hydroponic_health);
 
-    if (plants <= 0.0 && w->hydroponic_health > 45.0 && inv_stock(&w->inv, "Seeds") > 0.2 && inv_stock(&w->inv, "Soil") > 0.1) {
-        if (inv_consume(&w->inv, "Seeds", 0.2) > 0.0 && inv_consume(&w->inv, "Soil", 0.1) > 0.0) {
-            inv_add(&w->inv, "Plant", 0.6, 100.0);
-            plants = inv_stock(&w->inv, "Plant");
-            printf("    hydroponics: seeds germinated into starter plants\n");
+    if (plants <= 0.0 && w->hydroponic_health > 45.0 && inv_stock_h(&w->inv, CANON_ITEM_SEEDS) > 0.2 && inv_stock_h(&w->inv, CANON_ITEM_SOIL) > 0.1) {
+        if (inv_consume_h(&w->inv, CANON_ITEM_SEEDS, 0.2) > 0.0 && inv_consume_h(&w->inv, CANON_ITEM_SOIL, 0.1) > 0.0) {
+            inv_add_h(&w->inv, CANON_ITEM_PLANT, 0.6, 100.0);
+            plants = inv_stock_h(&w->inv, CANON_ITEM_PLANT);
+            sim_log(w, "    hydroponics: seeds germinated into starter plants\n");
         }
     }
 
@@ -584,10 +586,10 @@ static void overnight_plant_tick(World *w) {
         double growth = (w->hydroponic_health - 50.0)/70.0;
         if (w->plants_watered_today) growth += 0.3;
         if (w->hydroponics_maintained_today) growth += 0.2;
-        if (growth >= 0.0) inv_add(&w->inv, "Plant", growth, 100.0);
-        else inv_consume(&w->inv, "Plant", -growth);
+        if (growth >= 0.0) inv_add_h(&w->inv, CANON_ITEM_PLANT, growth, 100.0);
+        else inv_consume_h(&w->inv, CANON_ITEM_PLANT, -growth);
 
-        plants = inv_stock(&w->inv, "Plant");
+        plants = inv_stock_h(&w->inv, CANON_ITEM_PLANT);
         int attempts = (int)(plants/1.2);
         if (attempts < 1) attempts = 1;
         if (attempts > 5) attempts = 5;
@@ -597,21 +599,21 @@ static void overnight_plant_tick(World *w) {
         for (int i = 0; i<attempts; i++) {
             int chance = (int)(w->hydroponic_health*0.6 + plants*12.0);
             if (chance > 90) chance = 90;
-            if (rand_percent() < chance) {
-                int kind = rand()%4;
-                inv_add(&w->inv, kPlantProduce[kind], 1.0, 95.0);
-                inv_consume(&w->inv, "Plant", 0.12);
+            if (rand_percent(w, RNG_HARVEST) < chance) {
+                int kind = sim_rand(w, RNG_HARVEST)%4;
+                inv_add_h(&w->inv, kPlantProduceItems[kind], 1.0, 95.0);
+                inv_consume_h(&w->inv, CANON_ITEM_PLANT, 0.12);
                 produce_counts[kind]++;
                 harvests++;
             }
         }
 
         if (harvests > 0) {
-            printf("    hydroponics harvest:");
+            sim_log(w, "    hydroponics harvest:");
             for (int i = 0; i<4; i++) {
-                if (produce_counts[i] > 0) printf(" %s x%d", kPlantProduce[i], produce_counts[i]);
+                if (produce_counts[i] > 0) sim_log(w, " %s x%d", kPlantProduce[i], produce_counts[i]);
             }
-            printf("\n");
+            sim_log(w, "\n");
         }
     }
 
@@ -620,6 +622,32 @@ static void overnight_plant_tick(World *w) {
     clamp_world(w);
 }
 
+static void overnight_spoilage(World *w) {
+    /* Only lots that expire tonight are touched; the heap keeps the rest out of the pass. */
+    VecItemLot spoiled;
+    VEC_INIT(spoiled);
+    inv_expire_lots(&w->inv, &spoiled);
+    if (spoiled.n > 0) {
+        sim_log(w, "    spoilage:");
+        for (int i = 0; i<spoiled.n; i++) {
+            /* One line entry per item; a night's list is short, so merge by rescanning. */
+            int seen = 0;
+            double qty = 0.0;
+            for (int j = 0; j<spoiled.n; j++) {
+                if (spoiled.v[j].item != spoiled.v[i].item) continue;
+                if (j < i) seen = 1;
+                qty += spoiled.v[j].qty;
+            }
+            if (!seen) sim_log(w, " %s x%.2f", w->inv.items.v[spoiled.v[i].item].key, qty);
+        }
+        sim_log(w, "\n");
+    }
+    /* Cooked portions are a subset of Food stock and spoil with it. */
+    double food = inv_stock_h(&w->inv, CANON_ITEM_FOOD);
+    if (w->cooked_food_portions > food) w->cooked_food_portions = food;
+    VEC_FREE(spoiled);
+}
+
 static void tick_decay(Character *ch) {
     /* Passive per-tick drift while awake in shelter conditions. */
     ch->hunger -= 0.8;
@@ -653,16 +681,24 @@ static void fatigue_tick(Character *ch) {
     clamp01_100(&ch->fatigue);
 }
 
+/* Attributes subsequent inventory changes in the journal (if any) to `cause`. */
+static void journal_cause(World *w, int cause) {
+    if (w->inv.journal) w->inv.journal->cause = cause;
+}
+
 static void apply_task_effects(World *w, Character *ch, const char *task) {
     /* fatigue is handled per-tick in fatigue_tick() */
-    const TaskDelta *d = find_task_delta(task);
-    apply_task_delta(w, ch, d);
+    const CanonTask *ct = canon_task_find(task);
+    if (w->inv.journal) journal_cause(w, inv_journal_cause(w->inv.journal, task));
+    /* Baseline per-completion deltas come from data/tasks.txt via the generated table. */
+    apply_task_delta(w, ch, ct ? &ct->delta : NULL);
 
     /*
-     * Task-specific branches model inventory/equipment interactions that cannot
+     * Task-specific cases model inventory/equipment interactions that cannot
      * be represented as simple additive deltas.
      */
-    if (strcmp(task, "Eating")==0) {
+    switch (ct ? ct->id : -1) {
+    case CANON_TASK_EATING: {
         double h = 0.0;
         double hy = 0.0;
         if (consume_meal(w, &h, &hy)) {
@@ -672,110 +708,162 @@ static void apply_task_effects(World *w, Character *ch, const char *task) {
             ch->morale -= 2.0;
             ch->illness += 1.0;
         }
-    } else if (strcmp(task, "Meal prep")==0 || strcmp(task, "Cooking")==0) {
+        break;
+    }
+    case CANON_TASK_MEAL_PREP:
+    case CANON_TASK_COOKING: {
         double meal_parts = 0.0;
-        meal_parts += inv_consume(&w->inv, "Fish", 0.5)*1.2;
-        meal_parts += inv_consume(&w->inv, "Tomato", 0.5);
-        meal_parts += inv_consume(&w->inv, "Green bean", 0.5);
-        meal_parts += inv_consume(&w->inv, "Chili", 0.25);
-        meal_parts += inv_consume(&w->inv, "Garlic", 0.25);
+        meal_parts += inv_consume_h(&w->inv, CANON_ITEM_FISH, 0.5)*1.2;
+        meal_parts += inv_consume_h(&w->inv, CANON_ITEM_TOMATO, 0.5);
+        meal_parts += inv_consume_h(&w->inv, CANON_ITEM_GREEN_BEAN, 0.5);
+        meal_parts += inv_consume_h(&w->inv, CANON_ITEM_CHILI, 0.25);
+        meal_parts += inv_consume_h(&w->inv, CANON_ITEM_GARLIC, 0.25);
         if (meal_parts > 0.0) {
-            inv_add(&w->inv, "Food", meal_parts, 100.0);
+            inv_add_h(&w->inv, CANON_ITEM_FOOD, meal_parts, 100.0);
             w->cooked_food_portions += meal_parts;
         }
-    } else if (strcmp(task, "Food preservation")==0) {
-        double preserved = inv_consume(&w->inv, "Food", 1.5);
+        break;
+    }
+    case CANON_TASK_FOOD_PRESERVATION: {
+        double preserved = inv_consume_h(&w->inv, CANON_ITEM_FOOD, 1.5);
         if (preserved > 0.0) {
             if (w->cooked_food_portions > 0.0) {
                 double taken = preserved;
                 if (taken > w->cooked_food_portions) taken = w->cooked_food_portions;
                 w->cooked_food_portions -= taken;
             }
-            const char *canned[] = {
-                "Canned tomato",
-                "Canned corn",
-                "Canned beans",
-                "Canned tuna",
-                "Canned spam"
+            static const ItemHandle canned[] = {
+                CANON_ITEM_CANNED_TOMATO,
+                CANON_ITEM_CANNED_CORN,
+                CANON_ITEM_CANNED_BEANS,
+                CANON_ITEM_CANNED_TUNA,
+                CANON_ITEM_CANNED_SPAM
             };
-            inv_add(&w->inv, canned[rand()%5], 1.0, 95.0);
+            inv_add_h(&w->inv, canned[sim_rand(w, RNG_PRESERVE)%5], 1.0, 95.0);
         }
-    } else if (strcmp(task, "Gardening")==0) {
-        int has_planter = inv_stock(&w->inv, "Hydroponic planter") > 0.0;
+        break;
+    }
+    case CANON_TASK_GARDENING: {
+        int has_planter = inv_stock_h(&w->inv, CANON_ITEM_HYDROPONIC_PLANTER) > 0.0;
         double water_used = consume_world_water(w, 0.5);
-        if (has_planter && water_used > 0.0 && inv_consume(&w->inv, "Seeds", 0.3) > 0.0 && inv_consume(&w->inv, "Soil", 0.2) > 0.0) {
-            inv_add(&w->inv, "Plant", 1.0, 100.0);
+        if (has_planter && water_used > 0.0 && inv_consume_h(&w->inv, CANON_ITEM_SEEDS, 0.3) > 0.0 && inv_consume_h(&w->inv, CANON_ITEM_SOIL, 0.2) > 0.0) {
+            inv_add_h(&w->inv, CANON_ITEM_PLANT, 1.0, 100.0);
             w->hydroponic_health += 6.0;
-            printf("    gardening: planted seeds (Plant +1.0)\n");
+            sim_log(w, "    gardening: planted seeds (Plant +1.0)\n");
         }
-    } else if (strcmp(task, "Watering plants")==0) {
+        break;
+    }
+    case CANON_TASK_WATERING_PLANTS: {
         double used = consume_world_water(w, 1.0);
         if (used > 0.0) {
             w->plants_watered_today = 1;
             w->hydroponic_health += 4.0*used;
-            if (inv_stock(&w->inv, "Plant") > 0.0) inv_add(&w->inv, "Plant", 0.25*used, 100.0);
+            if (inv_stock_h(&w->inv, CANON_ITEM_PLANT) > 0.0) inv_add_h(&w->inv, CANON_ITEM_PLANT, 0.25*used, 100.0);
         } else {
             w->hydroponic_health -= 4.0;
         }
-    } else if (strcmp(task, "Hydroponics maintenance")==0) {
+        break;
+    }
+    case CANON_TASK_HYDROPONICS_MAINTENANCE: {
         w->hydroponics_maintained_today = 1;
-        if (inv_consume(&w->inv, "Fertilizer", 0.25) > 0.0) w->hydroponic_health += 6.0;
+        if (inv_consume_h(&w->inv, CANON_ITEM_FERTILIZER, 0.25) > 0.0) w->hydroponic_health += 6.0;
         else w->hydroponic_health += 3.0;
-    } else if (strcmp(task, "Aquarium maintenance")==0) {
-        int has_tank = (inv_stock(&w->inv, "Aquarium") > 0.0) || (inv_stock(&w->inv, "Fish tank") > 0.0);
-        if (has_tank && inv_stock(&w->inv, "Fish") > 0.0) ch->morale += 1.0;
+        break;
+    }
+    case CANON_TASK_AQUARIUM_MAINTENANCE: {
+        int has_tank = (inv_stock_h(&w->inv, CANON_ITEM_AQUARIUM) > 0.0) || (inv_stock_h(&w->inv, CANON_ITEM_FISH_TANK) > 0.0);
+        if (has_tank && inv_stock_h(&w->inv, CANON_ITEM_FISH) > 0.0) ch->morale += 1.0;
         if (!has_tank) ch->morale -= 1.0;
-    } else if (strcmp(task, "Fishing")==0) {
-        double bait = inv_consume(&w->inv, "Bait", 0.3);
-        double hooks = inv_consume(&w->inv, "Fishing hooks", 0.1);
+        break;
+    }
+    case CANON_TASK_FISHING: {
+        double bait = inv_consume_h(&w->inv, CANON_ITEM_BAIT, 0.3);
+        double hooks = inv_consume_h(&w->inv, CANON_ITEM_FISHING_HOOKS, 0.1);
         double catch_qty = 0.2;
-        if (inv_stock(&w->inv, "Fishing rod") > 0.0) catch_qty += 0.5;
+        if (inv_stock_h(&w->inv, CANON_ITEM_FISHING_ROD) > 0.0) {
+            inv_wear_h(&w->inv, CANON_ITEM_FISHING_ROD, 0.5);
+            catch_qty += 0.5;
+        }
         catch_qty += bait*1.8;
         catch_qty += hooks*2.0;
-        inv_add(&w->inv, "Fish", catch_qty, 80.0);
-    } else if (strcmp(task, "Fish cleaning")==0) {
-        double fish = inv_consume(&w->inv, "Fish", 1.0);
-        if (fish > 0.0) inv_add(&w->inv, "Food", fish*1.1, 100.0);
-    } else if (strcmp(task, "Soldering")==0 || strcmp(task, "Electronics repair")==0) {
-        inv_consume(&w->inv, "Solder wire", 0.2);
-    } else if (strcmp(task, "Defensive shooting")==0) {
-        if (inv_consume(&w->inv, "Ammunition", 2.0) < 1.0) ch->morale -= 2.0;
-    } else if (strcmp(task, "Tending a fire")==0 || strcmp(task, "Heating")==0) {
-        if (inv_consume(&w->inv, "Firewood", 1.0) <= 0.0) {
-            if (inv_consume(&w->inv, "Fuel can", 0.4) <= 0.0) {
+        inv_add_h(&w->inv, CANON_ITEM_FISH, catch_qty, 80.0);
+        break;
+    }
+    case CANON_TASK_FISH_CLEANING: {
+        double fish = inv_consume_h(&w->inv, CANON_ITEM_FISH, 1.0);
+        if (fish > 0.0) inv_add_h(&w->inv, CANON_ITEM_FOOD, fish*1.1, 100.0);
+        break;
+    }
+    case CANON_TASK_SOLDERING:
+    case CANON_TASK_ELECTRONICS_REPAIR: {
+        inv_consume_h(&w->inv, CANON_ITEM_SOLDER_WIRE, 0.2);
+        inv_wear_h(&w->inv, CANON_ITEM_SOLDERING_IRON, 0.5);
+        break;
+    }
+    case CANON_TASK_DEFENSIVE_SHOOTING: {
+        if (inv_consume_h(&w->inv, CANON_ITEM_AMMUNITION, 2.0) < 1.0) ch->morale -= 2.0;
+        else inv_wear_h(&w->inv, CANON_ITEM_RIFLE, 1.0);
+        break;
+    }
+    case CANON_TASK_TENDING_A_FIRE:
+    case CANON_TASK_HEATING: {
+        if (inv_consume_h(&w->inv, CANON_ITEM_FIREWOOD, 1.0) <= 0.0) {
+            if (inv_consume_h(&w->inv, CANON_ITEM_FUEL_CAN, 0.4) <= 0.0) {
                 w->shelter.temp_c -= 1.0;
                 ch->morale -= 1.0;
             }
         }
-    } else if (strcmp(task, "Power management")==0) {
-        if (inv_stock(&w->inv, "Solar panel") > 0.0) w->shelter.power += 1.5;
-        if (inv_stock(&w->inv, "Generator") > 0.0 && inv_consume(&w->inv, "Fuel can", 0.3) > 0.0) {
+        break;
+    }
+    case CANON_TASK_POWER_MANAGEMENT: {
+        if (inv_stock_h(&w->inv, CANON_ITEM_SOLAR_PANEL) > 0.0) w->shelter.power += 1.5;
+        if (inv_stock_h(&w->inv, CANON_ITEM_GENERATOR) > 0.0 && inv_consume_h(&w->inv, CANON_ITEM_FUEL_CAN, 0.3) > 0.0) {
             w->shelter.power += 4.0;
             w->shelter.signature += 0.6;
         }
-    } else if (strcmp(task, "Radio communication")==0) {
-        int has_radio = (inv_stock(&w->inv, "Radio") > 0.0) || (inv_stock(&w->inv, "Antenna") > 0.0) || (inv_stock(&w->inv, "Satellite dish") > 0.0);
+        break;
+    }
+    case CANON_TASK_RADIO_COMMUNICATION: {
+        int has_radio = (inv_stock_h(&w->inv, CANON_ITEM_RADIO) > 0.0) || (inv_stock_h(&w->inv, CANON_ITEM_ANTENNA) > 0.0) || (inv_stock_h(&w->inv, CANON_ITEM_SATELLITE_DISH) > 0.0);
         if (!has_radio) ch->morale -= 1.0;
-    } else if (strcmp(task, "Water collection")==0) {
+        break;
+    }
+    case CANON_TASK_WATER_COLLECTION: {
         double gain = 1.0;
-        if (inv_stock(&w->inv, "Bucket") > 0.0) gain += 1.0;
-        if (inv_stock(&w->inv, "Watering can") > 0.0) gain += 0.5;
-        if (inv_stock(&w->inv, "Water tank") > 0.0 || inv_stock(&w->inv, "Water barrel") > 0.0) gain += 0.5;
+        if (inv_stock_h(&w->inv, CANON_ITEM_BUCKET) > 0.0) {
+            inv_wear_h(&w->inv, CANON_ITEM_BUCKET, 0.25);
+            gain += 1.0;
+        }
+        if (inv_stock_h(&w->inv, CANON_ITEM_WATERING_CAN) > 0.0) gain += 0.5;
+        if (inv_stock_h(&w->inv, CANON_ITEM_WATER_TANK) > 0.0 || inv_stock_h(&w->inv, CANON_ITEM_WATER_BARREL) > 0.0) gain += 0.5;
         w->shelter.water_raw += gain;
-    } else if (strcmp(task, "Water filtration")==0) {
+        break;
+    }
+    case CANON_TASK_WATER_FILTRATION: {
         double filter_capacity = 2.0;
-        if (inv_stock(&w->inv, "Water filter") <= 0.0) filter_capacity = 0.5;
+        /* Filters wear per use; once the last one breaks, capacity drops to the unfiltered rate. */
+        if (inv_stock_h(&w->inv, CANON_ITEM_WATER_FILTER) <= 0.0) filter_capacity = 0.5;
+        else inv_wear_h(&w->inv, CANON_ITEM_WATER_FILTER, 1.0);
         if (w->shelter.water_raw > 0.0) {
             double moved = w->shelter.water_raw;
             if (moved > filter_capacity) moved = filter_capacity;
             w->shelter.water_raw -= moved;
             w->shelter.water_safe += moved*0.9;
         }
-    } else if (strcmp(task, "First aid")==0) {
-        inv_consume(&w->inv, "First-aid box", 0.05);
-    } else if (strcmp(task, "Medical treatment")==0) {
-        inv_consume(&w->inv, "Medical box", 0.05);
+        break;
     }
+    case CANON_TASK_FIRST_AID: {
+        inv_consume_h(&w->inv, CANON_ITEM_FIRST_AID_BOX, 0.05);
+        break;
+    }
+    case CANON_TASK_MEDICAL_TREATMENT: {
+        inv_consume_h(&w->inv, CANON_ITEM_MEDICAL_BOX, 0.05);
+        break;
+    }
+    default:
+        break;
+    }
+    journal_cause(w, -1);
 
     clamp01_100(&ch->morale);
     clamp01_100(&ch->injury);
@@ -785,177 +873,808 @@ static void apply_task_effects(World *w, Character *ch, const char *task) {
     clamp_world(w);
 }
 
-static void print_status(Character *ch) {
-    printf("    %s stats: hunger=%.0f hyd=%.0f fatigue=%.0f morale=%.0f injury=%.0f illness=%.0f posture=%s\n",
-           ch->name, ch->hunger, ch->hydration, ch->fatigue, ch->morale, ch->injury, ch->illness, ch->defense_posture);
+static void print_flows(World *w, int day) {
+    VecInvFlow flows;
+    VEC_INIT(flows);
+    inv_journal_flows(w->inv.journal, day, &flows);
+    for (int i = 0; i<flows.n; i++) {
+        const InvFlow *f = &flows.v[i];
+        sim_log(w, "    flow: %-16s %-22s +%.2f -%.2f\n",
+               w->inv.items.v[f->item].key, inv_journal_cause_name(w->inv.journal, f->cause), f->produced, f->consumed);
+    }
+    VEC_FREE(flows);
 }
 
-void run_sim(World *w, Catalog *cat, Character *A, Character *B, int days) {
+struct SimRun {
+    World *w;
+    Catalog *cat;
+    Character *A, *B;
     AgentDiagnostics da, db;
-    diag_init(&da);
-    diag_init(&db);
-
-    for (int day = 0; day<days; day++) {
-        DayEvents ev;
-        plan_day_events(w, &ev);
-        w->plants_watered_today = 0;
-        w->hydroponics_maintained_today = 0;
-
-        printf("\n=== DAY %d === shelter(structure=%.0f temp=%.1f power=%.0f sig=%.0f water_safe=%.0f hydro=%.0f plants=%.1f cooked=%.1f) breach_chance=%.0f%%\n",
-               day,
-               w->shelter.structure,
-               w->shelter.temp_c,
-               w->shelter.power,
-               w->shelter.signature,
-               w->shelter.water_safe,
-               w->hydroponic_health,
-               inv_stock(&w->inv, "Plant"),
-               w->cooked_food_portions,
-               w->events.breach_chance);
-
-        for (int tick = 0; tick<DAY_TICKS; tick++) {
-            int ev_breach = (ev.breach_tick==tick);
-            int breach_level = ev_breach?ev.breach_level:0;
-            int ev_overnight = (tick==DAY_TICKS-1);
-
-            printf("\n  [day %d tick %02d] ", day, tick);
-            if (ev_breach) printf("EVENT: BREACH level=%d! ", breach_level);
-            if (ev_overnight) printf("EVENT: overnight_threat_check ");
-            printf("\n");
-
-            /* Phase 1: passive per-tick decay/fatigue updates. */
-            tick_decay(A);
-            tick_decay(B);
-            fatigue_tick(A);
-            fatigue_tick(B);
-
-            /* progress ongoing tasks */
-            if (A->rt_remaining>0) {
-                A->rt_remaining--;
-                if (A->rt_remaining==0 && A->rt_task) {
-                    printf("    %s completed: %s\n", A->name, A->rt_task);
-                    diag_record_completion(&da, A->rt_task);
-                    apply_task_effects(w, A, A->rt_task);
-                    A->rt_task = NULL;
-                    A->rt_station = NULL;
-                    A->rt_priority = 0;
-                }
+    StationAssign assign; /* reused every tick */
+    int day;
+    int cur_day, cur_tick; /* tick being played, for notes */
+    /* End-of-day snapshots for --steady; level/drift are scratch rows. */
+    SteadyTrack steady;
+    VecDbl level, drift;
+    /* Items and tags the scripts read; a drifting one may flip a rule inside an extrapolated lap. */
+    VecInt reads;
+    ItemTagSet read_tags;
+};
+
+static void sim_note(SimRun *r, int agent, int counter, const char *fmt, ...) {
+    /* Scheduler notes go to the log and, when recording, into the decision log verbatim. */
+    char line[256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (r->w->log) fputs(line, r->w->log);
+    if (counter==NOTE_YIELD) (agent ? &r->db : &r->da)->conflict_yields++;
+    else if (counter==NOTE_SWITCH) (agent ? &r->db : &r->da)->conflict_switches++;
+    if (r->w->dlog && !r->w->dlog->replaying) {
+        DecisionNote nt;
+        nt.day = r->cur_day;
+        nt.tick = r->cur_tick;
+        nt.agent = agent;
+        nt.counter = counter;
+        nt.text = xstrdup(line);
+        VEC_PUSH(r->w->dlog->notes, nt);
+    }
+}
+
+/*
+  Preflight for one starter: reserve the candidate's inputs, or re-plan against
+  what a higher-priority starter left. The re-planned choice is feasible by
+  construction (choose_action skips short tasks), so its reservation succeeds.
+*/
+static void reserve_or_replan(SimRun *r, int agent, Candidate *c, const Candidate *other,
+                              int day, int tick, int breach_level, int ev_breach, int ev_overnight) {
+    World *w = r->w;
+    Character *ch = agent ? r->B : r->A;
+    if (c->kind != 1 || ledger_reserve(&w->reserve, &w->inv, c->inputs, c->n_inputs)) return;
+    sim_note(r, agent, NOTE_PLAIN, "    PREFLIGHT: %s cannot reserve inputs for %s; re-planning\n", ch->name, c->task_name);
+    *c = choose_action(ch, w, r->cat, day, tick, breach_level, ev_breach, ev_overnight);
+    if (c->kind != 1) return;
+    if (other && other->kind==1 && c->station && other->station && strcmp(c->station, other->station)==0) {
+        sim_note(r, agent, NOTE_YIELD, "    CONFLICT: station '%s' already claimed; %s yields\n", c->station, ch->name);
+        c->kind = 3;
+        return;
+    }
+    (void)ledger_reserve(&w->reserve, &w->inv, c->inputs, c->n_inputs);
+}
+
+static void print_status(FILE *out, Character *ch) {
+    if (!out) return;
+    fprintf(out, "    %s stats: hunger=%.0f hyd=%.0f fatigue=%.0f morale=%.0f injury=%.0f illness=%.0f posture=%s\n",
+           ch->name, ch->hunger, ch->hydration, ch->fatigue, ch->morale, ch->injury, ch->illness, ch->defense_posture);
+}
+
+static int same_station_name(const char *a, const char *b) {
+    return a && b && strcmp(a, b)==0;
+}
+
+static void assign_stations(SimRun *r, Character **who, Candidate **pick, const CandidateSet **alts, int n) {
+    /*
+     * Joint assignment over the survivors choosing this tick: a survivor that
+     * loses its station takes its next-best task elsewhere instead of idling
+     * (spec 8.1 "unless it has a fallback"). Ties go to the earlier agent, so
+     * agents enter in name order, as the old pairwise rule did.
+     */
+    int *order = (int*)xmalloc(sizeof(int)*(size_t)n);
+    for (int i = 0; i<n; i++) {
+        int k = i;
+        while (k>0 && strcmp(who[order[k-1]]->name, who[i]->name) > 0) {
+            order[k] = order[k-1];
+            k--;
+        }
+        order[k] = i;
+    }
+    assign_begin(&r->assign);
+    for (int k = 0; k<n; k++) {
+        const CandidateSet *set = alts[order[k]];
+        (void)assign_agent(&r->assign, who[order[k]]==r->B);
+        for (int j = 0; j<set->n; j++) assign_option(&r->assign, set->v[j].station, set->v[j].priority);
+    }
+    assign_solve(&r->assign);
+    int *got = (int*)xmalloc(sizeof(int)*(size_t)n);
+    for (int k = 0; k<n; k++) got[order[k]] = assign_choice(&r->assign, k);
+
+    for (int i = 0; i<n; i++) {
+        if (got[i]==0 || alts[i]->n==0) continue;
+        const char *lost = alts[i]->v[0].station;
+        /* Name the survivor now holding the station this one wanted. */
+        int holder = -1;
+        for (int h = 0; h<n; h++) {
+            if (h!=i && got[h] >= 0 && same_station_name(alts[h]->v[got[h]].station, lost)) holder = h;
+        }
+        const char *holder_name = holder >= 0 ? who[holder]->name : "?";
+        double holder_pr = holder >= 0 ? alts[holder]->v[got[holder]].priority : 0.0;
+        int agent = who[i]==r->B;
+        if (got[i] < 0) {
+            sim_note(r, agent, NOTE_YIELD, "    CONFLICT: station '%s' claimed by %s (priority %.1f); %s yields\n", lost, holder_name, holder_pr, who[i]->name);
+            pick[i]->kind = 3;
+        } else {
+            sim_note(r, agent, NOTE_SWITCH, "    CONFLICT: station '%s' claimed by %s (priority %.1f); %s takes %s instead\n",
+                     lost, holder_name, holder_pr, who[i]->name, alts[i]->v[got[i]].task_name);
+            *pick[i] = alts[i]->v[got[i]];
+        }
+    }
+    free(got);
+    free(order);
+}
+
+static void record_decision(SimRun *r, int agent, const Candidate *c) {
+    DecisionLog *l = r->w->dlog;
+    Decision d;
+    d.day = r->cur_day;
+    d.tick = r->cur_tick;
+    d.agent = agent;
+    d.kind = c->kind;
+    d.task = c->kind==1 ? dlog_intern(l, c->task_name) : -1;
+    d.station = c->kind==1 ? dlog_intern(l, c->station) : -1;
+    /* `set defaults.defense_posture` runs while choosing, so the posture is part of the decision. */
+    d.posture = dlog_intern(l, (agent ? r->B : r->A)->defense_posture);
+    d.ticks = c->ticks;
+    d.priority = c->priority;
+    VEC_PUSH(l->decisions, d);
+}
+
+static const char *dlog_str(const DecisionLog *l, int id) {
+    return id >= 0 ? l->strings.v[id] : NULL;
+}
+
+static void replay_apply(SimRun *r, const Decision *d, Candidate *c) {
+    World *w = r->w;
+    DecisionLog *l = w->dlog;
+    Character *ch = d->agent ? r->B : r->A;
+    const char *posture = dlog_str(l, d->posture);
+
+    cand_reset(c);
+    if (posture && (!ch->defense_posture || strcmp(ch->defense_posture, posture)!=0)) {
+        free(ch->defense_posture);
+        ch->defense_posture = xstrdup(posture);
+    }
+    if (d->kind != 1) {
+        c->kind = d->kind;
+        return;
+    }
+    /* Station and inputs come from today's catalog; a change there is a divergence. */
+    const char *task = dlog_str(l, d->task);
+    const char *want = dlog_str(l, d->station);
+    TaskDef *td = task ? cat_find_task(r->cat, task) : NULL;
+    const char *station = td ? td->station : NULL;
+    if ((station==NULL) != (want==NULL) || (station && strcmp(station, want)!=0)) {
+        dlog_diverge(l, d->day, d->tick, "%s: task '%s' is at station '%s', the log has '%s'",
+                     ch->name, task ? task : "?", station ? station : "-", want ? want : "-");
+        return;
+    }
+    c->kind = 1;
+    c->task_name = task;
+    c->ticks = d->ticks;
+    c->priority = d->priority;
+    c->station = station;
+    c->inputs = td ? td->inputs : NULL;
+    c->n_inputs = td ? td->n_inputs : 0;
+    if (!ledger_reserve(&w->reserve, &w->inv, c->inputs, c->n_inputs)) {
+        dlog_diverge(l, d->day, d->tick, "%s cannot reserve the inputs of '%s'", ch->name, task);
+        cand_reset(c);
+    }
+}
+
+/*
+  Replay counterpart of phase 2 and preflight: print the tick's notes, then
+  apply its decisions in the order they were reserved. Returns 0 once the run
+  and the log disagree about who is idle or what they can start.
+*/
+static int replay_decisions(SimRun *r, int day, int tick, Candidate *ca, Candidate *cb) {
+    World *w = r->w;
+    DecisionLog *l = w->dlog;
+    Character *who[2] = {r->A, r->B};
+    Candidate *pick[2] = {ca, cb};
+    int decided[2] = {0, 0};
+
+    while (l->next_note < l->notes.n && l->notes.v[l->next_note].day==day && l->notes.v[l->next_note].tick==tick) {
+        const DecisionNote *nt = &l->notes.v[l->next_note++];
+        if (w->log) fputs(nt->text, w->log);
+        if (nt->counter==NOTE_YIELD) (nt->agent ? &r->db : &r->da)->conflict_yields++;
+        else if (nt->counter==NOTE_SWITCH) (nt->agent ? &r->db : &r->da)->conflict_switches++;
+    }
+    while (!l->diverged && l->next_decision < l->decisions.n) {
+        const Decision *d = &l->decisions.v[l->next_decision];
+        if (d->day!=day || d->tick!=tick) break;
+        l->next_decision++;
+        if (who[d->agent]->rt_remaining > 0 || decided[d->agent]) {
+            dlog_diverge(l, day, tick, "%s is busy with %s, but the log has a decision for them",
+                         who[d->agent]->name, who[d->agent]->rt_task ? who[d->agent]->rt_task : "(none)");
+            break;
+        }
+        decided[d->agent] = 1;
+        replay_apply(r, d, pick[d->agent]);
+    }
+    for (int i = 0; i<2 && !l->diverged; i++) {
+        if (who[i]->rt_remaining==0 && !decided[i]) {
+            dlog_diverge(l, day, tick, "%s is idle, but the log has no decision for them", who[i]->name);
+        }
+    }
+    return !l->diverged;
+}
+
+static void dlog_end_of_day(SimRun *r, int day) {
+    DecisionLog *l = r->w->dlog;
+    unsigned long long h = dlog_state_hash(r->w, r->A, r->B);
+    if (!l->replaying) {
+        VEC_PUSH(l->day_hash, h);
+        l->days = day+1;
+    } else if (day >= l->day_hash.n) {
+        dlog_diverge(l, day, DAY_TICKS-1, "the log ends after day %d", l->day_hash.n-1);
+    } else if (l->day_hash.v[day]!=h) {
+        /* Same decisions, different outcome: effects, decay or the world changed. */
+        dlog_diverge(l, day, DAY_TICKS-1, "state at the end of the day differs from the recording");
+    }
+}
+
+SimRun *sim_begin(World *w, Catalog *cat, Character *A, Character *B) {
+    SimRun *r = (SimRun*)xmalloc(sizeof(*r));
+    r->w = w;
+    r->cat = cat;
+    r->A = A;
+    r->B = B;
+    r->day = 0;
+    r->cur_day = 0;
+    r->cur_tick = 0;
+    if (w->dlog) {
+        /* A replay restarts the beds' stream where the recording started it. */
+        if (w->dlog->replaying) w->rng = w->dlog->rng;
+        else w->dlog->rng = w->rng;
+    }
+    assign_init(&r->assign);
+    diag_init(&r->da);
+    diag_init(&r->db);
+    /* Tag totals (edible stock, stock_tag()) need item definitions; rebind for hand-built worlds. */
+    if (w->inv.reg != &cat->items) inv_bind_registry(&w->inv, &cat->items);
+    /* Script item literals resolve once here instead of hashing on every evaluation. */
+    character_bind_items(A, &w->inv);
+    character_bind_items(B, &w->inv);
+    if (w->until) expr_bind_items(w->until, &w->inv);
+    w->stop_day = -1;
+    w->stop_tick = -1;
+    steady_init(&r->steady, w->steady_period > 0 ? w->steady_period : 1);
+    VEC_INIT(r->level);
+    VEC_INIT(r->drift);
+    VEC_INIT(r->reads);
+    r->read_tags = 0;
+    if (w->steady_period > 0) {
+        character_stock_reads(A, &w->inv, &r->reads, &r->read_tags);
+        character_stock_reads(B, &w->inv, &r->reads, &r->read_tags);
+    }
+    return r;
+}
+
+static void diag_copy(AgentDiagnostics *dst, const AgentDiagnostics *src) {
+    *dst = *src;
+    dst->tasks = NULL;
+    if (src->cap > 0) dst->tasks = (TaskCount*)xmalloc(sizeof(TaskCount)*(size_t)src->cap);
+    for (int i = 0; i<src->n; i++) {
+        dst->tasks[i].task_name = xstrdup(src->tasks[i].task_name);
+        dst->tasks[i].count = src->tasks[i].count;
+    }
+}
+
+SimRun *sim_clone(const SimRun *src, World *w, Character *A, Character *B) {
+    SimRun *r = (SimRun*)xmalloc(sizeof(*r));
+    r->w = w;
+    r->cat = src->cat;
+    r->A = A;
+    r->B = B;
+    r->day = src->day;
+    r->cur_day = src->cur_day;
+    r->cur_tick = src->cur_tick;
+    assign_copy(&r->assign, &src->assign);
+    diag_copy(&r->da, &src->da);
+    diag_copy(&r->db, &src->db);
+    /* Handles are identical in a world_copy, so the shared scripts' item bindings still hold. */
+    steady_init(&r->steady, w->steady_period > 0 ? w->steady_period : 1);
+    VEC_INIT(r->level);
+    VEC_INIT(r->drift);
+    VEC_COPY(r->reads, src->reads);
+    r->read_tags = src->read_tags;
+    return r;
+}
+
+int sim_day(const SimRun *r) {
+    return r->day;
+}
+
+int sim_idle_ticks(const SimRun *r, int agent) {
+    return (agent ? &r->db : &r->da)->idle_ticks;
+}
+
+int sim_completed_kinds(const SimRun *r, int agent) {
+    return (agent ? &r->db : &r->da)->n;
+}
+
+const char *sim_completed_task(const SimRun *r, int agent, int i, int *count) {
+    const AgentDiagnostics *d = agent ? &r->db : &r->da;
+    *count = d->tasks[i].count;
+    return d->tasks[i].task_name;
+}
+
+/* Whether w->until holds for either survivor; `char.` names the survivor being checked. */
+static int until_holds(SimRun *r, int day, int tick) {
+    Character *who[2];
+    EvalCtx ctx;
+    int held = 0;
+    who[0] = r->A;
+    who[1] = r->B;
+    memset(&ctx, 0, sizeof(ctx));
+    ectx_init(&ctx);
+    ctx.w = r->w;
+    ctx.day = day;
+    ctx.tick = tick;
+    for (int k = 0; k<2 && !held; k++) {
+        ctx.ch = who[k];
+        held = truthy(eval_expr(&ctx, r->w->until));
+    }
+    ectx_clear(&ctx);
+    return held;
+}
+
+void sim_step_day(SimRun *r) {
+    World *w = r->w;
+    Catalog *cat = r->cat;
+    Character *A = r->A, *B = r->B;
+    if (w->stop_day >= 0) return;
+    int day = r->day++;
+
+    plan_day_events(w, day);
+    w->plants_watered_today = 0;
+    w->hydroponics_maintained_today = 0;
+
+    sim_log(w, "\n=== DAY %d === shelter(structure=%.0f temp=%.1f power=%.0f sig=%.0f water_safe=%.0f hydro=%.0f plants=%.1f cooked=%.1f) breach_chance=%.0f%%\n",
+           day,
+           w->shelter.structure,
+           w->shelter.temp_c,
+           w->shelter.power,
+           w->shelter.signature,
+           w->shelter.water_safe,
+           w->hydroponic_health,
+           inv_stock_h(&w->inv, CANON_ITEM_PLANT),
+           w->cooked_food_portions,
+           w->events.breach_chance);
+
+    for (int tick = 0; tick<DAY_TICKS; tick++) {
+        int ev_breach = 0, breach_level = 0, ev_overnight = 0;
+        int n_fired = event_pop_due(&w->events, day, tick);
+        w->inv.now = day*DAY_TICKS+tick;
+        r->cur_day = day;
+        r->cur_tick = tick;
+
+        sim_log(w, "\n  [day %d tick %02d] ", day, tick);
+        for (int i = 0; i<n_fired; i++) {
+            const EventFiring *f = &w->events.now.v[i];
+            if (f->id==EVENT_BREACH) {
+                ev_breach = 1;
+                breach_level = f->level;
+                sim_log(w, "EVENT: BREACH level=%d! ", breach_level);
+            } else if (f->id==EVENT_OVERNIGHT) {
+                ev_overnight = 1;
+                sim_log(w, "EVENT: overnight_threat_check ");
+            } else {
+                sim_log(w, "EVENT: %s ", w->events.names.v[f->id]);
             }
-            if (B->rt_remaining>0) {
-                B->rt_remaining--;
-                if (B->rt_remaining==0 && B->rt_task) {
-                    printf("    %s completed: %s\n", B->name, B->rt_task);
-                    diag_record_completion(&db, B->rt_task);
-                    apply_task_effects(w, B, B->rt_task);
-                    B->rt_task = NULL;
-                    B->rt_station = NULL;
-                    B->rt_priority = 0;
-                }
+        }
+        sim_log(w, "\n");
+
+        /* Phase 1: passive per-tick decay/fatigue updates. */
+        tick_decay(A);
+        tick_decay(B);
+        fatigue_tick(A);
+        fatigue_tick(B);
+
+        /* progress ongoing tasks */
+        if (A->rt_remaining>0) {
+            A->rt_remaining--;
+            if (A->rt_remaining==0 && A->rt_task) {
+                sim_log(w, "    %s completed: %s\n", A->name, A->rt_task);
+                diag_record_completion(&r->da, A->rt_task);
+                /* Commit: drop the hold, then the effects consume the stock it protected. */
+                ledger_release(&w->reserve, A->rt_inputs, A->rt_n_inputs);
+                A->rt_inputs = NULL;
+                A->rt_n_inputs = 0;
+                apply_task_effects(w, A, A->rt_task);
+                A->rt_task = NULL;
+                A->rt_station = NULL;
+                A->rt_priority = 0;
+            }
+        }
+        if (B->rt_remaining>0) {
+            B->rt_remaining--;
+            if (B->rt_remaining==0 && B->rt_task) {
+                sim_log(w, "    %s completed: %s\n", B->name, B->rt_task);
+                diag_record_completion(&r->db, B->rt_task);
+                ledger_release(&w->reserve, B->rt_inputs, B->rt_n_inputs);
+                B->rt_inputs = NULL;
+                B->rt_n_inputs = 0;
+                apply_task_effects(w, B, B->rt_task);
+                B->rt_task = NULL;
+                B->rt_station = NULL;
+                B->rt_priority = 0;
             }
+        }
 
-            /* Phase 2: ask scheduler for a new action when agent is idle. */
-            Candidate ca, cb;
-            cand_reset(&ca);
-            cand_reset(&cb);
-            if (A->rt_remaining==0) ca = choose_action(A, w, cat, day, tick, breach_level, ev_breach, ev_overnight);
-            if (B->rt_remaining==0) cb = choose_action(B, w, cat, day, tick, breach_level, ev_breach, ev_overnight);
-
-            /* station conflict */
-            if (A->rt_remaining==0 && B->rt_remaining==0 && ca.kind==1 && cb.kind==1) {
-                if (ca.station && cb.station && strcmp(ca.station, cb.station)==0) {
-                    int a_wins = (ca.priority > cb.priority) || (ca.priority==cb.priority && strcmp(A->name, B->name)<=0);
-                    if (a_wins) {
-                        printf("    CONFLICT: station '%s' claimed by %s (priority %.1f); %s yields\n", ca.station, A->name, ca.priority, B->name);
-                        db.conflict_yields++;
-                        cb.kind = 3;
-                    } else {
-                        printf("    CONFLICT: station '%s' claimed by %s (priority %.1f); %s yields\n", cb.station, B->name, cb.priority, A->name);
-                        da.conflict_yields++;
-                        ca.kind = 3;
-                    }
-                }
+        /* Phase 2: ask scheduler for a new action when agent is idle. */
+        Candidate ca, cb;
+        cand_reset(&ca);
+        cand_reset(&cb);
+        if (w->dlog && w->dlog->replaying) {
+            /* Replay: decisions come from the log; no rule is evaluated. */
+            if (!replay_decisions(r, day, tick, &ca, &cb)) break;
+        } else {
+            CandidateSet alt_a, alt_b;
+            alt_a.n = 0;
+            alt_b.n = 0;
+            if (A->rt_remaining==0) ca = choose_action_topk(A, w, cat, day, tick, breach_level, ev_breach, ev_overnight, &alt_a);
+            if (B->rt_remaining==0) cb = choose_action_topk(B, w, cat, day, tick, breach_level, ev_breach, ev_overnight, &alt_b);
+
+            /* station conflict: solved jointly so the loser can fall back to another station */
+            if (A->rt_remaining==0 && B->rt_remaining==0 && ca.kind==1 && cb.kind==1
+                && ca.station && cb.station && strcmp(ca.station, cb.station)==0) {
+                Character *who[2] = {A, B};
+                Candidate *pick[2] = {&ca, &cb};
+                const CandidateSet *alts[2] = {&alt_a, &alt_b};
+                assign_stations(r, who, pick, alts, 2);
             }
 
-            /* Phase 3: start chosen tasks or report continuation/idle state. */
-            if (A->rt_remaining==0) {
-                if (ca.kind==1) {
-                    A->rt_task = ca.task_name;
-                    A->rt_station = ca.station;
-                    A->rt_remaining = ca.ticks;
-                    A->rt_priority = ca.priority;
-                    printf("    %s starts: %s (%dt) station=%s priority=%.1f\n", A->name, ca.task_name, ca.ticks, ca.station?ca.station:"-", ca.priority);
-                } else {
-                    da.idle_ticks++;
-                    printf("    %s idle\n", A->name);
-                }
+            /* Preflight: scarce inputs go to the higher-priority starter; the other may re-plan. */
+            int a_idle = (A->rt_remaining==0);
+            int b_idle = (B->rt_remaining==0);
+            int a_first = !b_idle || (a_idle && ((ca.priority > cb.priority) || (ca.priority==cb.priority && strcmp(A->name, B->name)<=0)));
+            if (a_first) {
+                if (a_idle) reserve_or_replan(r, 0, &ca, b_idle ? &cb : NULL, day, tick, breach_level, ev_breach, ev_overnight);
+                if (b_idle) reserve_or_replan(r, 1, &cb, a_idle ? &ca : NULL, day, tick, breach_level, ev_breach, ev_overnight);
             } else {
-                printf("    %s continues: %s (remaining %dt)\n", A->name, A->rt_task?A->rt_task:"(none)", A->rt_remaining);
+                reserve_or_replan(r, 1, &cb, a_idle ? &ca : NULL, day, tick, breach_level, ev_breach, ev_overnight);
+                if (a_idle) reserve_or_replan(r, 0, &ca, &cb, day, tick, breach_level, ev_breach, ev_overnight);
             }
-
-            if (B->rt_remaining==0) {
-                if (cb.kind==1) {
-                    B->rt_task = cb.task_name;
-                    B->rt_station = cb.station;
-                    B->rt_remaining = cb.ticks;
-                    B->rt_priority = cb.priority;
-                    printf("    %s starts: %s (%dt) station=%s priority=%.1f\n", B->name, cb.task_name, cb.ticks, cb.station?cb.station:"-", cb.priority);
+            if (w->dlog) {
+                if (a_first) {
+                    if (a_idle) record_decision(r, 0, &ca);
+                    if (b_idle) record_decision(r, 1, &cb);
                 } else {
-                    db.idle_ticks++;
-                    printf("    %s idle\n", B->name);
+                    if (b_idle) record_decision(r, 1, &cb);
+                    if (a_idle) record_decision(r, 0, &ca);
                 }
+            }
+        }
+
+        /* Phase 3: start chosen tasks or report continuation/idle state. */
+        if (A->rt_remaining==0) {
+            if (ca.kind==1) {
+                A->rt_task = ca.task_name;
+                A->rt_station = ca.station;
+                A->rt_remaining = ca.ticks;
+                A->rt_priority = ca.priority;
+                A->rt_inputs = ca.inputs;
+                A->rt_n_inputs = ca.n_inputs;
+                sim_log(w, "    %s starts: %s (%dt) station=%s priority=%.1f\n", A->name, ca.task_name, ca.ticks, ca.station?ca.station:"-", ca.priority);
             } else {
-                printf("    %s continues: %s (remaining %dt)\n", B->name, B->rt_task?B->rt_task:"(none)", B->rt_remaining);
+                r->da.idle_ticks++;
+                sim_log(w, "    %s idle\n", A->name);
             }
+        } else {
+            sim_log(w, "    %s continues: %s (remaining %dt)\n", A->name, A->rt_task?A->rt_task:"(none)", A->rt_remaining);
+        }
 
-            /* Phase 4: resolve event consequences after action assignment. */
-            if (ev_breach) {
-                int defended = 0;
-                if (A->rt_task && strstr(A->rt_task, "Defensive")!=NULL) defended = 1;
-                if (B->rt_task && strstr(B->rt_task, "Defensive")!=NULL) defended = 1;
-                if (!defended) {
-                    double dmg = 4.0*breach_level;
-                    w->shelter.structure -= dmg;
-                    if (w->shelter.structure<0) w->shelter.structure = 0;
-                    printf("    BREACH impact: structure -%.0f (now %.0f)\n", dmg, w->shelter.structure);
-                } else {
-                    printf("    BREACH defended: minimal structure loss\n");
-                    w->shelter.structure -= (breach_level==3?1.0:0.5);
-                    if (w->shelter.structure<0) w->shelter.structure = 0;
-                }
+        if (B->rt_remaining==0) {
+            if (cb.kind==1) {
+                B->rt_task = cb.task_name;
+                B->rt_station = cb.station;
+                B->rt_remaining = cb.ticks;
+                B->rt_priority = cb.priority;
+                B->rt_inputs = cb.inputs;
+                B->rt_n_inputs = cb.n_inputs;
+                sim_log(w, "    %s starts: %s (%dt) station=%s priority=%.1f\n", B->name, cb.task_name, cb.ticks, cb.station?cb.station:"-", cb.priority);
+            } else {
+                r->db.idle_ticks++;
+                sim_log(w, "    %s idle\n", B->name);
             }
+        } else {
+            sim_log(w, "    %s continues: %s (remaining %dt)\n", B->name, B->rt_task?B->rt_task:"(none)", B->rt_remaining);
+        }
 
-            print_status(A);
-            print_status(B);
+        /* Phase 4: resolve event consequences after action assignment. */
+        if (ev_breach) {
+            int defended = 0;
+            if (A->rt_task && strstr(A->rt_task, "Defensive")!=NULL) defended = 1;
+            if (B->rt_task && strstr(B->rt_task, "Defensive")!=NULL) defended = 1;
+            if (!defended) {
+                double dmg = 4.0*breach_level;
+                w->shelter.structure -= dmg;
+                if (w->shelter.structure<0) w->shelter.structure = 0;
+                sim_log(w, "    BREACH impact: structure -%.0f (now %.0f)\n", dmg, w->shelter.structure);
+            } else {
+                sim_log(w, "    BREACH defended: minimal structure loss\n");
+                w->shelter.structure -= (breach_level==3?1.0:0.5);
+                if (w->shelter.structure<0) w->shelter.structure = 0;
+            }
+        }
 
-            if (ev_overnight) {
-                /* Phase 5 (last tick only): overnight encounter + plant cycle. */
-                int roll = rand_percent();
-                if (roll < (int)(w->events.overnight_chance+0.5)) {
-                    printf("    overnight_threat_check: contact outside (roll=%d < %.0f%%)\n", roll, w->events.overnight_chance);
-                    w->shelter.signature += 1.0;
-                } else {
-                    printf("    overnight_threat_check: quiet night (roll=%d)\n", roll);
-                    if (w->shelter.signature>0) w->shelter.signature -= 0.5;
-                    if (w->shelter.signature<0) w->shelter.signature = 0;
-                }
+        print_status(w->log, A);
+        print_status(w->log, B);
 
-                overnight_plant_tick(w);
-                printf("    hydroponics: health=%.0f plants=%.1f tomato=%.0f green_bean=%.0f chili=%.0f garlic=%.0f\n",
-                       w->hydroponic_health,
-                       inv_stock(&w->inv, "Plant"),
-                       inv_stock(&w->inv, "Tomato"),
-                       inv_stock(&w->inv, "Green bean"),
-                       inv_stock(&w->inv, "Chili"),
-                       inv_stock(&w->inv, "Garlic"));
+        if (ev_overnight) {
+            /* Phase 5 (last tick only): overnight encounter + plant cycle. */
+            int roll = rand_percent(w, RNG_OVERNIGHT);
+            if (roll < (int)(w->events.overnight_chance+0.5)) {
+                sim_log(w, "    overnight_threat_check: contact outside (roll=%d < %.0f%%)\n", roll, w->events.overnight_chance);
+                w->shelter.signature += 1.0;
+            } else {
+                sim_log(w, "    overnight_threat_check: quiet night (roll=%d)\n", roll);
+                if (w->shelter.signature>0) w->shelter.signature -= 0.5;
+                if (w->shelter.signature<0) w->shelter.signature = 0;
             }
+
+            overnight_plant_tick(w);
+            overnight_spoilage(w);
+            sim_log(w, "    hydroponics: health=%.0f plants=%.1f tomato=%.0f green_bean=%.0f chili=%.0f garlic=%.0f\n",
+                   w->hydroponic_health,
+                   inv_stock_h(&w->inv, CANON_ITEM_PLANT),
+                   inv_stock_h(&w->inv, CANON_ITEM_TOMATO),
+                   inv_stock_h(&w->inv, CANON_ITEM_GREEN_BEAN),
+                   inv_stock_h(&w->inv, CANON_ITEM_CHILI),
+                   inv_stock_h(&w->inv, CANON_ITEM_GARLIC));
         }
+
+        if (w->until && (!w->until_daily || tick==DAY_TICKS-1) && until_holds(r, day, tick)) {
+            w->stop_day = day;
+            w->stop_tick = tick;
+            sim_log(w, "\n  [until] stop condition held at day %d tick %02d\n", day, tick);
+            break;
+        }
+    }
+
+    if (w->dlog) dlog_end_of_day(r, day);
+
+    if (w->inv.journal) {
+        /* Day boundary: report, then fold the raw entries so memory tracks days, not ticks. */
+        sim_log(w, "\n  [day %d inventory flows]\n", day);
+        print_flows(w, day);
+        inv_journal_compact(w->inv.journal, inv_journal_mark(w->inv.journal));
     }
+}
 
-    printf("\n=== SIMULATION COMPLETE ===\n");
+void sim_end(SimRun *r) {
+    World *w = r->w;
+    DecisionLog *l = w->dlog;
+    if (l && l->replaying && !l->diverged && r->day==l->days
+        && (l->next_decision < l->decisions.n || l->next_draw < l->draws.n)) {
+        /* The replay ran out of days before the log ran out of decisions. */
+        dlog_diverge(l, r->day-1, DAY_TICKS-1, "%d decisions and %d draws of the log were never used",
+                     l->decisions.n - l->next_decision, l->draws.n - l->next_draw);
+    }
+    sim_log(w, "\n=== SIMULATION COMPLETE ===\n");
     print_world_diagnostics(w);
-    print_agent_diagnostics(A, cat, w, &da);
-    print_agent_diagnostics(B, cat, w, &db);
+    if (w->inv.journal) {
+        sim_log(w, "\n=== INVENTORY FLOWS (all days) ===\n");
+        print_flows(w, -1);
+    }
+    print_agent_diagnostics(r->A, r->cat, w, &r->da);
+    print_agent_diagnostics(r->B, r->cat, w, &r->db);
+
+    diag_free(&r->da);
+    diag_free(&r->db);
+    assign_free(&r->assign);
+    steady_free(&r->steady);
+    VEC_FREE(r->level);
+    VEC_FREE(r->drift);
+    VEC_FREE(r->reads);
+    free(r);
+}
+
+/* ---- steady state ---------------------------------------------------------- */
+
+/*
+  Values that must repeat exactly are rounded to STEADY_QUANTUM before hashing,
+  so a routine converging on a fixed point counts as settled once it is within
+  print precision many times over.
+*/
+#define STEADY_QUANTUM 1e-6
+
+static unsigned long long steady_mix(unsigned long long h, double v) {
+    double q = v / STEADY_QUANTUM;
+    long long k = (long long)(q + (q < 0 ? -0.5 : 0.5));
+    for (int i = 0; i<8; i++) {
+        h ^= (unsigned long long)((k >> (8*i)) & 0xff);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
 
-    diag_free(&da);
-    diag_free(&db);
+static unsigned long long steady_mix_str(unsigned long long h, const char *s) {
+    return steady_mix(h, s ? (double)lb_hash_str(s) + 1.0 : 0.0);
+}
+
+static unsigned long long steady_hash_character(unsigned long long h, const Character *c) {
+    h = steady_mix(h, c->hunger);
+    h = steady_mix(h, c->hydration);
+    h = steady_mix(h, c->fatigue);
+    h = steady_mix(h, c->morale);
+    h = steady_mix(h, c->injury);
+    h = steady_mix(h, c->illness);
+    h = steady_mix_str(h, c->defense_posture);
+    for (int i = 0; i<c->skill_vals.n; i++) h = steady_mix(h, c->skill_vals.v[i]);
+    h = steady_mix_str(h, c->rt_task);
+    h = steady_mix_str(h, c->rt_station);
+    h = steady_mix(h, c->rt_remaining);
+    return steady_mix(h, c->rt_priority);
+}
+
+/*
+  Everything but the RNG position that steers tomorrow and must not drift:
+  survivors, shelter, garden, held reservations, tool wear, and lot ages
+  relative to now. Stock quantities are levels, not hashed.
+*/
+static unsigned long long steady_hash(const SimRun *r) {
+    const World *w = r->w;
+    const Inventory *inv = &w->inv;
+    unsigned long long h = 1469598103934665603ULL;
+    double lot_age = 0.0, lot_qty = 0.0;
+    h = steady_mix(h, w->shelter.temp_c);
+    h = steady_mix(h, w->shelter.signature);
+    h = steady_mix(h, w->shelter.power);
+    h = steady_mix(h, w->shelter.water_safe);
+    h = steady_mix(h, w->shelter.water_raw);
+    h = steady_mix(h, w->shelter.structure);
+    h = steady_mix(h, w->shelter.contamination);
+    h = steady_mix(h, w->hydroponic_health);
+    h = steady_mix(h, w->cooked_food_portions);
+    h = steady_mix(h, w->events.breach_chance);
+    h = steady_mix(h, w->events.overnight_chance);
+    h = steady_mix(h, w->events.queue.n);
+    for (int i = 0; i<w->beds.n; i++) {
+        h = steady_mix(h, w->beds.health[i]);
+        h = steady_mix(h, w->beds.growth[i]);
+        h = steady_mix(h, w->beds.water[i]);
+        h = steady_mix(h, w->beds.crop[i]);
+    }
+    for (int i = 0; i<w->reserve.held.n; i++) h = steady_mix(h, w->reserve.held.v[i]);
+    for (int i = 0; i<inv->items.n; i++) h = steady_mix(h, inv->items.v[i].best_cond);
+    for (int i = 0; i<inv->inst.n; i++) {
+        if (inv->inst.owner[i] >= 0) h = steady_mix(h, inv->inst.cond[i]);
+    }
+    /* Heap order depends on history; order-free sums describe the lots well enough. */
+    for (int i = 0; i<inv->lots.n; i++) {
+        lot_age += inv->lots.v[i].expires - inv->now;
+        lot_qty += inv->lots.v[i].qty;
+    }
+    h = steady_mix(h, inv->lots.n);
+    h = steady_mix(h, lot_age);
+    h = steady_mix(h, lot_qty);
+    h = steady_hash_character(h, r->A);
+    return steady_hash_character(h, r->B);
+}
+
+static void steady_push_diag(VecDbl *v, const AgentDiagnostics *d) {
+    VEC_PUSH(*v, (double)d->idle_ticks);
+    VEC_PUSH(*v, (double)d->conflict_yields);
+    VEC_PUSH(*v, (double)d->conflict_switches);
+    for (int i = 0; i<d->n; i++) VEC_PUSH(*v, (double)d->tasks[i].count);
+}
+
+/* Levels, in order: item stocks, bed harvests, then A's and B's counters. */
+static void steady_levels(SimRun *r) {
+    const World *w = r->w;
+    r->level.n = 0;
+    for (int i = 0; i<w->inv.items.n; i++) VEC_PUSH(r->level, w->inv.items.v[i].qty);
+    for (int i = 0; i<w->beds.n; i++) VEC_PUSH(r->level, (double)w->beds.yield[i]);
+    steady_push_diag(&r->level, &r->da);
+    steady_push_diag(&r->level, &r->db);
+    while (r->drift.n < r->level.n) VEC_PUSH(r->drift, 0.0);
+}
+
+/* Counters move by whole units per lap; the drift is their difference as doubles. */
+static int lap_count(double per_lap, int laps) {
+    return (int)(per_lap*laps + 0.5);
+}
+
+static void steady_apply_diag(AgentDiagnostics *d, const double *drift, int laps) {
+    d->idle_ticks += lap_count(drift[0], laps);
+    d->conflict_yields += lap_count(drift[1], laps);
+    d->conflict_switches += lap_count(drift[2], laps);
+    for (int i = 0; i<d->n; i++) d->tasks[i].count += lap_count(drift[3+i], laps);
+}
+
+/*
+  Extrapolation assumes the coming days replay the cycle. Any roll that may
+  come out differently on one of them (breach, daily or overnight events, bed
+  growth, or a task outcome drawn during the cycle) breaks that assumption.
+*/
+static int steady_days_random(const SimRun *r, int p) {
+    const World *w = r->w;
+    if ((int)(w->events.breach_chance+0.5) > 0 || (int)(w->events.overnight_chance+0.5) > 0) return 1;
+    for (int i = 0; i<w->events.daily.n; i++) {
+        if ((int)(w->events.daily.v[i].chance+0.5) > 0) return 1;
+    }
+    if (w->beds.n > 0) return 1;
+    return w->steady_roll_day >= r->day - p*STEADY_REPEATS;
+}
+
+static int steady_item_read(const SimRun *r, ItemHandle h) {
+    if (r->w->inv.items.v[h].tags & r->read_tags) return 1;
+    for (int i = 0; i<r->reads.n; i++) if (r->reads.v[i]==h) return 1;
+    return 0;
+}
+
+int sim_fast_forward(SimRun *r, int days) {
+    World *w = r->w;
+    Inventory *inv = &w->inv;
+    /* An --until condition could hold on a skipped day, so its runs are played out. */
+    if (w->steady_period <= 0 || w->dlog || w->until || w->stop_day >= 0) return 0;
+    steady_levels(r);
+    int p = steady_observe(&r->steady, steady_hash(r), r->level.v, r->level.n, r->drift.v);
+    if (p==0 || steady_days_random(r, p)) return 0;
+    const double *drift = r->drift.v;
+
+    int laps = (days - r->day) / p;
+    if (w->events.queue.n > 0) {
+        /* A scheduled firing breaks the pattern; simulate up to it. */
+        int gap = w->events.queue.v[0].day - r->day;
+        if (gap / p < laps) laps = gap / p;
+    }
+    for (int i = 0; i<inv->items.n; i++) {
+        const ItemEntry *e = &inv->items.v[i];
+        double d = drift[i];
+        if (d > -1e-9 && d < 1e-9) continue;
+        /* Lots and instances have structure a linear drift cannot carry. */
+        if (e->shelf_ticks > 0 || e->instanced) return 0;
+        /* A rule reading this stock could change its mind on any skipped day. */
+        if (steady_item_read(r, i)) return 0;
+        if (d < 0) {
+            /* Leave a lap of stock so the shortage itself is simulated. */
+            int left = (int)(e->qty / -d) - 1;
+            if (left < laps) laps = left;
+        }
+    }
+    if (laps < 1) return 0;
+
+    int skip = laps * p;
+    journal_cause(w, -1);
+    for (int i = 0; i<inv->items.n; i++) {
+        double d = drift[i] * laps;
+        if (d >= 1e-9*laps) inv_add_h(inv, i, d, inv->items.v[i].best_cond);
+        else if (d <= -1e-9*laps) inv_consume_h(inv, i, -d);
+    }
+    for (int i = 0; i<w->beds.n; i++) {
+        w->beds.yield[i] += (unsigned int)lap_count(drift[inv->items.n + i], laps);
+    }
+    steady_apply_diag(&r->da, drift + inv->items.n + w->beds.n, laps);
+    steady_apply_diag(&r->db, drift + inv->items.n + w->beds.n + 3 + r->da.n, laps);
+    /* Lots keep their age relative to the clock; a uniform shift keeps the heap ordered. */
+    for (int i = 0; i<inv->lots.n; i++) inv->lots.v[i].expires += skip*DAY_TICKS;
+    inv->now += skip*DAY_TICKS;
+
+    sim_log(w, "\n  [steady] days %d..%d repeat every %d day(s); extrapolated days %d..%d\n",
+            r->day - p*STEADY_REPEATS, r->day - 1, p, r->day, r->day + skip - 1);
+    w->steady_day = r->day;
+    w->steady_cycle = p;
+    w->steady_skipped += skip;
+    r->day += skip;
+    steady_reset(&r->steady);
+    return skip;
+}
+
+void sim_play(SimRun *r, int days) {
+    World *w = r->w;
+    while (r->day < days) {
+        sim_step_day(r);
+        if (w->dlog && w->dlog->diverged) break;
+        if (w->stop_day >= 0) break;
+        sim_fast_forward(r, days);
+    }
+}
+
+void run_sim(World *w, Catalog *cat, Character *A, Character *B, int days) {
+    SimRun *r = sim_begin(w, cat, A, B);
+    sim_play(r, days);
+    sim_end(r);
 }
@@ -0,0 +1,260 @@
+#include "lastbreach.h"
+/**
+ * lb_stats.c
+ *
+ * Module: Streaming statistics (Welford moments, t-digest quantiles, batch tables).
+ *
+ * A batch of a million runs should cost memory per metric, not per run. Each
+ * StreamStat keeps Welford's running mean and M2, the extremes, and a merging
+ * t-digest of at most STAT_CENTROIDS centroids. Centroids also keep their
+ * value range; runs of equal values stay single points, so quantiles of
+ * integer-valued metrics (idle ticks, task counts) are not smeared between
+ * a large mass at 0 and the next value seen. All three merge exactly or,
+ * for the digest, with the same bounded error as streaming, so per-thread and
+ * per-shard accumulators can be combined at the end in any grouping.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+/* Digest compression: larger keeps more centroids near the median. */
+#define STAT_DELTA 100.0
+
+void stat_init(StreamStat *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+static int centroid_cmp(const void *pa, const void *pb) {
+    const StatCentroid *a = (const StatCentroid*)pa, *b = (const StatCentroid*)pb;
+    if (a->mean != b->mean) return a->mean < b->mean ? -1 : 1;
+    if (a->weight != b->weight) return a->weight < b->weight ? -1 : 1;
+    return 0;
+}
+
+/*
+  Greedy merge of sorted centroids: neighbours combine while the result stays
+  under 4*N*q*(1-q)/delta, so the tails keep small centroids and the middle
+  large ones. That bound grows with log N, so when a huge batch would not fit
+  the array the pass repeats with a coarser delta.
+*/
+static int digest_merge_pass(const StatCentroid *in, int n, double total, double delta, StatCentroid *out) {
+    int m = 0;
+    double before = 0.0; /* weight left of out[m-1] */
+    for (int i = 0; i<n; i++) {
+        if (m > 0) {
+            StatCentroid *cur = &out[m-1];
+            double w = cur->weight + in[i].weight;
+            double q = (before + 0.5*w) / total;
+            if (w <= 4.0*total*q*(1.0-q)/delta || (cur->lo==cur->hi && in[i].lo==cur->hi && in[i].hi==cur->hi)) {
+                /* Equal values always merge: a point mass loses nothing by being one centroid. */
+                cur->mean += (in[i].mean - cur->mean) * in[i].weight / w;
+                cur->weight = w;
+                if (in[i].lo < cur->lo) cur->lo = in[i].lo;
+                if (in[i].hi > cur->hi) cur->hi = in[i].hi;
+                continue;
+            }
+            before += cur->weight;
+        }
+        if (m==STAT_CENTROIDS) return -1;
+        out[m++] = in[i];
+    }
+    return m;
+}
+
+static void digest_compress(StreamStat *s) {
+    StatCentroid all[STAT_CENTROIDS + STAT_BUFFER];
+    int n = 0;
+    double total = 0.0;
+    if (s->nb==0) return;
+    for (int i = 0; i<s->nc; i++) all[n++] = s->c[i];
+    for (int i = 0; i<s->nb; i++) all[n++] = s->buf[i];
+    for (int i = 0; i<n; i++) total += all[i].weight;
+    qsort(all, (size_t)n, sizeof(all[0]), centroid_cmp);
+    int m = -1;
+    for (double delta = STAT_DELTA; m < 0; delta *= 0.5) m = digest_merge_pass(all, n, total, delta, s->c);
+    s->nc = m;
+    s->nb = 0;
+}
+
+static void digest_push(StreamStat *s, const StatCentroid *c) {
+    if (s->nb==STAT_BUFFER) digest_compress(s);
+    s->buf[s->nb++] = *c;
+}
+
+/* Chan et al.: combines two (n, mean, M2) summaries exactly. */
+static void moments_merge(StreamStat *s, long long n, double mean, double m2) {
+    long long total = s->n + n;
+    double delta = mean - s->mean;
+    s->mean += delta * (double)n / (double)total;
+    s->m2 += m2 + delta*delta * (double)s->n * (double)n / (double)total;
+    s->n = total;
+}
+
+void stat_add_n(StreamStat *s, double x, long long k) {
+    if (k <= 0) return;
+    if (s->n==0 || x < s->min) s->min = x;
+    if (s->n==0 || x > s->max) s->max = x;
+    moments_merge(s, k, x, 0.0);
+    StatCentroid c;
+    c.mean = c.lo = c.hi = x;
+    c.weight = (double)k;
+    digest_push(s, &c);
+}
+
+void stat_add(StreamStat *s, double x) {
+    stat_add_n(s, x, 1);
+}
+
+void stat_merge(StreamStat *dst, const StreamStat *src) {
+    if (src->n==0) return;
+    if (dst->n==0 || src->min < dst->min) dst->min = src->min;
+    if (dst->n==0 || src->max > dst->max) dst->max = src->max;
+    moments_merge(dst, src->n, src->mean, src->m2);
+    for (int i = 0; i<src->nc; i++) digest_push(dst, &src->c[i]);
+    for (int i = 0; i<src->nb; i++) digest_push(dst, &src->buf[i]);
+}
+
+double stat_var(const StreamStat *s) {
+    return s->n > 1 ? s->m2 / (double)(s->n - 1) : 0.0;
+}
+
+double stat_quantile(StreamStat *s, double q) {
+    if (s->n==0) return 0.0;
+    digest_compress(s);
+    if (q <= 0.0) return s->min;
+    if (q >= 1.0) return s->max;
+    /*
+      Piecewise-linear through anchors (rank, value): min at 0, each centroid's
+      mean at the middle of its rank span, max at n. A point-mass centroid
+      anchors both ends of its span instead, so every rank inside it reads
+      exactly its value.
+    */
+    double target = q * (double)s->n;
+    double left = 0.0;
+    double prev_x = s->min, prev_at = 0.0;
+    for (int i = 0; i<=s->nc; i++) {
+        int last = i==s->nc;
+        const StatCentroid *c = last ? NULL : &s->c[i];
+        int point = !last && c->lo==c->hi;
+        double x = last ? s->max : c->mean;
+        double at = last ? (double)s->n : (point ? left : left + 0.5*c->weight);
+        if (target < at) return prev_x + (target - prev_at) / (at - prev_at) * (x - prev_x);
+        if (point && target < left + c->weight) return x;
+        prev_x = x;
+        prev_at = point ? left + c->weight : at;
+        if (!last) left += c->weight;
+    }
+    return s->max;
+}
+
+void bstats_init(BatchStats *b) {
+    b->runs = 0;
+    VEC_INIT(b->rows);
+}
+
+void bstats_free(BatchStats *b) {
+    for (int i = 0; i<b->rows.n; i++) free(b->rows.v[i].name);
+    VEC_FREE(b->rows);
+}
+
+int bstats_row(BatchStats *b, const char *name) {
+    for (int i = 0; i<b->rows.n; i++) {
+        if (strcmp(b->rows.v[i].name, name)==0) return i;
+    }
+    StatRow row;
+    row.name = xstrdup(name);
+    stat_init(&row.s);
+    /* A metric first seen now was 0 in every earlier run (a task nobody completed). */
+    stat_add_n(&row.s, 0.0, b->runs);
+    VEC_PUSH(b->rows, row);
+    return b->rows.n-1;
+}
+
+void bstats_merge(BatchStats *dst, const BatchStats *src) {
+    for (int i = 0; i<src->rows.n; i++) {
+        /* bstats_row pads a row dst never saw with zeros for dst's runs. */
+        int r = bstats_row(dst, src->rows.v[i].name);
+        stat_merge(&dst->rows.v[r].s, &src->rows.v[i].s);
+    }
+    /* Rows src never saw were 0 in all of its runs. */
+    for (int k = 0; k<dst->rows.n; k++) {
+        int seen = 0;
+        for (int i = 0; i<src->rows.n && !seen; i++) seen = strcmp(dst->rows.v[k].name, src->rows.v[i].name)==0;
+        if (!seen) stat_add_n(&dst->rows.v[k].s, 0.0, src->runs);
+    }
+    dst->runs += src->runs;
+}
+
+void bstats_print(FILE *out, BatchStats *b) {
+    int width = 6;
+    for (int i = 0; i<b->rows.n; i++) {
+        int n = (int)strlen(b->rows.v[i].name);
+        if (n > width) width = n;
+    }
+    fprintf(out, "%-*s %10s %10s %10s %10s %10s %10s %10s\n", width, "metric", "mean", "sd", "min", "p05", "p50", "p95", "max");
+    for (int i = 0; i<b->rows.n; i++) {
+        StreamStat *s = &b->rows.v[i].s;
+        double sd = lb_sqrt(stat_var(s));
+        fprintf(out, "%-*s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", width, b->rows.v[i].name,
+                s->mean, sd, s->min, stat_quantile(s, 0.05), stat_quantile(s, 0.5), stat_quantile(s, 0.95), s->max);
+    }
+}
+
+/*
+  Two-sided 95% Student t quantiles for 1..30 degrees of freedom. Past the
+  table the value of the next tabulated df below is used, which errs on the
+  wide side.
+*/
+static const double kT975[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+double stat_t975(long long df) {
+    if (df < 1) return 0.0;
+    if (df <= 30) return kT975[df-1];
+    if (df < 40) return 2.042;
+    if (df < 60) return 2.021;
+    if (df < 120) return 2.000;
+    if (df < 1000) return 1.980;
+    return 1.960;
+}
+
+/* A row in [0, 1] whose squares sum to its sum holds only 0s and 1s. */
+static int stat_is_binary(const StreamStat *s) {
+    double n = (double)s->n, d = s->m2 - n*s->mean*(1.0 - s->mean);
+    return s->min >= 0.0 && s->max <= 1.0 && d > -1e-9*n && d < 1e-9*n;
+}
+
+double stat_ci_width(const StreamStat *s) {
+    if (s->n < 2) return 1e300;
+    if (stat_is_binary(s)) {
+        /*
+          Wilson score interval: the t interval of a share of 0 or 1 has width
+          0 and would stop a batch after its first round. Wilson's stays open
+          (about z^2/n at the edges) and matches the t width in the middle.
+        */
+        double n = (double)s->n, z2 = 1.96*1.96, p = s->mean;
+        return 2.0 * 1.96 / (1.0 + z2/n) * lb_sqrt(p*(1.0 - p)/n + z2/(4.0*n*n));
+    }
+    return 2.0 * stat_t975(s->n - 1) * lb_sqrt(stat_var(s) / (double)s->n);
+}
+
+void ab_print(FILE *out, const AbStats *s) {
+    fprintf(out, "%-10s %10s %10s %10s %10s %10s %8s %6s\n", "metric", "A mean", "B mean", "B-A", "ci95 lo", "ci95 hi", "gain", "");
+    for (int m = 0; m<AB_METRICS; m++) {
+        const StreamStat *d = &s->diff[m];
+        double half = stat_t975(d->n - 1) * lb_sqrt(stat_var(d) / (double)(d->n > 0 ? d->n : 1));
+        double lo = d->mean - half, hi = d->mean + half;
+        /* Independent runs would see var(A)+var(B); pairing sees var(B-A). The ratio is the runs saved. */
+        double unpaired = stat_var(&s->a[m]) + stat_var(&s->b[m]), paired = stat_var(d);
+        char gain[16];
+        if (paired > 0.0) snprintf(gain, sizeof(gain), "%.1fx", unpaired / paired);
+        else snprintf(gain, sizeof(gain), "%s", unpaired > 0.0 ? "inf" : "-");
+        const char *verdict = d->n < 2 ? "" : lo > 0.0 ? "B>A" : hi < 0.0 ? "B<A" : "n.s.";
+        fprintf(out, "%-10s %10.3f %10.3f %10.3f %10.3f %10.3f %8s %6s\n", ab_metric_name(m),
+                s->a[m].mean, s->b[m].mean, d->mean, lo, hi, gain, verdict);
+    }
+}
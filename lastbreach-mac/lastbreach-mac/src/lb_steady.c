@@ -0,0 +1,84 @@
+#include "lastbreach.h"
+/**
+ * lb_steady.c
+ *
+ * Module: Steady-state cycle detection over end-of-day snapshots.
+ *
+ * A settled routine repeats: the same tasks at the same ticks, vitals back
+ * where they were, and stocks that only move by the same amount each lap. The
+ * sim reduces every day to a hash of what must repeat exactly (quantized
+ * vitals, shelter, task state) and a vector of "levels" that may drift
+ * linearly (stocks, completion counters). This module keeps the last few
+ * snapshots in a ring and reports the shortest period whose last
+ * STEADY_REPEATS laps agree, together with the per-lap drift, so the caller
+ * can extrapolate instead of simulating the laps.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+void steady_init(SteadyTrack *t, int max_period) {
+    memset(t, 0, sizeof(*t));
+    t->max_period = max_period;
+    t->cap = max_period*STEADY_REPEATS + 1;
+    t->hash = (unsigned long long*)xmalloc(sizeof(*t->hash) * (size_t)t->cap);
+}
+
+void steady_free(SteadyTrack *t) {
+    free(t->hash);
+    free(t->level);
+    memset(t, 0, sizeof(*t));
+}
+
+void steady_reset(SteadyTrack *t) {
+    t->len = 0;
+}
+
+/* Slot of the snapshot `back` days before the newest one. */
+static int ring_slot(const SteadyTrack *t, int back) {
+    return (t->head - back + t->cap) % t->cap;
+}
+
+/* Levels are sums of the same per-day amounts, so equal drifts may differ only by rounding. */
+static int same_level(double a, double b) {
+    double m = a<0 ? -a : a;
+    double d = a-b;
+    if (m < 1.0) m = 1.0;
+    if (d < 0) d = -d;
+    return d <= 1e-9*m;
+}
+
+static int period_holds(const SteadyTrack *t, int p, double *drift) {
+    const double *now = &t->level[(size_t)ring_slot(t, 0) * (size_t)t->n_level];
+    const double *lap = &t->level[(size_t)ring_slot(t, p) * (size_t)t->n_level];
+    for (int k = 0; k<t->n_level; k++) drift[k] = now[k] - lap[k];
+    for (int j = 0; j<STEADY_REPEATS; j++) {
+        int a = ring_slot(t, j*p), b = ring_slot(t, (j+1)*p);
+        if (t->hash[a]!=t->hash[b]) return 0;
+        const double *la = &t->level[(size_t)a * (size_t)t->n_level];
+        const double *lb = &t->level[(size_t)b * (size_t)t->n_level];
+        for (int k = 0; k<t->n_level; k++) {
+            if (!same_level(la[k] - lb[k], drift[k])) return 0;
+        }
+    }
+    return 1;
+}
+
+int steady_observe(SteadyTrack *t, unsigned long long hash, const double *level, int n_level, double *drift) {
+    if (n_level!=t->n_level) {
+        /* A new item or task counter: earlier snapshots are not comparable. */
+        free(t->level);
+        t->level = (double*)xmalloc(sizeof(double) * (size_t)(n_level > 0 ? n_level : 1) * (size_t)t->cap);
+        t->n_level = n_level;
+        t->len = 0;
+    }
+    t->head = t->len==0 ? 0 : (t->head + 1) % t->cap;
+    if (t->len < t->cap) t->len++;
+    t->hash[t->head] = hash;
+    memcpy(&t->level[(size_t)t->head * (size_t)n_level], level, sizeof(double) * (size_t)n_level);
+    for (int p = 1; p<=t->max_period && p*STEADY_REPEATS < t->len; p++) {
+        if (period_holds(t, p, drift)) return p;
+    }
+    return 0;
+}
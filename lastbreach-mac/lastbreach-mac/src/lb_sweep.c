@@ -0,0 +1,829 @@
+#include "lb_runtime_internal.h"
+#include "lb_canon_ids.h"
+/**
+ * lb_sweep.c
+ *
+ * Module: Parameter sweeps and batches (many seeds from one parse, in parallel).
+ *
+ * The inputs are parsed once by the caller. Every (point, seed) run starts
+ * from a deep copy of that base world with the point's overrides applied and
+ * a copy of the cast that shares the parsed scripts, so runs never touch each
+ * other and the worker pool can take them in any order. A batch is the same
+ * with no axes and its end states streamed into BatchStats instead of kept.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+
+typedef struct {
+    const char *name;
+    size_t offset;
+} ShelterField;
+
+static const ShelterField kShelterFields[] = {
+    {"temp_c", offsetof(Shelter, temp_c)},
+    {"signature", offsetof(Shelter, signature)},
+    {"power", offsetof(Shelter, power)},
+    {"water_safe", offsetof(Shelter, water_safe)},
+    {"water_raw", offsetof(Shelter, water_raw)},
+    {"structure", offsetof(Shelter, structure)},
+    {"contamination", offsetof(Shelter, contamination)}
+};
+
+#define SHELTER_FIELDS ((int)(sizeof(kShelterFields)/sizeof(kShelterFields[0])))
+
+void sweep_init(Sweep *s) {
+    VEC_INIT(s->axes);
+    s->seeds = 1;
+    s->seed = 0;
+    s->days = 1;
+    s->threads = 0;
+    s->cache = NULL;
+}
+
+void sweep_free(Sweep *s) {
+    for (int i = 0; i<s->axes.n; i++) free(s->axes.v[i].key);
+    VEC_FREE(s->axes);
+}
+
+int sweep_add_axis(Sweep *s, const char *spec, char *err, size_t errn) {
+    const char *eq = strchr(spec, '=');
+    double start, stop, step;
+    char tail;
+    if (!eq || eq==spec || sscanf(eq+1, "%lf:%lf:%lf%c", &start, &stop, &step, &tail)!=3) {
+        snprintf(err, errn, "--sweep expects key=start:stop:step, got '%s'", spec);
+        return -1;
+    }
+    if (!(step > 0.0) || stop < start) {
+        snprintf(err, errn, "--sweep %s: need step > 0 and stop >= start", spec);
+        return -1;
+    }
+    SweepAxis ax;
+    ax.key = (char*)xmalloc((size_t)(eq-spec)+1);
+    memcpy(ax.key, spec, (size_t)(eq-spec));
+    ax.key[eq-spec] = 0;
+    ax.start = start;
+    ax.step = step;
+    /* The epsilon keeps 0:1:0.1 at eleven values despite rounding in the division. */
+    ax.n = (int)((stop-start)/step + 1e-9) + 1;
+    VEC_PUSH(s->axes, ax);
+    return 0;
+}
+
+int sweep_points(const Sweep *s) {
+    int n = 1;
+    for (int i = 0; i<s->axes.n; i++) n *= s->axes.v[i].n;
+    return n;
+}
+
+double sweep_value(const Sweep *s, int point, int axis) {
+    /* Mixed-radix decode, last axis fastest; values are start + k*step, never accumulated. */
+    for (int i = s->axes.n-1; i>axis; i--) point /= s->axes.v[i].n;
+    const SweepAxis *ax = &s->axes.v[axis];
+    return ax->start + (point % ax->n)*ax->step;
+}
+
+static int apply_inventory(World *w, const char *item, double v, char *err, size_t errn) {
+    ItemHandle h = inv_lookup(&w->inv, item);
+    if (h < 0 && !(w->inv.reg && item_reg_find(w->inv.reg, item) >= 0)) {
+        snprintf(err, errn, "--sweep inventory.%s: unknown item", item);
+        return -1;
+    }
+    if (v < 0.0) {
+        snprintf(err, errn, "--sweep inventory.%s: quantity %g is negative", item, v);
+        return -1;
+    }
+    if (h < 0) h = inv_handle(&w->inv, item);
+    double have = inv_stock_h(&w->inv, h);
+    /* Added stock matches what is already there; new items start in full condition. */
+    if (v > have) inv_add_h(&w->inv, h, v - have, have > 0.0 ? inv_cond_h(&w->inv, h) : 100.0);
+    else if (v < have) (void)inv_consume_h(&w->inv, h, have - v);
+    return 0;
+}
+
+int sweep_apply(World *w, const char *key, double v, char *err, size_t errn) {
+    if (strcmp(key, "events.breach_chance")==0) {
+        w->events.breach_chance = v;
+        return 0;
+    }
+    if (strcmp(key, "events.overnight_chance")==0) {
+        w->events.overnight_chance = v;
+        return 0;
+    }
+    if (strncmp(key, "shelter.", 8)==0) {
+        for (int i = 0; i<SHELTER_FIELDS; i++) {
+            if (strcmp(key+8, kShelterFields[i].name)==0) {
+                *(double*)((char*)&w->shelter + kShelterFields[i].offset) = v;
+                return 0;
+            }
+        }
+    }
+    if (strncmp(key, "inventory.", 10)==0) return apply_inventory(w, key+10, v, err, errn);
+    snprintf(err, errn, "--sweep: unknown key '%s' (events.breach_chance, events.overnight_chance, shelter.<field>, inventory.<item>)", key);
+    return -1;
+}
+
+/* What one run leaves behind; reduced per point in seed order. */
+typedef struct {
+    double structure;
+    double food;
+    double water_safe;
+    double hunger, morale;
+} SweepSample;
+
+typedef struct {
+    const Sweep *s;
+    World *base;
+    Catalog *cat;
+    Character *cast;
+    int first;              /* first point of this run */
+    SweepSample *samples;
+} SweepJobs;
+
+/* One run from copies of the base world and cast; the caller starts it, plays it and reads the end state before copy_end. */
+typedef struct {
+    World w;
+    Character a, b;
+    SimRun *r;
+} RunCopy;
+
+static void copy_begin(RunCopy *c, World *base, Character *cast, unsigned long long seed) {
+    world_copy(&c->w, base);
+    c->w.own_rng = 1;
+    lb_rng_seed(&c->w.rng, seed, 0);
+    c->w.log = NULL;
+    character_copy(&c->a, &cast[0]);
+    character_copy(&c->b, &cast[1]);
+}
+
+static void copy_end(RunCopy *c) {
+    sim_end(c->r);
+    character_copy_free(&c->a);
+    character_copy_free(&c->b);
+    world_free(&c->w);
+}
+
+/* The run's name in the cache: its seed and the point's overrides, exactly. */
+static void sweep_run_name(const Sweep *s, int point, int k, char *buf, size_t n) {
+    size_t len = (size_t)snprintf(buf, n, "sweep seed=%llu", (unsigned long long)s->seed + (unsigned long long)k);
+    for (int ax = 0; ax<s->axes.n && len < n; ax++) {
+        len += (size_t)snprintf(buf+len, n-len, " %s=%a", s->axes.v[ax].key, sweep_value(s, point, ax));
+    }
+}
+
+static int sweep_sample_parse(const char *payload, SweepSample *out) {
+    char tail;
+    return sscanf(payload, "s %la %la %la %la %la%c", &out->structure, &out->food, &out->water_safe, &out->hunger,
+                  &out->morale, &tail)==5 ? 0 : -1;
+}
+
+static void sweep_job(void *ctx, int i) {
+    SweepJobs *j = (SweepJobs*)ctx;
+    const Sweep *s = j->s;
+    int point = j->first + i / s->seeds, k = i % s->seeds;
+    char err[256];
+    char name[1024];
+    SweepSample *out = &j->samples[i];
+    RunCopy c;
+
+    if (s->cache) {
+        sweep_run_name(s, point, k, name, sizeof(name));
+        char *hit = cache_get(s->cache, name);
+        int ok = hit && sweep_sample_parse(hit, out)==0;
+        free(hit);
+        if (ok) return;
+    }
+    copy_begin(&c, j->base, j->cast, (unsigned long long)s->seed + (unsigned long long)k);
+    /* Axes were checked against the base world, so these cannot fail here. */
+    for (int ax = 0; ax<s->axes.n; ax++) (void)sweep_apply(&c.w, s->axes.v[ax].key, sweep_value(s, point, ax), err, sizeof(err));
+    c.r = sim_begin(&c.w, j->cat, &c.a, &c.b);
+    sim_play(c.r, s->days);
+
+    out->structure = c.w.shelter.structure;
+    out->food = inv_stock_h(&c.w.inv, CANON_ITEM_FOOD);
+    out->water_safe = c.w.shelter.water_safe;
+    out->hunger = 0.5*(c.a.hunger + c.b.hunger);
+    out->morale = 0.5*(c.a.morale + c.b.morale);
+    copy_end(&c);
+    if (s->cache) {
+        char payload[256];
+        snprintf(payload, sizeof(payload), "s %a %a %a %a %a", out->structure, out->food, out->water_safe, out->hunger,
+                 out->morale);
+        cache_put(s->cache, name, payload);
+    }
+}
+
+/* Everything shared by the runs is settled here, serially: lazy task bodies, registry, script bindings. */
+static int prepare_shared(World *base, Catalog *cat, Character *cast, int threads, char *err, size_t errn) {
+    if (cat_resolve_all(cat, threads, err, errn)!=0) return -1;
+    if (base->inv.reg != &cat->items) inv_bind_registry(&base->inv, &cat->items);
+    for (int c = 0; c<2; c++) {
+        character_bind_items(&cast[c], &base->inv);
+        character_bind_events(&cast[c], &base->events);
+    }
+    if (base->until) expr_bind_items(base->until, &base->inv);
+    return 0;
+}
+
+/* Points first .. first+n-1 into rows[0 .. n-1]. */
+static int sweep_run_points(const Sweep *s, World *base, Catalog *cat, Character *cast, int first, int n, SweepRow *rows,
+                            char *err, size_t errn) {
+    if (prepare_shared(base, cat, cast, s->threads, err, errn)!=0) return -1;
+    for (int ax = 0; ax<s->axes.n; ax++) {
+        World probe;
+        world_copy(&probe, base);
+        int rc = sweep_apply(&probe, s->axes.v[ax].key, s->axes.v[ax].start, err, errn);
+        world_free(&probe);
+        if (rc!=0) return -1;
+    }
+
+    int jobs = n * s->seeds;
+    SweepJobs j;
+    j.s = s;
+    j.base = base;
+    j.cat = cat;
+    j.cast = cast;
+    j.first = first;
+    j.samples = (SweepSample*)xmalloc(sizeof(SweepSample)*(size_t)jobs);
+    parallel_for(jobs, s->threads, sweep_job, &j);
+
+    for (int p = 0; p<n; p++) {
+        SweepRow *row = &rows[p];
+        memset(row, 0, sizeof(*row));
+        row->structure_min = 1e300;
+        for (int k = 0; k<s->seeds; k++) {
+            const SweepSample *x = &j.samples[p*s->seeds + k];
+            row->structure += x->structure;
+            if (x->structure < row->structure_min) row->structure_min = x->structure;
+            row->food += x->food;
+            row->water_safe += x->water_safe;
+            row->hunger += x->hunger;
+            row->morale += x->morale;
+            row->lost += x->structure <= 0.0 ? 1.0 : 0.0;
+        }
+        row->structure /= s->seeds;
+        row->food /= s->seeds;
+        row->water_safe /= s->seeds;
+        row->hunger /= s->seeds;
+        row->morale /= s->seeds;
+        row->lost /= s->seeds;
+    }
+    free(j.samples);
+    return 0;
+}
+
+int sweep_run(const Sweep *s, World *base, Catalog *cat, Character *cast, SweepRow *rows, char *err, size_t errn) {
+    return sweep_run_points(s, base, cat, cast, 0, sweep_points(s), rows, err, errn);
+}
+
+int sweep_run_shard(const Sweep *s, World *base, Catalog *cat, Character *cast, int shard, int shards, Partial *out,
+                    char *err, size_t errn) {
+    long long first, end;
+    shard_range(sweep_points(s), shard, shards, &first, &end);
+    out->kind = PARTIAL_SWEEP;
+    out->total = sweep_points(s);
+    for (int ax = 0; ax<s->axes.n; ax++) {
+        SweepAxis copy = s->axes.v[ax];
+        copy.key = xstrdup(copy.key);
+        VEC_PUSH(out->sweep.axes, copy);
+    }
+    out->sweep.seeds = s->seeds;
+    out->sweep.seed = s->seed;
+    out->sweep.days = s->days;
+    out->first = (int)first;
+    out->n = (int)(end - first);
+    out->rows = (SweepRow*)xmalloc(sizeof(SweepRow)*(size_t)(out->n > 0 ? out->n : 1));
+    return out->n > 0 ? sweep_run_points(s, base, cat, cast, out->first, out->n, out->rows, err, errn) : 0;
+}
+
+/* Chunks of a batch; fixed so the merge order, and with it the quantiles, ignore the pool size. */
+#define BATCH_CHUNKS 32
+
+typedef struct {
+    World *base;
+    Catalog *cat;
+    Character *cast;
+    unsigned int seed;
+    long long first, runs; /* this round: seeds seed+first .. seed+first+runs-1 */
+    int days;
+    int chunk0;            /* chunks[k] is chunk chunk0+k of the round */
+    BatchStats *chunks;
+    ResultCache *cache;    /* may be NULL */
+} BatchJobs;
+
+static const char *const kVitalNames[] = {"hunger", "hydration", "fatigue", "morale", "injury", "illness", "idle_ticks"};
+
+#define VITAL_ROWS ((int)(sizeof(kVitalNames)/sizeof(kVitalNames[0])))
+#define SHELTER_ROWS 4
+
+static void batch_fixed_rows(BatchStats *b, const World *base, const Character *cast) {
+    /* Rows are registered in this order everywhere, so record_apply can fill them by index. */
+    char name[256];
+    for (int c = 0; c<2; c++) {
+        for (int k = 0; k<VITAL_ROWS; k++) {
+            snprintf(name, sizeof(name), "%s.%s", cast[c].name, kVitalNames[k]);
+            (void)bstats_row(b, name);
+        }
+    }
+    (void)bstats_row(b, "shelter.structure");
+    (void)bstats_row(b, "shelter.water_safe");
+    (void)bstats_row(b, "shelter.power");
+    (void)bstats_row(b, "shelter.survived");
+    if (base->until) {
+        (void)bstats_row(b, "until.held");
+        (void)bstats_row(b, "until.end_tick");
+    }
+    if (base->steady_period > 0) (void)bstats_row(b, "steady.skipped_days");
+    for (int h = 0; h<base->inv.items.n; h++) {
+        snprintf(name, sizeof(name), "stock.%s", base->inv.items.v[h].key);
+        (void)bstats_row(b, name);
+    }
+}
+
+/* One run's contribution to a batch: the fixed rows in order, then its completions as found. */
+typedef struct {
+    VecDbl v;
+    VecStr task;  /* "done.<task>", once per survivor that finished it */
+    VecInt count;
+} RunRecord;
+
+static void record_init(RunRecord *rec) {
+    VEC_INIT(rec->v);
+    VEC_INIT(rec->task);
+    VEC_INIT(rec->count);
+}
+
+static void record_clear(RunRecord *rec) {
+    for (int i = 0; i<rec->task.n; i++) free(rec->task.v[i]);
+    rec->v.n = 0;
+    rec->task.n = 0;
+    rec->count.n = 0;
+}
+
+static void record_free(RunRecord *rec) {
+    record_clear(rec);
+    VEC_FREE(rec->v);
+    VEC_FREE(rec->task);
+    VEC_FREE(rec->count);
+}
+
+static void record_capture(RunRecord *rec, const RunCopy *c, int n_items) {
+    const Character *who[2];
+    who[0] = &c->a;
+    who[1] = &c->b;
+    for (int k = 0; k<2; k++) {
+        const Character *ch = who[k];
+        VEC_PUSH(rec->v, ch->hunger);
+        VEC_PUSH(rec->v, ch->hydration);
+        VEC_PUSH(rec->v, ch->fatigue);
+        VEC_PUSH(rec->v, ch->morale);
+        VEC_PUSH(rec->v, ch->injury);
+        VEC_PUSH(rec->v, ch->illness);
+        VEC_PUSH(rec->v, (double)sim_idle_ticks(c->r, k));
+    }
+    VEC_PUSH(rec->v, c->w.shelter.structure);
+    VEC_PUSH(rec->v, c->w.shelter.water_safe);
+    VEC_PUSH(rec->v, c->w.shelter.power);
+    VEC_PUSH(rec->v, c->w.shelter.structure > 0.0 ? 1.0 : 0.0);
+    if (c->w.until) {
+        /* Ticks played: the stop tick's, or every tick of the run. */
+        int held = c->w.stop_day >= 0;
+        VEC_PUSH(rec->v, held ? 1.0 : 0.0);
+        VEC_PUSH(rec->v, held ? (double)(c->w.stop_day*DAY_TICKS + c->w.stop_tick + 1) : (double)(sim_day(c->r)*DAY_TICKS));
+    }
+    if (c->w.steady_period > 0) VEC_PUSH(rec->v, (double)c->w.steady_skipped);
+    for (int h = 0; h<n_items; h++) VEC_PUSH(rec->v, inv_stock_h(&c->w.inv, h));
+
+    for (int k = 0; k<2; k++) {
+        for (int i = 0; i<sim_completed_kinds(c->r, k); i++) {
+            char name[256];
+            int count;
+            snprintf(name, sizeof(name), "done.%s", sim_completed_task(c->r, k, i, &count));
+            VEC_PUSH(rec->task, xstrdup(name));
+            VEC_PUSH(rec->count, count);
+        }
+    }
+}
+
+static void record_apply(BatchStats *b, const RunRecord *rec, VecDbl *done) {
+    int fixed = rec->v.n;
+    for (int r = 0; r<fixed; r++) stat_add(&b->rows.v[r].s, rec->v.v[r]);
+    /* Completions per task over both survivors; tasks this run never finished count 0. */
+    for (int i = 0; i<rec->task.n; i++) {
+        int idx = bstats_row(b, rec->task.v[i]);
+        while (done->n < b->rows.n) VEC_PUSH(*done, 0.0);
+        done->v[idx] += rec->count.v[i];
+    }
+    for (int i = fixed; i<b->rows.n; i++) {
+        stat_add(&b->rows.v[i].s, i < done->n ? done->v[i] : 0.0);
+        if (i < done->n) done->v[i] = 0.0;
+    }
+    b->runs++;
+}
+
+/* "b <n> <value>... <tasks> <count> <len>:<name>...", values in %a so they read back exactly. */
+static char *record_format(const RunRecord *rec) {
+    size_t cap = 32 + 40*(size_t)rec->v.n;
+    for (int i = 0; i<rec->task.n; i++) cap += 40 + strlen(rec->task.v[i]);
+    char *out = (char*)xmalloc(cap);
+    size_t len = (size_t)snprintf(out, cap, "b %d", rec->v.n);
+    for (int i = 0; i<rec->v.n; i++) len += (size_t)snprintf(out+len, cap-len, " %a", rec->v.v[i]);
+    len += (size_t)snprintf(out+len, cap-len, " %d", rec->task.n);
+    for (int i = 0; i<rec->task.n; i++) {
+        len += (size_t)snprintf(out+len, cap-len, " %d %d:%s", rec->count.v[i], (int)strlen(rec->task.v[i]), rec->task.v[i]);
+    }
+    return out;
+}
+
+/* Returns 0, or -1 if the payload is not a run of this batch (`fixed` values); `rec` is then partly filled. */
+static int record_parse(RunRecord *rec, const char *p, int fixed) {
+    char *end;
+    if (p[0]!='b' || p[1]!=' ') return -1;
+    long n = strtol(p+2, &end, 10);
+    if (end==p+2 || n!=fixed) return -1;
+    for (long i = 0; i<n; i++) {
+        p = end;
+        double v = strtod(p, &end);
+        if (end==p) return -1;
+        VEC_PUSH(rec->v, v);
+    }
+    p = end;
+    long tasks = strtol(p, &end, 10);
+    if (end==p || tasks < 0) return -1;
+    for (long i = 0; i<tasks; i++) {
+        p = end;
+        long count = strtol(p, &end, 10);
+        if (end==p) return -1;
+        p = end;
+        long len = strtol(p, &end, 10);
+        if (end==p || *end!=':' || len < 0 || (long)strlen(end+1) < len) return -1;
+        char *name = (char*)xmalloc((size_t)len + 1);
+        memcpy(name, end+1, (size_t)len);
+        name[len] = 0;
+        VEC_PUSH(rec->task, name);
+        VEC_PUSH(rec->count, (int)count);
+        end += 1 + len;
+    }
+    return *end ? -1 : 0;
+}
+
+static void batch_job(void *ctx, int k) {
+    BatchJobs *j = (BatchJobs*)ctx;
+    BatchStats *b = &j->chunks[k];
+    int chunk = j->chunk0 + k;
+    long long first = j->first + j->runs * chunk / BATCH_CHUNKS, end = j->first + j->runs * (chunk+1) / BATCH_CHUNKS;
+    int n_items = j->base->inv.items.n;
+    VecDbl done;
+    RunRecord rec;
+    VEC_INIT(done);
+    record_init(&rec);
+    batch_fixed_rows(b, j->base, j->cast);
+    int fixed = b->rows.n;
+    for (long long k = first; k<end; k++) {
+        unsigned long long seed = (unsigned long long)j->seed + (unsigned long long)k;
+        char name[64];
+        record_clear(&rec);
+        if (j->cache) {
+            snprintf(name, sizeof(name), "batch seed=%llu", seed);
+            char *hit = cache_get(j->cache, name);
+            int ok = hit && record_parse(&rec, hit, fixed)==0;
+            free(hit);
+            if (ok) {
+                record_apply(b, &rec, &done);
+                continue;
+            }
+            record_clear(&rec);
+        }
+        RunCopy c;
+        copy_begin(&c, j->base, j->cast, seed);
+        c.r = sim_begin(&c.w, j->cat, &c.a, &c.b);
+        /* A run that met --until hands its thread to the next seed. */
+        sim_play(c.r, j->days);
+        record_capture(&rec, &c, n_items);
+        copy_end(&c);
+        record_apply(b, &rec, &done);
+        if (j->cache) {
+            char *payload = record_format(&rec);
+            cache_put(j->cache, name, payload);
+            free(payload);
+        }
+    }
+    record_free(&rec);
+    VEC_FREE(done);
+}
+
+/* Plays one round of seeds into `out`, which already holds the earlier rounds. */
+static void batch_round(BatchJobs *j, long long first, long long runs, int threads, BatchStats *out) {
+    j->first = first;
+    j->runs = runs;
+    j->chunk0 = 0;
+    j->chunks = (BatchStats*)xmalloc(sizeof(BatchStats)*BATCH_CHUNKS);
+    for (int c = 0; c<BATCH_CHUNKS; c++) bstats_init(&j->chunks[c]);
+    parallel_for(BATCH_CHUNKS, threads, batch_job, j);
+    for (int c = 0; c<BATCH_CHUNKS; c++) {
+        bstats_merge(out, &j->chunks[c]);
+        bstats_free(&j->chunks[c]);
+    }
+    free(j->chunks);
+}
+
+void bstats_finish(BatchStats *out, int fixed) {
+    /* Items no run ever held only pad the table. */
+    int kept = 0, dropped = 0;
+    for (int i = 0; i<out->rows.n; i++) {
+        StatRow *row = &out->rows.v[i];
+        if (strncmp(row->name, "stock.", 6)==0 && row->s.min==0.0 && row->s.max==0.0) {
+            free(row->name);
+            dropped++;
+            continue;
+        }
+        out->rows.v[kept++] = *row;
+    }
+    out->rows.n = kept;
+    fixed -= dropped; /* stock rows are all among the fixed ones */
+    /* Task rows appear in discovery order; list them by name. */
+    for (int i = fixed+1; i<out->rows.n; i++) {
+        StatRow row = out->rows.v[i];
+        int k = i;
+        while (k > fixed && strcmp(out->rows.v[k-1].name, row.name) > 0) {
+            out->rows.v[k] = out->rows.v[k-1];
+            k--;
+        }
+        out->rows.v[k] = row;
+    }
+}
+
+static void batch_jobs_init(BatchJobs *j, World *base, Catalog *cat, Character *cast, unsigned int seed, int days,
+                            ResultCache *cache) {
+    j->base = base;
+    j->cat = cat;
+    j->cast = cast;
+    j->seed = seed;
+    j->days = days;
+    j->cache = cache;
+}
+
+int batch_run(World *base, Catalog *cat, Character *cast, unsigned int seed, long long runs, int days, int threads,
+              ResultCache *cache, BatchStats *out, char *err, size_t errn) {
+    if (prepare_shared(base, cat, cast, threads, err, errn)!=0) return -1;
+    BatchJobs j;
+    batch_jobs_init(&j, base, cat, cast, seed, days, cache);
+    batch_fixed_rows(out, base, cast);
+    int fixed = out->rows.n;
+    batch_round(&j, 0, runs, threads, out);
+    bstats_finish(out, fixed);
+    return 0;
+}
+
+int batch_run_shard(World *base, Catalog *cat, Character *cast, unsigned int seed, long long runs, int days, int threads,
+                    ResultCache *cache, int shard, int shards, Partial *out, char *err, size_t errn) {
+    if (prepare_shared(base, cat, cast, threads, err, errn)!=0) return -1;
+    /* Whole chunks, cut where a single process cuts them, so merging them in order repeats its merge exactly. */
+    long long c0, c1;
+    shard_range(BATCH_CHUNKS, shard, shards, &c0, &c1);
+    BatchJobs j;
+    batch_jobs_init(&j, base, cat, cast, seed, days, cache);
+    j.first = 0;
+    j.runs = runs;
+    j.chunk0 = (int)c0;
+    j.chunks = (BatchStats*)xmalloc(sizeof(BatchStats)*(size_t)(c1 > c0 ? c1-c0 : 1));
+    for (int k = 0; k<(int)(c1-c0); k++) bstats_init(&j.chunks[k]);
+    parallel_for((int)(c1-c0), threads, batch_job, &j);
+
+    BatchStats fixed_rows;
+    bstats_init(&fixed_rows);
+    batch_fixed_rows(&fixed_rows, base, cast);
+    out->kind = PARTIAL_BATCH;
+    out->total = BATCH_CHUNKS;
+    out->runs = runs;
+    out->fixed = fixed_rows.rows.n;
+    out->first = (int)c0;
+    out->n = (int)(c1-c0);
+    out->chunks = j.chunks;
+    bstats_free(&fixed_rows);
+    return 0;
+}
+
+void ci_targets_init(VecCiTarget *t) {
+    VEC_INIT(*t);
+}
+
+void ci_targets_free(VecCiTarget *t) {
+    for (int i = 0; i<t->n; i++) free(t->v[i].metric);
+    VEC_FREE(*t);
+}
+
+int ci_target_add(VecCiTarget *t, const char *spec, char *err, size_t errn) {
+    const char *eq = strchr(spec, '=');
+    double width;
+    char tail;
+    if (!eq || eq==spec || sscanf(eq+1, "%lf%c", &width, &tail)!=1 || !(width > 0.0)) {
+        snprintf(err, errn, "--target-ci expects metric=width with width > 0, got '%s'", spec);
+        return -1;
+    }
+    CiTarget c;
+    c.metric = (char*)xmalloc((size_t)(eq-spec)+1);
+    memcpy(c.metric, spec, (size_t)(eq-spec));
+    c.metric[eq-spec] = 0;
+    c.width = width;
+    c.achieved = 0.0;
+    c.met = 0;
+    VEC_PUSH(*t, c);
+    return 0;
+}
+
+static const StreamStat *find_row(const BatchStats *b, const char *name) {
+    for (int i = 0; i<b->rows.n; i++) {
+        if (strcmp(b->rows.v[i].name, name)==0) return &b->rows.v[i].s;
+    }
+    return NULL;
+}
+
+/* Widest 95% interval among the rows a target names; -1 if it names none. */
+static double target_width(const BatchStats *b, const Character *cast, const char *metric) {
+    const char *rows[2];
+    char names[2][256];
+    int n = 1;
+    rows[0] = metric;
+    /* Short names for the usual questions; anything else is a row of the batch table. */
+    if (strcmp(metric, "survival")==0) rows[0] = "shelter.survived";
+    else if (strcmp(metric, "structure")==0) rows[0] = "shelter.structure";
+    else if (strcmp(metric, "morale")==0) {
+        for (int c = 0; c<2; c++) {
+            snprintf(names[c], sizeof(names[c]), "%s.morale", cast[c].name);
+            rows[c] = names[c];
+        }
+        n = 2;
+    }
+    double widest = -1.0;
+    for (int k = 0; k<n; k++) {
+        const StreamStat *s = find_row(b, rows[k]);
+        if (!s) return -1.0;
+        double w = stat_ci_width(s);
+        if (w > widest) widest = w;
+    }
+    return widest;
+}
+
+int batch_run_ci(World *base, Catalog *cat, Character *cast, unsigned int seed, long long max_runs, int days, int threads,
+                 ResultCache *cache, VecCiTarget *targets, BatchStats *out, char *err, size_t errn) {
+    if (prepare_shared(base, cat, cast, threads, err, errn)!=0) return -1;
+    BatchJobs j;
+    batch_jobs_init(&j, base, cat, cast, seed, days, cache);
+    batch_fixed_rows(out, base, cast);
+    int fixed = out->rows.n;
+    /*
+      Seeds go out in rounds and the rule only looks at whole rounds, merged
+      in seed order. Stopping as soon as enough runs had finished would favour
+      whichever runs finish first (short ones, under --until) and would
+      depend on the pool; this way the runs used are always seed .. seed+n-1.
+    */
+    long long done = 0, next = 4*BATCH_CHUNKS;
+    if (next > max_runs) next = max_runs;
+    while (next > 0) {
+        batch_round(&j, done, next, threads, out);
+        done += next;
+        /* Width shrinks like 1/sqrt(n): aim the next round at the slowest target. */
+        double need = (double)done;
+        int all_met = 1;
+        for (int i = 0; i<targets->n; i++) {
+            CiTarget *t = &targets->v[i];
+            t->achieved = target_width(out, cast, t->metric);
+            if (t->achieved < 0.0) {
+                snprintf(err, errn, "--target-ci: no batch metric '%s' (survival, structure, morale, or a row of the --batch table)", t->metric);
+                return -1;
+            }
+            t->met = t->achieved <= t->width;
+            if (!t->met) {
+                double r = t->achieved / t->width;
+                all_met = 0;
+                if (done * r * r > need) need = done * r * r;
+            }
+        }
+        if (all_met) break;
+        /* At least a chunk's worth, at most doubling, so an early noisy estimate cannot overshoot far. */
+        next = (long long)(need - (double)done) + 1;
+        if (next < BATCH_CHUNKS) next = BATCH_CHUNKS;
+        if (next > done) next = done;
+        if (next > max_runs - done) next = max_runs - done;
+    }
+    bstats_finish(out, fixed);
+    return 0;
+}
+
+void ci_targets_print(FILE *out, const VecCiTarget *targets, long long runs) {
+    for (int i = 0; i<targets->n; i++) {
+        const CiTarget *t = &targets->v[i];
+        fprintf(out, "target-ci %s: 95%% interval width %.4g (target %.4g) after %lld runs%s\n",
+                t->metric, t->achieved, t->width, runs, t->met ? "" : " - NOT MET, run limit reached");
+    }
+}
+
+static const char *const kAbMetricNames[AB_METRICS] = {
+    "score", "structure", "fell", "hunger", "hydration", "fatigue", "morale", "injury", "idle_ticks"
+};
+
+const char *ab_metric_name(int m) {
+    return kAbMetricNames[m];
+}
+
+typedef struct {
+    World *base;
+    Catalog *cat;
+    Character *cast[2]; /* variant A's pair, variant B's pair */
+    unsigned int seed;
+    long long runs;
+    int days;
+    AbStats *chunks;
+} AbJobs;
+
+/* One variant on seed `seed` with common random numbers; fills v[AB_METRICS]. */
+static void ab_play(AbJobs *j, int variant, unsigned long long seed, double *v) {
+    RunCopy c;
+    copy_begin(&c, j->base, j->cast[variant], seed);
+    world_use_crn(&c.w, seed);
+    c.r = sim_begin(&c.w, j->cat, &c.a, &c.b);
+    sim_play(c.r, j->days);
+    /* Survivor metrics are means over the pair, so a renamed or swapped plan still lines up. */
+    v[0] = survival_score(&c.w, &c.a, &c.b);
+    v[1] = c.w.shelter.structure;
+    v[2] = c.w.shelter.structure <= 0.0 ? 1.0 : 0.0;
+    v[3] = 0.5*(c.a.hunger + c.b.hunger);
+    v[4] = 0.5*(c.a.hydration + c.b.hydration);
+    v[5] = 0.5*(c.a.fatigue + c.b.fatigue);
+    v[6] = 0.5*(c.a.morale + c.b.morale);
+    v[7] = 0.5*(c.a.injury + c.b.injury);
+    v[8] = (double)(sim_idle_ticks(c.r, 0) + sim_idle_ticks(c.r, 1));
+    copy_end(&c);
+}
+
+static void ab_job(void *ctx, int chunk) {
+    AbJobs *j = (AbJobs*)ctx;
+    AbStats *st = &j->chunks[chunk];
+    long long first = j->runs * chunk / BATCH_CHUNKS, end = j->runs * (chunk+1) / BATCH_CHUNKS;
+    for (long long k = first; k<end; k++) {
+        unsigned long long seed = (unsigned long long)j->seed + (unsigned long long)k;
+        double va[AB_METRICS], vb[AB_METRICS];
+        ab_play(j, 0, seed, va);
+        ab_play(j, 1, seed, vb);
+        for (int m = 0; m<AB_METRICS; m++) {
+            stat_add(&st->a[m], va[m]);
+            stat_add(&st->b[m], vb[m]);
+            stat_add(&st->diff[m], vb[m] - va[m]);
+        }
+        st->runs++;
+    }
+}
+
+static void ab_init(AbStats *st) {
+    st->runs = 0;
+    for (int m = 0; m<AB_METRICS; m++) {
+        stat_init(&st->a[m]);
+        stat_init(&st->b[m]);
+        stat_init(&st->diff[m]);
+    }
+}
+
+int ab_run(World *base, Catalog *cat, Character *cast_a, Character *cast_b, unsigned int seed, long long runs, int days, int threads,
+           AbStats *out, char *err, size_t errn) {
+    if (prepare_shared(base, cat, cast_a, threads, err, errn)!=0) return -1;
+    if (prepare_shared(base, cat, cast_b, threads, err, errn)!=0) return -1;
+    AbJobs j;
+    j.base = base;
+    j.cat = cat;
+    j.cast[0] = cast_a;
+    j.cast[1] = cast_b;
+    j.seed = seed;
+    j.runs = runs;
+    j.days = days;
+    j.chunks = (AbStats*)xmalloc(sizeof(AbStats)*BATCH_CHUNKS);
+    for (int c = 0; c<BATCH_CHUNKS; c++) ab_init(&j.chunks[c]);
+    parallel_for(BATCH_CHUNKS, threads, ab_job, &j);
+
+    ab_init(out);
+    for (int c = 0; c<BATCH_CHUNKS; c++) {
+        const AbStats *st = &j.chunks[c];
+        for (int m = 0; m<AB_METRICS; m++) {
+            stat_merge(&out->a[m], &st->a[m]);
+            stat_merge(&out->b[m], &st->b[m]);
+            stat_merge(&out->diff[m], &st->diff[m]);
+        }
+        out->runs += st->runs;
+    }
+    free(j.chunks);
+    return 0;
+}
+
+void sweep_write_csv(FILE *out, const Sweep *s, const SweepRow *rows) {
+    for (int ax = 0; ax<s->axes.n; ax++) fprintf(out, "%s,", s->axes.v[ax].key);
+    fprintf(out, "runs,structure_mean,structure_min,food_mean,water_safe_mean,hunger_mean,morale_mean,lost_share\n");
+    int points = sweep_points(s);
+    for (int p = 0; p<points; p++) {
+        const SweepRow *r = &rows[p];
+        for (int ax = 0; ax<s->axes.n; ax++) fprintf(out, "%g,", sweep_value(s, p, ax));
+        fprintf(out, "%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", s->seeds,
+                r->structure, r->structure_min, r->food, r->water_safe, r->hunger, r->morale, r->lost);
+    }
+}
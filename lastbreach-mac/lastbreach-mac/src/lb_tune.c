@@ -0,0 +1,440 @@
+#include "lb_runtime_internal.h"
+/**
+ * lb_tune.c
+ *
+ * Module: Plan tuning (genetic search over task priority literals).
+ *
+ * A parameter is the priority literal of one `task` statement, named by its
+ * plan and line. Every candidate of a generation owns a separately parsed
+ * pair of scripts whose literals are overwritten before the generation runs,
+ * so all (candidate, seed) runs can share the worker pool the way sweep runs
+ * do. All random choices of the search are made on the calling thread from
+ * one stream, and every candidate is scored on the same seeds, so a fixed
+ * seed gives the same plan for any thread count.
+ *
+ * This file is part of the modularized LastBreach DSL runner (C99, no third-party
+ * libraries). The goal here is readability: small functions, clear names, and
+ * comments that explain *why* a piece of logic exists.
+ */
+
+void tune_init(Tune *t) {
+    VEC_INIT(t->params);
+    t->population = 16;
+    t->generations = 20;
+    t->seeds = 1;
+    t->seed = 0;
+    t->days = 1;
+    t->threads = 0;
+    t->log = NULL;
+}
+
+void tune_free(Tune *t) {
+    VEC_FREE(t->params);
+}
+
+static int tune_find(const Tune *t, int script, int line) {
+    for (int i = 0; i<t->params.n; i++) {
+        if (t->params.v[i].script==script && t->params.v[i].line==line) return i;
+    }
+    return -1;
+}
+
+/* Parses "lo..hi"; strtod alone would read "60." out of "60..95". */
+static int parse_range(const char *s, double *lo, double *hi) {
+    const char *dots = strstr(s, "..");
+    char buf[64], *end;
+    if (!dots || dots==s || (size_t)(dots-s) >= sizeof(buf)) return -1;
+    memcpy(buf, s, (size_t)(dots-s));
+    buf[dots-s] = 0;
+    *lo = strtod(buf, &end);
+    if (end==buf || *end) return -1;
+    *hi = strtod(dots+2, &end);
+    if (end==dots+2) return -1;
+    while (*end==' ' || *end=='\t' || *end=='\r') end++;
+    if (*end && *end!='\n') return -1;
+    return *lo <= *hi ? 0 : -1;
+}
+
+static int tune_add(Tune *t, int script, int line, double lo, double hi, const char *where, char *err, size_t errn) {
+    if (tune_find(t, script, line) >= 0) {
+        snprintf(err, errn, "%s: line %d is already tuned", where, line);
+        return -1;
+    }
+    TuneParam p;
+    p.script = script;
+    p.line = line;
+    p.lo = lo;
+    p.hi = hi;
+    p.start = 0.0;
+    VEC_PUSH(t->params, p);
+    return 0;
+}
+
+/* Start of a `#` or `//` comment on the line, ignoring string literals; NULL if none. */
+static const char *line_comment(const char *s, const char *eol) {
+    int in_str = 0;
+    for (const char *p = s; p<eol; p++) {
+        if (*p=='"') in_str = !in_str;
+        else if (in_str) continue;
+        else if (*p=='#') return p+1;
+        else if (*p=='/' && p+1<eol && p[1]=='/') return p+2;
+    }
+    return NULL;
+}
+
+int tune_scan_annotations(Tune *t, int script, const char *path, const char *src, char *err, size_t errn) {
+    int line = 1;
+    for (const char *s = src; *s; line++) {
+        const char *eol = strchr(s, '\n');
+        if (!eol) eol = s + strlen(s);
+        const char *c = line_comment(s, eol);
+        if (c) {
+            while (c<eol && (*c==' ' || *c=='\t')) c++;
+            if ((size_t)(eol-c) > 5 && strncmp(c, "tune", 4)==0 && (c[4]==' ' || c[4]=='\t')) {
+                char spec[64];
+                const char *r = c+5;
+                while (r<eol && (*r==' ' || *r=='\t')) r++;
+                size_t n = (size_t)(eol-r);
+                if (n >= sizeof(spec)) n = sizeof(spec)-1;
+                memcpy(spec, r, n);
+                spec[n] = 0;
+                double lo, hi;
+                if (parse_range(spec, &lo, &hi)!=0) {
+                    snprintf(err, errn, "%s:%d: expected '# tune lo..hi' with lo <= hi", path, line);
+                    return -1;
+                }
+                if (tune_add(t, script, line, lo, hi, path, err, errn)!=0) return -1;
+            }
+        }
+        s = *eol ? eol+1 : eol;
+    }
+    return 0;
+}
+
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash+1 : path;
+}
+
+int tune_load_file(Tune *t, const char *path, const char *const *script_paths, char *err, size_t errn) {
+    char *src = read_entire_file(path);
+    if (!src) {
+        snprintf(err, errn, "failed to read tune file: %s", path);
+        return -1;
+    }
+    int rc = 0, lineno = 0;
+    for (char *s = src, *eol; s && rc==0; s = eol ? eol+1 : NULL) {
+        eol = strchr(s, '\n');
+        if (eol) *eol = 0;
+        lineno++;
+        char *hash = strchr(s, '#');
+        if (hash) *hash = 0;
+        while (*s==' ' || *s=='\t') s++;
+        if (!*s || *s=='\r') continue;
+        char file[256], range[64];
+        int line;
+        double lo, hi;
+        if (sscanf(s, "%255[^:]:%d %63s", file, &line, range)!=3 || parse_range(range, &lo, &hi)!=0) {
+            snprintf(err, errn, "%s:%d: expected '<plan>:<line> lo..hi'", path, lineno);
+            rc = -1;
+            break;
+        }
+        int script = -1;
+        for (int k = 0; k<2; k++) {
+            if (strcmp(base_name(script_paths[k]), base_name(file))==0) {
+                if (script >= 0) {
+                    snprintf(err, errn, "%s:%d: both plans are named %s", path, lineno, file);
+                    rc = -1;
+                }
+                script = k;
+            }
+        }
+        if (rc!=0) break;
+        if (script < 0) {
+            snprintf(err, errn, "%s:%d: %s is not one of the plans being run", path, lineno, file);
+            rc = -1;
+            break;
+        }
+        rc = tune_add(t, script, line, lo, hi, path, err, errn);
+    }
+    free(src);
+    return rc;
+}
+
+/* Priority literals of the task statements on `line`, counted into *n; the last one is kept. */
+static void find_priority(VecStmtPtr *stmts, int line, Expr **out, int *n);
+
+static void find_priority_stmt(Stmt *st, int line, Expr **out, int *n) {
+    if (!st) return;
+    if (st->kind==ST_IF) {
+        find_priority(&st->u.if_.then_stmts, line, out, n);
+        find_priority(&st->u.if_.else_stmts, line, out, n);
+    } else if (st->kind==ST_TASK && st->line==line && st->u.task.priority) {
+        *out = st->u.task.priority;
+        (*n)++;
+    }
+}
+
+static void find_priority(VecStmtPtr *stmts, int line, Expr **out, int *n) {
+    for (int i = 0; i<stmts->n; i++) find_priority_stmt(stmts->v[i], line, out, n);
+}
+
+static Expr *resolve_param(Character *ch, int line, char *err, size_t errn) {
+    Expr *lit = NULL;
+    int n = 0;
+    for (int i = 0; i<ch->thresholds.n; i++) find_priority_stmt(ch->thresholds.v[i].action, line, &lit, &n);
+    for (int i = 0; i<ch->blocks.n; i++) find_priority(&ch->blocks.v[i].stmts, line, &lit, &n);
+    for (int i = 0; i<ch->rules.n; i++) find_priority(&ch->rules.v[i].stmts, line, &lit, &n);
+    for (int i = 0; i<ch->on_events.n; i++) find_priority(&ch->on_events.v[i].stmts, line, &lit, &n);
+    if (n==0) {
+        snprintf(err, errn, "plan \"%s\" line %d: no task priority to tune", ch->name, line);
+        return NULL;
+    }
+    if (n > 1) {
+        snprintf(err, errn, "plan \"%s\" line %d: %d tasks on one line; give the tuned task its own line", ch->name, line, n);
+        return NULL;
+    }
+    if (lit->kind!=EX_NUM) {
+        snprintf(err, errn, "plan \"%s\" line %d: priority is an expression, not a number", ch->name, line);
+        return NULL;
+    }
+    return lit;
+}
+
+static double clampd(double v, double lo, double hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+double survival_score(const World *w, const Character *a, const Character *b) {
+    const Character *cast[2];
+    double condition = 0.0;
+    cast[0] = a;
+    cast[1] = b;
+    for (int i = 0; i<2; i++) {
+        const Character *c = cast[i];
+        condition += (c->hunger + c->hydration + c->morale + (100.0-c->fatigue) + (100.0-c->injury) + (100.0-c->illness)) / 6.0;
+    }
+    double structure = clampd(w->shelter.structure, 0.0, 100.0);
+    double score = 0.5*structure + 0.25*condition;
+    return structure <= 0.0 ? score - 100.0 : score;
+}
+
+typedef struct {
+    const Tune *t;
+    World *base;
+    Catalog *cat;
+    Character *casts;
+    double *scores; /* [candidate*seeds + k] */
+} TuneJobs;
+
+static void tune_job(void *ctx, int i) {
+    TuneJobs *j = (TuneJobs*)ctx;
+    const Tune *t = j->t;
+    int cand = i / t->seeds, k = i % t->seeds;
+    World w;
+    Character a, b;
+
+    world_copy(&w, j->base);
+    w.own_rng = 1;
+    lb_rng_seed(&w.rng, (unsigned long long)t->seed + (unsigned long long)k, 0);
+    w.log = NULL;
+    character_copy(&a, &j->casts[2*cand]);
+    character_copy(&b, &j->casts[2*cand+1]);
+
+    SimRun *r = sim_begin(&w, j->cat, &a, &b);
+    sim_play(r, t->days);
+    sim_end(r);
+    j->scores[i] = survival_score(&w, &a, &b);
+
+    character_copy_free(&a);
+    character_copy_free(&b);
+    world_free(&w);
+}
+
+/* Priorities are kept to one decimal so the emitted plan is exactly what was scored. */
+static double quantize(double v) {
+    return (double)(long long)(v*10.0 + (v < 0.0 ? -0.5 : 0.5)) / 10.0;
+}
+
+static double gauss(LbRng *r) {
+    /* Sum of twelve uniforms: unit variance, close enough to normal, and no libm. */
+    double s = -6.0;
+    for (int k = 0; k<12; k++) s += lb_rng_unit(r);
+    return s;
+}
+
+/* Rank order: higher score first, lower index on ties, so sorting is deterministic. */
+static void rank(const double *score, int *order, int n) {
+    for (int i = 0; i<n; i++) {
+        int k = i;
+        while (k > 0 && (score[i] > score[order[k-1]])) {
+            order[k] = order[k-1];
+            k--;
+        }
+        order[k] = i;
+    }
+}
+
+static int tournament(LbRng *r, const int *pos, int n) {
+    /* Three draws; the entrant ranked best (lowest position) wins. */
+    int best = (int)(lb_rng_next(r) % (unsigned long long)n);
+    for (int k = 1; k<3; k++) {
+        int c = (int)(lb_rng_next(r) % (unsigned long long)n);
+        if (pos[c] < pos[best]) best = c;
+    }
+    return best;
+}
+
+static void evaluate(TuneJobs *j, Expr **lit, const double *pop, double *score) {
+    const Tune *t = j->t;
+    int n = t->params.n, P = t->population;
+    /* Candidates write only their own scripts; nothing is written once the pool starts. */
+    for (int c = 0; c<P; c++) {
+        for (int p = 0; p<n; p++) lit[c*n + p]->u.num = pop[c*n + p];
+    }
+    parallel_for(P * t->seeds, t->threads, tune_job, j);
+    for (int c = 0; c<P; c++) {
+        double sum = 0.0;
+        for (int k = 0; k<t->seeds; k++) sum += j->scores[c*t->seeds + k];
+        score[c] = sum / t->seeds;
+    }
+}
+
+int tune_run(Tune *t, World *base, Catalog *cat, Character *casts, double *best, double *best_score, char *err, size_t errn) {
+    int n = t->params.n, P = t->population;
+    if (n==0) {
+        snprintf(err, errn, "no parameters to tune (add '# tune lo..hi' to task lines or pass --tune-file)");
+        return -1;
+    }
+    Expr **lit = (Expr**)xmalloc(sizeof(Expr*)*(size_t)(P*n));
+    for (int c = 0; c<P; c++) {
+        for (int p = 0; p<n; p++) {
+            const TuneParam *tp = &t->params.v[p];
+            lit[c*n + p] = resolve_param(&casts[2*c + tp->script], tp->line, err, errn);
+            if (!lit[c*n + p]) {
+                free(lit);
+                return -1;
+            }
+        }
+    }
+    for (int p = 0; p<n; p++) t->params.v[p].start = lit[p]->u.num;
+
+    /* Shared state is settled serially, as in sweep_run. */
+    if (cat_resolve_all(cat, t->threads, err, errn)!=0) {
+        free(lit);
+        return -1;
+    }
+    if (base->inv.reg != &cat->items) inv_bind_registry(&base->inv, &cat->items);
+    for (int c = 0; c<2*P; c++) {
+        character_bind_items(&casts[c], &base->inv);
+        character_bind_events(&casts[c], &base->events);
+    }
+    if (base->until) expr_bind_items(base->until, &base->inv);
+
+    double *pop = (double*)xmalloc(sizeof(double)*(size_t)(P*n));
+    double *next = (double*)xmalloc(sizeof(double)*(size_t)(P*n));
+    double *score = (double*)xmalloc(sizeof(double)*(size_t)P);
+    int *order = (int*)xmalloc(sizeof(int)*(size_t)P);
+    int *pos = (int*)xmalloc(sizeof(int)*(size_t)P);
+    TuneJobs j;
+    j.t = t;
+    j.base = base;
+    j.cat = cat;
+    j.casts = casts;
+    j.scores = (double*)xmalloc(sizeof(double)*(size_t)(P*t->seeds));
+
+    /* The plan as written is candidate 0, so the result is never worse than the input. */
+    LbRng rng;
+    lb_rng_seed(&rng, t->seed, 1);
+    for (int c = 0; c<P; c++) {
+        for (int p = 0; p<n; p++) {
+            const TuneParam *tp = &t->params.v[p];
+            double v = c==0 ? tp->start : tp->lo + lb_rng_unit(&rng)*(tp->hi - tp->lo);
+            pop[c*n + p] = quantize(clampd(v, tp->lo, tp->hi));
+        }
+    }
+
+    int elite = P >= 4 ? 2 : 1;
+    *best_score = -1e300;
+    for (int g = 0; g<t->generations; g++) {
+        evaluate(&j, lit, pop, score);
+        rank(score, order, P);
+        for (int k = 0; k<P; k++) pos[order[k]] = k;
+        if (score[order[0]] > *best_score) {
+            *best_score = score[order[0]];
+            memcpy(best, &pop[order[0]*n], sizeof(double)*(size_t)n);
+        }
+        if (t->log) {
+            double mean = 0.0;
+            for (int c = 0; c<P; c++) mean += score[c];
+            fprintf(t->log, "generation %d: best=%.3f mean=%.3f\n", g, score[order[0]], mean/P);
+        }
+        if (g+1==t->generations) break;
+
+        /* Blend crossover of two tournament winners, then a mutation that narrows over the run. */
+        double sigma = t->generations > 1 ? 0.2 - 0.18*g/(t->generations-1) : 0.2;
+        for (int c = 0; c<P; c++) {
+            double *child = &next[c*n];
+            if (c < elite) {
+                memcpy(child, &pop[order[c]*n], sizeof(double)*(size_t)n);
+                continue;
+            }
+            const double *pa = &pop[tournament(&rng, pos, P)*n];
+            const double *pb = &pop[tournament(&rng, pos, P)*n];
+            for (int p = 0; p<n; p++) {
+                const TuneParam *tp = &t->params.v[p];
+                double v = pa[p] + (-0.25 + 1.5*lb_rng_unit(&rng))*(pb[p] - pa[p]);
+                if (lb_rng_unit(&rng)*n < 1.0) v += gauss(&rng)*sigma*(tp->hi - tp->lo);
+                child[p] = quantize(clampd(v, tp->lo, tp->hi));
+            }
+        }
+        double *tmp = pop;
+        pop = next;
+        next = tmp;
+    }
+
+    /* Leave the candidate scripts as parsed. */
+    for (int c = 0; c<P; c++) {
+        for (int p = 0; p<n; p++) lit[c*n + p]->u.num = t->params.v[p].start;
+    }
+    free(j.scores);
+    free(pos);
+    free(order);
+    free(score);
+    free(next);
+    free(pop);
+    free(lit);
+    return 0;
+}
+
+void tune_write_plan(FILE *out, const Tune *t, int script, const char *src, const double *x) {
+    int line = 1;
+    for (const char *s = src; *s; line++) {
+        const char *eol = strchr(s, '\n');
+        if (!eol) eol = s + strlen(s);
+        int p = tune_find(t, script, line);
+        const char *kw = NULL;
+        if (p >= 0) {
+            /* The literal after `priority`; resolve_param guaranteed one task statement here. */
+            for (const char *q = s; q+8<=eol; q++) {
+                if (strncmp(q, "priority", 8)==0) {
+                    kw = q+8;
+                    break;
+                }
+            }
+        }
+        if (!kw) {
+            fwrite(s, 1, (size_t)(eol-s), out);
+        } else {
+            const char *num = kw;
+            while (num<eol && (*num==' ' || *num=='\t')) num++;
+            const char *end = num;
+            while (end<eol && (isdigit((unsigned char)*end) || *end=='.' || *end=='-' || *end=='+')) end++;
+            fwrite(s, 1, (size_t)(num-s), out);
+            fprintf(out, "%g", x[p]);
+            fwrite(end, 1, (size_t)(eol-end), out);
+        }
+        if (*eol) fputc('\n', out);
+        s = *eol ? eol+1 : eol;
+    }
+}
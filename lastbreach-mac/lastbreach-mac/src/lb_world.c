@@ -22,11 +22,55 @@ void world_init(World *w) {
     w->shelter.structure = 75.0;
     w->shelter.contamination = 10.0;
     inv_init(&w->inv);
+    ledger_init(&w->reserve);
     /* Event defaults are percentages in [0, 100]. */
     w->events.breach_chance = 15.0;
     w->events.overnight_chance = 25.0;
+    events_init(&w->events);
+    /* Interned first so the ids match EVENT_BREACH / EVENT_OVERNIGHT. */
+    event_intern(&w->events, "breach");
+    event_intern(&w->events, "overnight_threat_check");
     w->hydroponic_health = 55.0;
     w->plants_watered_today = 0;
     w->hydroponics_maintained_today = 0;
     w->cooked_food_portions = 0.0;
+    beds_init(&w->beds);
+    /* main reseeds from --seed; a fixed default keeps hand-built worlds reproducible. */
+    lb_rng_seed(&w->rng, 0, 0);
+    w->own_rng = 0;
+    w->log = stdout;
+    w->dlog = NULL;
+    w->until = NULL;
+    w->until_daily = 0;
+    w->stop_day = -1;
+    w->stop_tick = -1;
+    w->steady_period = 0;
+    w->steady_day = -1;
+    w->steady_cycle = 0;
+    w->steady_skipped = 0;
+    w->steady_roll_day = -1;
+    w->crn = 0;
+    for (int p = 0; p<RNG_PURPOSES; p++) w->crn_at[p] = -1;
+}
+
+void world_free(World *w) {
+    inv_free(&w->inv);
+    ledger_free(&w->reserve);
+    events_free(&w->events);
+    beds_free(&w->beds);
+}
+
+void world_copy(World *dst, const World *src) {
+    *dst = *src;
+    inv_copy(&dst->inv, &src->inv);
+    ledger_copy(&dst->reserve, &src->reserve);
+    events_copy(&dst->events, &src->events);
+    beds_copy(&dst->beds, &src->beds);
+    dst->dlog = NULL;
+}
+
+void world_use_crn(World *w, unsigned long long seed) {
+    w->crn = 1;
+    w->crn_seed = seed;
+    for (int p = 0; p<RNG_PURPOSES; p++) w->crn_at[p] = -1;
 }
@@ -12,13 +12,336 @@
 static void usage(void) {
     fprintf(stderr,
             "usage: lastbreach <a.lbp> <b.lbp> [--days N] [--seed N] [--world file.lbw] [--catalog file.lbc]\n"
+            "                  [--catalog-mode eager|lazy|parallel] [--flows] [--region N [--threads T]]\n"
+            "                  [--record log.lbd | --replay log.lbd] [--until expr [--until-check tick|day]]\n"
+            "                  [--steady P]\n"
+            "                  [--sweep key=start:stop:step ... [--seeds N] [--threads T]]\n"
+            "                  [--batch N [--threads T]] [--target-ci metric=width ...]\n"
+            "                  [--shard i/n [--shard-out part.lbr]]  (with --batch or --sweep)\n"
+            "                  [--cache file.lbk [--cache-max MB]]  (with --batch or --sweep)\n"
+            "                  [--ab planA.lbp planB.lbp [--seeds N] [--threads T]]\n"
+            "                  [--split L1,L2,... [--split-effort N] [--split-reps R] [--threads T]]\n"
+            "                  [--tune [--tune-file f] [--generations G] [--population P] [--seeds N]\n"
+            "                   [--tune-out dir] [--threads T]]\n"
             "notes:\n"
             "  - if --world omitted and ./world.lbw exists, it will be loaded\n"
             "  - if --catalog omitted and ./catalog.lbc exists, it will be loaded\n"
+            "  - lazy catalogs index taskdefs in one scan and parse bodies on first use\n"
+            "  - --flows journals inventory changes and reports produced/consumed per item and task\n"
+            "  - --region runs N copies of the shelter in parallel with trade/raids at day ends\n"
+            "  - --record saves every decision and random draw; --replay re-runs them without\n"
+            "    evaluating rules (seed and days come from the log, so --seed and --days are\n"
+            "    rejected) and reports divergence\n"
+            "  - --sweep (repeatable) runs every grid point for N seeds in parallel and prints one\n"
+            "    CSV row per point; keys: events.breach_chance, events.overnight_chance,\n"
+            "    shelter.<field>, inventory.<item>\n"
+            "  - --until ends a run once the DSL expression holds for either survivor, checked\n"
+            "    after every tick (or each day's last tick), e.g. \"shelter.structure <= 0\"\n"
+            "  - --steady looks for end-of-day states that repeat with a period of up to P days and\n"
+            "    extrapolates whole cycles (stocks drift linearly) instead of simulating them\n"
+            "  - --batch runs N seeds from one parse and prints mean, sd, min, p05, p50, p95 and\n"
+            "    max of the end-of-run vitals, idle ticks, shelter, stock and task completions\n"
+            "  - --target-ci (repeatable) runs a batch in rounds until the 95%% interval on each\n"
+            "    metric's mean is at most `width` wide; metrics: survival, structure, morale or\n"
+            "    any row of the --batch table; --batch N then caps the runs (default 1000000)\n"
+            "  - --shard runs only the i-th of n slices of a --batch or --sweep and writes it to\n"
+            "    --shard-out (default shard-i-of-n.lbr); lastbreach-merge combines all n files\n"
+            "    into the output of the unsharded run\n"
+            "  - --cache keeps each run's result in a file keyed by the inputs' tokens, the\n"
+            "    flags, seed and days; later batches and sweeps read matching runs instead of\n"
+            "    playing them, so an interrupted sweep resumes where it stopped. Least recently\n"
+            "    used runs are evicted to keep the file under --cache-max MB (default 256)\n"
+            "  - --ab plays each seed once with planA and once with planB in place of the survivor\n"
+            "    of the same name, on identical per-purpose random streams, and prints the paired\n"
+            "    differences with 95%% confidence intervals (--seeds defaults to 100 here)\n"
+            "  - --split estimates the chance that structure reaches 0 within --days by splitting\n"
+            "    runs as they fall below each structure level (checked at day ends); N runs per\n"
+            "    stage (default 100), R independent replications for the variance (default 10)\n"
+            "  - --tune searches the task priorities marked '# tune lo..hi' (or listed in a\n"
+            "    --tune-file as '<plan>:<line> lo..hi') for the best survival score and writes\n"
+            "    <plan>.tuned.lbp into --tune-out (default: current directory)\n"
            );
     exit(2);
 }
 
+/* Stop condition and steady-state period shared by every mode that plays days. */
+typedef struct {
+    Expr *expr;
+    int daily;
+    int steady;
+} Until;
+
+static void apply_until(World *w, const Until *u) {
+    w->until = u->expr;
+    w->until_daily = u->daily;
+    w->steady_period = u->steady;
+}
+
+/* --shard: which slice this process runs and where its partial result goes. */
+typedef struct {
+    int shard, shards;    /* shards 0: not sharded */
+    const char *out;
+    char options[1024];   /* result-affecting flags, compared by lastbreach-merge */
+} ShardReq;
+
+static int save_shard(const ShardReq *sh, const LoadRequest *rq, Partial *p, unsigned int seed, int days) {
+    /* Same fingerprint as --record, so shards of different inputs refuse to merge. */
+    const char *input_paths[4];
+    char err[512];
+    input_paths[0] = rq->char_paths[0];
+    input_paths[1] = rq->char_paths[1];
+    input_paths[2] = rq->world_path;
+    input_paths[3] = rq->catalog_path;
+    p->inputs = dlog_fingerprint(input_paths, 4);
+    free(p->options);
+    p->options = xstrdup(sh->options);
+    p->seed = seed;
+    p->days = days;
+    p->shard = sh->shard;
+    p->shards = sh->shards;
+    if (partial_save(p, sh->out, err, sizeof(err))!=0) dief("%s", err);
+    printf("wrote %s (shard %d/%d)\n", sh->out, sh->shard, sh->shards);
+    partial_free(p);
+    return 0;
+}
+
+/* --cache: where finished runs are kept between invocations. */
+typedef struct {
+    const char *path;     /* NULL: no cache */
+    long long max_bytes;
+} CacheReq;
+
+/* Keyed on the same flags lastbreach-merge compares; NULL without --cache. */
+static ResultCache *open_cache(const CacheReq *cr, const LoadRequest *rq, const ShardReq *sh, int days) {
+    if (!cr->path) return NULL;
+    const char *input_paths[4];
+    char err[512];
+    input_paths[0] = rq->char_paths[0];
+    input_paths[1] = rq->char_paths[1];
+    input_paths[2] = rq->world_path;
+    input_paths[3] = rq->catalog_path;
+    unsigned long long base = cache_inputs_key(input_paths, 4, sh->options, days);
+    ResultCache *c = cache_open(cr->path, cr->max_bytes, base, err, sizeof(err));
+    if (!c) dief("%s", err);
+    return c;
+}
+
+static int run_sweep(LoadRequest *rq, Sweep *sweep, const Until *until, const ShardReq *sh, const CacheReq *cr) {
+    /* Parsed once; every grid point and seed runs from copies of these. */
+    World world;
+    Catalog cat;
+    Character chars[2];
+    char err[512];
+    if (load_inputs(rq, &cat, &world, chars, err, sizeof(err))!=0) dief("%s", err);
+    apply_until(&world, until);
+    /* After loading, so a bad input is reported by the parser rather than the key. */
+    sweep->cache = open_cache(cr, rq, sh, sweep->days);
+    if (sh->shards > 0) {
+        Partial part;
+        partial_init(&part);
+        if (sweep_run_shard(sweep, &world, &cat, chars, sh->shard, sh->shards, &part, err, sizeof(err))!=0) dief("%s", err);
+        cache_close(sweep->cache, stderr);
+        return save_shard(sh, rq, &part, sweep->seed, sweep->days);
+    }
+    int points = sweep_points(sweep);
+    SweepRow *rows = (SweepRow*)xmalloc(sizeof(SweepRow)*(size_t)points);
+    if (sweep_run(sweep, &world, &cat, chars, rows, err, sizeof(err))!=0) dief("%s", err);
+    /* stderr, so the CSV is the same with or without a cache. */
+    cache_close(sweep->cache, stderr);
+    sweep_write_csv(stdout, sweep, rows);
+    free(rows);
+    return 0;
+}
+
+static int run_batch(LoadRequest *rq, unsigned int seed, long long runs, int days, int threads, const Until *until,
+                     VecCiTarget *targets, const ShardReq *sh, const CacheReq *cr) {
+    /* Streamed: memory stays flat however many runs the batch has. */
+    World world;
+    Catalog cat;
+    Character chars[2];
+    BatchStats stats;
+    char err[512];
+    if (load_inputs(rq, &cat, &world, chars, err, sizeof(err))!=0) dief("%s", err);
+    apply_until(&world, until);
+    ResultCache *cache = open_cache(cr, rq, sh, days);
+    if (sh->shards > 0) {
+        Partial part;
+        partial_init(&part);
+        if (batch_run_shard(&world, &cat, chars, seed, runs, days, threads, cache, sh->shard, sh->shards, &part, err,
+                            sizeof(err))!=0) {
+            dief("%s", err);
+        }
+        cache_close(cache, stderr);
+        return save_shard(sh, rq, &part, seed, days);
+    }
+    bstats_init(&stats);
+    if (targets->n > 0) {
+        if (batch_run_ci(&world, &cat, chars, seed, runs, days, threads, cache, targets, &stats, err, sizeof(err))!=0) {
+            dief("%s", err);
+        }
+    } else if (batch_run(&world, &cat, chars, seed, runs, days, threads, cache, &stats, err, sizeof(err))!=0) {
+        dief("%s", err);
+    }
+    cache_close(cache, stderr);
+    printf("Batch: %lld runs, seeds %u.., days=%d\n", stats.runs, seed, days);
+    bstats_print(stdout, &stats);
+    ci_targets_print(stdout, targets, stats.runs);
+    bstats_free(&stats);
+    return 0;
+}
+
+/* A variant plan stands in for the cast member with its character name. */
+static void ab_cast(const Character *chars, const Character *variant, const char *path, Character *cast) {
+    cast[0] = chars[0];
+    cast[1] = chars[1];
+    for (int k = 0; k<2; k++) {
+        if (strcmp(chars[k].name, variant->name)==0) {
+            cast[k] = *variant;
+            return;
+        }
+    }
+    dief("--ab: %s plays \"%s\", who is neither %s nor %s", path, variant->name, chars[0].name, chars[1].name);
+}
+
+static int run_ab(LoadRequest *rq, const char *plan_a, const char *plan_b, unsigned int seed, long long runs, int days,
+                  int threads, const Until *until) {
+    /* Parsed once: the cast, then both variants, which replace a cast member by name. */
+    const char *paths[4];
+    paths[0] = rq->char_paths[0];
+    paths[1] = rq->char_paths[1];
+    paths[2] = plan_a;
+    paths[3] = plan_b;
+    LoadRequest all = *rq;
+    all.char_paths = paths;
+    all.n_chars = 4;
+    World world;
+    Catalog cat;
+    Character chars[4], cast_a[2], cast_b[2];
+    AbStats *stats = (AbStats*)xmalloc(sizeof(AbStats));
+    char err[512];
+    if (load_inputs(&all, &cat, &world, chars, err, sizeof(err))!=0) dief("%s", err);
+    ab_cast(chars, &chars[2], plan_a, cast_a);
+    ab_cast(chars, &chars[3], plan_b, cast_b);
+    apply_until(&world, until);
+    if (ab_run(&world, &cat, cast_a, cast_b, seed, runs, days, threads, stats, err, sizeof(err))!=0) dief("%s", err);
+    printf("A/B: %lld paired runs, seeds %u.., days=%d\n  A = %s\n  B = %s\n", runs, seed, days, plan_a, plan_b);
+    ab_print(stdout, stats);
+    free(stats);
+    return 0;
+}
+
+static int run_split(LoadRequest *rq, Split *s, const Until *until) {
+    World world;
+    Catalog cat;
+    Character chars[2];
+    SplitResult res;
+    char err[512];
+    if (load_inputs(rq, &cat, &world, chars, err, sizeof(err))!=0) dief("%s", err);
+    apply_until(&world, until);
+    if (split_run(s, &world, &cat, chars, &res, err, sizeof(err))!=0) dief("%s", err);
+    printf("Split: %d stages x %d runs, %d replications, seed %u, days=%d\n",
+           res.stages, s->effort, s->reps, s->seed, s->days);
+    split_print(stdout, s, &res);
+    split_result_free(&res);
+    return 0;
+}
+
+static int write_tuned_plan(const Tune *t, int script, const char *path, const char *dir, const double *x) {
+    const char *name = strrchr(path, '/');
+    name = name ? name+1 : path;
+    size_t stem = strlen(name);
+    if (stem > 4 && strcmp(name+stem-4, ".lbp")==0) stem -= 4;
+    char out_path[1024];
+    snprintf(out_path, sizeof(out_path), "%s/%.*s.tuned.lbp", dir, (int)stem, name);
+    char *src = read_entire_file(path);
+    if (!src) dief("failed to read %s", path);
+    FILE *f = fopen(out_path, "w");
+    if (!f) dief("cannot write %s", out_path);
+    tune_write_plan(f, t, script, src, x);
+    fclose(f);
+    free(src);
+    printf("wrote %s\n", out_path);
+    return 0;
+}
+
+static int run_tune(LoadRequest *rq, Tune *t, const char *tune_file, const char *out_dir, const Until *until) {
+    char err[512];
+    for (int k = 0; k<2; k++) {
+        char *src = read_entire_file(rq->char_paths[k]);
+        if (!src) dief("failed to read %s", rq->char_paths[k]);
+        int rc = tune_scan_annotations(t, k, rq->char_paths[k], src, err, sizeof(err));
+        free(src);
+        if (rc!=0) dief("%s", err);
+    }
+    if (tune_file && tune_load_file(t, tune_file, rq->char_paths, err, sizeof(err))!=0) dief("%s", err);
+
+    /* Each candidate needs scripts of its own to write its priorities into: parse the pair once per slot. */
+    const char **paths = (const char**)xmalloc(sizeof(char*)*(size_t)(2*t->population));
+    for (int c = 0; c<2*t->population; c++) paths[c] = rq->char_paths[c%2];
+    LoadRequest many = *rq;
+    many.char_paths = paths;
+    many.n_chars = 2*t->population;
+    World world;
+    Catalog cat;
+    Character *casts = (Character*)xmalloc(sizeof(Character)*(size_t)many.n_chars);
+    if (load_inputs(&many, &cat, &world, casts, err, sizeof(err))!=0) dief("%s", err);
+    apply_until(&world, until);
+
+    printf("Tuning %d priorities: population=%d generations=%d seeds=%d days=%d seed=%u\n",
+           t->params.n, t->population, t->generations, t->seeds, t->days, t->seed);
+    double *best = (double*)xmalloc(sizeof(double)*(size_t)(t->params.n > 0 ? t->params.n : 1));
+    double score;
+    t->log = stdout;
+    if (tune_run(t, &world, &cat, casts, best, &score, err, sizeof(err))!=0) dief("%s", err);
+    printf("best score %.3f\n", score);
+    for (int p = 0; p<t->params.n; p++) {
+        const TuneParam *tp = &t->params.v[p];
+        printf("  %s:%d priority %g -> %g\n", rq->char_paths[tp->script], tp->line, tp->start, best[p]);
+    }
+    for (int k = 0; k<2; k++) {
+        int touched = 0;
+        for (int p = 0; p<t->params.n; p++) touched |= t->params.v[p].script==k;
+        if (touched) write_tuned_plan(t, k, rq->char_paths[k], out_dir, best);
+    }
+    free(best);
+    free(paths);
+    return 0;
+}
+
+static int run_region(LoadRequest *rq, int n_sites, int threads, unsigned int seed, int days) {
+    /* Every shelter starts from the same files; their own RNG streams make them diverge. */
+    Region region;
+    char err[512];
+    region_init(&region, seed, threads, NULL);
+    for (int i = 0; i<n_sites; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "shelter-%d", i);
+        RegionSite *s = region_add_site(&region, name);
+        /* load_inputs initializes from scratch; release the empty site it replaces. */
+        world_free(&s->world);
+        cat_free(&s->cat);
+        character_free(&s->cast[0]);
+        character_free(&s->cast[1]);
+        if (load_inputs(rq, &s->cat, &s->world, s->cast, err, sizeof(err))!=0) dief("%s", err);
+    }
+    printf("Region: %d shelters, seed=%u days=%d\n", n_sites, seed, days);
+    for (int day = 0; day<days; day++) {
+        RegionExchange ex;
+        region_step_day(&region, &ex);
+        printf("[region day %d] trades=%d (%.0f units) raids=%d (%.0f units)\n",
+               day, ex.trades, ex.traded_units, ex.raids, ex.raided_units);
+    }
+    printf("\n=== REGION COMPLETE ===\n");
+    for (int i = 0; i<region.sites.n; i++) {
+        RegionSite *s = region.sites.v[i];
+        printf("  %s: structure=%.0f food=%.1f traded_in=%.0f traded_out=%.0f raided_in=%.0f raided_out=%.0f\n",
+               s->name, s->world.shelter.structure, inv_stock(&s->world.inv, "Food"),
+               s->traded_in, s->traded_out, s->raided_in, s->raided_out);
+    }
+    region_free(&region);
+    return 0;
+}
+
 /** main function. */
 int main(int argc, char **argv) {
     if (argc < 3) usage();
@@ -26,15 +349,48 @@ int main(int argc, char **argv) {
     const char *b_path = argv[2];
     const char *world_path = NULL;
     const char *catalog_path = NULL;
+    CatalogMode catalog_mode = CATALOG_EAGER;
     int days = 1;
+    int flows = 0;
+    int region_sites = 0;
+    int threads = 0;
     unsigned int seed = (unsigned int)time(NULL);
+    const char *record_path = NULL;
+    Sweep sweep;
+    sweep_init(&sweep);
+    int seeds = 0; /* 0 = the mode's default */
+    long long batch = 0;
+    VecCiTarget targets;
+    ci_targets_init(&targets);
+    ShardReq shard;
+    memset(&shard, 0, sizeof(shard));
+    CacheReq cache;
+    cache.path = NULL;
+    cache.max_bytes = 256LL << 20;
+    const char *ab_a = NULL, *ab_b = NULL;
+    Split split;
+    split_init(&split);
+    int tune = 0;
+    Tune tuner;
+    tune_init(&tuner);
+    const char *tune_file = NULL;
+    const char *tune_out = ".";
+    const char *until_text = NULL;
+    Until until;
+    until.expr = NULL;
+    until.daily = 0;
+    until.steady = 0;
+    const char *replay_path = NULL;
+    int run_flags = 0; /* --seed or --days given; a replay takes both from its log */
     for (int i = 3; i<argc; i++) {
         if (strcmp(argv[i], "--days")==0 && i+1<argc) {
             days = atoi(argv[++i]);
+            run_flags = 1;
             continue;
         }
         if (strcmp(argv[i], "--seed")==0 && i+1<argc) {
             seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+            run_flags = 1;
             continue;
         }
         if (strcmp(argv[i], "--world")==0 && i+1<argc) {
@@ -45,51 +401,256 @@ int main(int argc, char **argv) {
             catalog_path = argv[++i];
             continue;
         }
+        if (strcmp(argv[i], "--flows")==0) {
+            flows = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--region")==0 && i+1<argc) {
+            region_sites = atoi(argv[++i]);
+            if (region_sites < 1) usage();
+            continue;
+        }
+        if (strcmp(argv[i], "--threads")==0 && i+1<argc) {
+            threads = atoi(argv[++i]);
+            continue;
+        }
+        if (strcmp(argv[i], "--sweep")==0 && i+1<argc) {
+            char err[256];
+            if (sweep_add_axis(&sweep, argv[++i], err, sizeof(err))!=0) dief("%s", err);
+            continue;
+        }
+        if (strcmp(argv[i], "--seeds")==0 && i+1<argc) {
+            seeds = atoi(argv[++i]);
+            if (seeds < 1) usage();
+            continue;
+        }
+        if (strcmp(argv[i], "--until")==0 && i+1<argc) {
+            until_text = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--until-check")==0 && i+1<argc) {
+            const char *m = argv[++i];
+            if (strcmp(m, "tick")==0) until.daily = 0;
+            else if (strcmp(m, "day")==0) until.daily = 1;
+            else usage();
+            continue;
+        }
+        if (strcmp(argv[i], "--steady")==0 && i+1<argc) {
+            until.steady = atoi(argv[++i]);
+            if (until.steady < 1) usage();
+            continue;
+        }
+        if (strcmp(argv[i], "--ab")==0 && i+2<argc) {
+            ab_a = argv[++i];
+            ab_b = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--split")==0 && i+1<argc) {
+            char err[256];
+            if (split_parse_levels(&split, argv[++i], err, sizeof(err))!=0) dief("%s", err);
+            continue;
+        }
+        if (strcmp(argv[i], "--split-effort")==0 && i+1<argc) {
+            split.effort = atoi(argv[++i]);
+            if (split.effort < 1) usage();
+            continue;
+        }
+        if (strcmp(argv[i], "--split-reps")==0 && i+1<argc) {
+            split.reps = atoi(argv[++i]);
+            if (split.reps < 1) usage();
+            continue;
+        }
+        if (strcmp(argv[i], "--batch")==0 && i+1<argc) {
+            batch = atoll(argv[++i]);
+            if (batch < 1) usage();
+            continue;
+        }
+        if (strcmp(argv[i], "--target-ci")==0 && i+1<argc) {
+            char err[256];
+            if (ci_target_add(&targets, argv[++i], err, sizeof(err))!=0) dief("%s", err);
+            continue;
+        }
+        if (strcmp(argv[i], "--shard")==0 && i+1<argc) {
+            char err[256];
+            if (shard_parse(argv[++i], &shard.shard, &shard.shards, err, sizeof(err))!=0) dief("%s", err);
+            continue;
+        }
+        if (strcmp(argv[i], "--shard-out")==0 && i+1<argc) {
+            shard.out = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--cache")==0 && i+1<argc) {
+            cache.path = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--cache-max")==0 && i+1<argc) {
+            long long mb = atoll(argv[++i]);
+            if (mb < 1) usage();
+            cache.max_bytes = mb << 20;
+            continue;
+        }
+        if (strcmp(argv[i], "--tune")==0) {
+            tune = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--tune-file")==0 && i+1<argc) {
+            tune = 1;
+            tune_file = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--tune-out")==0 && i+1<argc) {
+            tune_out = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--generations")==0 && i+1<argc) {
+            tuner.generations = atoi(argv[++i]);
+            if (tuner.generations < 1) usage();
+            continue;
+        }
+        if (strcmp(argv[i], "--population")==0 && i+1<argc) {
+            tuner.population = atoi(argv[++i]);
+            if (tuner.population < 2) usage();
+            continue;
+        }
+        if (strcmp(argv[i], "--record")==0 && i+1<argc) {
+            record_path = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--replay")==0 && i+1<argc) {
+            replay_path = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--catalog-mode")==0 && i+1<argc) {
+            const char *m = argv[++i];
+            if (strcmp(m, "eager")==0) catalog_mode = CATALOG_EAGER;
+            else if (strcmp(m, "lazy")==0) catalog_mode = CATALOG_LAZY;
+            else if (strcmp(m, "parallel")==0) catalog_mode = CATALOG_LAZY_PARALLEL;
+            else usage();
+            continue;
+        }
         usage();
     }
+    /* Targets make it a batch that sizes itself; --batch N is then the limit. */
+    if (targets.n > 0 && batch==0) batch = 1000000;
+    if (record_path && replay_path) usage();
+    if (replay_path && run_flags) usage();
+    if ((record_path || replay_path) && region_sites > 0) usage();
+    if (sweep.axes.n > 0 && (region_sites > 0 || record_path || replay_path)) usage();
+    if (tune && (sweep.axes.n > 0 || region_sites > 0 || record_path || replay_path)) usage();
+    if (batch > 0 && (tune || sweep.axes.n > 0 || region_sites > 0 || record_path || replay_path)) usage();
+    if (ab_a && (batch > 0 || tune || sweep.axes.n > 0 || region_sites > 0 || record_path || replay_path)) usage();
+    if (split.levels.n > 0 && (ab_a || batch > 0 || tune || sweep.axes.n > 0 || region_sites > 0 || record_path || replay_path)) usage();
+    /* Only batches and sweeps split into independent slices; a self-sizing batch does not. */
+    if (shard.shards > 0 && (sweep.axes.n > 0 ? batch > 0 : batch==0)) usage();
+    if (shard.shards > 0 && (targets.n > 0 || ab_a || tune || split.levels.n > 0 || region_sites > 0 || record_path || replay_path)) usage();
+    if (cache.path && batch==0 && sweep.axes.n==0) usage();
+    if (seeds==0) seeds = ab_a ? 100 : 1;
+    if (until_text && region_sites > 0) usage();
+    if (until.steady > 0 && (region_sites > 0 || record_path || replay_path)) usage();
+    if (until_text) {
+        char uerr[512];
+        until.expr = parse_condition("--until", until_text, uerr, sizeof(uerr));
+        if (!until.expr) dief("%s", uerr);
+    }
+    char shard_path[64];
+    if (shard.shards > 0 && !shard.out) {
+        snprintf(shard_path, sizeof(shard_path), "shard-%d-of-%d.lbr", shard.shard, shard.shards);
+        shard.out = shard_path;
+    }
+    snprintf(shard.options, sizeof(shard.options), "until=%s check=%s steady=%d",
+             until_text ? until_text : "", until.daily ? "day" : "tick", until.steady);
     srand(seed);
-    World world;
-    world_init(&world);
-    Catalog cat;
-    cat_init(&cat);
-    seed_default_catalog(&cat);
     /* Auto-discover local data files for convenience in developer workflows. */
     if (!world_path && file_exists("world.lbw")) world_path = "world.lbw";
     if (!catalog_path && file_exists("catalog.lbc")) catalog_path = "catalog.lbc";
-    if (catalog_path) {
-        char *src = read_entire_file(catalog_path);
-        if (!src) dief("failed to read catalog file: %s", catalog_path);
-        parse_catalog(&cat, catalog_path, src);
-        free(src);
-        printf("Loaded catalog: %s\n", catalog_path);
+    /* All four files are independent until the simulation starts. */
+    const char *char_paths[2];
+    char_paths[0] = a_path;
+    char_paths[1] = b_path;
+    LoadRequest rq;
+    memset(&rq, 0, sizeof(rq));
+    rq.catalog_path = catalog_path;
+    rq.catalog_mode = catalog_mode;
+    rq.world_path = world_path;
+    rq.char_paths = char_paths;
+    rq.n_chars = 2;
+    char err[512];
+    if (region_sites > 0) return run_region(&rq, region_sites, threads, seed, days);
+    if (ab_a) return run_ab(&rq, ab_a, ab_b, seed, seeds, days, threads, &until);
+    if (split.levels.n > 0) {
+        split.seed = seed;
+        split.days = days;
+        split.threads = threads;
+        int rc = run_split(&rq, &split, &until);
+        split_free(&split);
+        return rc;
     }
-    if (world_path) {
-        char *src = read_entire_file(world_path);
-        if (!src) dief("failed to read world file: %s", world_path);
-        parse_world(&world, world_path, src);
-        free(src);
-        printf("Loaded world: %s\n", world_path);
-    }
-    char *a_src = read_entire_file(a_path);
-    char *b_src = read_entire_file(b_path);
-    if (!a_src) dief("failed to read %s", a_path);
-    if (!b_src) dief("failed to read %s", b_path);
-    Parser pa;
-    ps_init(&pa, a_path, a_src);
-    Parser pb;
-    ps_init(&pb, b_path, b_src);
-    /* Skip any DSL preamble until the first `character` block in each file. */
-    while (!ps_is_ident(&pa, "character") && !ps_is(&pa, TK_EOF)) lx_next_token(&pa.lx);
-    while (!ps_is_ident(&pb, "character") && !ps_is(&pb, TK_EOF)) lx_next_token(&pb.lx);
-    if (ps_is(&pa, TK_EOF)) dief("%s: no character block found", a_path);
-    if (ps_is(&pb, TK_EOF)) dief("%s: no character block found", b_path);
-    Character A, B;
-    parse_character(&pa, &A);
-    parse_character(&pb, &B);
-    printf("Loaded characters: %s and %s\n", A.name, B.name);
+    if (batch > 0) {
+        int rc = run_batch(&rq, seed, batch, days, threads, &until, &targets, &shard, &cache);
+        ci_targets_free(&targets);
+        return rc;
+    }
+    if (tune) {
+        tuner.seed = seed;
+        tuner.days = days;
+        tuner.seeds = seeds;
+        tuner.threads = threads;
+        int rc = run_tune(&rq, &tuner, tune_file, tune_out, &until);
+        tune_free(&tuner);
+        return rc;
+    }
+    if (sweep.axes.n > 0) {
+        sweep.seeds = seeds;
+        sweep.seed = seed;
+        sweep.days = days;
+        sweep.threads = threads;
+        int rc = run_sweep(&rq, &sweep, &until, &shard, &cache);
+        sweep_free(&sweep);
+        return rc;
+    }
+    /* The fingerprint tells a replay whether it is running against the recorded files. */
+    const char *input_paths[4];
+    input_paths[0] = a_path;
+    input_paths[1] = b_path;
+    input_paths[2] = world_path;
+    input_paths[3] = catalog_path;
+    DecisionLog dlog;
+    dlog_init(&dlog);
+    if (replay_path) {
+        dlog_free(&dlog);
+        if (dlog_load(&dlog, replay_path, err, sizeof(err))!=0) dief("%s", err);
+        if (dlog.inputs!=dlog_fingerprint(input_paths, 4)) {
+            fprintf(stderr, "replay: inputs differ from the recorded run; decisions are checked as they replay\n");
+        }
+        seed = dlog.seed;
+        days = dlog.days;
+        dlog_rewind(&dlog);
+    } else if (record_path) {
+        dlog.inputs = dlog_fingerprint(input_paths, 4);
+        dlog.seed = seed;
+    }
+    World world;
+    Catalog cat;
+    Character chars[2];
+    if (load_inputs(&rq, &cat, &world, chars, err, sizeof(err))!=0) dief("%s", err);
+    if (catalog_path) printf("Loaded catalog: %s\n", catalog_path);
+    if (world_path) printf("Loaded world: %s\n", world_path);
+    printf("Loaded characters: %s and %s\n", chars[0].name, chars[1].name);
     printf("Seed=%u days=%d\n", seed, days);
-    run_sim(&world, &cat, &A, &B, days);
-    free(a_src);
-    free(b_src);
-    return 0;
+    lb_rng_seed(&world.rng, seed, 0);
+    apply_until(&world, &until);
+    InvJournal journal;
+    inv_journal_init(&journal);
+    if (flows) world.inv.journal = &journal;
+    if (record_path || replay_path) world.dlog = &dlog;
+    run_sim(&world, &cat, &chars[0], &chars[1], days);
+    inv_journal_free(&journal);
+    int status = 0;
+    if (replay_path && dlog.diverged) {
+        fprintf(stderr, "replay: diverged at day %d tick %02d: %s\n", dlog.div_day, dlog.div_tick, dlog.div_reason);
+        status = 3;
+    }
+    if (record_path && dlog_save(&dlog, record_path, err, sizeof(err))!=0) dief("%s", err);
+    dlog_free(&dlog);
+    return status;
 }
@@ -1,5 +1,6 @@
 #include "test_framework.h"
 #include "test_support.h"
+#include "lb_canon_ids.h"
 
 #include <fcntl.h>
 #include <unistd.h>
@@ -23,6 +24,21 @@ static void test_xalloc_helpers(void) {
     free(mem);
 }
 
+static void test_sqrt_helper(void) {
+    /* Converges for every exponent, including those the old x-sized first guess never reached. */
+    static const double xs[] = {1e-310, 1e-300, 1e-9, 0.3, 2.0, 12345.678, 1e40, 1e300, 1.7e308};
+    ASSERT_EQ_DBL(0.0, lb_sqrt(0.0), 0.0);
+    ASSERT_EQ_DBL(0.0, lb_sqrt(-4.0), 0.0);
+    ASSERT_EQ_DBL(2.0, lb_sqrt(4.0), 0.0);
+    ASSERT_EQ_DBL(0.5, lb_sqrt(0.25), 0.0);
+    ASSERT_EQ_DBL(1e20, lb_sqrt(1e40), 1e5);
+    for (int i = 0; i<(int)(sizeof(xs)/sizeof(xs[0])); i++) {
+        double r = lb_sqrt(xs[i]);
+        double q = xs[i] / r;
+        ASSERT_TRUE_MSG(r - q <= 4e-16*r && q - r <= 4e-16*r, "sqrt(%g) = %.17g", xs[i], r);
+    }
+}
+
 static void test_inventory_basics(void) {
     /* Inventory tracks both quantity accumulation and best condition. */
     Inventory inv;
@@ -41,6 +57,216 @@ static void test_inventory_basics(void) {
     ASSERT_EQ_DBL(0.0, inv_cond(&inv, "Missing"), 1e-9);
 }
 
+static void test_inventory_handles(void) {
+    /* Handles are stable across index growth; canonical ids double as handles. */
+    Inventory inv;
+    ItemHandle first;
+    char key[32];
+
+    inv_init(&inv);
+    ASSERT_EQ_INT(CANON_ITEM_FOOD, inv_lookup(&inv, "Food"));
+    ASSERT_EQ_INT(-1, inv_lookup(&inv, "Widget 0"));
+    ASSERT_EQ_DBL(0.0, inv_stock_h(&inv, -1), 1e-9);
+    ASSERT_EQ_DBL(0.0, inv_consume_h(&inv, -1, 1.0), 1e-9);
+
+    first = inv_handle(&inv, "Widget 0");
+    ASSERT_EQ_INT(first, inv_handle(&inv, "Widget 0"));
+    ASSERT_EQ_INT(0, inv_has(&inv, "Widget 0"));
+    inv_add_h(&inv, first, 2.0, 40.0);
+    for (int i = 1; i < 5000; i++) {
+        snprintf(key, sizeof(key), "Widget %d", i);
+        inv_add(&inv, key, (double)i, 50.0);
+    }
+    ASSERT_EQ_INT(first, inv_lookup(&inv, "Widget 0"));
+    ASSERT_EQ_DBL(2.0, inv_stock(&inv, "Widget 0"), 1e-9);
+    ASSERT_EQ_DBL(4999.0, inv_stock(&inv, "Widget 4999"), 1e-9);
+    ASSERT_EQ_DBL(1.5, inv_consume(&inv, "Widget 0", 1.5), 1e-9);
+    ASSERT_EQ_DBL(0.5, inv_consume_h(&inv, first, 3.0), 1e-9);
+    ASSERT_EQ_DBL(0.0, inv_stock_h(&inv, first), 1e-9);
+    ASSERT_EQ_DBL(40.0, inv_cond_h(&inv, first), 1e-9);
+
+    inv_add_h(&inv, CANON_ITEM_FISH, 3.0, 80.0);
+    ASSERT_EQ_DBL(3.0, inv_stock(&inv, "Fish"), 1e-9);
+}
+
+static void test_inventory_journal(void) {
+    /* Rollback restores exact values; compaction keeps flows but drops entries. */
+    Inventory inv;
+    InvJournal jr;
+    VecInvFlow flows;
+    InvMark mark;
+
+    inv_init(&inv);
+    inv_journal_init(&jr);
+    inv.journal = &jr;
+    jr.cause = CANON_TASK_COOKING;
+    inv_add_h(&inv, CANON_ITEM_FOOD, 3.0, 90.0);
+    inv.now = DAY_TICKS+2;
+    jr.cause = CANON_TASK_EATING;
+    inv_consume_h(&inv, CANON_ITEM_FOOD, 1.0);
+    inv_consume_h(&inv, CANON_ITEM_WATER, 1.0); /* nothing taken, nothing logged */
+    ASSERT_EQ_INT(2, (int)inv_journal_mark(&jr));
+
+    mark = inv_journal_mark(&jr);
+    inv_add_h(&inv, CANON_ITEM_FOOD, 0.1, 100.0);
+    inv_consume_h(&inv, CANON_ITEM_FOOD, 0.7);
+    inv_add(&inv, "Scrap", 4.0, 10.0);
+    inv_journal_rollback(&inv, mark);
+    ASSERT_TRUE(inv_stock_h(&inv, CANON_ITEM_FOOD) == 2.0);
+    ASSERT_EQ_DBL(90.0, inv_cond_h(&inv, CANON_ITEM_FOOD), 1e-9);
+    ASSERT_EQ_DBL(0.0, inv_stock(&inv, "Scrap"), 1e-9);
+    ASSERT_EQ_INT(2, (int)inv_journal_mark(&jr));
+
+    inv_journal_compact(&jr, 1);
+    ASSERT_EQ_INT(1, jr.entries.n);
+    ASSERT_EQ_INT(1, (int)jr.base);
+    inv_consume_h(&inv, CANON_ITEM_FOOD, 0.5);
+
+    VEC_INIT(flows);
+    inv_journal_flows(&jr, 1, &flows);
+    ASSERT_EQ_INT(1, flows.n);
+    ASSERT_EQ_INT(CANON_TASK_EATING, flows.v[0].cause);
+    ASSERT_EQ_DBL(1.5, flows.v[0].consumed, 1e-9);
+    flows.n = 0;
+    inv_journal_flows(&jr, -1, &flows);
+    ASSERT_EQ_INT(2, flows.n);
+    ASSERT_EQ_DBL(3.0, flows.v[0].produced, 1e-9);
+    VEC_FREE(flows);
+    inv_journal_free(&jr);
+}
+
+static void test_inventory_journal_bounded(void) {
+    /* A year of compacted days keeps only the window per day; totals still cover every day. */
+    Inventory inv;
+    InvJournal jr;
+    VecInvFlow flows;
+    int days = 365;
+
+    inv_init(&inv);
+    inv_journal_init(&jr);
+    inv.journal = &jr;
+    int own = inv_journal_cause(&jr, "Whittling");
+    ASSERT_TRUE(own < -1);
+    ASSERT_EQ_INT(own, inv_journal_cause(&jr, "Whittling"));
+    ASSERT_EQ_INT(CANON_TASK_COOKING, inv_journal_cause(&jr, "Cooking"));
+    ASSERT_STREQ("Whittling", inv_journal_cause_name(&jr, own));
+    ASSERT_STREQ("(world)", inv_journal_cause_name(&jr, -1));
+    for (int d = 0; d<days; d++) {
+        inv.now = d*DAY_TICKS;
+        jr.cause = CANON_TASK_COOKING;
+        inv_add_h(&inv, CANON_ITEM_FOOD, 2.0, 90.0);
+        jr.cause = own;
+        inv_add(&inv, "Scrap", 1.0, 50.0);
+        jr.cause = -1;
+        inv_consume_h(&inv, CANON_ITEM_FOOD, 1.0);
+        inv_journal_compact(&jr, inv_journal_mark(&jr));
+        ASSERT_TRUE(jr.flows.n <= 3*jr.window);
+        ASSERT_TRUE(jr.totals.n <= 3);
+    }
+
+    VEC_INIT(flows);
+    inv_journal_flows(&jr, days-1, &flows);
+    ASSERT_EQ_INT(3, flows.n);
+    flows.n = 0;
+    inv_journal_flows(&jr, 0, &flows);
+    ASSERT_EQ_INT(0, flows.n);
+    inv_journal_flows(&jr, -1, &flows);
+    ASSERT_EQ_INT(3, flows.n);
+    ASSERT_EQ_INT(CANON_TASK_COOKING, flows.v[0].cause);
+    ASSERT_EQ_DBL(2.0*days, flows.v[0].produced, 1e-9);
+    ASSERT_EQ_INT(own, flows.v[1].cause);
+    ASSERT_EQ_DBL(1.0*days, flows.v[1].produced, 1e-9);
+    ASSERT_EQ_DBL(1.0*days, flows.v[2].consumed, 1e-9);
+    VEC_FREE(flows);
+    inv_journal_free(&jr);
+    inv_free(&inv);
+}
+
+static void test_inventory_lots_expire(void) {
+    /* Only due lots are popped; stock is assumed to be used oldest-first. */
+    Catalog cat;
+    Inventory inv;
+    VecItemLot spoiled;
+
+    cat_init(&cat);
+    seed_default_catalog(&cat);
+    inv_init(&inv);
+    inv_bind_registry(&inv, &cat.items);
+    VEC_INIT(spoiled);
+
+    inv_add_h(&inv, CANON_ITEM_FISH, 2.0, 90.0);
+    for (int i = 0; i < 1000; i++) inv_add_h(&inv, CANON_ITEM_GARLIC, 0.5, 90.0);
+    inv_add_h(&inv, CANON_ITEM_AMMUNITION, 10.0, 90.0); /* no shelf life, no lot */
+    inv.now = DAY_TICKS;
+    inv_add_h(&inv, CANON_ITEM_FISH, 3.0, 90.0);
+    inv_consume_h(&inv, CANON_ITEM_FISH, 1.0);
+    ASSERT_EQ_INT(1002, inv.lots.n);
+
+    inv.now = 3*DAY_TICKS-1;
+    inv_expire_lots(&inv, &spoiled);
+    ASSERT_EQ_INT(0, spoiled.n);
+    inv.now = 3*DAY_TICKS;
+    inv_expire_lots(&inv, &spoiled);
+    ASSERT_EQ_INT(1, spoiled.n);
+    ASSERT_EQ_DBL(1.0, spoiled.v[0].qty, 1e-9);
+    ASSERT_EQ_DBL(3.0, inv_stock_h(&inv, CANON_ITEM_FISH), 1e-9);
+    ASSERT_EQ_INT(1001, inv.lots.n);
+
+    inv.now = 4*DAY_TICKS;
+    inv_expire_lots(&inv, NULL);
+    ASSERT_EQ_DBL(0.0, inv_stock_h(&inv, CANON_ITEM_FISH), 1e-9);
+    ASSERT_EQ_DBL(500.0, inv_stock_h(&inv, CANON_ITEM_GARLIC), 1e-6);
+    ASSERT_EQ_DBL(10.0, inv_stock_h(&inv, CANON_ITEM_AMMUNITION), 1e-9);
+    ASSERT_EQ_INT(1000, inv.lots.n);
+    VEC_FREE(spoiled);
+}
+
+static double brute_best_cond(const Inventory *inv, ItemHandle h) {
+    double best = 0.0;
+    for (int i = 0; i < inv->inst.n; i++) {
+        if (inv->inst.owner[i]==h && inv->inst.cond[i] > best) best = inv->inst.cond[i];
+    }
+    return best;
+}
+
+static void test_inventory_tool_instances(void) {
+    /* Non-stackable items keep one condition per instance; cond() is the best live one. */
+    Catalog cat;
+    Inventory inv;
+    int rifle;
+
+    cat_init(&cat);
+    seed_default_catalog(&cat);
+    rifle = item_reg_find(&cat.items, "Rifle");
+    cat.items.items.v[rifle].stackable = 0;
+    cat.items.items.v[rifle].max_condition = 80.0;
+    inv_init(&inv);
+    inv_add_h(&inv, CANON_ITEM_RIFLE, 2.0, 60.0); /* predates binding */
+    inv_bind_registry(&inv, &cat.items);
+    ASSERT_EQ_INT(2, inv.items.v[CANON_ITEM_RIFLE].inst.n);
+
+    inv_add_h(&inv, CANON_ITEM_RIFLE, 1.0, 95.0);
+    ASSERT_EQ_DBL(80.0, inv_cond_h(&inv, CANON_ITEM_RIFLE), 1e-9);
+    ASSERT_EQ_DBL(80.0, inv_wear_h(&inv, CANON_ITEM_RIFLE, 30.0), 1e-9);
+    ASSERT_EQ_DBL(60.0, inv_cond_h(&inv, CANON_ITEM_RIFLE), 1e-9);
+    ASSERT_EQ_DBL(3.0, inv_stock_h(&inv, CANON_ITEM_RIFLE), 1e-9);
+    inv_wear_h(&inv, CANON_ITEM_RIFLE, 60.0); /* breaks */
+    ASSERT_EQ_DBL(2.0, inv_stock_h(&inv, CANON_ITEM_RIFLE), 1e-9);
+    ASSERT_EQ_DBL(60.0, inv_cond_h(&inv, CANON_ITEM_RIFLE), 1e-9);
+
+    /* A large armoury: the heap top always matches a full scan. */
+    srand(11);
+    for (int i = 0; i < 2000; i++) inv_add_h(&inv, CANON_ITEM_RIFLE, 1.0, (double)(rand()%80+1));
+    for (int i = 0; i < 5000; i++) {
+        inv_wear_h(&inv, CANON_ITEM_RIFLE, (double)(rand()%20));
+        if (i%500==0) inv_consume_h(&inv, CANON_ITEM_RIFLE, 3.0);
+        ASSERT_EQ_DBL(brute_best_cond(&inv, CANON_ITEM_RIFLE), inv_cond_h(&inv, CANON_ITEM_RIFLE), 1e-9);
+    }
+    ASSERT_EQ_DBL((double)inv.items.v[CANON_ITEM_RIFLE].inst.n, inv_stock_h(&inv, CANON_ITEM_RIFLE), 1e-9);
+    ASSERT_TRUE(inv_best_instance(&inv, CANON_ITEM_RIFLE) >= 0);
+    ASSERT_EQ_INT(-1, inv_best_instance(&inv, CANON_ITEM_FOOD));
+}
+
 static void test_catalog_basics(void) {
     /* get_or_add must return stable pointers for duplicate task names. */
     Catalog cat;
@@ -75,6 +301,221 @@ static void test_world_defaults(void) {
     ASSERT_EQ_INT(0, w.plants_watered_today);
     ASSERT_EQ_INT(0, w.hydroponics_maintained_today);
     ASSERT_EQ_DBL(0.0, w.cooked_food_portions, 1e-9);
+    ASSERT_EQ_INT(0, w.beds.n);
+}
+
+static void test_world_copy_is_independent(void) {
+    /* Copies share nothing mutable: stock, tool instances, events and beds diverge freely. */
+    Catalog cat;
+    World a, b;
+    cat_init(&cat);
+    seed_default_catalog(&cat);
+    cat.items.items.v[item_reg_find(&cat.items, "Rifle")].stackable = 0;
+    world_init(&a);
+    inv_bind_registry(&a.inv, &cat.items);
+    inv_add_h(&a.inv, CANON_ITEM_FOOD, 5.0, 100.0);
+    inv_add_h(&a.inv, CANON_ITEM_RIFLE, 2.0, 80.0);
+    event_schedule(&a.events, 0, 6, event_intern(&a.events, "radio_call"), 0);
+    beds_add(&a.beds, 3, 60.0, 40.0, 2);
+
+    world_copy(&b, &a);
+    ASSERT_EQ_INT(a.inv.items.n, b.inv.items.n);
+    ASSERT_EQ_INT(2, b.inv.items.v[CANON_ITEM_RIFLE].inst.n);
+    inv_consume_h(&b.inv, CANON_ITEM_FOOD, 5.0);
+    inv_add(&b.inv, "Brand new thing", 1.0, 50.0);
+    int worn = inv_best_instance(&b.inv, CANON_ITEM_RIFLE);
+    (void)inv_wear_h(&b.inv, CANON_ITEM_RIFLE, 30.0);
+    ASSERT_EQ_INT(1, event_pop_due(&b.events, 0, 6));
+    b.beds.health[0] = 0.0;
+
+    ASSERT_EQ_DBL(5.0, inv_stock_h(&a.inv, CANON_ITEM_FOOD), 0.0);
+    ASSERT_EQ_INT(-1, inv_lookup(&a.inv, "Brand new thing"));
+    ASSERT_EQ_DBL(80.0, a.inv.inst.cond[worn], 0.0);
+    ASSERT_EQ_DBL(50.0, b.inv.inst.cond[worn], 0.0);
+    ASSERT_EQ_INT(1, a.events.queue.n);
+    ASSERT_EQ_DBL(60.0, a.beds.health[0], 0.0);
+    world_free(&b);
+    world_free(&a);
+}
+
+static void test_steady_cycle_detection(void) {
+    /* Hashes alternate with period 2 while one level drifts by 3 per lap. */
+    SteadyTrack t;
+    double level[2], drift[3];
+    int p = 0;
+    steady_init(&t, 4);
+    for (int day = 0; day<=2*STEADY_REPEATS; day++) {
+        ASSERT_EQ_INT(0, p);
+        level[0] = 100.0 - 1.5*day;
+        level[1] = (day % 2) ? 7.0 : 4.0;
+        p = steady_observe(&t, (day % 2) ? 0xbeefull : 0xfeedull, level, 2, drift);
+    }
+    ASSERT_EQ_INT(2, p);
+    ASSERT_EQ_DBL(-3.0, drift[0], 1e-12);
+    ASSERT_EQ_DBL(0.0, drift[1], 1e-12);
+
+    /* A level that stops drifting evenly breaks the cycle. */
+    level[0] -= 10.0;
+    ASSERT_EQ_INT(0, steady_observe(&t, 0xfeedull, level, 2, drift));
+    /* So does a new level, which restarts the ring. */
+    double three[3] = {1.0, 2.0, 3.0};
+    for (int day = 0; day<STEADY_REPEATS; day++) ASSERT_EQ_INT(0, steady_observe(&t, 1ull, three, 3, drift));
+    ASSERT_EQ_INT(1, steady_observe(&t, 1ull, three, 3, drift));
+    steady_free(&t);
+}
+
+static void test_streaming_stats(void) {
+    /* Two halves merged agree with one stream, and with exact answers, at O(1) memory. */
+    StreamStat all, lo, hi;
+    LbRng r;
+    double sum = 0.0, sq = 0.0;
+    const int n = 200000;
+    stat_init(&all);
+    stat_init(&lo);
+    stat_init(&hi);
+    lb_rng_seed(&r, 3, 0);
+    for (int i = 0; i<n; i++) {
+        double x = 100.0*lb_rng_unit(&r);
+        stat_add(&all, x);
+        stat_add(i < n/2 ? &lo : &hi, x);
+        sum += x;
+        sq += x*x;
+    }
+    double mean = sum/n, var = (sq - n*mean*mean)/(n-1);
+    stat_merge(&lo, &hi);
+    ASSERT_TRUE(lo.n == (long long)n);
+    ASSERT_EQ_DBL(mean, lo.mean, 1e-9);
+    ASSERT_EQ_DBL(var, stat_var(&lo), 1e-6);
+    ASSERT_EQ_DBL(all.min, lo.min, 0.0);
+    ASSERT_EQ_DBL(all.max, lo.max, 0.0);
+    ASSERT_TRUE(all.nc <= STAT_CENTROIDS);
+    /* Uniform on [0,100): quantile q sits at 100q. */
+    ASSERT_EQ_DBL(50.0, stat_quantile(&all, 0.5), 0.5);
+    ASSERT_EQ_DBL(95.0, stat_quantile(&lo, 0.95), 0.5);
+    ASSERT_EQ_DBL(1.0, stat_quantile(&lo, 0.01), 0.1);
+
+    /* Point masses stay points: a count that is 0 in 98% of runs has p95 exactly 0. */
+    StreamStat c;
+    stat_init(&c);
+    stat_add_n(&c, 0.0, 980);
+    for (int i = 0; i<20; i++) stat_add(&c, 1.0 + i%3);
+    ASSERT_EQ_DBL(0.0, stat_quantile(&c, 0.95), 0.0);
+    ASSERT_EQ_DBL(3.0, stat_quantile(&c, 1.0), 0.0);
+
+    /* Batch rows pad metrics the other side never saw. */
+    BatchStats a, b;
+    bstats_init(&a);
+    bstats_init(&b);
+    int ra = bstats_row(&a, "done.Eating"), rb = bstats_row(&b, "done.Fishing");
+    stat_add(&a.rows.v[ra].s, 4.0);
+    a.runs = 1;
+    stat_add(&b.rows.v[rb].s, 2.0);
+    b.runs = 1;
+    bstats_merge(&a, &b);
+    ASSERT_EQ_INT(2, a.rows.n);
+    ASSERT_TRUE(a.rows.v[0].s.n == 2 && a.rows.v[1].s.n == 2);
+    ASSERT_EQ_DBL(2.0, a.rows.v[0].s.mean, 0.0);
+    ASSERT_EQ_DBL(1.0, a.rows.v[1].s.mean, 0.0);
+    bstats_free(&a);
+    bstats_free(&b);
+}
+
+static void test_hydroponic_beds(void) {
+    /* Beds evolve independently, harvest deterministically per seed, and dry out without water. */
+    HydroBeds a, b;
+    LbRng ra, rb;
+    BedsNight wet = {45.0, 3.0, 1.0};
+    BedsNight dry = {0.0, 0.0, 1.0};
+    int ha[4] = {0, 0, 0, 0}, hb[4] = {0, 0, 0, 0};
+    int total = 0;
+
+    beds_init(&a);
+    beds_init(&b);
+    beds_add(&a, 200, 70.0, 50.0, 4);
+    beds_add(&b, 200, 70.0, 50.0, 4);
+    ASSERT_EQ_INT(200, a.n);
+    ASSERT_EQ_INT(3, a.crop[7]);
+    lb_rng_seed(&ra, 42, 0);
+    lb_rng_seed(&rb, 42, 0);
+
+    for (int night = 0; night<12; night++) {
+        beds_night(&a, &wet, &ra, ha);
+        beds_night(&b, &wet, &rb, hb);
+    }
+    for (int i = 0; i<4; i++) {
+        ASSERT_EQ_INT(ha[i], hb[i]);
+        ASSERT_TRUE(ha[i] > 0);
+        total += ha[i];
+    }
+    for (int i = 0; i<a.n; i++) total -= (int)a.yield[i];
+    ASSERT_EQ_INT(0, total);
+    ASSERT_EQ_DBL(100.0, beds_mean_health(&a), 1e-9);
+
+    /* Watering stops: full reservoirs run dry on the fourth night, then health falls 7 a night. */
+    for (int night = 0; night<6; night++) beds_night(&a, &dry, &ra, ha);
+    ASSERT_EQ_DBL(0.0, a.water[0], 1e-9);
+    ASSERT_EQ_DBL(79.0, beds_mean_health(&a), 1e-9);
+    beds_free(&a);
+    beds_free(&b);
+}
+
+static void test_station_assignment(void) {
+    /* Losers switch to their next station instead of idling; equal bids go to the earlier agent. */
+    StationAssign a;
+    assign_init(&a);
+    assign_begin(&a);
+    assign_agent(&a, 0);
+    assign_option(&a, "kitchen", 60.0);
+    assign_option(&a, "workbench", 20.0);
+    assign_agent(&a, 1);
+    assign_option(&a, "kitchen", 80.0);
+    assign_option(&a, "workbench", 70.0);
+    assign_agent(&a, 2);
+    assign_option(&a, "kitchen", 10.0);
+    assign_option(&a, NULL, 5.0);
+    assign_solve(&a);
+    /* 60+70+5 beats the greedy 80+20+5. */
+    ASSERT_EQ_INT(0, assign_choice(&a, 0));
+    ASSERT_EQ_INT(1, assign_choice(&a, 1));
+    ASSERT_EQ_INT(1, assign_choice(&a, 2));
+
+    assign_begin(&a);
+    assign_agent(&a, 0);
+    assign_option(&a, "kitchen", 50.0);
+    assign_agent(&a, 1);
+    assign_option(&a, "kitchen", 50.0);
+    assign_solve(&a);
+    ASSERT_EQ_INT(0, assign_choice(&a, 0));
+    ASSERT_EQ_INT(-1, assign_choice(&a, 1));
+    ASSERT_EQ_INT(2, a.stations.n);
+
+    /* Unchanged agents keep their stations without bidding; a changed one bids against the old prices. */
+    for (int round = 0; round<3; round++) {
+        assign_begin(&a);
+        assign_agent(&a, 7);
+        assign_option(&a, "kitchen", 60.0);
+        assign_option(&a, "workbench", 20.0);
+        assign_agent(&a, 8);
+        assign_option(&a, "kitchen", 80.0);
+        assign_option(&a, "workbench", round==2 ? 10.0 : 70.0);
+        assign_solve(&a);
+        if (round==1) ASSERT_EQ_INT(0, a.queue.n);
+        ASSERT_EQ_INT(round==2 ? 1 : 0, assign_choice(&a, 0));
+        ASSERT_EQ_INT(round==2 ? 0 : 1, assign_choice(&a, 1));
+    }
+    /* The warm start follows keys, not positions: the same agents in the other order still keep theirs. */
+    assign_begin(&a);
+    assign_agent(&a, 8);
+    assign_option(&a, "kitchen", 80.0);
+    assign_option(&a, "workbench", 10.0);
+    assign_agent(&a, 7);
+    assign_option(&a, "kitchen", 60.0);
+    assign_option(&a, "workbench", 20.0);
+    assign_solve(&a);
+    ASSERT_EQ_INT(0, a.queue.n);
+    ASSERT_EQ_INT(0, assign_choice(&a, 0));
+    ASSERT_EQ_INT(1, assign_choice(&a, 1));
+    assign_free(&a);
 }
 
 static void test_io_helpers(void) {
@@ -114,7 +555,7 @@ static void test_seed_default_catalog_covers_tasks_file(void) {
 
     line = strtok(tasks, "\n");
     while (line) {
-        char *name = trim_ws(line);
+        char *name = data_row_name(line);
         if (*name) {
             TaskDef *t = cat_find_task(&cat, name);
             seen++;
@@ -134,6 +575,45 @@ static void test_seed_default_catalog_covers_tasks_file(void) {
     free(tasks);
 }
 
+static void test_canonical_tables(void) {
+    /* Generated tables must stay sorted, self-indexed and hash-compatible. */
+    Catalog cat;
+    const char *catalog_src =
+        "taskdef \"Gardening\" { station: greenhouse; }\n"
+        "taskdef \"Gardening\" { station: shed; time: 3; }\n";
+
+    ASSERT_TRUE(kCanonTaskCount >= 40);
+    ASSERT_EQ_INT(CANON_TASK_COUNT, kCanonTaskCount);
+    ASSERT_EQ_INT(CANON_ITEM_COUNT, kCanonItemCount);
+    for (int i = 0; i<kCanonTaskCount; i++) {
+        ASSERT_EQ_INT(i, kCanonTasks[i].id);
+        ASSERT_TRUE(kCanonTasks[i].hash==lb_hash_str(kCanonTasks[i].name));
+        if (i > 0) ASSERT_TRUE(strcmp(kCanonTasks[i-1].name, kCanonTasks[i].name) < 0);
+        ASSERT_TRUE(canon_task_find(kCanonTasks[i].name)==&kCanonTasks[i]);
+    }
+    for (int i = 0; i<kCanonItemCount; i++) {
+        ASSERT_EQ_INT(i, kCanonItems[i].id);
+        ASSERT_TRUE(kCanonItems[i].hash==lb_hash_str(kCanonItems[i].name));
+        if (i > 0) ASSERT_TRUE(strcmp(kCanonItems[i-1].name, kCanonItems[i].name) < 0);
+    }
+    ASSERT_TRUE(canon_task_find("Juggling") == NULL);
+    ASSERT_EQ_INT(CANON_ITEM_OSCILLOSCOPE_CRO, canon_item_find("Oscilloscope (CRO)")->id);
+    ASSERT_TRUE(canon_item_find("Unobtainium") == NULL);
+    ASSERT_TRUE(canon_task_find("Eating")->delta.hunger > 0.0);
+
+    /* Seeded entries borrow table strings; overriding them must not free those. */
+    cat_init(&cat);
+    seed_default_catalog(&cat);
+    ASSERT_EQ_INT(kCanonTaskCount, cat.tasks.n);
+    ASSERT_TRUE(cat_find_task(&cat, "Gardening")->station == kCanonTasks[CANON_TASK_GARDENING].station);
+    ASSERT_EQ_INT(CANON_TASK_GARDENING, cat_find_task(&cat, "Gardening")->canon_id);
+    parse_catalog_text("canon.lbc", catalog_src, &cat);
+    ASSERT_STREQ("shed", cat_find_task(&cat, "Gardening")->station);
+    ASSERT_EQ_INT(3, cat_find_task(&cat, "Gardening")->time_ticks);
+    ASSERT_EQ_INT(kCanonTaskCount, cat.tasks.n);
+    ASSERT_EQ_INT(-1, cat_get_or_add_task(&cat, "Juggling")->canon_id);
+}
+
 static void test_dsl_catalog_covers_data_lists(void) {
     /* Verifies DSL catalog declares every item/task listed in the data text files. */
     char *catalog = read_entire_file("../../dsl/catalog.lbc");
@@ -147,7 +627,7 @@ static void test_dsl_catalog_covers_data_lists(void) {
 
     line = strtok(items, "\n");
     while (line) {
-        char *name = trim_ws(line);
+        char *name = data_row_name(line);
         if (*name) {
             char pat[512];
             snprintf(pat, sizeof(pat), "itemdef \"%s\"", name);
@@ -158,7 +638,7 @@ static void test_dsl_catalog_covers_data_lists(void) {
 
     line = strtok(tasks, "\n");
     while (line) {
-        char *name = trim_ws(line);
+        char *name = data_row_name(line);
         if (*name) {
             char pat[512];
             snprintf(pat, sizeof(pat), "taskdef \"%s\"", name);
@@ -174,10 +654,22 @@ static void test_dsl_catalog_covers_data_lists(void) {
 
 void register_core_tests(void) {
     test_run_case("xalloc helpers", test_xalloc_helpers);
+    test_run_case("sqrt helper", test_sqrt_helper);
     test_run_case("inventory basics", test_inventory_basics);
+    test_run_case("inventory handles", test_inventory_handles);
+    test_run_case("inventory journal", test_inventory_journal);
+    test_run_case("inventory journal bounded", test_inventory_journal_bounded);
+    test_run_case("inventory lots expire", test_inventory_lots_expire);
+    test_run_case("inventory tool instances", test_inventory_tool_instances);
     test_run_case("catalog basics", test_catalog_basics);
     test_run_case("world defaults", test_world_defaults);
+    test_run_case("world copy is independent", test_world_copy_is_independent);
+    test_run_case("streaming stats", test_streaming_stats);
+    test_run_case("steady cycle detection", test_steady_cycle_detection);
+    test_run_case("hydroponic beds", test_hydroponic_beds);
+    test_run_case("station assignment", test_station_assignment);
     test_run_case("io helpers", test_io_helpers);
     test_run_case("default catalog covers tasks file", test_seed_default_catalog_covers_tasks_file);
+    test_run_case("canonical tables", test_canonical_tables);
     test_run_case("dsl catalog covers data lists", test_dsl_catalog_covers_data_lists);
 }
@@ -1,5 +1,8 @@
 #include "test_framework.h"
 #include "test_support.h"
+#include "lb_canon_ids.h"
+
+#include <unistd.h>
 
 static void test_lexer_tokens(void) {
     /* Covers literal/token edge cases, comment skipping, and operator lexing. */
@@ -64,6 +67,7 @@ static void test_parse_world_and_catalog(void) {
         "  shelter { temp_c: 7; signature: 9; power: 12; water_safe: 8; water_raw: 5; structure: 80; contamination: 11; }\n"
         "  inventory { \"Food\": qty 4; \"Rifle\": qty 1, cond 70; }\n"
         "  events { daily \"breach\" chance 12%; overnight_threat_check chance 33%; }\n"
+        "  hydroponics { beds: 12; health: 70; }\n"
         "  constants { DAY_TICKS: 24; }\n"
         "}\n";
     Catalog cat;
@@ -97,6 +101,8 @@ static void test_parse_world_and_catalog(void) {
     ASSERT_EQ_DBL(70.0, inv_cond(&w.inv, "Rifle"), 1e-9);
     ASSERT_EQ_DBL(12.0, w.events.breach_chance, 1e-9);
     ASSERT_EQ_DBL(33.0, w.events.overnight_chance, 1e-9);
+    ASSERT_EQ_INT(12, w.beds.n);
+    ASSERT_EQ_DBL(70.0, w.beds.health[11], 1e-9);
 }
 
 static void test_parse_character_sections(void) {
@@ -240,6 +246,288 @@ static void test_parse_task_optional_clauses(void) {
     ectx_clear(&ctx);
 }
 
+static void test_load_inputs_parallel(void) {
+    /* Concurrent load must match sequential parsing and name the failing file. */
+    char *cat_path = write_temp_file("taskdef \"Custom\" { time: 3t; station: bench; }\n");
+    char *world_path = write_temp_file("world { inventory { \"Food\": qty 6; } }\n");
+    char *a_path = write_temp_file("version 0.1;\ncharacter \"A\" { version 1; }\n");
+    char *b_path = write_temp_file("character \"B\" { version 1; }\n");
+    char *bad_path = write_temp_file("character \"Bad\" {\n  version 1;\n  plan { nonsense }\n}\n");
+    const char *paths[2];
+    LoadRequest rq;
+    Catalog cat;
+    World w;
+    Character chars[2];
+    char err[512];
+    char expect[600];
+
+    ASSERT_TRUE(cat_path && world_path && a_path && b_path && bad_path);
+    memset(&rq, 0, sizeof(rq));
+    rq.catalog_path = cat_path;
+    rq.world_path = world_path;
+    rq.char_paths = paths;
+    rq.n_chars = 2;
+    rq.threads = 4;
+    paths[0] = a_path;
+    paths[1] = b_path;
+
+    ASSERT_EQ_INT(0, load_inputs(&rq, &cat, &w, chars, err, sizeof(err)));
+    ASSERT_EQ_INT(3, cat_find_task(&cat, "Custom")->time_ticks);
+    ASSERT_STREQ("kitchen", cat_find_task(&cat, "Eating")->station);
+    ASSERT_EQ_DBL(6.0, inv_stock(&w.inv, "Food"), 1e-9);
+    ASSERT_STREQ("A", chars[0].name);
+    ASSERT_STREQ("B", chars[1].name);
+
+    paths[0] = bad_path;
+    ASSERT_EQ_INT(-1, load_inputs(&rq, &cat, &w, chars, err, sizeof(err)));
+    snprintf(expect, sizeof(expect), "%s:3: expected block or rule in plan", bad_path);
+    ASSERT_STREQ(expect, err);
+
+    unlink(cat_path);
+    unlink(world_path);
+    unlink(a_path);
+    unlink(b_path);
+    unlink(bad_path);
+    free(cat_path);
+    free(world_path);
+    free(a_path);
+    free(b_path);
+    free(bad_path);
+}
+
+static char *gen_to_string(void (*emit)(FILE *, const GenParams *), const GenParams *p) {
+    /* Round-trips generator output through a temp FILE into a parser buffer. */
+    FILE *f = tmpfile();
+    long n;
+    char *buf;
+    if (!f) return NULL;
+    emit(f, p);
+    n = ftell(f);
+    rewind(f);
+    buf = (char *)xmalloc((size_t)n + 1);
+    buf[fread(buf, 1, (size_t)n, f)] = 0;
+    fclose(f);
+    return buf;
+}
+
+static void test_generator_output_parses(void) {
+    /* Generated inputs must be accepted by the real parsers at the requested sizes. */
+    GenParams p;
+    Catalog cat;
+    World w;
+    Character ch;
+    char *src;
+    char *again;
+    FILE *f;
+    long n;
+    int stocked;
+
+    gen_params_default(&p);
+    p.seed = 77;
+    p.taskdefs = 120;
+    p.itemdefs = 40;
+    p.inventory = 60;
+    p.thresholds = 5;
+    p.blocks = 30;
+    p.rules = 3;
+    p.if_depth = 4;
+    p.lets = 2;
+
+    src = gen_to_string(gen_catalog, &p);
+    ASSERT_TRUE(src != NULL);
+    cat_init(&cat);
+    parse_catalog(&cat, "gen.lbc", src);
+    ASSERT_EQ_INT(120, cat.tasks.n);
+    ASSERT_TRUE(cat_find_task(&cat, "Gen task 00119") != NULL);
+    again = gen_to_string(gen_catalog, &p);
+    ASSERT_STREQ(src, again);
+    free(src);
+    free(again);
+
+    src = gen_to_string(gen_world, &p);
+    ASSERT_TRUE(src != NULL);
+    world_init(&w);
+    parse_world(&w, "gen.lbw", src);
+    /* Canonical items are pre-interned at zero stock; count what the file stocked. */
+    stocked = 0;
+    for (int i = 0; i < w.inv.items.n; i++) if (w.inv.items.v[i].qty > 0.0) stocked++;
+    ASSERT_EQ_INT(60, stocked);
+    free(src);
+
+    f = tmpfile();
+    ASSERT_TRUE(f != NULL);
+    gen_character(f, &p, "Gen", 3);
+    n = ftell(f);
+    rewind(f);
+    src = (char *)xmalloc((size_t)n + 1);
+    src[fread(src, 1, (size_t)n, f)] = 0;
+    fclose(f);
+    {
+        Parser ps;
+        ps_init(&ps, "gen.lbp", src);
+        while (!ps_is_ident(&ps, "character") && !ps_is(&ps, TK_EOF)) lx_next_token(&ps.lx);
+        parse_character(&ps, &ch);
+    }
+    ASSERT_STREQ("Gen", ch.name);
+    ASSERT_EQ_INT(5, ch.thresholds.n);
+    ASSERT_EQ_INT(30, ch.blocks.n);
+    ASSERT_EQ_INT(3, ch.rules.n);
+    ASSERT_EQ_INT(1, ch.on_events.n);
+    free(src);
+}
+
+static void test_lazy_catalog_matches_eager(void) {
+    /* Lazy index + on-demand/parallel body parsing must equal the eager parse. */
+    const char *src =
+        "# comment with taskdef \"Fake\" { time: 9t; }\n"
+        "itemdef \"Food\" { stackable: true; tags: [\"consumable\"]; }\n"
+        "taskdef \"Custom\" {\n  time: 3t; /* } */ station: bench;\n  effects: { morale: +1; };\n}\n"
+        "taskdef \"Eating\" { station: mess; }\n"
+        "taskdef \"Custom\" { time: 5t; }\n";
+    GenParams p;
+    Catalog eager, lazy, par;
+    char *gen;
+    char err[512];
+    TaskDef *t;
+
+    cat_init(&lazy);
+    seed_default_catalog(&lazy);
+    parse_catalog_lazy(&lazy, "lazy.lbc", xstrdup(src));
+    ASSERT_TRUE(cat_find_task(&lazy, "Fake") == NULL);
+    t = &lazy.tasks.v[lazy.tasks.n - 1];
+    ASSERT_STREQ("Custom", t->name);
+    ASSERT_TRUE(t->lazy_head >= 0);
+    t = cat_find_task(&lazy, "Custom");
+    ASSERT_TRUE(t->lazy_head < 0);
+    ASSERT_EQ_INT(5, t->time_ticks);
+    ASSERT_STREQ("bench", t->station);
+    ASSERT_STREQ("mess", cat_find_task(&lazy, "Eating")->station);
+    ASSERT_EQ_INT(1, cat_find_task(&lazy, "Eating")->time_ticks);
+
+    gen_params_default(&p);
+    p.taskdefs = 3000;
+    p.itemdefs = 50;
+    gen = gen_to_string(gen_catalog, &p);
+    cat_init(&eager);
+    parse_catalog(&eager, "gen.lbc", gen);
+    cat_init(&par);
+    parse_catalog_lazy(&par, "gen.lbc", gen);
+    ASSERT_EQ_INT(eager.tasks.n, par.tasks.n);
+    ASSERT_EQ_INT(0, cat_resolve_all(&par, 4, err, sizeof(err)));
+    for (int i = 0; i < eager.tasks.n; i++) {
+        ASSERT_TRUE(par.tasks.v[i].lazy_head < 0);
+        ASSERT_STREQ(eager.tasks.v[i].name, par.tasks.v[i].name);
+        ASSERT_EQ_INT(eager.tasks.v[i].time_ticks, par.tasks.v[i].time_ticks);
+        ASSERT_STREQ(eager.tasks.v[i].station, par.tasks.v[i].station);
+    }
+    ASSERT_EQ_INT(eager.items.items.n, par.items.items.n);
+    ASSERT_EQ_INT(eager.items.n_tags, par.items.n_tags);
+    for (int i = 0; i < eager.items.items.n; i++) {
+        ASSERT_STREQ(eager.items.items.v[i].name, par.items.items.v[i].name);
+        ASSERT_TRUE(eager.items.items.v[i].tags == par.items.items.v[i].tags);
+    }
+
+    cat_init(&par);
+    parse_catalog_lazy(&par, "broken.lbc", xstrdup("taskdef \"A\" { time: 1t; }\ntaskdef \"B\" {\n  time: ;\n}\n"));
+    ASSERT_EQ_INT(-1, cat_resolve_all(&par, 4, err, sizeof(err)));
+    ASSERT_STREQ("broken.lbc:3: expected ticks", err);
+}
+
+static void test_itemdef_registry_and_tag_stock(void) {
+    /* itemdefs feed the registry; tag totals follow every inventory change. */
+    const char *src =
+        "itemdef \"Food\" { stackable: true; tags: [\"consumable\"]; }\n"
+        "itemdef \"Rifle\" { max_condition: 80; stackable: false; tags: [\"weapon\", \"tool\"]; }\n"
+        "itemdef \"Ramen\" { tags: [\"consumable\"]; shelf_life: 90; notes: { a: 1; }; }\n"
+        "itemdef \"Bare\";\n";
+    Catalog cat;
+    World w;
+    Character ch;
+    EvalCtx ctx;
+    char *expr_src = NULL;
+    int rifle;
+
+    cat_init(&cat);
+    seed_default_catalog(&cat);
+    parse_catalog_text("items.lbc", src, &cat);
+    rifle = item_reg_find(&cat.items, "Rifle");
+    ASSERT_TRUE(rifle >= 0);
+    ASSERT_EQ_INT(0, cat.items.items.v[rifle].stackable);
+    ASSERT_EQ_DBL(80.0, cat.items.items.v[rifle].max_condition, 1e-9);
+    ASSERT_TRUE(item_reg_find(&cat.items, "Bare") >= 0);
+    ASSERT_EQ_INT(90, cat.items.items.v[item_reg_find(&cat.items, "Ramen")].shelf_life_days);
+    ASSERT_EQ_INT(3, cat.items.items.v[item_reg_find(&cat.items, "Fish")].shelf_life_days);
+    ASSERT_TRUE(item_reg_find(&cat.items, "Nope") < 0);
+    ASSERT_TRUE(item_reg_tag_id(&cat.items, "edible") >= 0);
+    ASSERT_TRUE(cat.items.items.v[rifle].tags == (((ItemTagSet)1 << item_reg_tag_id(&cat.items, "weapon")) |
+                ((ItemTagSet)1 << item_reg_tag_id(&cat.items, "tool"))));
+
+    /* Stock added before binding is picked up by the bind. */
+    world_init(&w);
+    inv_add(&w.inv, "Food", 2.0, 100.0);
+    ASSERT_EQ_DBL(0.0, inv_stock_tag(&w.inv, "consumable"), 1e-9);
+    inv_bind_registry(&w.inv, &cat.items);
+    inv_add(&w.inv, "Ramen", 1.5, 100.0);
+    inv_add(&w.inv, "Tomato", 4.0, 100.0);
+    inv_add(&w.inv, "Unlisted", 9.0, 100.0);
+    ASSERT_EQ_DBL(3.5, inv_stock_tag(&w.inv, "consumable"), 1e-9);
+    /* Food and Tomato are edible via data/items.txt; the catalog tag merges in. */
+    ASSERT_EQ_DBL(7.5, inv_stock_tag(&w.inv, "edible"), 1e-9);
+    ASSERT_EQ_DBL(2.0, inv_consume(&w.inv, "Food", 5.0), 1e-9);
+    ASSERT_EQ_DBL(1.5, inv_stock_tag(&w.inv, "consumable"), 1e-9);
+    ASSERT_EQ_DBL(0.0, inv_stock_tag(&w.inv, "no-such-tag"), 1e-9);
+
+    character_init(&ch);
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.ch = &ch;
+    ctx.w = &w;
+    ectx_init(&ctx);
+    ASSERT_EQ_DBL(7.0, eval_expr(&ctx, parse_expr_text("tags", "stock_tag(\"consumable\") + stock_tag(\"edible\")", &expr_src)), 1e-9);
+    free(expr_src);
+    ectx_clear(&ctx);
+}
+
+static void test_script_items_bind_to_handles(void) {
+    /* stock()/has()/cond() literals bind once; evaluation then skips the lookup. */
+    const char *ch_src =
+        "character \"Binder\" {\n"
+        "  thresholds { when stock(\"Ammunition\") < 2 do task \"Resting\"; }\n"
+        "  plan { block day 0..24 { if has(\"Rare part\") and cond(\"Rifle\") > 10 { task \"Reading\"; } } }\n"
+        "}\n";
+    Character ch;
+    World w, other;
+    EvalCtx ctx;
+    CallExpr *stock_call;
+    Expr *if_cond;
+
+    parse_character_text("binder", ch_src, &ch);
+    world_init(&w);
+    inv_add(&w.inv, "Ammunition", 5.0, 100.0);
+    character_bind_items(&ch, &w.inv);
+
+    stock_call = &ch.thresholds.v[0].cond->u.bin.a->u.call;
+    ASSERT_EQ_INT(CALL_STOCK, stock_call->builtin);
+    ASSERT_EQ_INT(CANON_ITEM_AMMUNITION, stock_call->item);
+    if_cond = ch.blocks.v[0].stmts.v[0]->u.if_.cond;
+    ASSERT_EQ_INT(CALL_HAS, if_cond->u.bin.a->u.call.builtin);
+    /* Unknown literals are interned at zero stock so they also get a handle. */
+    ASSERT_EQ_INT(inv_lookup(&w.inv, "Rare part"), if_cond->u.bin.a->u.call.item);
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.ch = &ch;
+    ctx.w = &w;
+    ectx_init(&ctx);
+    ASSERT_EQ_DBL(5.0, eval_expr(&ctx, ch.thresholds.v[0].cond->u.bin.a), 1e-9);
+
+    /* A different inventory layout falls back to the name instead of a stale handle. */
+    world_init(&other);
+    inv_add(&other.inv, "Zeta", 1.0, 100.0);
+    inv_add(&other.inv, "Rare part", 7.0, 100.0);
+    ctx.w = &other;
+    ASSERT_EQ_DBL(1.0, eval_expr(&ctx, if_cond->u.bin.a), 1e-9);
+    ectx_clear(&ctx);
+}
+
 void register_parser_eval_tests(void) {
     /* Keep registration order aligned with parser/eval workflow complexity. */
     test_run_case("lexer tokens", test_lexer_tokens);
@@ -247,4 +535,9 @@ void register_parser_eval_tests(void) {
     test_run_case("parse character sections", test_parse_character_sections);
     test_run_case("eval expressions", test_eval_expressions);
     test_run_case("parse task optional clauses", test_parse_task_optional_clauses);
+    test_run_case("load inputs in parallel", test_load_inputs_parallel);
+    test_run_case("generator output parses", test_generator_output_parses);
+    test_run_case("lazy catalog matches eager", test_lazy_catalog_matches_eager);
+    test_run_case("itemdef registry and tag stock", test_itemdef_registry_and_tag_stock);
+    test_run_case("script items bind to handles", test_script_items_bind_to_handles);
 }
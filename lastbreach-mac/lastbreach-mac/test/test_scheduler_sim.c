@@ -1,5 +1,8 @@
 #include "test_framework.h"
 #include "test_support.h"
+#include "lb_canon_ids.h"
+
+#include <unistd.h>
 
 static const char *kSchedCharacterSrc =
     "character \"Sched\" {\n"
@@ -26,6 +29,35 @@ static const char *kEatAtTickZeroSrc =
     "  }\n"
     "}\n";
 
+static const char *kTwoMealsSrc =
+    "character \"Meals\" {\n"
+    "  version 1;\n"
+    "  plan {\n"
+    "    block day 0..24 {\n"
+    "      if tick == 0 or tick == 12 {\n"
+    "        task \"Eating\" for 1t priority 100;\n"
+    "      } else {\n"
+    "        task \"Resting\" for 1t priority 10;\n"
+    "      }\n"
+    "    }\n"
+    "  }\n"
+    "}\n";
+
+/* Same meals, but only while the beans last above a reserve the rule reads. */
+static const char *kGatedMealsSrc =
+    "character \"Gated\" {\n"
+    "  version 1;\n"
+    "  plan {\n"
+    "    block day 0..24 {\n"
+    "      if (tick == 0 or tick == 12) and stock(\"Canned beans\") > 400 {\n"
+    "        task \"Eating\" for 1t priority 100;\n"
+    "      } else {\n"
+    "        task \"Resting\" for 1t priority 10;\n"
+    "      }\n"
+    "    }\n"
+    "  }\n"
+    "}\n";
+
 static const char *kAlwaysRestSrc =
     "character \"B\" {\n"
     "  version 1;\n"
@@ -50,6 +82,42 @@ static const char *kGrowerSrc =
     "  }\n"
     "}\n";
 
+static const char *kShooterSrc =
+    "character \"%s\" {\n"
+    "  version 1;\n"
+    "  plan {\n"
+    "    block day 0..24 {\n"
+    "      if tick == 0 { task \"Defensive shooting\" for 3t priority %d; }\n"
+    "      task \"Reading\" for 1t priority 10;\n"
+    "    }\n"
+    "  }\n"
+    "}\n";
+
+static const char *kRadioSrc =
+    "character \"Radio\" {\n"
+    "  version 1;\n"
+    "  plan {\n"
+    "    block day 0..24 {\n"
+    "      if event(\"supply_drop\") { task \"Reading\" for 1t priority 60; }\n"
+    "      task \"Resting\" for 1t priority 10;\n"
+    "    }\n"
+    "  }\n"
+    "  on \"radio_call\" priority 95 { task \"Talking\" for 1t; }\n"
+    "  on \"breach\" priority 80 { task \"Defensive combat\" for 2t; }\n"
+    "}\n";
+
+static const char *kTunedSrc =
+    "character \"Tuned\" {\n"
+    "  version 1;\n"
+    "  plan {\n"
+    "    block day 0..24 {\n"
+    "      if tick < 4 { task \"Eating\" for 1t priority 30; } # tune 5..60\n"
+    "      task \"Maintenance chores\" for 2t priority 20; // tune 5..60\n"
+    "      task \"Resting\" for 1t priority 25;\n"
+    "    }\n"
+    "  }\n"
+    "}\n";
+
 static void seed_world_and_catalog(World *w, Catalog *cat) {
     /* Neutralize random event pressure so tests remain deterministic. */
     world_init(w);
@@ -163,8 +231,884 @@ static void test_run_sim_hydroponics_produce(void) {
     ASSERT_TRUE(inv_stock(&w.inv, "Plant") > 0.0);
 }
 
+static void test_run_sim_reserves_scarce_inputs(void) {
+    /* One job's worth of ammo: the higher priority shooter gets it, the other re-plans. */
+    World w;
+    Catalog cat;
+    Character a, b;
+    InvJournal jr;
+    Candidate cand;
+    char src[512];
+    int shots = 0;
+
+    snprintf(src, sizeof(src), kShooterSrc, "A", 80);
+    parse_character_text("shooter_a", src, &a);
+    snprintf(src, sizeof(src), kShooterSrc, "B", 90);
+    parse_character_text("shooter_b", src, &b);
+    seed_world_and_catalog(&w, &cat);
+    inv_add(&w.inv, "Ammunition", 3.0, 100.0);
+    inv_bind_registry(&w.inv, &cat.items);
+
+    /* Preflight only counts what is not already held. */
+    ASSERT_EQ_INT(1, ledger_reserve(&w.reserve, &w.inv, cat_find_task(&cat, "Defensive shooting")->inputs, 1));
+    ASSERT_EQ_DBL(1.0, ledger_available(&w.reserve, &w.inv, CANON_ITEM_AMMUNITION), 1e-9);
+    cand = choose_action(&a, &w, &cat, 0, 0, 0, 0, 0);
+    ASSERT_STREQ("Reading", cand.task_name);
+    ledger_release(&w.reserve, cat_find_task(&cat, "Defensive shooting")->inputs, 1);
+    ASSERT_EQ_DBL(3.0, ledger_available(&w.reserve, &w.inv, CANON_ITEM_AMMUNITION), 1e-9);
+
+    inv_journal_init(&jr);
+    w.inv.journal = &jr;
+    srand(5);
+    run_sim_quiet(&w, &cat, &a, &b, 1);
+    for (int i = 0; i < jr.entries.n; i++) shots += jr.entries.v[i].cause==CANON_TASK_DEFENSIVE_SHOOTING;
+    for (int i = 0; i < jr.flows.n; i++) shots += jr.flows.v[i].cause==CANON_TASK_DEFENSIVE_SHOOTING;
+    ASSERT_EQ_INT(1, shots);
+    ASSERT_EQ_DBL(1.0, inv_stock_h(&w.inv, CANON_ITEM_AMMUNITION), 1e-9);
+    ASSERT_EQ_DBL(1.0, ledger_available(&w.reserve, &w.inv, CANON_ITEM_AMMUNITION), 1e-9);
+    inv_journal_free(&jr);
+}
+
+static void test_world_events_dispatch_by_id(void) {
+    /* World-declared events fire from the queue and reach only their own handlers. */
+    const char *world_src =
+        "world \"Events\" {\n"
+        "  events {\n"
+        "    daily \"breach\" chance 0%;\n"
+        "    daily \"radio_call\" chance 100% at 9;\n"
+        "    daily \"dust_storm\" chance 0%;\n"
+        "    once \"supply_drop\" day 0 tick 14;\n"
+        "  }\n"
+        "}\n";
+    World w;
+    Catalog cat;
+    Character ch, rest;
+    Candidate cand;
+    int radio, drop;
+
+    parse_character_text("radio_char", kRadioSrc, &ch);
+    parse_character_text("rest_char", kAlwaysRestSrc, &rest);
+    seed_world_and_catalog(&w, &cat);
+    parse_world_text("events_world", world_src, &w);
+    radio = event_find(&w.events, "radio_call");
+    drop = event_find(&w.events, "supply_drop");
+    ASSERT_EQ_INT(0, event_find(&w.events, "breach"));
+    ASSERT_TRUE(radio > EVENT_OVERNIGHT && drop > EVENT_OVERNIGHT);
+    ASSERT_EQ_INT(2, w.events.daily.n);
+    ASSERT_EQ_INT(9, w.events.daily.v[0].tick);
+
+    event_schedule(&w.events, 0, 9, radio, 0);
+    ASSERT_EQ_INT(0, event_pop_due(&w.events, 0, 8));
+    cand = choose_action(&ch, &w, &cat, 0, 8, 0, 0, 0);
+    ASSERT_STREQ("Resting", cand.task_name);
+
+    ASSERT_EQ_INT(1, event_pop_due(&w.events, 0, 9));
+    ASSERT_EQ_INT(radio, w.events.now.v[0].id);
+    cand = choose_action(&ch, &w, &cat, 0, 9, 0, 0, 0);
+    ASSERT_STREQ("Talking", cand.task_name);
+
+    /* supply_drop has no handler but is visible to event() on its tick only. */
+    ASSERT_EQ_INT(1, event_pop_due(&w.events, 0, 14));
+    ASSERT_EQ_INT(drop, w.events.now.v[0].id);
+    cand = choose_action(&ch, &w, &cat, 0, 14, 0, 0, 0);
+    ASSERT_STREQ("Reading", cand.task_name);
+    ASSERT_EQ_INT(0, event_pop_due(&w.events, 0, 15));
+    cand = choose_action(&ch, &w, &cat, 0, 15, 0, 0, 0);
+    ASSERT_STREQ("Resting", cand.task_name);
+
+    /* Rolled by the sim: radio_call every day at tick 9, overnight at the last tick. */
+    srand(11);
+    run_sim_quiet(&w, &cat, &ch, &rest, 1);
+    ASSERT_EQ_INT(0, w.events.queue.n);
+    ASSERT_EQ_INT(EVENT_OVERNIGHT, w.events.now.v[0].id);
+    events_free(&w.events);
+}
+
+static void build_test_region(Region *r, int threads) {
+    /* Uneven larders so the exchange has something to level. */
+    region_init(r, 99, threads, NULL);
+    for (int i = 0; i<6; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "site-%d", i);
+        RegionSite *s = region_add_site(r, name);
+        seed_default_catalog(&s->cat);
+        s->world.events.breach_chance = 30.0;
+        inv_add(&s->world.inv, "Food", 2.0 + 6.0*i, 100.0);
+        inv_add(&s->world.inv, "Ammunition", (double)(i%3)*4.0, 100.0);
+        parse_character_text("region_a", kSchedCharacterSrc, &s->cast[0]);
+        parse_character_text("region_b", kAlwaysRestSrc, &s->cast[1]);
+    }
+}
+
+static void test_region_independent_of_threads(void) {
+    Region one, many;
+    double in = 0.0, out = 0.0;
+    int trades = 0;
+
+    build_test_region(&one, 1);
+    build_test_region(&many, 4);
+    for (int day = 0; day<3; day++) {
+        RegionExchange ex1, ex4;
+        region_step_day(&one, &ex1);
+        region_step_day(&many, &ex4);
+        ASSERT_EQ_INT(ex1.trades, ex4.trades);
+        ASSERT_EQ_INT(ex1.raids, ex4.raids);
+        trades += ex1.trades;
+    }
+    ASSERT_TRUE(trades > 0);
+    for (int i = 0; i<6; i++) {
+        RegionSite *a = one.sites.v[i], *b = many.sites.v[i];
+        ASSERT_EQ_DBL(inv_stock_h(&a->world.inv, CANON_ITEM_FOOD), inv_stock_h(&b->world.inv, CANON_ITEM_FOOD), 0.0);
+        ASSERT_EQ_DBL(a->world.shelter.structure, b->world.shelter.structure, 0.0);
+        ASSERT_EQ_DBL(a->cast[0].hunger, b->cast[0].hunger, 0.0);
+        ASSERT_EQ_DBL(a->traded_in, b->traded_in, 0.0);
+        in += a->traded_in;
+        out += a->traded_out;
+    }
+    ASSERT_EQ_DBL(in, out, 1e-9);
+    region_free(&one);
+    region_free(&many);
+}
+
+static char *run_with_dlog(DecisionLog *l, double food) {
+    /* Three days with breaches and an eater; the tick log is returned as text. */
+    World w;
+    Catalog cat;
+    Character a, b;
+    FILE *out = tmpfile();
+    seed_world_and_catalog(&w, &cat);
+    w.events.breach_chance = 40.0;
+    w.events.overnight_chance = 50.0;
+    inv_add(&w.inv, "Food", food, 100.0);
+    parse_character_text("replay_a", kSchedCharacterSrc, &a);
+    parse_character_text("replay_b", kAlwaysRestSrc, &b);
+    a.hunger = 45.0;
+    w.own_rng = 1;
+    lb_rng_seed(&w.rng, 7, 0);
+    w.log = out;
+    w.dlog = l;
+    run_sim(&w, &cat, &a, &b, 3);
+
+    long n = ftell(out);
+    char *text = (char*)xmalloc((size_t)n+1);
+    rewind(out);
+    text[fread(text, 1, (size_t)n, out)] = 0;
+    fclose(out);
+    return text;
+}
+
+static void test_replay_matches_recording(void) {
+    DecisionLog rec, play;
+    char err[256];
+    char *path = write_temp_file("");
+    ASSERT_TRUE(path != NULL);
+
+    dlog_init(&rec);
+    char *live = run_with_dlog(&rec, 20.0);
+    ASSERT_EQ_INT(3, rec.days);
+    ASSERT_EQ_INT(3, rec.day_hash.n);
+    ASSERT_TRUE(rec.decisions.n > 0);
+    ASSERT_TRUE(rec.draws.n > 0);
+    ASSERT_EQ_INT(0, dlog_save(&rec, path, err, sizeof(err)));
+
+    /* Round trip through the file, then replay without evaluating rules: same log text. */
+    ASSERT_EQ_INT(0, dlog_load(&play, path, err, sizeof(err)));
+    ASSERT_EQ_INT(rec.decisions.n, play.decisions.n);
+    ASSERT_EQ_INT(rec.draws.n, play.draws.n);
+    ASSERT_EQ_DBL(rec.decisions.v[0].priority, play.decisions.v[0].priority, 0.0);
+    dlog_rewind(&play);
+    char *replayed = run_with_dlog(&play, 20.0);
+    ASSERT_TRUE_MSG(!play.diverged, "diverged: %s", play.div_reason);
+    ASSERT_EQ_INT(play.decisions.n, play.next_decision);
+    ASSERT_STREQ(live, replayed);
+
+    /* A different larder is caught as divergence, not replayed silently. */
+    dlog_rewind(&play);
+    free(run_with_dlog(&play, 0.0));
+    ASSERT_TRUE(play.diverged);
+    ASSERT_TRUE(play.div_day == 0);
+
+    free(live);
+    free(replayed);
+    dlog_free(&rec);
+    dlog_free(&play);
+    unlink(path);
+    free(path);
+}
+
+static void test_sweep_independent_of_threads(void) {
+    /* One parse, a 3x2 grid of copies; rows match for any pool size and follow the axes. */
+    World base;
+    Catalog cat;
+    Character cast[2];
+    Sweep s;
+    SweepRow one[6], many[6];
+    char err[256];
+
+    seed_world_and_catalog(&base, &cat);
+    inv_add(&base.inv, "Food", 4.0, 100.0);
+    parse_character_text("sweep_a", kSchedCharacterSrc, &cast[0]);
+    parse_character_text("sweep_b", kAlwaysRestSrc, &cast[1]);
+    sweep_init(&s);
+    ASSERT_EQ_INT(0, sweep_add_axis(&s, "events.breach_chance=0:60:30", err, sizeof(err)));
+    ASSERT_EQ_INT(0, sweep_add_axis(&s, "inventory.Food=0:10:10", err, sizeof(err)));
+    ASSERT_TRUE(sweep_add_axis(&s, "shelter.power=1:0:1", err, sizeof(err)) != 0);
+    ASSERT_EQ_INT(6, sweep_points(&s));
+    ASSERT_EQ_DBL(30.0, sweep_value(&s, 3, 0), 0.0);
+    ASSERT_EQ_DBL(10.0, sweep_value(&s, 3, 1), 0.0);
+    s.seeds = 3;
+    s.days = 2;
+    s.seed = 5;
+
+    s.threads = 1;
+    ASSERT_EQ_INT(0, sweep_run(&s, &base, &cat, cast, one, err, sizeof(err)));
+    s.threads = 4;
+    ASSERT_EQ_INT(0, sweep_run(&s, &base, &cat, cast, many, err, sizeof(err)));
+    for (int p = 0; p<6; p++) {
+        ASSERT_EQ_DBL(one[p].structure, many[p].structure, 0.0);
+        ASSERT_EQ_DBL(one[p].food, many[p].food, 0.0);
+        ASSERT_EQ_DBL(one[p].hunger, many[p].hunger, 0.0);
+    }
+    /* No breaches at chance 0; the base world itself is never touched. */
+    ASSERT_EQ_DBL(base.shelter.structure, one[0].structure_min, 1e-9);
+    ASSERT_TRUE(one[4].structure < one[0].structure);
+    ASSERT_EQ_DBL(4.0, inv_stock(&base.inv, "Food"), 0.0);
+
+    ASSERT_TRUE(sweep_apply(&base, "inventory.No such thing", 1.0, err, sizeof(err)) != 0);
+    ASSERT_EQ_INT(0, sweep_apply(&base, "shelter.power", 12.0, err, sizeof(err)));
+    ASSERT_EQ_DBL(12.0, base.shelter.power, 0.0);
+    sweep_free(&s);
+    world_free(&base);
+}
+
+static void test_until_stops_run(void) {
+    /* A held condition ends the day at that tick and turns later days into no-ops. */
+    World w;
+    Catalog cat;
+    Character a, b;
+    char err[256];
+
+    ASSERT_TRUE(parse_condition("--until", "shelter.structure <=", err, sizeof(err)) == NULL);
+    ASSERT_TRUE(strstr(err, "--until:1") != NULL);
+    Expr *cond = parse_condition("--until", "day >= 1 and (tick >= 5 or char.hunger < 0)", err, sizeof(err));
+    ASSERT_TRUE(cond != NULL);
+
+    seed_world_and_catalog(&w, &cat);
+    parse_character_text("until_a", kSchedCharacterSrc, &a);
+    parse_character_text("until_b", kAlwaysRestSrc, &b);
+    w.until = cond;
+    w.log = NULL;
+    SimRun *r = sim_begin(&w, &cat, &a, &b);
+    for (int day = 0; day<4; day++) sim_step_day(r);
+    ASSERT_EQ_INT(1, w.stop_day);
+    ASSERT_EQ_INT(5, w.stop_tick);
+    ASSERT_EQ_INT(2, sim_day(r));
+    ASSERT_EQ_INT(1*DAY_TICKS + 5, w.inv.now);
+    sim_end(r);
+
+    /* Checked once per day, it waits for the last tick of the day. */
+    w.until = parse_condition("--until", "char.hunger >= 0 and day == 2", err, sizeof(err));
+    w.until_daily = 1;
+    r = sim_begin(&w, &cat, &a, &b);
+    for (int day = 0; day<4; day++) sim_step_day(r);
+    ASSERT_EQ_INT(2, w.stop_day);
+    ASSERT_EQ_INT(DAY_TICKS-1, w.stop_tick);
+    sim_end(r);
+    world_free(&w);
+}
+
+static void play_routine(World *w, Catalog *cat, Character *a, Character *b, const char *src, Expr *until,
+                         int steady, double breach, int days, int *idle, int *eaten) {
+    seed_world_and_catalog(w, cat);
+    w->events.breach_chance = breach;
+    w->own_rng = 1;
+    lb_rng_seed(&w->rng, 7, 0);
+    inv_add(&w->inv, "Canned beans", 1000.0, 100.0);
+    parse_character_text("steady_a", src, a);
+    parse_character_text("steady_b", kAlwaysRestSrc, b);
+    w->log = NULL;
+    w->until = until;
+    w->steady_period = steady;
+    SimRun *r = sim_begin(w, cat, a, b);
+    sim_play(r, days);
+    if (!until) ASSERT_EQ_INT(days, sim_day(r));
+    *idle = sim_idle_ticks(r, 0) + sim_idle_ticks(r, 1);
+    *eaten = 0;
+    for (int i = 0; i<sim_completed_kinds(r, 0); i++) {
+        int n;
+        if (strcmp(sim_completed_task(r, 0, i, &n), "Eating")==0) *eaten = n;
+    }
+    sim_end(r);
+}
+
+static void test_steady_state_matches_full_run(void) {
+    /* A daily routine settles; extrapolating its cycles must land where the full run does. */
+    World full, fast;
+    Catalog cat_full, cat_fast;
+    Character a1, b1, a2, b2;
+    int idle1, idle2, eaten1, eaten2;
+
+    play_routine(&full, &cat_full, &a1, &b1, kTwoMealsSrc, NULL, 0, 0.0, 300, &idle1, &eaten1);
+    play_routine(&fast, &cat_fast, &a2, &b2, kTwoMealsSrc, NULL, 4, 0.0, 300, &idle2, &eaten2);
+    ASSERT_EQ_INT(0, full.steady_skipped);
+    ASSERT_TRUE(fast.steady_skipped > 100);
+    ASSERT_TRUE(fast.steady_cycle >= 1 && fast.steady_cycle <= 4);
+    ASSERT_EQ_DBL(a1.hunger, a2.hunger, 1e-6);
+    ASSERT_EQ_DBL(a1.hydration, a2.hydration, 1e-6);
+    ASSERT_EQ_DBL(a1.fatigue, a2.fatigue, 1e-6);
+    ASSERT_EQ_DBL(a1.morale, a2.morale, 1e-6);
+    ASSERT_EQ_DBL(b1.hunger, b2.hunger, 1e-6);
+    ASSERT_EQ_DBL(b1.fatigue, b2.fatigue, 1e-6);
+    ASSERT_EQ_DBL(full.shelter.structure, fast.shelter.structure, 1e-6);
+    ASSERT_EQ_DBL(full.shelter.water_safe, fast.shelter.water_safe, 1e-6);
+    ASSERT_EQ_DBL(full.shelter.power, fast.shelter.power, 1e-6);
+    ASSERT_EQ_DBL(inv_stock(&full.inv, "Canned beans"), inv_stock(&fast.inv, "Canned beans"), 1e-6);
+    ASSERT_TRUE(inv_stock(&full.inv, "Canned beans") < 1000.0);
+    ASSERT_EQ_INT(idle1, idle2);
+    ASSERT_EQ_INT(eaten1, eaten2);
+    ASSERT_EQ_INT(full.inv.now, fast.inv.now);
+    world_free(&full);
+    world_free(&fast);
+
+    /* The rule reads the drifting stock: no lap may skip past the day it stops eating. */
+    play_routine(&full, &cat_full, &a1, &b1, kGatedMealsSrc, NULL, 0, 0.0, 600, &idle1, &eaten1);
+    play_routine(&fast, &cat_fast, &a2, &b2, kGatedMealsSrc, NULL, 4, 0.0, 600, &idle2, &eaten2);
+    ASSERT_EQ_DBL(400.0, inv_stock(&full.inv, "Canned beans"), 1.0);
+    ASSERT_EQ_DBL(inv_stock(&full.inv, "Canned beans"), inv_stock(&fast.inv, "Canned beans"), 1e-6);
+    ASSERT_EQ_DBL(a1.hunger, a2.hunger, 1e-6);
+    ASSERT_EQ_INT(idle1, idle2);
+    ASSERT_EQ_INT(eaten1, eaten2);
+    /* Once it has stopped nothing read drifts, so the idle stretch may still be extrapolated. */
+    ASSERT_TRUE(fast.steady_skipped > 0);
+    world_free(&full);
+    world_free(&fast);
+
+    /* --until is never extrapolated past: both runs stop on the same day. */
+    char err[256];
+    Expr *until = parse_condition("--until", "stock(\"Canned beans\") < 500", err, sizeof(err));
+    ASSERT_TRUE(until != NULL);
+    play_routine(&full, &cat_full, &a1, &b1, kTwoMealsSrc, until, 0, 0.0, 600, &idle1, &eaten1);
+    play_routine(&fast, &cat_fast, &a2, &b2, kTwoMealsSrc, until, 4, 0.0, 600, &idle2, &eaten2);
+    ASSERT_TRUE(full.stop_day > 0);
+    ASSERT_EQ_INT(full.stop_day, fast.stop_day);
+    ASSERT_EQ_INT(full.stop_tick, fast.stop_tick);
+    ASSERT_EQ_INT(0, fast.steady_skipped);
+    world_free(&full);
+    world_free(&fast);
+}
+
+static void test_steady_state_refuses_random_days(void) {
+    /* A settled routine under breach rolls must not be extrapolated; both runs play every day alike. */
+    World full, fast;
+    Catalog cat_full, cat_fast;
+    Character a1, b1, a2, b2;
+    int idle1, idle2, eaten1, eaten2;
+
+    play_routine(&full, &cat_full, &a1, &b1, kTwoMealsSrc, NULL, 0, 3.0, 300, &idle1, &eaten1);
+    play_routine(&fast, &cat_fast, &a2, &b2, kTwoMealsSrc, NULL, 4, 3.0, 300, &idle2, &eaten2);
+    ASSERT_EQ_INT(0, fast.steady_skipped);
+    ASSERT_TRUE(full.shelter.structure < 100.0);
+    ASSERT_EQ_DBL(full.shelter.structure, fast.shelter.structure, 1e-9);
+    ASSERT_EQ_DBL(a1.hunger, a2.hunger, 1e-9);
+    ASSERT_EQ_DBL(a1.morale, a2.morale, 1e-9);
+    ASSERT_EQ_DBL(inv_stock(&full.inv, "Canned beans"), inv_stock(&fast.inv, "Canned beans"), 1e-9);
+    ASSERT_EQ_INT(idle1, idle2);
+    ASSERT_EQ_INT(eaten1, eaten2);
+    world_free(&full);
+    world_free(&fast);
+}
+
+static void test_ab_pairs_seeds(void) {
+    /* Same streams for both variants: identical plans differ by exactly 0, different ones less than unpaired. */
+    World base;
+    Catalog cat;
+    Character cast[3], same[2], other[2];
+    AbStats *one = (AbStats*)xmalloc(sizeof(AbStats));
+    AbStats *many = (AbStats*)xmalloc(sizeof(AbStats));
+    char err[256];
+
+    seed_world_and_catalog(&base, &cat);
+    base.events.breach_chance = 60.0;
+    base.events.overnight_chance = 50.0;
+    inv_add(&base.inv, "Food", 20.0, 100.0);
+    parse_character_text("ab_a", kSchedCharacterSrc, &cast[0]);
+    parse_character_text("ab_b", kAlwaysRestSrc, &cast[1]);
+    /* The same survivor eating earlier, and without the fallback chatter. */
+    parse_character_text("ab_c",
+        "character \"Sched\" {\n"
+        "  version 1;\n"
+        "  thresholds { when char.hunger < 70 do task \"Eating\" for 1t priority 90; }\n"
+        "  plan { block day 0..24 { task \"Resting\" for 1t priority 10; } }\n"
+        "  on \"breach\" priority 80 { task \"Defensive combat\" for 2t; }\n"
+        "}\n", &cast[2]);
+    same[0] = cast[0];
+    same[1] = cast[1];
+    other[0] = cast[2];
+    other[1] = cast[1];
+    ASSERT_EQ_INT(0, ab_run(&base, &cat, same, same, 5, 40, 6, 2, one, err, sizeof(err)));
+    ASSERT_TRUE(one->runs == 40);
+    for (int m = 0; m<AB_METRICS; m++) {
+        ASSERT_EQ_DBL(0.0, one->diff[m].min, 0.0);
+        ASSERT_EQ_DBL(0.0, one->diff[m].max, 0.0);
+    }
+    ASSERT_TRUE(stat_var(&one->a[1]) > 0.0);
+
+    ASSERT_EQ_INT(0, ab_run(&base, &cat, same, other, 5, 40, 6, 1, one, err, sizeof(err)));
+    ASSERT_EQ_INT(0, ab_run(&base, &cat, same, other, 5, 40, 6, 4, many, err, sizeof(err)));
+    for (int m = 0; m<AB_METRICS; m++) {
+        ASSERT_EQ_DBL(one->diff[m].mean, many->diff[m].mean, 0.0);
+        ASSERT_EQ_DBL(one->diff[m].m2, many->diff[m].m2, 0.0);
+    }
+    /* Eating earlier shows up as a paired difference in hunger. */
+    ASSERT_TRUE(one->diff[3].mean > 0.0);
+    /* Breach days are shared, so structure differs far less than between independent seeds. */
+    ASSERT_TRUE(stat_var(&one->diff[1]) < 0.5*(stat_var(&one->a[1]) + stat_var(&one->b[1])));
+    ASSERT_STREQ("score", ab_metric_name(0));
+    ASSERT_EQ_DBL(12.706, stat_t975(1), 0.0);
+    ASSERT_EQ_DBL(1.960, stat_t975(100000), 0.0);
+    free(one);
+    free(many);
+    world_free(&base);
+}
+
+static void test_target_ci_sizes_batch(void) {
+    /* Rounds stop once the structure interval is narrow enough, at the same run count for any pool size. */
+    World base;
+    Catalog cat;
+    Character cast[2];
+    BatchStats one, many;
+    VecCiTarget t;
+    char err[256];
+
+    seed_world_and_catalog(&base, &cat);
+    base.events.breach_chance = 50.0;
+    inv_add(&base.inv, "Food", 3.0, 100.0);
+    parse_character_text("ci_a", kSchedCharacterSrc, &cast[0]);
+    parse_character_text("ci_b", kAlwaysRestSrc, &cast[1]);
+    ci_targets_init(&t);
+    ASSERT_TRUE(ci_target_add(&t, "structure=0", err, sizeof(err)) != 0);
+    ASSERT_TRUE(ci_target_add(&t, "structure", err, sizeof(err)) != 0);
+    ASSERT_EQ_INT(0, ci_target_add(&t, "structure=0.1", err, sizeof(err)));
+    ASSERT_EQ_INT(0, ci_target_add(&t, "survival=0.2", err, sizeof(err)));
+
+    bstats_init(&one);
+    bstats_init(&many);
+    ASSERT_EQ_INT(0, batch_run_ci(&base, &cat, cast, 3, 100000, 3, 1, NULL, &t, &one, err, sizeof(err)));
+    ASSERT_TRUE(t.v[0].met && t.v[1].met);
+    ASSERT_TRUE(t.v[0].achieved <= 0.1);
+    ASSERT_EQ_INT(0, batch_run_ci(&base, &cat, cast, 3, 100000, 3, 4, NULL, &t, &many, err, sizeof(err)));
+    ASSERT_TRUE(one.runs == many.runs);
+    /* The first round alone is too wide; the rule asked for more. */
+    ASSERT_TRUE(one.runs > 128 && one.runs < 100000);
+    ASSERT_EQ_INT(one.rows.n, many.rows.n);
+    for (int i = 0; i<one.rows.n; i++) {
+        ASSERT_EQ_DBL(one.rows.v[i].s.mean, many.rows.v[i].s.mean, 0.0);
+        ASSERT_EQ_DBL(one.rows.v[i].s.m2, many.rows.v[i].s.m2, 0.0);
+    }
+    /* The limit wins over the target, and says so. */
+    bstats_free(&one);
+    bstats_init(&one);
+    ASSERT_EQ_INT(0, batch_run_ci(&base, &cat, cast, 3, 40, 3, 2, NULL, &t, &one, err, sizeof(err)));
+    ASSERT_TRUE(one.runs == 40);
+    ASSERT_TRUE(!t.v[0].met);
+    bstats_free(&one);
+    bstats_free(&many);
+    ci_targets_free(&t);
+
+    ci_targets_init(&t);
+    ASSERT_EQ_INT(0, ci_target_add(&t, "no.such.row=1", err, sizeof(err)));
+    bstats_init(&one);
+    ASSERT_TRUE(batch_run_ci(&base, &cat, cast, 3, 100, 3, 1, NULL, &t, &one, err, sizeof(err)) != 0);
+    ASSERT_TRUE(strstr(err, "no.such.row") != NULL);
+    bstats_free(&one);
+    ci_targets_free(&t);
+
+    /* Every run survives: a share of 1 still has an open interval, so one round is not enough. */
+    base.events.breach_chance = 0.0;
+    base.events.overnight_chance = 0.0;
+    ci_targets_init(&t);
+    ASSERT_EQ_INT(0, ci_target_add(&t, "survival=0.02", err, sizeof(err)));
+    bstats_init(&one);
+    ASSERT_EQ_INT(0, batch_run_ci(&base, &cat, cast, 3, 100000, 3, 2, NULL, &t, &one, err, sizeof(err)));
+    for (int i = 0; i<one.rows.n; i++) {
+        if (strcmp(one.rows.v[i].name, "shelter.survived")==0) ASSERT_EQ_DBL(1.0, one.rows.v[i].s.mean, 0.0);
+    }
+    ASSERT_TRUE(t.v[0].met);
+    ASSERT_TRUE(t.v[0].achieved > 0.0 && t.v[0].achieved <= 0.02);
+    ASSERT_TRUE(one.runs > 128);
+    bstats_free(&one);
+    ci_targets_free(&t);
+    world_free(&base);
+}
+
+static char *read_back(FILE *f) {
+    long n = ftell(f);
+    char *text = (char*)xmalloc((size_t)n+1);
+    rewind(f);
+    text[fread(text, 1, (size_t)n, f)] = 0;
+    fclose(f);
+    return text;
+}
+
+static void test_shards_merge_to_one_batch(void) {
+    /* Three shards through files, merged in any order: the single-process table, byte for byte. */
+    World base;
+    Catalog cat;
+    Character cast[2];
+    BatchStats full;
+    Partial parts[3];
+    char *paths[3];
+    char err[256];
+
+    seed_world_and_catalog(&base, &cat);
+    base.events.breach_chance = 40.0;
+    inv_add(&base.inv, "Food", 3.0, 100.0);
+    parse_character_text("shard_a", kSchedCharacterSrc, &cast[0]);
+    parse_character_text("shard_b", kAlwaysRestSrc, &cast[1]);
+    bstats_init(&full);
+    ASSERT_EQ_INT(0, batch_run(&base, &cat, cast, 9, 50, 2, 2, NULL, &full, err, sizeof(err)));
+    FILE *f = tmpfile();
+    fprintf(f, "Batch: %lld runs, seeds %u.., days=%d\n", full.runs, 9u, 2);
+    bstats_print(f, &full);
+    char *want = read_back(f);
+
+    for (int i = 0; i<3; i++) {
+        Partial p;
+        partial_init(&p);
+        ASSERT_EQ_INT(0, batch_run_shard(&base, &cat, cast, 9, 50, 2, 2, NULL, i+1, 3, &p, err, sizeof(err)));
+        p.inputs = 0x1234;
+        p.seed = 9;
+        p.days = 2;
+        p.shard = i+1;
+        p.shards = 3;
+        paths[i] = write_temp_file("");
+        ASSERT_EQ_INT(0, partial_save(&p, paths[i], err, sizeof(err)));
+        partial_free(&p);
+    }
+    for (int i = 0; i<3; i++) ASSERT_TRUE_MSG(partial_load(&parts[i], paths[2-i], err, sizeof(err))==0, "%s", err);
+    f = tmpfile();
+    ASSERT_TRUE_MSG(partial_merge(parts, 3, f, err, sizeof(err))==0, "%s", err);
+    char *got = read_back(f);
+    ASSERT_STREQ(want, got);
+
+    /* A missing shard, or one from another seed, is refused. */
+    f = tmpfile();
+    ASSERT_TRUE(partial_merge(parts, 2, f, err, sizeof(err)) != 0);
+    parts[1].seed = 10;
+    ASSERT_TRUE(partial_merge(parts, 3, f, err, sizeof(err)) != 0);
+    ASSERT_TRUE(strstr(err, "seed") != NULL);
+    fclose(f);
+    int s0, sn;
+    ASSERT_TRUE(shard_parse("4/3", &s0, &sn, err, sizeof(err)) != 0);
+    ASSERT_EQ_INT(0, shard_parse("2/3", &s0, &sn, err, sizeof(err)));
+    ASSERT_EQ_INT(2, s0);
+
+    for (int i = 0; i<3; i++) {
+        partial_free(&parts[i]);
+        unlink(paths[i]);
+        free(paths[i]);
+    }
+    free(want);
+    free(got);
+    bstats_free(&full);
+    world_free(&base);
+}
+
+static void test_cache_reuses_runs(void) {
+    /* A second batch reads every run back and prints the same table; layout and comments do not change the key. */
+    World base;
+    Catalog cat;
+    Character cast[2];
+    BatchStats first, again;
+    char err[256];
+    char *plan = write_temp_file("character \"A\" { version 1; }\n");
+    char *same = write_temp_file("# notes\ncharacter   \"A\"\n{ version 1.0; }\n");
+    char *other = write_temp_file("character \"A\" { version 2; }\n");
+    const char *paths[2];
+    paths[1] = NULL;
+    paths[0] = plan;
+    unsigned long long key = cache_inputs_key(paths, 2, "", 2);
+    paths[0] = same;
+    ASSERT_TRUE(cache_inputs_key(paths, 2, "", 2)==key);
+    ASSERT_TRUE(cache_inputs_key(paths, 2, "", 3)!=key);
+    ASSERT_TRUE(cache_inputs_key(paths, 2, "until=x", 2)!=key);
+    paths[0] = other;
+    ASSERT_TRUE(cache_inputs_key(paths, 2, "", 2)!=key);
+
+    seed_world_and_catalog(&base, &cat);
+    base.events.breach_chance = 40.0;
+    inv_add(&base.inv, "Food", 3.0, 100.0);
+    parse_character_text("cache_a", kSchedCharacterSrc, &cast[0]);
+    parse_character_text("cache_b", kAlwaysRestSrc, &cast[1]);
+    char *path = write_temp_file("");
+    ResultCache *c = cache_open(path, 1LL << 20, key, err, sizeof(err));
+    ASSERT_TRUE_MSG(c != NULL, "%s", err);
+    bstats_init(&first);
+    ASSERT_EQ_INT(0, batch_run(&base, &cat, cast, 9, 30, 2, 2, c, &first, err, sizeof(err)));
+    cache_close(c, NULL);
+    FILE *f = tmpfile();
+    bstats_print(f, &first);
+    char *want = read_back(f);
+
+    c = cache_open(path, 1LL << 20, key, err, sizeof(err));
+    bstats_init(&again);
+    ASSERT_EQ_INT(0, batch_run(&base, &cat, cast, 9, 30, 2, 1, c, &again, err, sizeof(err)));
+    f = tmpfile();
+    cache_close(c, f);
+    char *report = read_back(f);
+    ASSERT_TRUE_MSG(strstr(report, "30 runs reused, 0 stored") != NULL, "%s", report);
+    f = tmpfile();
+    bstats_print(f, &again);
+    char *got = read_back(f);
+    ASSERT_STREQ(want, got);
+
+    /* Over the limit, the entries used least recently go first. */
+    unlink(path);
+    c = cache_open(path, 1LL << 20, key, err, sizeof(err));
+    cache_put(c, "a", "x");
+    cache_put(c, "b", "x");
+    cache_put(c, "c", "x");
+    cache_close(c, NULL);
+    c = cache_open(path, 2*40, key, err, sizeof(err));
+    free(cache_get(c, "c"));
+    cache_close(c, NULL);
+    c = cache_open(path, 1LL << 20, key, err, sizeof(err));
+    char *kept = cache_get(c, "c");
+    ASSERT_TRUE(kept != NULL && strcmp(kept, "x")==0);
+    int left = 0;
+    for (int i = 0; i<2; i++) {
+        char *e = cache_get(c, i==0 ? "a" : "b");
+        left += e != NULL;
+        free(e);
+    }
+    ASSERT_EQ_INT(1, left);
+    cache_close(c, NULL);
+
+    /* A long run keeps the file near the limit while it is still open, not only at close. */
+    unlink(path);
+    c = cache_open(path, 4*40, key, err, sizeof(err));
+    for (int i = 0; i<50; i++) {
+        char what[16];
+        snprintf(what, sizeof(what), "run%d", i);
+        cache_put(c, what, "x");
+        char *text = read_entire_file(path);
+        ASSERT_TRUE(text != NULL && (long long)strlen(text) <= 4*40);
+        free(text);
+    }
+    char *last = cache_get(c, "run49");
+    ASSERT_TRUE(last != NULL);
+    free(last);
+    cache_close(c, NULL);
+
+    free(kept);
+    free(report);
+    free(want);
+    free(got);
+    bstats_free(&first);
+    bstats_free(&again);
+    world_free(&base);
+    char *tmp[4];
+    tmp[0] = path;
+    tmp[1] = plan;
+    tmp[2] = same;
+    tmp[3] = other;
+    for (int i = 0; i<4; i++) {
+        unlink(tmp[i]);
+        free(tmp[i]);
+    }
+}
+
+static double plain_collapse_rate(World *base, Catalog *cat, Character *cast, int runs, int days) {
+    /* Plain Monte Carlo on the same day-end check the splitting uses. */
+    int fell = 0;
+    for (int k = 0; k<runs; k++) {
+        World w;
+        Character a, b;
+        world_copy(&w, base);
+        w.own_rng = 1;
+        lb_rng_seed(&w.rng, 77, (unsigned long long)k);
+        character_copy(&a, &cast[0]);
+        character_copy(&b, &cast[1]);
+        SimRun *r = sim_begin(&w, cat, &a, &b);
+        for (int d = 0; d<days && w.shelter.structure > 0.0; d++) sim_step_day(r);
+        if (w.shelter.structure <= 0.0) fell++;
+        sim_end(r);
+        character_copy_free(&a);
+        character_copy_free(&b);
+        world_free(&w);
+    }
+    return (double)fell / runs;
+}
+
+static void test_split_matches_plain_runs(void) {
+    /* Undefended breaches on a weak shelter: collapse is common enough to count directly. */
+    World base;
+    Catalog cat;
+    Character cast[2];
+    Split s;
+    SplitResult one, many;
+    char err[256];
+
+    seed_world_and_catalog(&base, &cat);
+    base.events.breach_chance = 40.0;
+    base.shelter.structure = 40.0;
+    base.log = NULL;
+    parse_character_text("split_a", kAlwaysRestSrc, &cast[0]);
+    parse_character_text("split_b", kAlwaysRestSrc, &cast[1]);
+    split_init(&s);
+    ASSERT_TRUE(split_parse_levels(&s, "30,10,20", err, sizeof(err)) != 0);
+    ASSERT_TRUE(split_parse_levels(&s, "30,x", err, sizeof(err)) != 0);
+    ASSERT_EQ_INT(0, split_parse_levels(&s, "30,20,10", err, sizeof(err)));
+    ASSERT_EQ_INT(3, s.levels.n);
+    s.effort = 60;
+    s.reps = 8;
+    s.days = 6;
+    s.seed = 3;
+
+    s.threads = 1;
+    ASSERT_EQ_INT(0, split_run(&s, &base, &cat, cast, &one, err, sizeof(err)));
+    s.threads = 3;
+    ASSERT_EQ_INT(0, split_run(&s, &base, &cat, cast, &many, err, sizeof(err)));
+    ASSERT_EQ_DBL(one.p, many.p, 0.0);
+    ASSERT_EQ_DBL(one.var, many.var, 0.0);
+    ASSERT_TRUE(one.days_simulated == many.days_simulated);
+    ASSERT_EQ_INT(4, one.stages);
+
+    double p = plain_collapse_rate(&base, &cat, cast, 1500, s.days);
+    double se = one.var + p*(1.0-p)/1500;
+    ASSERT_TRUE(p > 0.02 && p < 0.5);
+    ASSERT_TRUE_MSG((one.p-p)*(one.p-p) < 16.0*se, "split %g vs plain %g", one.p, p);
+    /* The base world is only ever copied. */
+    ASSERT_EQ_DBL(40.0, base.shelter.structure, 0.0);
+    split_result_free(&one);
+    split_result_free(&many);
+    split_free(&s);
+    world_free(&base);
+}
+
+static void test_batch_stats_independent_of_threads(void) {
+    /* 50 runs streamed through chunked accumulators: the same table for any pool size. */
+    World base;
+    Catalog cat;
+    Character cast[2];
+    BatchStats one, many;
+    char err[256];
+
+    seed_world_and_catalog(&base, &cat);
+    base.events.breach_chance = 40.0;
+    inv_add(&base.inv, "Food", 3.0, 100.0);
+    parse_character_text("batch_a", kSchedCharacterSrc, &cast[0]);
+    parse_character_text("batch_b", kAlwaysRestSrc, &cast[1]);
+    bstats_init(&one);
+    bstats_init(&many);
+    ASSERT_EQ_INT(0, batch_run(&base, &cat, cast, 9, 50, 2, 1, NULL, &one, err, sizeof(err)));
+    ASSERT_EQ_INT(0, batch_run(&base, &cat, cast, 9, 50, 2, 4, NULL, &many, err, sizeof(err)));
+    ASSERT_TRUE(one.runs == 50);
+    ASSERT_EQ_INT(one.rows.n, many.rows.n);
+    int eating = -1;
+    for (int i = 0; i<one.rows.n; i++) {
+        StreamStat *x = &one.rows.v[i].s, *y = &many.rows.v[i].s;
+        ASSERT_STREQ(one.rows.v[i].name, many.rows.v[i].name);
+        ASSERT_TRUE(x->n == 50);
+        ASSERT_EQ_DBL(x->mean, y->mean, 0.0);
+        ASSERT_EQ_DBL(stat_quantile(x, 0.5), stat_quantile(y, 0.5), 0.0);
+        if (strcmp(one.rows.v[i].name, "done.Eating")==0) eating = i;
+    }
+    /* Sched eats below hunger 50, so two days of runs always include meals. */
+    ASSERT_TRUE(eating >= 0);
+    ASSERT_TRUE(one.rows.v[eating].s.min >= 1.0);
+    ASSERT_STREQ("Sched.hunger", one.rows.v[0].name);
+    bstats_free(&one);
+    bstats_free(&many);
+    world_free(&base);
+}
+
+static void run_test_tune(Tune *t, World *base, Catalog *cat, double *best, double *score) {
+    /* A fresh pair of scripts per candidate, as main parses them. */
+    Character casts[8];
+    char err[256];
+    for (int c = 0; c<8; c += 2) {
+        parse_character_text("tune_a", kTunedSrc, &casts[c]);
+        parse_character_text("tune_b", kAlwaysRestSrc, &casts[c+1]);
+    }
+    ASSERT_TRUE_MSG(tune_run(t, base, cat, casts, best, score, err, sizeof(err))==0, "%s", err);
+    /* Candidate scripts are handed back with the priorities they were parsed with. */
+    ASSERT_EQ_DBL(30.0, casts[6].blocks.v[0].stmts.v[0]->u.if_.then_stmts.v[0]->u.task.priority->u.num, 0.0);
+}
+
+static void test_tune_independent_of_threads(void) {
+    World base;
+    Catalog cat;
+    Tune t;
+    double one[2], many[2], first[2];
+    double s_one, s_many, s_first;
+    char err[256];
+
+    seed_world_and_catalog(&base, &cat);
+    base.events.breach_chance = 40.0;
+    base.shelter.structure = 60.0;
+    inv_add(&base.inv, "Food", 6.0, 100.0);
+    tune_init(&t);
+    ASSERT_EQ_INT(0, tune_scan_annotations(&t, 0, "tuned.lbp", kTunedSrc, err, sizeof(err)));
+    ASSERT_EQ_INT(2, t.params.n);
+    ASSERT_EQ_INT(5, t.params.v[0].line);
+    ASSERT_EQ_DBL(60.0, t.params.v[1].hi, 0.0);
+    ASSERT_TRUE(tune_scan_annotations(&t, 1, "bad.lbp", "task \"X\" priority 1; # tune 9..3\n", err, sizeof(err)) != 0);
+    t.population = 4;
+    t.seeds = 2;
+    t.days = 2;
+    t.seed = 11;
+
+    t.generations = 1;
+    run_test_tune(&t, &base, &cat, first, &s_first);
+    t.generations = 4;
+    t.threads = 1;
+    run_test_tune(&t, &base, &cat, one, &s_one);
+    t.threads = 3;
+    run_test_tune(&t, &base, &cat, many, &s_many);
+    ASSERT_EQ_DBL(s_one, s_many, 0.0);
+    ASSERT_EQ_DBL(one[0], many[0], 0.0);
+    ASSERT_EQ_DBL(one[1], many[1], 0.0);
+    /* Elitism: later generations never lose the best of the first. */
+    ASSERT_TRUE(s_one >= s_first);
+    ASSERT_TRUE(one[0] >= 5.0 && one[0] <= 60.0);
+    ASSERT_EQ_DBL(30.0, t.params.v[0].start, 0.0);
+
+    /* The emitted plan carries the tuned literals and nothing else changes. */
+    FILE *f = tmpfile();
+    double x[2] = {42.5, 7.0};
+    tune_write_plan(f, &t, 0, kTunedSrc, x);
+    long n = ftell(f);
+    char *text = (char*)xmalloc((size_t)n+1);
+    rewind(f);
+    text[fread(text, 1, (size_t)n, f)] = 0;
+    fclose(f);
+    ASSERT_TRUE(strstr(text, "for 1t priority 42.5; } # tune 5..60\n") != NULL);
+    ASSERT_TRUE(strstr(text, "for 2t priority 7; // tune") != NULL);
+    ASSERT_TRUE(strstr(text, "\"Resting\" for 1t priority 25;") != NULL);
+    ASSERT_EQ_INT((int)strlen(kTunedSrc) + 1, (int)strlen(text));
+    free(text);
+    tune_free(&t);
+    world_free(&base);
+}
+
 void register_scheduler_sim_tests(void) {
     test_run_case("scheduler precedence", test_choose_action_precedence);
     test_run_case("sim cooked-food bonus", test_run_sim_cooked_food_bonus);
     test_run_case("sim hydroponics produce", test_run_sim_hydroponics_produce);
+    test_run_case("sim reserves scarce inputs", test_run_sim_reserves_scarce_inputs);
+    test_run_case("world events dispatch by id", test_world_events_dispatch_by_id);
+    test_run_case("region independent of threads", test_region_independent_of_threads);
+    test_run_case("replay matches recording", test_replay_matches_recording);
+    test_run_case("sweep independent of threads", test_sweep_independent_of_threads);
+    test_run_case("until stops run", test_until_stops_run);
+    test_run_case("steady state matches full run", test_steady_state_matches_full_run);
+    test_run_case("steady state refuses random days", test_steady_state_refuses_random_days);
+    test_run_case("ab pairs seeds", test_ab_pairs_seeds);
+    test_run_case("split matches plain runs", test_split_matches_plain_runs);
+    test_run_case("batch stats independent of threads", test_batch_stats_independent_of_threads);
+    test_run_case("target ci sizes batch", test_target_ci_sizes_batch);
+    test_run_case("shards merge to one batch", test_shards_merge_to_one_batch);
+    test_run_case("cache reuses runs", test_cache_reuses_runs);
+    test_run_case("tune independent of threads", test_tune_independent_of_threads);
 }
@@ -1,3 +1,4 @@
+#define _POSIX_C_SOURCE 200809L
 #include "test_support.h"
 
 #include <ctype.h>
@@ -65,6 +66,29 @@ char *trim_ws(char *s) {
     return s;
 }
 
+char *data_row_name(char *line) {
+    /* Rows of the data .txt files are "name | columns..."; '#' lines are comments. */
+    char *bar = strchr(line, '|');
+    if (bar) *bar = '\0';
+    line = trim_ws(line);
+    return (*line=='#') ? line+strlen(line) : line;
+}
+
+char *write_temp_file(const char *payload) {
+    /* Returns a heap-allocated path; callers unlink() and free() it. */
+    char path[] = "/tmp/lastbreach_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return NULL;
+    size_t n = strlen(payload);
+    if (write(fd, payload, n) != (ssize_t)n) {
+        close(fd);
+        unlink(path);
+        return NULL;
+    }
+    close(fd);
+    return xstrdup(path);
+}
+
 double produce_total(World *w) {
     return inv_stock(&w->inv, "Tomato")
            + inv_stock(&w->inv, "Green bean")
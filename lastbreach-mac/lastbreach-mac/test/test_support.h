@@ -12,6 +12,8 @@ void parse_catalog_text(const char *filename, const char *src, Catalog *out);
 Expr *parse_expr_text(const char *filename, const char *src, char **storage);
 void run_sim_quiet(World *w, Catalog *cat, Character *a, Character *b, int days);
 char *trim_ws(char *s);
+char *data_row_name(char *line);
+char *write_temp_file(const char *payload);
 double produce_total(World *w);
 
 #endif
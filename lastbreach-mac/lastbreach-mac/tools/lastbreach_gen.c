@@ -0,0 +1,116 @@
+#define _POSIX_C_SOURCE 200809L
+#include "lastbreach.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+/**
+ * lastbreach_gen.c
+ *
+ * Module: Command-line front end for the synthetic scenario generator.
+ *
+ * Produces the standard inputs for lexer, parser, scheduler and simulation
+ * scaling curves. Output is a pure function of the options and --seed.
+ */
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: lastbreach-gen <catalog|world|character|scenario> [options]\n"
+            "  catalog    [--tasks N] [--items N] [--stations N]\n"
+            "  world      [--inventory N]\n"
+            "  character  [--name S] [--index N] [--thresholds N] [--blocks N] [--rules N]\n"
+            "             [--on-events N] [--stmts N] [--depth N] [--lets N]\n"
+            "  scenario   --out DIR [--survivors N] plus any option above\n"
+            "common: [--seed N] [-o FILE]  (single-file kinds write to stdout by default)\n"
+           );
+    exit(2);
+}
+
+static int parse_count(const char *s) {
+    char *end = NULL;
+    long v = strtol(s, &end, 10);
+    if (!end || *end || v < 0 || v > 100000000L) dief("invalid count: %s", s);
+    return (int)v;
+}
+
+static FILE *open_out(const char *path) {
+    if (!path) return stdout;
+    FILE *f = fopen(path, "wb");
+    if (!f) dief("failed to open %s for writing", path);
+    return f;
+}
+
+static void close_out(FILE *f) {
+    if (f != stdout && fclose(f) != 0) dief("failed to write output");
+}
+
+static void write_scenario(const char *dir, const GenParams *p, int survivors) {
+    char path[1024];
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) dief("failed to create directory: %s", dir);
+
+    snprintf(path, sizeof(path), "%s/catalog.lbc", dir);
+    FILE *f = open_out(path);
+    gen_catalog(f, p);
+    close_out(f);
+
+    snprintf(path, sizeof(path), "%s/world.lbw", dir);
+    f = open_out(path);
+    gen_world(f, p);
+    close_out(f);
+
+    for (int i = 0; i<survivors; i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "Survivor %03d", i);
+        snprintf(path, sizeof(path), "%s/survivor_%03d.lbp", dir, i);
+        f = open_out(path);
+        gen_character(f, p, name, i);
+        close_out(f);
+    }
+}
+
+/** main function. */
+int main(int argc, char **argv) {
+    if (argc < 2) usage();
+    const char *kind = argv[1];
+    const char *out_path = NULL;
+    const char *name = "Generated";
+    int index = 0;
+    int survivors = 2;
+    GenParams p;
+    gen_params_default(&p);
+
+    for (int i = 2; i<argc; i++) {
+        if (i+1 >= argc) usage();
+        const char *opt = argv[i];
+        const char *val = argv[++i];
+        if (strcmp(opt, "--seed")==0) p.seed = strtoull(val, NULL, 10);
+        else if (strcmp(opt, "-o")==0 || strcmp(opt, "--out")==0) out_path = val;
+        else if (strcmp(opt, "--tasks")==0) p.taskdefs = parse_count(val);
+        else if (strcmp(opt, "--items")==0) p.itemdefs = parse_count(val);
+        else if (strcmp(opt, "--stations")==0) p.stations = parse_count(val);
+        else if (strcmp(opt, "--inventory")==0) p.inventory = parse_count(val);
+        else if (strcmp(opt, "--thresholds")==0) p.thresholds = parse_count(val);
+        else if (strcmp(opt, "--blocks")==0) p.blocks = parse_count(val);
+        else if (strcmp(opt, "--rules")==0) p.rules = parse_count(val);
+        else if (strcmp(opt, "--on-events")==0) p.on_events = parse_count(val);
+        else if (strcmp(opt, "--stmts")==0) p.stmts = parse_count(val);
+        else if (strcmp(opt, "--depth")==0) p.if_depth = parse_count(val);
+        else if (strcmp(opt, "--lets")==0) p.lets = parse_count(val);
+        else if (strcmp(opt, "--name")==0) name = val;
+        else if (strcmp(opt, "--index")==0) index = parse_count(val);
+        else if (strcmp(opt, "--survivors")==0) survivors = parse_count(val);
+        else usage();
+    }
+
+    if (strcmp(kind, "scenario")==0) {
+        if (!out_path) usage();
+        write_scenario(out_path, &p, survivors);
+        return 0;
+    }
+    FILE *f = open_out(out_path);
+    if (strcmp(kind, "catalog")==0) gen_catalog(f, &p);
+    else if (strcmp(kind, "world")==0) gen_world(f, &p);
+    else if (strcmp(kind, "character")==0) gen_character(f, &p, name, index);
+    else usage();
+    close_out(f);
+    return 0;
+}
@@ -0,0 +1,32 @@
+#include "lastbreach.h"
+/**
+ * lastbreach_merge.c
+ *
+ * Module: Command-line front end that combines --shard partial results.
+ *
+ * Prints what the unsharded batch or sweep would have printed, or refuses
+ * when the files are not every shard of one run.
+ */
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: lastbreach-merge <part.lbr> [part.lbr ...]\n"
+            "  combines the files written by `lastbreach ... --shard i/n`, one per shard in any\n"
+            "  order, and prints the batch table or sweep CSV of the whole run\n"
+           );
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) usage();
+    int n = argc-1;
+    Partial *parts = (Partial*)xmalloc(sizeof(Partial)*(size_t)n);
+    char err[512];
+    for (int i = 0; i<n; i++) {
+        if (partial_load(&parts[i], argv[i+1], err, sizeof(err))!=0) dief("%s", err);
+    }
+    if (partial_merge(parts, n, stdout, err, sizeof(err))!=0) dief("lastbreach-merge: %s", err);
+    for (int i = 0; i<n; i++) partial_free(&parts[i]);
+    free(parts);
+    return 0;
+}
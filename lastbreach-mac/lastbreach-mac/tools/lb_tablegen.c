@@ -0,0 +1,362 @@
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/**
+ * lb_tablegen.c
+ *
+ * Module: Build-time generator for the canonical task and item tables.
+ *
+ * Reads data/tasks.txt ("name | ticks | station | deltas | inputs") and data/items.txt
+ * ("name | tags | shelf life days") and writes src/lb_canon_tables.c and
+ * src/lb_canon_ids.h. The data files are the single source of truth: the default
+ * catalog, the per-task delta table and the effect switch in lb_sim.c are all
+ * keyed off the generated ids. This tool is built before the runner, so it
+ * cannot use the runner's helpers and keeps its own (identical) FNV-1a hash.
+ *
+ * Usage: lb_tablegen TASKS.txt ITEMS.txt OUT.c OUT.h
+ */
+
+#define MAX_ROWS 4096
+#define MAX_LINE 1024
+#define MAX_INPUTS 8
+
+static const char *kDeltaFields[] = {
+    "hunger", "hydration", "morale", "injury", "illness", "temp_c",
+    "power", "water_safe", "water_raw", "structure", "contamination", "signature"
+};
+#define N_DELTA ((int)(sizeof(kDeltaFields)/sizeof(kDeltaFields[0])))
+
+typedef struct {
+    char *name;
+    unsigned int hash;
+    int ticks;
+    char *station;
+    char *delta[N_DELTA]; /* literal text from the data file, or NULL for 0 */
+    char *input_item[MAX_INPUTS]; /* tasks: required inputs, resolved after items are sorted */
+    char *input_qty[MAX_INPUTS];
+    int n_inputs;
+    int line;
+    unsigned long long tags; /* items: bits index g_tags */
+    int shelf_days;          /* items: 0 = never expires */
+} Row;
+
+#define MAX_TAGS 64
+static char *g_tags[MAX_TAGS];
+static int g_ntags;
+
+static const char *g_path;
+static int g_line;
+
+static void die(const char *fmt, ...) {
+    va_list ap;
+    fprintf(stderr, "lb_tablegen: ");
+    if (g_path) fprintf(stderr, "%s:%d: ", g_path, g_line);
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    exit(1);
+}
+
+static char *dup_str(const char *s) {
+    size_t n = strlen(s)+1;
+    char *p = (char*)malloc(n);
+    if (!p) die("out of memory");
+    memcpy(p, s, n);
+    return p;
+}
+
+/* Must match lb_hash_str() in lb_common.c; test_core checks they agree. */
+static unsigned int hash_str(const char *s) {
+    unsigned int h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char*)s; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static char *trim(char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    char *e = s+strlen(s);
+    while (e > s && isspace((unsigned char)e[-1])) *--e = 0;
+    return s;
+}
+
+/* Splits the next '|' field off *cursor; the last field consumes the rest. */
+static char *next_field(char **cursor) {
+    char *s = *cursor;
+    if (!s) return NULL;
+    char *bar = strchr(s, '|');
+    if (bar) {
+        *bar = 0;
+        *cursor = bar+1;
+    } else {
+        *cursor = NULL;
+    }
+    return trim(s);
+}
+
+static void parse_deltas(Row *r, char *s) {
+    for (char *tok = strtok(s, " \t"); tok; tok = strtok(NULL, " \t")) {
+        char *eq = strchr(tok, '=');
+        if (!eq) die("expected key=value delta, got '%s'", tok);
+        *eq = 0;
+        int k = 0;
+        while (k<N_DELTA && strcmp(kDeltaFields[k], tok)!=0) k++;
+        if (k==N_DELTA) die("unknown delta field '%s'", tok);
+        char *end = NULL;
+        (void)strtod(eq+1, &end);
+        if (end==eq+1 || *end) die("bad number for %s: '%s'", tok, eq+1);
+        /* Keep the literal so the generated doubles match the source text exactly. */
+        r->delta[k] = dup_str(eq+1);
+    }
+}
+
+/* "Solder wire=0.2, Fish=1": item names may contain spaces, so entries split on ','. */
+static void parse_inputs(Row *r, char *s) {
+    for (char *tok = strtok(s, ","); tok; tok = strtok(NULL, ",")) {
+        char *eq = strchr(tok, '=');
+        if (!eq) die("expected Item=qty input, got '%s'", tok);
+        *eq = 0;
+        if (r->n_inputs==MAX_INPUTS) die("more than %d inputs for %s", MAX_INPUTS, r->name);
+        char *qty = trim(eq+1);
+        char *end = NULL;
+        if (strtod(qty, &end) <= 0.0 || *end) die("bad input quantity for %s: '%s'", r->name, qty);
+        r->input_item[r->n_inputs] = dup_str(trim(tok));
+        r->input_qty[r->n_inputs] = dup_str(qty);
+        r->n_inputs++;
+    }
+}
+
+static void parse_tags(Row *r, char *s) {
+    for (char *tok = strtok(s, " \t"); tok; tok = strtok(NULL, " \t")) {
+        int k = 0;
+        /* Tag ids follow first appearance in the file. */
+        while (k<g_ntags && strcmp(g_tags[k], tok)!=0) k++;
+        if (k==g_ntags) {
+            if (g_ntags==MAX_TAGS) die("more than %d distinct item tags", MAX_TAGS);
+            g_tags[g_ntags++] = dup_str(tok);
+        }
+        r->tags |= 1ull<<k;
+    }
+}
+
+static int read_rows(const char *path, Row *rows, int with_columns) {
+    FILE *f = fopen(path, "rb");
+    char buf[MAX_LINE];
+    int n = 0;
+    if (!f) {
+        fprintf(stderr, "lb_tablegen: cannot open %s\n", path);
+        exit(1);
+    }
+    g_path = path;
+    g_line = 0;
+    while (fgets(buf, sizeof(buf), f)) {
+        g_line++;
+        char *cursor = buf;
+        char *name = next_field(&cursor);
+        if (!*name || *name=='#') continue;
+        if (n==MAX_ROWS) die("too many rows");
+        Row *r = &rows[n++];
+        memset(r, 0, sizeof(*r));
+        r->name = dup_str(name);
+        r->hash = hash_str(name);
+        r->line = g_line;
+        if (!with_columns) {
+            char *tags = next_field(&cursor);
+            char *shelf = next_field(&cursor);
+            if (tags) parse_tags(r, tags);
+            if (shelf && *shelf) {
+                char *end = NULL;
+                long days = strtol(shelf, &end, 10);
+                if (*end || days <= 0) die("shelf life must be a positive day count for %s", name);
+                r->shelf_days = (int)days;
+            }
+            continue;
+        }
+
+        char *ticks = next_field(&cursor);
+        char *station = next_field(&cursor);
+        char *deltas = next_field(&cursor);
+        char *inputs = next_field(&cursor);
+        if (!ticks || !station) die("expected 'name | ticks | station | deltas | inputs'");
+        r->ticks = atoi(ticks);
+        if (r->ticks <= 0) die("ticks must be positive for %s", name);
+        r->station = *station ? dup_str(station) : NULL;
+        if (deltas) parse_deltas(r, deltas);
+        if (inputs && *inputs) parse_inputs(r, inputs);
+    }
+    fclose(f);
+    g_path = NULL;
+    return n;
+}
+
+static int cmp_row(const void *a, const void *b) {
+    return strcmp(((const Row*)a)->name, ((const Row*)b)->name);
+}
+
+static void sort_unique(Row *rows, int n, const char *what) {
+    qsort(rows, (size_t)n, sizeof(*rows), cmp_row);
+    for (int i = 1; i<n; i++) {
+        if (strcmp(rows[i-1].name, rows[i].name)==0) die("duplicate %s: %s", what, rows[i].name);
+    }
+}
+
+static int find_row(const Row *rows, int n, const char *name) {
+    int lo = 0, hi = n-1;
+    while (lo <= hi) {
+        int mid = (lo+hi)/2;
+        int c = strcmp(rows[mid].name, name);
+        if (c==0) return mid;
+        if (c < 0) lo = mid+1;
+        else hi = mid-1;
+    }
+    return -1;
+}
+
+static void put_cstr(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s=='"' || *s=='\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+/* "Oscilloscope (CRO)" -> OSCILLOSCOPE_CRO */
+static void put_enum(FILE *out, const char *prefix, const char *name) {
+    int pending_sep = 0;
+    fputs(prefix, out);
+    for (const char *p = name; *p; p++) {
+        if (isalnum((unsigned char)*p)) {
+            if (pending_sep) fputc('_', out);
+            pending_sep = 0;
+            fputc(toupper((unsigned char)*p), out);
+        } else {
+            pending_sep = 1;
+        }
+    }
+}
+
+static void write_header(FILE *out, const Row *tasks, int nt, const Row *items, int ni) {
+    fprintf(out,
+            "/* Generated by tools/lb_tablegen.c from data/tasks.txt and data/items.txt. Do not edit. */\n"
+            "#ifndef LB_CANON_IDS_H\n"
+            "#define LB_CANON_IDS_H\n\n"
+            "/* Ids index kCanonTasks / kCanonItems, which are sorted by name. */\n"
+            "enum {\n");
+    for (int i = 0; i<nt; i++) {
+        fputs("    ", out);
+        put_enum(out, "CANON_TASK_", tasks[i].name);
+        fprintf(out, " = %d,\n", i);
+    }
+    fprintf(out, "    CANON_TASK_COUNT = %d\n};\n\nenum {\n", nt);
+    for (int i = 0; i<ni; i++) {
+        fputs("    ", out);
+        put_enum(out, "CANON_ITEM_", items[i].name);
+        fprintf(out, " = %d,\n", i);
+    }
+    fprintf(out, "    CANON_ITEM_COUNT = %d\n};\n\n#endif /* LB_CANON_IDS_H */\n", ni);
+}
+
+static void write_source(FILE *out, const Row *tasks, int nt, const Row *items, int ni) {
+    int n_inputs = 0;
+    fprintf(out,
+            "/* Generated by tools/lb_tablegen.c from data/tasks.txt and data/items.txt. Do not edit. */\n"
+            "#include \"lastbreach.h\"\n"
+            "#include \"lb_canon_ids.h\"\n\n"
+            "/* Required task inputs; tasks point at their run of entries. */\n"
+            "static const TaskInput kCanonTaskInputs[] = {\n");
+    for (int i = 0; i<nt; i++) {
+        for (int k = 0; k<tasks[i].n_inputs; k++) {
+            fputs("    {", out);
+            put_enum(out, "CANON_ITEM_", items[find_row(items, ni, tasks[i].input_item[k])].name);
+            fprintf(out, ", %s},\n", tasks[i].input_qty[k]);
+            n_inputs++;
+        }
+    }
+    /* Same C99 rule as the tag list below: keep the array non-empty. */
+    if (!n_inputs) fputs("    {0, 0}\n", out);
+    fprintf(out, "};\n\n/* {name, hash, id, time_ticks, station, {");
+    for (int k = 0; k<N_DELTA; k++) fprintf(out, "%s%s", k ? ", " : "", kDeltaFields[k]);
+    fprintf(out, "}, inputs, n_inputs} */\nconst CanonTask kCanonTasks[] = {\n");
+    n_inputs = 0;
+    for (int i = 0; i<nt; i++) {
+        const Row *r = &tasks[i];
+        fputs("    {", out);
+        put_cstr(out, r->name);
+        fprintf(out, ", 0x%08xu, ", r->hash);
+        put_enum(out, "CANON_TASK_", r->name);
+        fprintf(out, ", %d, ", r->ticks);
+        if (r->station) put_cstr(out, r->station);
+        else fputs("NULL", out);
+        fputs(", {", out);
+        for (int k = 0; k<N_DELTA; k++) fprintf(out, "%s%s", k ? ", " : "", r->delta[k] ? r->delta[k] : "0");
+        if (r->n_inputs) fprintf(out, "}, kCanonTaskInputs+%d, %d}%s\n", n_inputs, r->n_inputs, i+1<nt ? "," : "");
+        else fprintf(out, "}, NULL, 0}%s\n", i+1<nt ? "," : "");
+        n_inputs += r->n_inputs;
+    }
+    fprintf(out, "};\nconst int kCanonTaskCount = CANON_TASK_COUNT;\n\n");
+
+    fprintf(out, "const char *const kCanonItemTags[] = {");
+    for (int k = 0; k<g_ntags; k++) {
+        fputs(k ? ", " : "", out);
+        put_cstr(out, g_tags[k]);
+    }
+    /* C99 has no empty initializer lists. */
+    fprintf(out, "%s};\nconst int kCanonItemTagCount = %d;\n\n", g_ntags ? "" : "NULL", g_ntags);
+
+    fprintf(out, "/* {name, hash, id, tags, shelf_life_days} */\nconst CanonItem kCanonItems[] = {\n");
+    for (int i = 0; i<ni; i++) {
+        fputs("    {", out);
+        put_cstr(out, items[i].name);
+        fprintf(out, ", 0x%08xu, ", items[i].hash);
+        put_enum(out, "CANON_ITEM_", items[i].name);
+        fprintf(out, ", 0x%llxull, %d}%s\n", items[i].tags, items[i].shelf_days, i+1<ni ? "," : "");
+    }
+    fprintf(out, "};\nconst int kCanonItemCount = CANON_ITEM_COUNT;\n");
+}
+
+static FILE *open_out(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "lb_tablegen: cannot write %s\n", path);
+        exit(1);
+    }
+    return f;
+}
+
+static Row g_tasks[MAX_ROWS];
+static Row g_items[MAX_ROWS];
+
+/** main function. */
+int main(int argc, char **argv) {
+    if (argc != 5) {
+        fprintf(stderr, "usage: lb_tablegen TASKS.txt ITEMS.txt OUT.c OUT.h\n");
+        return 2;
+    }
+    int nt = read_rows(argv[1], g_tasks, 1);
+    int ni = read_rows(argv[2], g_items, 0);
+    sort_unique(g_tasks, nt, "task");
+    sort_unique(g_items, ni, "item");
+    for (int i = 0; i<nt; i++) {
+        for (int k = 0; k<g_tasks[i].n_inputs; k++) {
+            if (find_row(g_items, ni, g_tasks[i].input_item[k]) < 0) {
+                g_path = argv[1];
+                g_line = g_tasks[i].line;
+                die("task %s needs unknown item '%s'", g_tasks[i].name, g_tasks[i].input_item[k]);
+            }
+        }
+    }
+
+    FILE *out = open_out(argv[3]);
+    write_source(out, g_tasks, nt, g_items, ni);
+    if (fclose(out) != 0) die("failed to write %s", argv[3]);
+    out = open_out(argv[4]);
+    write_header(out, g_tasks, nt, g_items, ni);
+    if (fclose(out) != 0) die("failed to write %s", argv[4]);
+    return 0;
+}